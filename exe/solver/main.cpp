@@ -108,7 +108,7 @@ int main(int argc, char **argv) {
 
         /**
          * this program would continue running here, until the viewer is closed by the users.
-         * the viewer is maintained by the 'CalibSolver'.
+         * the viewer is maintained by the 'CalibSolver' (not created in the headless mode).
          */
 
     } catch (const ns_ikalibr::IKalibrStatus &status) {
@@ -0,0 +1,359 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ros/ros.h"
+#include "spdlog/spdlog.h"
+#include "util/status.hpp"
+#include "spdlog/fmt/bundled/color.h"
+#include "util/utils_tpl.hpp"
+#include "ctraj/core/spline_bundle.h"
+#include "ceres/manifold.h"
+#include "factor/imu_gyro_factor.hpp"
+#include "factor/imu_acce_factor.hpp"
+#include "factor/radar_factor.hpp"
+#include "factor/point_to_surfel_factor.hpp"
+#include "chrono"
+#include "random"
+#include "map"
+#include "limits"
+#include "cmath"
+#include "cstdlib"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+using namespace ns_ikalibr;
+
+constexpr int Order = Configor::Prior::SplineOrder;
+using SplineBundleType = ns_ctraj::SplineBundle<Order>;
+using SplineMetaType = ns_ctraj::SplineMeta<Order>;
+
+/**
+ * the randomly generated states shared by all factors, the splines are dense enough so that
+ * measurements always lie in a single segment (the case the analytic factors are designed for)
+ */
+struct RandomStates {
+    SplineBundleType::Ptr splines;
+
+    Sophus::SO3d SO3_SenToBr, SO3_AtoG;
+    Eigen::Vector3d POS_SenInBr, bias, gravity;
+    Eigen::Vector6d mapCoeff;
+    double TO_SenToBr;
+
+    explicit RandomStates(std::default_random_engine &engine) {
+        std::uniform_real_distribution<double> u(-1.0, 1.0);
+        auto RandVec3 = [&engine, &u](double scale) {
+            return Eigen::Vector3d(u(engine), u(engine), u(engine)) * scale;
+        };
+
+        splines = SplineBundleType::Create(
+            {ns_ctraj::SplineInfo(Configor::Preference::SO3_SPLINE,
+                                  ns_ctraj::SplineType::So3Spline, 0.0, 1.0, 0.05),
+             ns_ctraj::SplineInfo(Configor::Preference::SCALE_SPLINE,
+                                  ns_ctraj::SplineType::RdSpline, 0.0, 1.0, 0.05)});
+
+        // a random walk for the rotation knots, otherwise the angular velocities are unrealistic
+        auto &so3Spline = splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+        Sophus::SO3d so3 = Sophus::SO3d::exp(RandVec3(M_PI));
+        for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+            so3Spline.GetKnot(i) = so3 = so3 * Sophus::SO3d::exp(RandVec3(0.2));
+        }
+        auto &scaleSpline = splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+        for (int i = 0; i < static_cast<int>(scaleSpline.GetKnots().size()); ++i) {
+            scaleSpline.GetKnot(i) = RandVec3(2.0);
+        }
+
+        SO3_SenToBr = Sophus::SO3d::exp(RandVec3(M_PI));
+        SO3_AtoG = Sophus::SO3d::exp(RandVec3(0.01));
+        POS_SenInBr = RandVec3(0.5);
+        bias = RandVec3(0.1);
+        gravity = Eigen::Vector3d(0.0, 0.0, -9.8) + RandVec3(0.1);
+        mapCoeff << 1.0 + u(engine) * 0.01, 1.0 + u(engine) * 0.01, 1.0 + u(engine) * 0.01,
+            u(engine) * 0.01, u(engine) * 0.01, u(engine) * 0.01;
+        TO_SenToBr = u(engine) * 0.005;
+    }
+
+    [[nodiscard]] std::pair<SplineMetaType, SplineMetaType> Metas(double time) const {
+        SplineMetaType so3Meta, scaleMeta;
+        splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, {{time, time}}, so3Meta);
+        splines->CalculateRdSplineMeta(Configor::Preference::SCALE_SPLINE, {{time, time}},
+                                       scaleMeta);
+        return {so3Meta, scaleMeta};
+    }
+
+    // the knots involved by the spline meta, see 'Estimator::AddSo3KnotsData'
+    template <class SplineType>
+    static void AddKnots(const SplineType &spline,
+                         const SplineMetaType &meta,
+                         std::vector<double *> &blocks) {
+        for (const auto &seg : meta.segments) {
+            auto idxMaster = spline.ComputeTIndex(seg.t0 + seg.dt * 0.5).second;
+            for (std::size_t i = idxMaster; i < idxMaster + seg.NumParameters(); ++i) {
+                blocks.push_back(const_cast<double *>(spline.GetKnot(static_cast<int>(i)).data()));
+            }
+        }
+    }
+
+    [[nodiscard]] std::vector<double *> Knots(const SplineMetaType &so3Meta,
+                                              const SplineMetaType *scaleMeta) const {
+        std::vector<double *> blocks;
+        AddKnots(splines->GetSo3Spline(Configor::Preference::SO3_SPLINE), so3Meta, blocks);
+        if (scaleMeta != nullptr) {
+            AddKnots(splines->GetRdSpline(Configor::Preference::SCALE_SPLINE), *scaleMeta, blocks);
+        }
+        return blocks;
+    }
+};
+
+struct CheckResult {
+    double maxResidualDiff = 0.0;
+    double maxJacobianDiff = 0.0;
+    double analyticTime = 0.0;
+    double autodiffTime = 0.0;
+    int count = 0;
+};
+
+double Evaluate(const ceres::CostFunction *costFunc,
+                const std::vector<double *> &blocks,
+                Eigen::VectorXd &residuals,
+                std::vector<Eigen::MatrixXd> &jacobians) {
+    const int rows = costFunc->num_residuals();
+    const auto &sizes = costFunc->parameter_block_sizes();
+    std::vector<std::vector<double>> jacBuffers(sizes.size());
+    std::vector<double *> jacPtrs(sizes.size());
+    for (int i = 0; i < static_cast<int>(sizes.size()); ++i) {
+        jacBuffers.at(i).resize(rows * sizes.at(i));
+        jacPtrs.at(i) = jacBuffers.at(i).data();
+    }
+    residuals.resize(rows);
+
+    auto start = std::chrono::steady_clock::now();
+    costFunc->Evaluate(blocks.data(), residuals.data(), jacPtrs.data());
+    auto end = std::chrono::steady_clock::now();
+
+    // map the jacobians of quaternions to the tangent space, the ambient ones are not unique
+    static const ceres::EigenQuaternionManifold QUATER_MANIFOLD;
+    jacobians.resize(sizes.size());
+    for (int i = 0; i < static_cast<int>(sizes.size()); ++i) {
+        jacobians.at(i) = Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
+                                                   Eigen::RowMajor>>(jacPtrs.at(i), rows,
+                                                                     sizes.at(i));
+        if (sizes.at(i) == 4) {
+            Eigen::Matrix<double, 4, 3, Eigen::RowMajor> plusJac;
+            QUATER_MANIFOLD.PlusJacobian(blocks.at(i), plusJac.data());
+            jacobians.at(i) = (jacobians.at(i) * plusJac).eval();
+        }
+    }
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+void Compare(const ceres::CostFunction *analytic,
+             const ceres::CostFunction *autodiff,
+             const std::vector<double *> &blocks,
+             CheckResult &result) {
+    Eigen::VectorXd resAna, resAuto;
+    std::vector<Eigen::MatrixXd> jacAna, jacAuto;
+    result.analyticTime += Evaluate(analytic, blocks, resAna, jacAna);
+    result.autodiffTime += Evaluate(autodiff, blocks, resAuto, jacAuto);
+
+    // non-finite differences (e.g., nan) never pass, 'std::max' would drop them
+    auto Finite = [](double diff) {
+        return std::isfinite(diff) ? diff : std::numeric_limits<double>::infinity();
+    };
+    result.maxResidualDiff =
+        std::max(result.maxResidualDiff, Finite((resAna - resAuto).cwiseAbs().maxCoeff()));
+    for (int i = 0; i < static_cast<int>(jacAna.size()); ++i) {
+        // relative to the magnitude of the autodiff jacobian, absolute for tiny ones
+        double diff = (jacAna.at(i) - jacAuto.at(i)).norm() / std::max(1.0, jacAuto.at(i).norm());
+        result.maxJacobianDiff = std::max(result.maxJacobianDiff, Finite(diff));
+    }
+    ++result.count;
+
+    delete analytic;
+    delete autodiff;
+}
+
+template <int TimeDeriv>
+void CheckFactors(int sampleCount,
+                  std::default_random_engine &engine,
+                  std::map<std::string, CheckResult> &results) {
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+    std::uniform_real_distribution<double> time(0.2, 0.8);
+    const std::string suffix = "<" + std::to_string(TimeDeriv) + ">";
+
+    for (int i = 0; i < sampleCount; ++i) {
+        RandomStates states(engine);
+        const double t = time(engine);
+        const double timeByBr = t + states.TO_SenToBr;
+        const auto [so3Meta, scaleMeta] = states.Metas(timeByBr);
+
+        // imu gyroscope, which is independent of the scale spline
+        if constexpr (TimeDeriv == 0) {
+            auto frame = IMUFrame::Create(t, Eigen::Vector3d(u(engine), u(engine), u(engine)),
+                                          Eigen::Vector3d::Zero());
+            auto blocks = states.Knots(so3Meta, nullptr);
+            blocks.insert(blocks.end(),
+                          {states.bias.data(), states.mapCoeff.data(), states.SO3_AtoG.data(),
+                           states.SO3_SenToBr.data(), &states.TO_SenToBr});
+            Compare(IMUGyroAnalyticFactor<Order>::Create(so3Meta, frame, states.TO_SenToBr, 1.0),
+                    IMUGyroFactor<Order>::CreateFixedArity(so3Meta, frame, 1.0), blocks,
+                    results["IMUGyroFactor"]);
+        }
+        // imu accelerometer
+        {
+            auto frame = IMUFrame::Create(t, Eigen::Vector3d::Zero(),
+                                          Eigen::Vector3d(u(engine), u(engine), u(engine)) * 10.0);
+            auto blocks = states.Knots(so3Meta, &scaleMeta);
+            blocks.insert(blocks.end(),
+                          {states.bias.data(), states.mapCoeff.data(), states.gravity.data(),
+                           states.SO3_SenToBr.data(), states.POS_SenInBr.data(),
+                           &states.TO_SenToBr});
+            Compare(IMUAcceAnalyticFactor<Order, TimeDeriv>::Create(so3Meta, scaleMeta, frame,
+                                                                    states.TO_SenToBr, 1.0),
+                    IMUAcceFactor<Order, TimeDeriv>::CreateFixedArity(so3Meta, scaleMeta, frame,
+                                                                      1.0),
+                    blocks, results["IMUAcceFactor" + suffix]);
+        }
+        // radar doppler
+        {
+            auto target = RadarTarget::Create(
+                t, Eigen::Vector3d(u(engine), u(engine), u(engine)) * 20.0, u(engine));
+            auto blocks = states.Knots(so3Meta, &scaleMeta);
+            blocks.insert(blocks.end(), {states.SO3_SenToBr.data(), states.POS_SenInBr.data(),
+                                         &states.TO_SenToBr});
+            Compare(RadarAnalyticFactor<Order, TimeDeriv>::Create(so3Meta, scaleMeta, target,
+                                                                  states.TO_SenToBr, 1.0),
+                    RadarFactor<Order, TimeDeriv>::CreateFixedArity(so3Meta, scaleMeta, target,
+                                                                    1.0),
+                    blocks, results["RadarFactor" + suffix]);
+        }
+        // point to surfel
+        {
+            Eigen::Vector4d surfel;
+            surfel.head<3>() = Eigen::Vector3d(u(engine), u(engine), u(engine)).normalized();
+            surfel(3) = u(engine) * 10.0;
+            auto corr = PointToSurfelCorr::Create(
+                t, Eigen::Vector3d(u(engine), u(engine), u(engine)) * 20.0, 1.0, surfel);
+            auto blocks = states.Knots(so3Meta, &scaleMeta);
+            blocks.insert(blocks.end(), {states.SO3_SenToBr.data(), states.POS_SenInBr.data(),
+                                         &states.TO_SenToBr});
+            Compare(PointToSurfelAnalyticFactor<Order, TimeDeriv>::Create(
+                        so3Meta, scaleMeta, corr, states.TO_SenToBr, 1.0),
+                    PointToSurfelFactor<Order, TimeDeriv>::CreateFixedArity(so3Meta, scaleMeta,
+                                                                            corr, 1.0),
+                    blocks, results["PointToSurfelFactor" + suffix]);
+        }
+    }
+}
+
+// the samples are reproducible, so that a failed check could be rerun and debugged
+constexpr unsigned int RANDOM_SEED = 2024;
+
+int main(int argc, char **argv) {
+    ros::init(argc, argv, "ikalibr_analytic_jacobian_check");
+    // a non-zero exit code for any mismatch or error, so that scripts could rely on the check
+    int exitCode = EXIT_SUCCESS;
+    try {
+        ns_ikalibr::ConfigSpdlog();
+
+        ns_ikalibr::PrintIKalibrLibInfo();
+
+        // load parameters
+        auto sampleCount =
+            GetParamFromROS<int>("/ikalibr_analytic_jacobian_check/sample_count_per_factor");
+        auto tolerance = GetParamFromROS<double>("/ikalibr_analytic_jacobian_check/tolerance");
+        if (sampleCount <= 0 || tolerance <= 0.0) {
+            throw Status(Status::ERROR,
+                         "invalid sample count '{}' or tolerance '{}', both should be positive!",
+                         sampleCount, tolerance);
+        }
+        spdlog::info(
+            "check analytic jacobians against automatic ones using '{}' samples (seed: {})",
+            sampleCount, RANDOM_SEED);
+
+        std::default_random_engine engine(RANDOM_SEED);
+        std::map<std::string, CheckResult> results;
+        CheckFactors<0>(sampleCount, engine, results);
+        CheckFactors<1>(sampleCount, engine, results);
+        CheckFactors<2>(sampleCount, engine, results);
+
+        bool passed = true;
+        for (const auto &[name, res] : results) {
+            const bool ok = res.maxResidualDiff < tolerance && res.maxJacobianDiff < tolerance;
+            passed = passed && ok;
+            spdlog::info(
+                "{:>24}: max residual diff: {:.3e}, max jacobian diff: {:.3e}, evaluation time "
+                "(analytic / autodiff): {:.3f} / {:.3f} (us), {}",
+                name, res.maxResidualDiff, res.maxJacobianDiff, res.analyticTime / res.count,
+                res.autodiffTime / res.count, ok ? "passed" : "FAILED");
+        }
+        if (!passed) {
+            throw Status(Status::ERROR,
+                         "analytic jacobians disagree with automatic ones, do not enable "
+                         "'UseAnalyticJacobian'!");
+        }
+        spdlog::info("all analytic jacobians agree with automatic ones (tolerance: {:.3e})",
+                     tolerance);
+
+    } catch (const ns_ikalibr::IKalibrStatus &status) {
+        exitCode = EXIT_FAILURE;
+        // if error happened, print it
+        static const auto FStyle = fmt::emphasis::italic | fmt::fg(fmt::color::green);
+        static const auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        switch (status.flag) {
+            case ns_ikalibr::Status::FINE:
+                // this case usually won't happen
+                spdlog::info(fmt::format(FStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::WARNING:
+                spdlog::warn(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::ERROR:
+                spdlog::error(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::CRITICAL:
+                spdlog::critical(fmt::format(WECStyle, "{}", status.what));
+                break;
+        }
+    } catch (const std::exception &e) {
+        exitCode = EXIT_FAILURE;
+        // an unknown exception not thrown by this program
+        static const auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        spdlog::critical(fmt::format(WECStyle, "unknown error happened: '{}'", e.what()));
+    }
+
+    ros::shutdown();
+    return exitCode;
+}
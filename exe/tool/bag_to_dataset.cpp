@@ -0,0 +1,131 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ros/ros.h"
+#include "spdlog/spdlog.h"
+#include "config/configor.h"
+#include "util/status.hpp"
+#include "util/utils_tpl.hpp"
+#include "spdlog/fmt/bundled/color.h"
+#include "calib/calib_data_manager.h"
+#include "filesystem"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+int main(int argc, char **argv) {
+    ros::init(argc, argv, "ikalibr_bag_to_dataset");
+
+    try {
+        ns_ikalibr::ConfigSpdlog();
+
+        ns_ikalibr::PrintIKalibrLibInfo();
+
+        // load parameters
+        auto configPath =
+            ns_ikalibr::GetParamFromROS<std::string>("/ikalibr_bag_to_dataset/config_path");
+        spdlog::info("loading configure from yaml file '{}'...", configPath);
+        if (!std::filesystem::exists(configPath)) {
+            throw ns_ikalibr::Status(ns_ikalibr::Status::CRITICAL,
+                                     "configure file dose not exist: '{}'", configPath);
+        }
+
+        auto datasetPath =
+            ns_ikalibr::GetParamFromROS<std::string>("/ikalibr_bag_to_dataset/dataset_path");
+        if (std::filesystem::exists(datasetPath)) {
+            throw ns_ikalibr::Status(ns_ikalibr::Status::WARNING,
+                                     "the output dataset exists: '{}', please delete it first!",
+                                     datasetPath);
+        } else {
+            spdlog::info("the path of output dataset: '{}'", datasetPath);
+        }
+
+        auto chunkDuration =
+            ns_ikalibr::GetParamFromROS<double>("/ikalibr_bag_to_dataset/chunk_duration");
+        if (chunkDuration <= 0.0) {
+            throw ns_ikalibr::Status(ns_ikalibr::Status::WARNING,
+                                     "invalid chunk duration: '{:.3f}'", chunkDuration);
+        } else {
+            spdlog::info("the time duration of chunks: '{:.3f}'", chunkDuration);
+        }
+
+        if (!ns_ikalibr::Configor::LoadConfigure(configPath)) {
+            throw ns_ikalibr::Status(ns_ikalibr::Status::CRITICAL,
+                                     "load configure file from '{}' failed!", configPath);
+        }
+        using DataStream = ns_ikalibr::Configor::DataStream;
+        if (!std::filesystem::exists(DataStream::BagPath)) {
+            throw ns_ikalibr::Status(ns_ikalibr::Status::CRITICAL,
+                                     "can not find the ros bag (i.e., DataStream::BagPath): '{}'",
+                                     DataStream::BagPath);
+        }
+        // the whole ros bag is converted, the time piece is selected when the dataset is loaded
+        DataStream::BeginTime = -1.0, DataStream::Duration = -1.0;
+        spdlog::info("the ros bag to convert: '{}'", DataStream::BagPath);
+
+        // topics and their types in the configure file are converted
+        ns_ikalibr::CalibDataManager::Create()->SaveAsDataset(datasetPath, chunkDuration);
+
+        static constexpr auto FStyle = fmt::emphasis::italic | fmt::fg(fmt::color::green);
+        spdlog::info(fmt::format(FStyle, "converting finished!!! Everything is fine!!!"));
+
+    } catch (const ns_ikalibr::IKalibrStatus &status) {
+        // if error happened, print it
+        static const auto FStyle = fmt::emphasis::italic | fmt::fg(fmt::color::green);
+        static const auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        switch (status.flag) {
+            case ns_ikalibr::Status::FINE:
+                // this case usually won't happen
+                spdlog::info(fmt::format(FStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::WARNING:
+                spdlog::warn(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::ERROR:
+                spdlog::error(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::CRITICAL:
+                spdlog::critical(fmt::format(WECStyle, "{}", status.what));
+                break;
+        }
+    } catch (const std::exception &e) {
+        // an unknown exception not thrown by this program
+        static const auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        spdlog::critical(fmt::format(WECStyle, "unknown error happened: '{}'", e.what()));
+    }
+
+    ros::shutdown();
+    return 0;
+}
@@ -42,6 +42,7 @@
 #include "ctraj/core/spline_bundle.h"
 #include "cereal/types/utility.hpp"
 #include "cereal/types/list.hpp"
+#include "cereal/types/vector.hpp"
 #include "spdlog/fmt/bundled/color.h"
 
 namespace {
@@ -157,19 +158,61 @@ int main(int argc, char **argv) {
             wName = ws + "/hessian/hessian" + dstExt;
             if (std::filesystem::exists(rName)) {
                 spdlog::info("perform transformation:\n   '{}'\n-> '{}'", rName, wName);
-                int row, col;
+                // the sparse hessian matrix, i.e., non-zeros of its upper triangle in triplets
+                long row, col;
+                bool upperTriangle;
+                std::size_t nonZeros;
+                std::vector<int> rowIndices, colIndices;
+                std::vector<double> values;
                 std::vector<std::pair<std::string, int>> parOrderSize;
-                Eigen::MatrixXd hessian;
                 // load
                 {
                     std::ifstream file(rName);
                     auto ar = ns_ikalibr::GetInputArchiveVariant(file, srcFormat);
                     SerializeByInputArchiveVariant(
                         ar, srcFormat, cereal::make_nvp("row", row), cereal::make_nvp("col", col),
+                        cereal::make_nvp("upper_triangle", upperTriangle),
+                        cereal::make_nvp("non_zeros", nonZeros),
+                        cereal::make_nvp("row_indices", rowIndices),
+                        cereal::make_nvp("col_indices", colIndices),
+                        cereal::make_nvp("values", values),
+                        cereal::make_nvp("par_order_size", parOrderSize));
+                }
+                {
+                    // output
+                    std::ofstream file(wName);
+                    auto ar = ns_ikalibr::GetOutputArchiveVariant(file, dstFormat);
+                    SerializeByOutputArchiveVariant(
+                        ar, dstFormat, cereal::make_nvp("row", row), cereal::make_nvp("col", col),
+                        cereal::make_nvp("upper_triangle", upperTriangle),
+                        cereal::make_nvp("non_zeros", nonZeros),
+                        cereal::make_nvp("row_indices", rowIndices),
+                        cereal::make_nvp("col_indices", colIndices),
+                        cereal::make_nvp("values", values),
+                        cereal::make_nvp("par_order_size", parOrderSize));
+                }
+            }
+
+            // ------------------------------------
+            // covariance of spatiotemporal params
+            // ------------------------------------
+            rName = ws + "/covariance/spat_temp_covariance" + srcExt;
+            wName = ws + "/covariance/spat_temp_covariance" + dstExt;
+            if (std::filesystem::exists(rName)) {
+                spdlog::info("perform transformation:\n   '{}'\n-> '{}'", rName, wName);
+                long row, col;
+                std::vector<std::pair<std::string, int>> parOrderSize;
+                Eigen::MatrixXd covariance;
+                // load
+                {
+                    std::ifstream file(rName);
+                    auto ar = ns_ikalibr::GetInputArchiveVariant(file, srcFormat);
+                    SerializeByInputArchiveVariant(ar, srcFormat, cereal::make_nvp("row", row),
+                                                   cereal::make_nvp("col", col));
+                    covariance.resize(row, col);
+                    SerializeByInputArchiveVariant(
+                        ar, srcFormat, cereal::make_nvp("covariance", covariance),
                         cereal::make_nvp("par_order_size", parOrderSize));
-                    hessian.resize(row, col);
-                    SerializeByInputArchiveVariant(ar, srcFormat,
-                                                   cereal::make_nvp("hessian", hessian));
                 }
                 {
                     // output
@@ -177,7 +220,7 @@ int main(int argc, char **argv) {
                     auto ar = ns_ikalibr::GetOutputArchiveVariant(file, dstFormat);
                     SerializeByOutputArchiveVariant(
                         ar, dstFormat, cereal::make_nvp("row", row), cereal::make_nvp("col", col),
-                        cereal::make_nvp("hessian", hessian),
+                        cereal::make_nvp("covariance", covariance),
                         cereal::make_nvp("par_order_size", parOrderSize));
                 }
             }
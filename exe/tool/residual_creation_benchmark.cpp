@@ -0,0 +1,318 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ros/ros.h"
+#include "spdlog/spdlog.h"
+#include "util/status.hpp"
+#include "spdlog/fmt/bundled/color.h"
+#include "util/utils_tpl.hpp"
+#include "calib/estimator_tpl.hpp"
+#include "factor/data_correspondence.h"
+#include "veta/camera/pinhole.h"
+#include "chrono"
+#include "random"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+using namespace ns_ikalibr;
+
+constexpr int Order = Configor::Prior::SplineOrder;
+constexpr TimeDeriv::ScaleSplineType LinScaleType = TimeDeriv::LIN_POS_SPLINE;
+using SplineBundleType = ns_ctraj::SplineBundle<Order>;
+
+/**
+ * exposes the two stages of the 'Add...' methods of the estimator: the (parallel) creation of cost
+ * functions, and their (serial) registration into the problem
+ */
+class EstimatorBenchmark : public Estimator {
+public:
+    using Estimator::Estimator;
+    using Estimator::PendingResidual;
+    using Estimator::CreateResidualsInParallel;
+    using Estimator::CreateIMUGyroResidual;
+    using Estimator::CreateIMUAcceResidual;
+    using Estimator::CreateLiDARPointToSurfelResidual;
+    using Estimator::CreateVisualReprojectionResidual;
+    using Estimator::AddIMUGyroResidualBlock;
+    using Estimator::AddIMUAcceResidualBlock;
+    using Estimator::AddLiDARPointToSurfelResidualBlock;
+    using Estimator::AddVisualReprojectionResidualBlock;
+};
+
+using PendingResidual = EstimatorBenchmark::PendingResidual;
+
+// a kind of measurements, whose residuals are created and registered by the estimator
+struct MeasurementKind {
+    std::string name;
+    std::size_t count;
+    // the spline index lookups involved in creating the i-th residual, returns the knot count
+    std::function<std::size_t(int)> lookup;
+    std::function<void(EstimatorBenchmark &, int, PendingResidual &)> create;
+    std::function<void(EstimatorBenchmark &, int, const PendingResidual &)> add;
+};
+
+template <class Func>
+double TimeCost(const Func &func) {
+    const auto startTime = std::chrono::steady_clock::now();
+    func();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    return elapsed.count();
+}
+
+void ReleaseResiduals(std::vector<PendingResidual> &residuals) {
+    for (auto &residual : residuals) {
+        delete residual.costFunc, delete residual.lossFunc;
+    }
+    residuals.clear();
+}
+
+int main(int argc, char **argv) {
+    ros::init(argc, argv, "ikalibr_residual_creation_benchmark");
+    try {
+        ns_ikalibr::ConfigSpdlog();
+
+        ns_ikalibr::PrintIKalibrLibInfo();
+
+        // load parameters
+        const std::string ns = "/ikalibr_residual_creation_benchmark/";
+        const auto duration = GetParamFromROS<double>(ns + "duration");
+        const auto knotDt = GetParamFromROS<double>(ns + "knot_dt");
+        const auto imuFrequency = GetParamFromROS<double>(ns + "imu_frequency");
+        const auto surfelCorrRate = GetParamFromROS<double>(ns + "point_to_surfel_per_second");
+        const auto reprojRate = GetParamFromROS<double>(ns + "reprojections_per_second");
+        const auto threads = GetParamFromROS<int>(ns + "threads");
+        Configor::Preference::UseAnalyticJacobian =
+            GetParamFromROS<bool>(ns + "use_analytic_jacobian");
+        if (knotDt <= 0.0 || duration <= 4.0 * Order * knotDt || imuFrequency <= 0.0 ||
+            surfelCorrRate < 0.0 || reprojRate < 0.0 || threads <= 0) {
+            throw Status(Status::ERROR, "invalid settings of the benchmark, please check them!");
+        }
+
+        // splines and parameters, values of which have no effect on the construction cost
+        std::default_random_engine engine(0);
+        std::uniform_real_distribution<double> u(-1.0, 1.0);
+        auto RandVec3 = [&engine, &u](double scale) {
+            return Eigen::Vector3d(u(engine), u(engine), u(engine)) * scale;
+        };
+        auto splines = SplineBundleType::Create(
+            {ns_ctraj::SplineInfo(Configor::Preference::SO3_SPLINE,
+                                  ns_ctraj::SplineType::So3Spline, 0.0, duration, knotDt),
+             ns_ctraj::SplineInfo(Configor::Preference::SCALE_SPLINE,
+                                  ns_ctraj::SplineType::RdSpline, 0.0, duration, knotDt)});
+        auto &so3Spline = splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+        auto &scaleSpline = splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+        for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+            so3Spline.GetKnot(i) = Sophus::SO3d::exp(RandVec3(M_PI));
+            scaleSpline.GetKnot(i) = RandVec3(10.0);
+        }
+
+        const std::string imuTopic = "/imu", lidarTopic = "/lidar", camTopic = "/camera";
+        Configor::DataStream::ReferIMU = imuTopic;
+        auto parMagr = CalibParamManager::Create({imuTopic}, {}, {lidarTopic}, {camTopic});
+        parMagr->INTRI.Camera.at(camTopic) =
+            ns_veta::PinholeIntrinsic::Create(640, 480, 500.0, 500.0, 320.0, 240.0);
+        double globalScale = 1.0;
+        const auto option = OptOption::OPT_SO3_SPLINE | OptOption::OPT_SCALE_SPLINE;
+
+        // measurements within the time range of splines
+        const double st = 2.0 * Order * knotDt, et = duration - 2.0 * Order * knotDt;
+        std::uniform_real_distribution<double> time(st, et);
+        std::vector<IMUFrame::Ptr> imuFrames;
+        for (double t = st; t < et; t += 1.0 / imuFrequency) {
+            imuFrames.push_back(IMUFrame::Create(t, RandVec3(1.0), RandVec3(10.0)));
+        }
+        std::vector<PointToSurfelCorr::Ptr> surfelCorrs;
+        for (int i = 0; i < static_cast<int>(surfelCorrRate * (et - st)); ++i) {
+            Eigen::Vector4d surfel;
+            surfel.head<3>() = RandVec3(1.0).normalized();
+            surfel(3) = u(engine) * 10.0;
+            surfelCorrs.push_back(PointToSurfelCorr::Create(time(engine), RandVec3(20.0), 1.0,
+                                                            surfel));
+        }
+        std::vector<VisualReProjCorr::Ptr> reprojCorrs;
+        for (int i = 0; i < static_cast<int>(reprojRate * (et - st)); ++i) {
+            const double ti = time(engine);
+            const Eigen::Vector2d fi = Eigen::Vector2d(320.0, 240.0) + RandVec3(200.0).head<2>();
+            const Eigen::Vector2d fj = Eigen::Vector2d(320.0, 240.0) + RandVec3(200.0).head<2>();
+            reprojCorrs.push_back(
+                VisualReProjCorr::Create(ti, std::min(ti + 0.1, et), fi, fj, 0.0, 0.0, 1.0));
+        }
+        // each reprojection refers to its own landmark here
+        std::vector<double> invDepths(reprojCorrs.size(), 0.2);
+
+        auto MetaKnots = [&splines](const std::vector<std::pair<double, double>> &times,
+                                    bool withScale) {
+            Estimator::SplineMetaType so3Meta, scaleMeta;
+            splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, times, so3Meta);
+            if (withScale) {
+                splines->CalculateRdSplineMeta(Configor::Preference::SCALE_SPLINE, times,
+                                               scaleMeta);
+            }
+            return so3Meta.NumParameters() + scaleMeta.NumParameters();
+        };
+
+        std::vector<MeasurementKind> kinds;
+        kinds.push_back(
+            {"IMUGyro", imuFrames.size(),
+             [&](int i) {
+                 const double t = imuFrames.at(i)->GetTimestamp();
+                 return MetaKnots({{t, t}}, false);
+             },
+             [&](EstimatorBenchmark &est, int i, PendingResidual &res) {
+                 est.CreateIMUGyroResidual(imuFrames.at(i), imuTopic, option, 1.0, res);
+             },
+             [&](EstimatorBenchmark &est, int i, const PendingResidual &res) {
+                 est.AddIMUGyroResidualBlock(res.costFunc, res.so3Meta, imuTopic, option);
+             }});
+        kinds.push_back(
+            {"IMUAcce", imuFrames.size(),
+             [&](int i) {
+                 const double t = imuFrames.at(i)->GetTimestamp();
+                 return MetaKnots({{t, t}}, true);
+             },
+             [&](EstimatorBenchmark &est, int i, PendingResidual &res) {
+                 est.CreateIMUAcceResidual<LinScaleType>(imuFrames.at(i), imuTopic, option,
+                                                         1.0, res);
+             },
+             [&](EstimatorBenchmark &est, int i, const PendingResidual &res) {
+                 est.AddIMUAcceResidualBlock(res.costFunc, res.so3Meta, res.scaleMeta, imuTopic,
+                                             option);
+             }});
+        kinds.push_back(
+            {"LiDARPointToSurfel", surfelCorrs.size(),
+             [&](int i) {
+                 const double t = surfelCorrs.at(i)->timestamp;
+                 return MetaKnots({{t, t}}, true);
+             },
+             [&](EstimatorBenchmark &est, int i, PendingResidual &res) {
+                 est.CreateLiDARPointToSurfelResidual<LinScaleType>(
+                     surfelCorrs.at(i), lidarTopic, option, 1.0, res);
+             },
+             [&](EstimatorBenchmark &est, int i, const PendingResidual &res) {
+                 est.AddLiDARPointToSurfelResidualBlock(res.costFunc, res.lossFunc, res.so3Meta,
+                                                        res.scaleMeta, lidarTopic, option);
+             }});
+        kinds.push_back(
+            {"VisualReprojection", reprojCorrs.size(),
+             [&](int i) {
+                 const auto &corr = reprojCorrs.at(i);
+                 return MetaKnots({{corr->ti, corr->ti}, {corr->tj, corr->tj}}, true);
+             },
+             [&](EstimatorBenchmark &est, int i, PendingResidual &res) {
+                 est.CreateVisualReprojectionResidual<LinScaleType>(
+                     reprojCorrs.at(i), camTopic, option, 1.0, res);
+             },
+             [&](EstimatorBenchmark &est, int i, const PendingResidual &res) {
+                 est.AddVisualReprojectionResidualBlock(res.costFunc, res.lossFunc, res.so3Meta,
+                                                        res.scaleMeta, camTopic, &globalScale,
+                                                        &invDepths.at(i), option);
+             }});
+
+        spdlog::info(
+            "knots: {} x 2, analytic jacobians: {}, times (s) of creating residuals using 1 and {} "
+            "thread(s), and of registering them into the problem:",
+            so3Spline.GetKnots().size(), Configor::Preference::UseAnalyticJacobian, threads);
+        for (const auto &kind : kinds) {
+            EstimatorBenchmark estimator(splines, parMagr);
+            auto Create = [&kind, &estimator](std::vector<PendingResidual> &residuals) {
+                residuals = estimator.CreateResidualsInParallel(
+                    kind.count, [&kind, &estimator](int i, PendingResidual &res) {
+                        kind.create(estimator, i, res);
+                    });
+            };
+            std::vector<PendingResidual> residuals;
+
+            // spline index lookups only, the rest of the serial creation is the allocation
+            std::size_t knotCount = 0;
+            const double lookupTime = TimeCost([&kind, &knotCount]() {
+                for (int i = 0; i < static_cast<int>(kind.count); ++i) {
+                    knotCount += kind.lookup(i);
+                }
+            });
+
+            Configor::Preference::ThreadsToUse = 1;
+            const double serialTime = TimeCost([&Create, &residuals]() { Create(residuals); });
+            ReleaseResiduals(residuals);
+
+            Configor::Preference::ThreadsToUse = threads;
+            const double parallelTime = TimeCost([&Create, &residuals]() { Create(residuals); });
+
+            // the problem takes the ownership of created functions
+            const double registerTime = TimeCost([&kind, &estimator, &residuals]() {
+                for (int i = 0; i < static_cast<int>(residuals.size()); ++i) {
+                    if (residuals.at(i).costFunc != nullptr) {
+                        kind.add(estimator, i, residuals.at(i));
+                    }
+                }
+            });
+
+            spdlog::info(
+                "{:>20}: {:>7} residuals ({:.1f} knots each), serial: {:.3f} (lookup: {:.3f}, "
+                "allocation: {:.3f}), parallel: {:.3f} (x{:.2f}), registration: {:.3f}",
+                kind.name, estimator.NumResidualBlocks(),
+                static_cast<double>(knotCount) / std::max<std::size_t>(kind.count, 1), serialTime,
+                lookupTime, std::max(serialTime - lookupTime, 0.0), parallelTime,
+                serialTime / std::max(parallelTime, 1E-9), registerTime);
+        }
+
+    } catch (const ns_ikalibr::IKalibrStatus &status) {
+        // if error happened, print it
+        static const auto FStyle = fmt::emphasis::italic | fmt::fg(fmt::color::green);
+        static const auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        switch (status.flag) {
+            case ns_ikalibr::Status::FINE:
+                // this case usually won't happen
+                spdlog::info(fmt::format(FStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::WARNING:
+                spdlog::warn(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::ERROR:
+                spdlog::error(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::CRITICAL:
+                spdlog::critical(fmt::format(WECStyle, "{}", status.what));
+                break;
+        }
+    } catch (const std::exception &e) {
+        // an unknown exception not thrown by this program
+        static const auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        spdlog::critical(fmt::format(WECStyle, "unknown error happened: '{}'", e.what()));
+    }
+
+    ros::shutdown();
+    return 0;
+}
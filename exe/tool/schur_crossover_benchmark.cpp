@@ -0,0 +1,440 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ros/ros.h"
+#include "spdlog/spdlog.h"
+#include "util/status.hpp"
+#include "spdlog/fmt/bundled/color.h"
+#include "util/utils_tpl.hpp"
+#include "calib/estimator.h"
+#include "ctraj/core/spline_bundle.h"
+#include "ceres/manifold.h"
+#include "factor/data_correspondence.h"
+#include "factor/imu_gyro_factor.hpp"
+#include "factor/imu_acce_factor.hpp"
+#include "factor/visual_reproj_factor.hpp"
+#include "random"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+using namespace ns_ikalibr;
+
+constexpr int Order = Configor::Prior::SplineOrder;
+constexpr int AcceDeriv = TimeDeriv::Deriv<TimeDeriv::LIN_POS_SPLINE, TimeDeriv::LIN_ACCE>();
+constexpr int PosDeriv = TimeDeriv::Deriv<TimeDeriv::LIN_POS_SPLINE, TimeDeriv::LIN_POS>();
+using SplineBundleType = ns_ctraj::SplineBundle<Order>;
+using SplineMetaType = ns_ctraj::SplineMeta<Order>;
+
+struct BenchmarkSetting {
+    double knotDt;
+    double imuFrequency;
+    double landmarkRate;
+    int observationsPerLandmark;
+    int iterations;
+    int threads;
+};
+
+/**
+ * a synthetic visual-inertial problem whose structure is the one of the batch optimization: spline
+ * knots are coupled by inertial factors in a band, and landmark (inverse) depths are coupled with
+ * knots of frames observing them. Measurements are generated from the ground truth, and states are
+ * perturbed before solving, thus every linear solver solves the same problem
+ */
+class SyntheticProblem {
+private:
+    SplineBundleType::Ptr _splines;
+
+    // the camera is rigidly attached to the imu (identity extrinsics), intrinsics are fixed
+    double _fx = 500.0, _fy = 500.0, _cx = 320.0, _cy = 240.0;
+    double _readout = 0.0, _globalScale = 1.0, _timeOffset = 0.0;
+    Sophus::SO3d _SO3_SenToBr, _SO3_AtoG;
+    Eigen::Vector3d _POS_SenInBr = Eigen::Vector3d::Zero();
+    Eigen::Vector3d _gyroBias = Eigen::Vector3d::Zero(), _acceBias = Eigen::Vector3d::Zero();
+    Eigen::Vector3d _gravity = Eigen::Vector3d(0.0, 0.0, -9.8);
+    Eigen::Vector6d _gyroMapCoeff, _acceMapCoeff;
+
+    std::vector<double> _invDepths;
+
+    // cost functions and their param blocks, they are not owned by problems (reused by solvers)
+    std::vector<std::unique_ptr<ceres::CostFunction>> _costFuncs;
+    std::vector<std::vector<double *>> _costFuncBlocks;
+    ceres::EigenQuaternionManifold _quaterManifold;
+
+    // the perturbed initial states
+    std::vector<Sophus::SO3d> _initSo3Knots;
+    std::vector<Eigen::Vector3d> _initScaleKnots;
+    std::vector<double> _initInvDepths;
+
+public:
+    SyntheticProblem(double duration, const BenchmarkSetting &setting, std::uint32_t seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<double> n(0.0, 1.0);
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        auto RandVec3 = [&engine, &n](double sigma) {
+            return Eigen::Vector3d(n(engine), n(engine), n(engine)) * sigma;
+        };
+        _gyroMapCoeff << 1.0, 1.0, 1.0, 0.0, 0.0, 0.0;
+        _acceMapCoeff = _gyroMapCoeff;
+
+        _splines = SplineBundleType::Create(
+            {ns_ctraj::SplineInfo(Configor::Preference::SO3_SPLINE,
+                                  ns_ctraj::SplineType::So3Spline, 0.0, duration, setting.knotDt),
+             ns_ctraj::SplineInfo(Configor::Preference::SCALE_SPLINE,
+                                  ns_ctraj::SplineType::RdSpline, 0.0, duration, setting.knotDt)});
+        auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+        auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+
+        // random walks with handheld-like velocities
+        Sophus::SO3d so3;
+        Eigen::Vector3d pos = Eigen::Vector3d::Zero();
+        for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+            so3Spline.GetKnot(i) = so3 = so3 * Sophus::SO3d::exp(RandVec3(0.3 * setting.knotDt));
+            scaleSpline.GetKnot(i) = pos = pos + RandVec3(0.5 * setting.knotDt);
+        }
+
+        const double st = Order * setting.knotDt, et = duration - Order * setting.knotDt;
+
+        // inertial measurements, generated by evaluating factors with zero measurements
+        for (double t = st; t < et; t += 1.0 / setting.imuFrequency) {
+            auto [so3Meta, scaleMeta] = Metas({{t, t}});
+            auto zero = IMUFrame::Create(t, Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero());
+
+            auto gyroBlocks = Knots(so3Meta, nullptr);
+            gyroBlocks.insert(gyroBlocks.end(),
+                              {_gyroBias.data(), _gyroMapCoeff.data(), _SO3_AtoG.data(),
+                               _SO3_SenToBr.data(), &_timeOffset});
+            auto gyro = Evaluate(IMUGyroFactor<Order>::CreateFixedArity(so3Meta, zero, 1.0),
+                                 gyroBlocks);
+
+            auto acceBlocks = Knots(so3Meta, &scaleMeta);
+            acceBlocks.insert(acceBlocks.end(),
+                              {_acceBias.data(), _acceMapCoeff.data(), _gravity.data(),
+                               _SO3_SenToBr.data(), _POS_SenInBr.data(), &_timeOffset});
+            auto acce = Evaluate(
+                IMUAcceFactor<Order, AcceDeriv>::CreateFixedArity(so3Meta, scaleMeta, zero, 1.0),
+                acceBlocks);
+
+            auto frame = IMUFrame::Create(t, gyro, acce);
+            AddCostFunction(IMUGyroFactor<Order>::CreateFixedArity(so3Meta, frame, 1.0),
+                            gyroBlocks);
+            AddCostFunction(
+                IMUAcceFactor<Order, AcceDeriv>::CreateFixedArity(so3Meta, scaleMeta, frame, 1.0),
+                acceBlocks);
+        }
+
+        // landmarks, each is anchored in the frame observing it first
+        const double frameDt = 0.1;
+        const auto landmarkCount = static_cast<int>(setting.landmarkRate * (et - st));
+        // pointers to inverse depths are held by cost functions, thus no reallocation is allowed
+        _invDepths.reserve(landmarkCount);
+        for (int i = 0; i < landmarkCount; ++i) {
+            const double span = setting.observationsPerLandmark * frameDt;
+            const double ti = st + u(engine) * (et - st - span);
+            const Eigen::Vector2d fi(u(engine) * 2.0 * _cx, u(engine) * 2.0 * _cy);
+            _invDepths.push_back(1.0 / (2.0 + u(engine) * 8.0));
+            for (int j = 1; j < setting.observationsPerLandmark; ++j) {
+                const double tj = ti + j * frameDt;
+                auto [so3Meta, scaleMeta] = Metas({{ti, ti}, {tj, tj}});
+
+                auto blocks = Knots(so3Meta, &scaleMeta);
+                blocks.insert(blocks.end(),
+                              {_SO3_SenToBr.data(), _POS_SenInBr.data(), &_timeOffset, &_readout,
+                               &_fx, &_fy, &_cx, &_cy, &_globalScale, &_invDepths.back()});
+                auto fj = Evaluate(
+                    CreateReProjFactor(so3Meta, scaleMeta,
+                                       VisualReProjCorr::Create(ti, tj, fi, Eigen::Vector2d::Zero(),
+                                                                0.0, 0.0, 1.0)),
+                    blocks);
+                if (!fj.allFinite() || fj(0) < 0.0 || fj(0) > 2.0 * _cx || fj(1) < 0.0 ||
+                    fj(1) > 2.0 * _cy) {
+                    // out of the image
+                    continue;
+                }
+                AddCostFunction(CreateReProjFactor(
+                                    so3Meta, scaleMeta,
+                                    VisualReProjCorr::Create(ti, tj, fi, fj, 0.0, 0.0, 1.0)),
+                                blocks);
+            }
+        }
+
+        // perturb states
+        for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+            _initSo3Knots.push_back(so3Spline.GetKnot(i) * Sophus::SO3d::exp(RandVec3(0.01)));
+            _initScaleKnots.push_back(scaleSpline.GetKnot(i) + RandVec3(0.01));
+        }
+        for (const double &invDepth : _invDepths) {
+            _initInvDepths.push_back(invDepth * (1.0 + 0.05 * n(engine)));
+        }
+    }
+
+    [[nodiscard]] std::size_t KnotCount() const { return _initSo3Knots.size(); }
+
+    [[nodiscard]] std::size_t LandmarkCount() const { return _invDepths.size(); }
+
+    [[nodiscard]] std::size_t ResidualCount() const { return _costFuncs.size(); }
+
+    ceres::Solver::Summary Solve(const ceres::Solver::Options &options) {
+        // reset to the perturbed states
+        auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+        auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+        for (int i = 0; i < static_cast<int>(_initSo3Knots.size()); ++i) {
+            so3Spline.GetKnot(i) = _initSo3Knots.at(i);
+            scaleSpline.GetKnot(i) = _initScaleKnots.at(i);
+        }
+        _invDepths = _initInvDepths;
+
+        auto problemOptions = Estimator::DefaultProblemOptions();
+        problemOptions.cost_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+        problemOptions.manifold_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+        ceres::Problem problem(problemOptions);
+        for (int i = 0; i < static_cast<int>(_costFuncs.size()); ++i) {
+            problem.AddResidualBlock(_costFuncs.at(i).get(), nullptr, _costFuncBlocks.at(i));
+        }
+        std::vector<double *> blocks;
+        problem.GetParameterBlocks(&blocks);
+        for (double *block : blocks) {
+            if (problem.ParameterBlockSize(block) == 4) {
+                problem.SetManifold(block, &_quaterManifold);
+            }
+        }
+        // only knots and inverse depths are estimated, the first knots are fixed for the gauge
+        for (double *block : {_SO3_SenToBr.data(), _POS_SenInBr.data(), &_timeOffset, &_readout,
+                              &_fx, &_fy, &_cx, &_cy, &_globalScale, _gyroBias.data(),
+                              _gyroMapCoeff.data(), _SO3_AtoG.data(), _acceBias.data(),
+                              _acceMapCoeff.data(), _gravity.data()}) {
+            if (problem.HasParameterBlock(block)) {
+                problem.SetParameterBlockConstant(block);
+            }
+        }
+        for (int i = 0; i < Order; ++i) {
+            problem.SetParameterBlockConstant(so3Spline.GetKnot(i).data());
+            problem.SetParameterBlockConstant(scaleSpline.GetKnot(i).data());
+        }
+
+        auto curOptions = options;
+        if (ceres::IsSchurType(curOptions.linear_solver_type) && !_invDepths.empty()) {
+            // landmark depths first, the same as 'Estimator::Solve'
+            auto ordering = std::make_shared<ceres::ParameterBlockOrdering>();
+            for (double *block : blocks) {
+                bool isLandmark = block >= _invDepths.data() &&
+                                  block < _invDepths.data() + _invDepths.size();
+                ordering->AddElementToGroup(block, isLandmark ? 0 : 1);
+            }
+            curOptions.linear_solver_ordering = ordering;
+        }
+        ceres::Solver::Summary summary;
+        ceres::Solve(curOptions, &problem, &summary);
+        return summary;
+    }
+
+protected:
+    [[nodiscard]] std::pair<SplineMetaType, SplineMetaType> Metas(
+        const std::vector<std::pair<double, double>> &times) const {
+        SplineMetaType so3Meta, scaleMeta;
+        _splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, times, so3Meta);
+        _splines->CalculateRdSplineMeta(Configor::Preference::SCALE_SPLINE, times, scaleMeta);
+        return {so3Meta, scaleMeta};
+    }
+
+    // the knots involved by the spline meta, see 'Estimator::AddSo3KnotsData'
+    template <class SplineType>
+    static void AddKnots(const SplineType &spline,
+                         const SplineMetaType &meta,
+                         std::vector<double *> &blocks) {
+        for (const auto &seg : meta.segments) {
+            auto idxMaster = spline.ComputeTIndex(seg.t0 + seg.dt * 0.5).second;
+            for (std::size_t i = idxMaster; i < idxMaster + seg.NumParameters(); ++i) {
+                blocks.push_back(const_cast<double *>(spline.GetKnot(static_cast<int>(i)).data()));
+            }
+        }
+    }
+
+    [[nodiscard]] std::vector<double *> Knots(const SplineMetaType &so3Meta,
+                                              const SplineMetaType *scaleMeta) const {
+        std::vector<double *> blocks;
+        AddKnots(_splines->GetSo3Spline(Configor::Preference::SO3_SPLINE), so3Meta, blocks);
+        if (scaleMeta != nullptr) {
+            AddKnots(_splines->GetRdSpline(Configor::Preference::SCALE_SPLINE), *scaleMeta,
+                     blocks);
+        }
+        return blocks;
+    }
+
+    static ceres::CostFunction *CreateReProjFactor(const SplineMetaType &so3Meta,
+                                                   const SplineMetaType &scaleMeta,
+                                                   const VisualReProjCorr::Ptr &corr) {
+        auto costFunc =
+            VisualReProjFactor<Order, PosDeriv>::Create(so3Meta, scaleMeta, corr, 1.0);
+        for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
+            costFunc->AddParameterBlock(4);
+        }
+        for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
+            costFunc->AddParameterBlock(3);
+        }
+        for (int size : {4, 3, 1, 1, 1, 1, 1, 1, 1, 1}) {
+            costFunc->AddParameterBlock(size);
+        }
+        costFunc->SetNumResiduals(2);
+        return costFunc;
+    }
+
+    // residuals of a (temporary) cost function, which is deleted then
+    static Eigen::VectorXd Evaluate(ceres::CostFunction *costFunc,
+                                    const std::vector<double *> &blocks) {
+        std::unique_ptr<ceres::CostFunction> holder(costFunc);
+        Eigen::VectorXd residuals(costFunc->num_residuals());
+        costFunc->Evaluate(blocks.data(), residuals.data(), nullptr);
+        return residuals;
+    }
+
+    void AddCostFunction(ceres::CostFunction *costFunc, const std::vector<double *> &blocks) {
+        _costFuncs.emplace_back(costFunc);
+        _costFuncBlocks.push_back(blocks);
+    }
+};
+
+int main(int argc, char **argv) {
+    ros::init(argc, argv, "ikalibr_schur_crossover_benchmark");
+    try {
+        ns_ikalibr::ConfigSpdlog();
+
+        ns_ikalibr::PrintIKalibrLibInfo();
+
+        // load parameters
+        const std::string ns = "/ikalibr_schur_crossover_benchmark/";
+        auto durations = GetParamFromROS<std::vector<double>>(ns + "durations");
+        auto solvers = GetParamFromROS<std::vector<std::string>>(ns + "linear_solvers");
+        BenchmarkSetting setting{};
+        setting.knotDt = GetParamFromROS<double>(ns + "knot_dt");
+        setting.imuFrequency = GetParamFromROS<double>(ns + "imu_frequency");
+        setting.landmarkRate = GetParamFromROS<double>(ns + "landmarks_per_second");
+        setting.observationsPerLandmark = GetParamFromROS<int>(ns + "observations_per_landmark");
+        setting.iterations = GetParamFromROS<int>(ns + "iterations");
+        setting.threads = GetParamFromROS<int>(ns + "threads");
+        if (durations.empty() || solvers.empty() || setting.knotDt <= 0.0 ||
+            setting.imuFrequency <= 0.0 || setting.landmarkRate < 0.0 ||
+            setting.observationsPerLandmark < 2 || setting.iterations <= 0) {
+            throw Status(Status::ERROR, "invalid settings of the benchmark, please check them!");
+        }
+        std::sort(durations.begin(), durations.end());
+
+        // the fastest linear solver for each duration, to find crossover points
+        std::vector<std::string> fastest;
+        for (double duration : durations) {
+            if (duration <= 2.0 * Order * setting.knotDt +
+                                setting.observationsPerLandmark * 0.1) {
+                throw Status(Status::ERROR, "the duration '{:.3f}' (s) is too short!", duration);
+            }
+            SyntheticProblem problem(duration, setting, 0);
+            spdlog::info(
+                "duration: {:.1f} (s), knots: {} x 2, landmarks: {}, residual blocks: {}", duration,
+                problem.KnotCount(), problem.LandmarkCount(), problem.ResidualCount());
+
+            double bestTime = std::numeric_limits<double>::max();
+            fastest.emplace_back();
+            for (const auto &solver : solvers) {
+                auto options = Estimator::DefaultSolverOptions(setting.threads, false, false);
+                std::string error;
+                if (!ceres::StringToLinearSolverType(solver, &options.linear_solver_type) ||
+                    !options.IsValid(&error)) {
+                    spdlog::warn("linear solver '{}' is unavailable, skip it. {}", solver, error);
+                    continue;
+                }
+                if (options.linear_solver_type == ceres::ITERATIVE_SCHUR) {
+                    options.preconditioner_type = ceres::SCHUR_JACOBI;
+                }
+                // a fixed number of iterations, so that solvers are compared per iteration
+                options.max_num_iterations = setting.iterations;
+                options.function_tolerance = 0.0;
+                options.gradient_tolerance = 0.0;
+                options.parameter_tolerance = 0.0;
+
+                auto summary = problem.Solve(options);
+                if (!summary.IsSolutionUsable()) {
+                    spdlog::warn("linear solver '{}' failed: {}", solver, summary.message);
+                    continue;
+                }
+                const int iterations = std::max(1, static_cast<int>(summary.iterations.size()) - 1);
+                const double timePerIter = summary.total_time_in_seconds / iterations;
+                spdlog::info(
+                    "{:>24}: {:.3f} (s) per iteration ({:.3f} (s) in linear solver), final cost: "
+                    "{:.3e}",
+                    solver, timePerIter, summary.linear_solver_time_in_seconds / iterations,
+                    summary.final_cost);
+                if (timePerIter < bestTime) {
+                    bestTime = timePerIter, fastest.back() = solver;
+                }
+            }
+        }
+
+        spdlog::info("the fastest linear solver for each duration:");
+        for (int i = 0; i < static_cast<int>(durations.size()); ++i) {
+            spdlog::info("{:>8.1f} (s): '{}'", durations.at(i), fastest.at(i));
+            if (i > 0 && fastest.at(i) != fastest.at(i - 1)) {
+                spdlog::info("crossover from '{}' to '{}' between {:.1f} and {:.1f} (s)",
+                             fastest.at(i - 1), fastest.at(i), durations.at(i - 1),
+                             durations.at(i));
+            }
+        }
+
+    } catch (const ns_ikalibr::IKalibrStatus &status) {
+        // if error happened, print it
+        static const auto FStyle = fmt::emphasis::italic | fmt::fg(fmt::color::green);
+        static const auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        switch (status.flag) {
+            case ns_ikalibr::Status::FINE:
+                // this case usually won't happen
+                spdlog::info(fmt::format(FStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::WARNING:
+                spdlog::warn(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::ERROR:
+                spdlog::error(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::CRITICAL:
+                spdlog::critical(fmt::format(WECStyle, "{}", status.what));
+                break;
+        }
+    } catch (const std::exception &e) {
+        // an unknown exception not thrown by this program
+        static const auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        spdlog::critical(fmt::format(WECStyle, "unknown error happened: '{}'", e.what()));
+    }
+
+    ros::shutdown();
+    return 0;
+}
@@ -0,0 +1,228 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ros/ros.h"
+#include "spdlog/spdlog.h"
+#include "util/status.hpp"
+#include "spdlog/fmt/bundled/color.h"
+#include "util/utils_tpl.hpp"
+#include "core/scan_undistortion.h"
+#include "calib/calib_param_manager.h"
+#include "sensor/lidar.h"
+#include "chrono"
+#include "random"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+using namespace ns_ikalibr;
+
+using SplineBundleType = ScanUndistortion::SplineBundleType;
+using UndistortFunc = std::function<std::vector<LiDARFrame::Ptr>(
+    ScanUndistortion &, const std::vector<LiDARFrame::Ptr> &)>;
+
+struct UndistortionResult {
+    std::vector<LiDARFrame::Ptr> frames;
+    double time;
+};
+
+UndistortionResult Undistort(const SplineBundleType::Ptr &splines,
+                             const CalibParamManager::Ptr &parMagr,
+                             const std::vector<LiDARFrame::Ptr> &frames,
+                             const UndistortFunc &func,
+                             double lutResolution) {
+    Configor::Preference::UndistortionLUTResolution = lutResolution;
+    auto undistortion = ScanUndistortion::Create(splines, parMagr);
+
+    const auto startTime = std::chrono::steady_clock::now();
+    auto undistFrames = func(*undistortion, frames);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    return {undistFrames, elapsed.count()};
+}
+
+// the max and mean distances of points undistorted approximately to the exact ones
+std::pair<double, double> PointErrors(const std::vector<LiDARFrame::Ptr> &exact,
+                                      const std::vector<LiDARFrame::Ptr> &approx) {
+    double maxError = 0.0, errorSum = 0.0;
+    std::size_t count = 0;
+    for (int i = 0; i < static_cast<int>(exact.size()); ++i) {
+        if (exact.at(i) == nullptr || approx.at(i) == nullptr) {
+            continue;
+        }
+        const auto &es = exact.at(i)->GetCompactScan(), &as = approx.at(i)->GetCompactScan();
+        for (std::size_t j = 0; j < es->Size(); ++j) {
+            if (!es->IsValid(j) || !as->IsValid(j)) {
+                continue;
+            }
+            const double error = (Eigen::Vector3d(es->GetX()[j], es->GetY()[j], es->GetZ()[j]) -
+                                  Eigen::Vector3d(as->GetX()[j], as->GetY()[j], as->GetZ()[j]))
+                                     .norm();
+            maxError = std::max(maxError, error);
+            errorSum += error;
+            ++count;
+        }
+    }
+    return {maxError, count == 0 ? 0.0 : errorSum / static_cast<double>(count)};
+}
+
+int main(int argc, char **argv) {
+    ros::init(argc, argv, "ikalibr_undistortion_lut_benchmark");
+    try {
+        ns_ikalibr::ConfigSpdlog();
+
+        ns_ikalibr::PrintIKalibrLibInfo();
+
+        // load parameters
+        const std::string ns = "/ikalibr_undistortion_lut_benchmark/";
+        const auto scanCount = GetParamFromROS<int>(ns + "scan_count");
+        const auto scanFrequency = GetParamFromROS<double>(ns + "scan_frequency");
+        const auto pointsPerScan = GetParamFromROS<int>(ns + "points_per_scan");
+        const auto knotDt = GetParamFromROS<double>(ns + "knot_dt");
+        const auto angVelStd = GetParamFromROS<double>(ns + "angular_velocity_std");
+        const auto linVelStd = GetParamFromROS<double>(ns + "linear_velocity_std");
+        const auto resolutions = GetParamFromROS<std::vector<double>>(ns + "lut_resolutions");
+        Configor::Preference::ThreadsToUse = GetParamFromROS<int>(ns + "threads");
+        if (scanCount <= 0 || scanFrequency <= 0.0 || pointsPerScan <= 0 || knotDt <= 0.0 ||
+            angVelStd < 0.0 || linVelStd < 0.0 || resolutions.empty()) {
+            throw Status(Status::ERROR, "invalid settings of the benchmark, please check them!");
+        }
+
+        // splines of random walks, the velocities are random as well
+        std::default_random_engine engine(0);
+        std::normal_distribution<double> n(0.0, 1.0);
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        auto RandVec3 = [&engine, &n](double sigma) {
+            return Eigen::Vector3d(n(engine), n(engine), n(engine)) * sigma;
+        };
+        const double padding = 2.0 * Configor::Prior::SplineOrder * knotDt;
+        const double st = padding, et = st + scanCount / scanFrequency;
+        auto splines = SplineBundleType::Create(
+            {ns_ctraj::SplineInfo(Configor::Preference::SO3_SPLINE,
+                                  ns_ctraj::SplineType::So3Spline, 0.0, et + padding, knotDt),
+             ns_ctraj::SplineInfo(Configor::Preference::SCALE_SPLINE,
+                                  ns_ctraj::SplineType::RdSpline, 0.0, et + padding, knotDt)});
+        auto &so3Spline = splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+        auto &posSpline = splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+        Sophus::SO3d so3;
+        Eigen::Vector3d pos = Eigen::Vector3d::Zero();
+        for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+            so3Spline.GetKnot(i) = so3 = so3 * Sophus::SO3d::exp(RandVec3(angVelStd * knotDt));
+            posSpline.GetKnot(i) = pos = pos + RandVec3(linVelStd * knotDt);
+        }
+
+        const std::string topic = "/lidar";
+        auto parMagr = CalibParamManager::Create({}, {}, {topic});
+        parMagr->EXTRI.SO3_LkToBr.at(topic) = Sophus::SO3d::exp(RandVec3(1.0));
+        parMagr->EXTRI.POS_LkInBr.at(topic) = RandVec3(0.2);
+
+        // scans of spinning lidars, points are sampled uniformly over the sweep
+        std::vector<LiDARFrame::Ptr> frames;
+        for (int i = 0; i < scanCount; ++i) {
+            const double scanTime = st + i / scanFrequency;
+            auto scan = LiDARScan::Create(scanTime);
+            scan->Reserve(pointsPerScan);
+            for (int j = 0; j < pointsPerScan; ++j) {
+                const double sweep = static_cast<double>(j) / pointsPerScan;
+                const double yaw = 2.0 * M_PI * sweep, pitch = (u(engine) - 0.5) * M_PI / 6.0;
+                const Eigen::Vector3d p = Eigen::Vector3d(std::cos(pitch) * std::cos(yaw),
+                                                          std::cos(pitch) * std::sin(yaw),
+                                                          std::sin(pitch)) *
+                                          (1.0 + u(engine) * 49.0);
+                scan->PushBack(static_cast<float>(p(0)), static_cast<float>(p(1)),
+                               static_cast<float>(p(2)), scanTime + sweep / scanFrequency);
+            }
+            frames.push_back(LiDARFrame::Create(scanTime, scan));
+        }
+
+        const std::map<std::string, UndistortFunc> funcs = {
+            {"UndistortToScan",
+             [&topic](ScanUndistortion &undistortion, const std::vector<LiDARFrame::Ptr> &data) {
+                 return undistortion.UndistortToScan(data, topic, ScanUndistortion::Option::ALL);
+             }},
+            {"UndistortToRef",
+             [&topic](ScanUndistortion &undistortion, const std::vector<LiDARFrame::Ptr> &data) {
+                 return undistortion.UndistortToRef(data, topic, ScanUndistortion::Option::ALL);
+             }}};
+
+        std::vector<std::string> reports;
+        for (const auto &[name, func] : funcs) {
+            // the exact evaluation from splines, as the reference
+            auto exact = Undistort(splines, parMagr, frames, func, 0.0);
+            reports.push_back(fmt::format("{:>16}: {:>10}, time: {:.3f} (s)", name, "exact",
+                                          exact.time));
+            for (double resolution : resolutions) {
+                auto lut = Undistort(splines, parMagr, frames, func, resolution);
+                auto [maxError, meanError] = PointErrors(exact.frames, lut.frames);
+                reports.push_back(fmt::format(
+                    "{:>16}: {:>8.4f} s, time: {:.3f} (s) (x{:.2f}), point error (m): max {:.2e}, "
+                    "mean {:.2e}",
+                    name, resolution, lut.time, exact.time / std::max(lut.time, 1E-9), maxError,
+                    meanError));
+            }
+        }
+        spdlog::info("undistortion of {} scans ({} points each) using {} threads:", scanCount,
+                     pointsPerScan, Configor::Preference::AvailableThreads());
+        for (const auto &report : reports) {
+            spdlog::info(report);
+        }
+
+    } catch (const ns_ikalibr::IKalibrStatus &status) {
+        // if error happened, print it
+        static const auto FStyle = fmt::emphasis::italic | fmt::fg(fmt::color::green);
+        static const auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        switch (status.flag) {
+            case ns_ikalibr::Status::FINE:
+                // this case usually won't happen
+                spdlog::info(fmt::format(FStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::WARNING:
+                spdlog::warn(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::ERROR:
+                spdlog::error(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::CRITICAL:
+                spdlog::critical(fmt::format(WECStyle, "{}", status.what));
+                break;
+        }
+    } catch (const std::exception &e) {
+        // an unknown exception not thrown by this program
+        static const auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        spdlog::critical(fmt::format(WECStyle, "unknown error happened: '{}'", e.what()));
+    }
+
+    ros::shutdown();
+    return 0;
+}
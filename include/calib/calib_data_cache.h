@@ -0,0 +1,119 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_CALIB_DATA_CACHE_H
+#define IKALIBR_CALIB_DATA_CACHE_H
+
+#include "sensor/camera.h"
+#include "sensor/imu.h"
+#include "sensor/lidar.h"
+#include "sensor/radar.h"
+#include "sensor/rgbd.h"
+#include "list"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+/**
+ * an on-disk binary cache of the measurements decoded from the ros bag, so that re-runs on the
+ * same bag skip bag parsing. The cache file is named by the hash of a descriptor that consists of
+ * the bag path, size, modification time and the decoding-related fields of
+ * 'Configor::DataStream' (topics, types, 'BeginTime' and 'Duration'), thus a changed bag or
+ * configuration points to another cache file, i.e., the stale one is never hit. The weights and
+ * other fields that do not affect decoding are not involved.
+ *
+ * the cache file is memory-mapped when loaded (private, copy-on-write), image data of camera,
+ * rgbd and depth frames refer to the mapped memory directly rather than being copied, thus the
+ * cache object should outlive these frames.
+ */
+class CalibDataCache {
+public:
+    using Ptr = std::shared_ptr<CalibDataCache>;
+
+    template <typename MesSeqType>
+    using TopicMes = std::map<std::string, MesSeqType>;
+
+private:
+    const static std::string MAGIC;
+    const static std::uint32_t VERSION;
+
+    std::string _descriptor;
+    std::string _filename;
+
+    // the memory mapping of the loaded cache file
+    void *_mapAddr;
+    std::size_t _mapSize;
+
+public:
+    explicit CalibDataCache(const std::string &cacheDir);
+
+    static CalibDataCache::Ptr Create(const std::string &cacheDir);
+
+    CalibDataCache(const CalibDataCache &) = delete;
+
+    CalibDataCache &operator=(const CalibDataCache &) = delete;
+
+    virtual ~CalibDataCache();
+
+    [[nodiscard]] const std::string &GetFilename() const;
+
+    // try to load the cached measurements, returns false if the cache is missing or invalid
+    bool Load(TopicMes<std::vector<IMUFrame::Ptr>> &imuMes,
+              TopicMes<std::vector<RadarTargetArray::Ptr>> &radarMes,
+              TopicMes<std::vector<LiDARFrame::Ptr>> &lidarMes,
+              TopicMes<std::vector<CameraFrame::Ptr>> &camMes,
+              TopicMes<std::list<CameraFrame::Ptr>> &rgbdColorMes,
+              TopicMes<std::list<DepthFrame::Ptr>> &rgbdDepthMes);
+
+    // save the decoded measurements (before any post-processing) to the cache file
+    bool Save(const TopicMes<std::vector<IMUFrame::Ptr>> &imuMes,
+              const TopicMes<std::vector<RadarTargetArray::Ptr>> &radarMes,
+              const TopicMes<std::vector<LiDARFrame::Ptr>> &lidarMes,
+              const TopicMes<std::vector<CameraFrame::Ptr>> &camMes,
+              const TopicMes<std::list<CameraFrame::Ptr>> &rgbdColorMes,
+              const TopicMes<std::list<DepthFrame::Ptr>> &rgbdDepthMes) const;
+
+    // the descriptor of the current bag and data stream configuration
+    static std::string CacheDescriptor();
+
+protected:
+    void Unmap();
+};
+
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_CALIB_DATA_CACHE_H
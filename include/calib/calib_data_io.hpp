@@ -0,0 +1,335 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_CALIB_DATA_IO_HPP
+#define IKALIBR_CALIB_DATA_IO_HPP
+
+#include "sensor/camera.h"
+#include "sensor/imu.h"
+#include "sensor/lidar.h"
+#include "sensor/radar.h"
+#include "sensor/rgbd.h"
+#include "util/status.hpp"
+#include "fstream"
+#include "cstring"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+/**
+ * binary records of decoded measurements, shared by the data cache ('CalibDataCache') and the
+ * native dataset ('CalibDataset'). Image data are aligned in files, so that mats referring to the
+ * memory-mapped files are aligned as well.
+ */
+constexpr std::size_t BINARY_DATA_ALIGNMENT = 64;
+
+struct BinaryDataWriter {
+    std::ofstream &file;
+
+    template <typename Type>
+    void Write(const Type &val) {
+        static_assert(std::is_trivially_copyable_v<Type>);
+        file.write(reinterpret_cast<const char *>(&val), sizeof(Type));
+    }
+
+    void Write(const std::string &str) {
+        Write(static_cast<std::uint64_t>(str.size()));
+        file.write(str.data(), static_cast<std::streamsize>(str.size()));
+    }
+
+    void Write(const Eigen::Vector3d &vec) {
+        file.write(reinterpret_cast<const char *>(vec.data()), 3 * sizeof(double));
+    }
+
+    void Write(const cv::Mat &mat) {
+        const cv::Mat contMat = mat.isContinuous() ? mat : mat.clone();
+        Write(static_cast<std::int32_t>(contMat.rows));
+        Write(static_cast<std::int32_t>(contMat.cols));
+        Write(static_cast<std::int32_t>(contMat.type()));
+        if (!contMat.empty()) {
+            Align();
+            file.write(reinterpret_cast<const char *>(contMat.data),
+                       static_cast<std::streamsize>(contMat.total() * contMat.elemSize()));
+        }
+    }
+
+    template <typename Type>
+    void WriteArray(const std::vector<Type> &vec) {
+        static_assert(std::is_trivially_copyable_v<Type>);
+        file.write(reinterpret_cast<const char *>(vec.data()),
+                   static_cast<std::streamsize>(vec.size() * sizeof(Type)));
+    }
+
+    void Align() {
+        static const char zeros[BINARY_DATA_ALIGNMENT]{};
+        auto pos = static_cast<std::size_t>(file.tellp());
+        file.write(zeros, (BINARY_DATA_ALIGNMENT - pos % BINARY_DATA_ALIGNMENT) %
+                              BINARY_DATA_ALIGNMENT);
+    }
+
+    template <typename MesSeqType, typename WriteFunc>
+    void Write(const std::map<std::string, MesSeqType> &topicMes, WriteFunc writeMes) {
+        Write(static_cast<std::uint64_t>(topicMes.size()));
+        for (const auto &[topic, mesSeq] : topicMes) {
+            Write(topic);
+            Write(static_cast<std::uint64_t>(mesSeq.size()));
+            for (const auto &mes : mesSeq) {
+                writeMes(mes);
+            }
+        }
+    }
+
+    // ------------------------
+    // records of measurements
+    // ------------------------
+
+    void WriteMes(const IMUFrame::Ptr &frame) {
+        Write(frame->GetTimestamp());
+        Write(Eigen::Vector3d(frame->GetGyro()));
+        Write(Eigen::Vector3d(frame->GetAcce()));
+    }
+
+    void WriteMes(const RadarTargetArray::Ptr &array) {
+        Write(array->GetTimestamp());
+        Write(static_cast<std::uint64_t>(array->GetTargets().size()));
+        for (const auto &target : array->GetTargets()) {
+            Write(target->GetTimestamp());
+            Write(target->GetTargetXYZ());
+            Write(target->GetRadialVelocity());
+        }
+    }
+
+    void WriteMes(const LiDARFrame::Ptr &frame) {
+        const auto &scan = frame->GetCompactScan();
+        Write(frame->GetTimestamp());
+        Write(scan->GetBaseTime());
+        Write(scan->GetWidth());
+        Write(scan->GetHeight());
+        Write(static_cast<std::uint8_t>(scan->IsDense()));
+        WriteArray(scan->GetX());
+        WriteArray(scan->GetY());
+        WriteArray(scan->GetZ());
+        WriteArray(scan->GetTimeOffsets());
+    }
+
+    void WriteMes(const CameraFrame::Ptr &frame) {
+        Write(frame->GetTimestamp());
+        Write(frame->GetId());
+        // frames keeping encoded images are saved without decoding
+        const auto &encodedImg = frame->GetEncodedImage();
+        Write(static_cast<std::uint8_t>(encodedImg != nullptr));
+        if (encodedImg != nullptr) {
+            Write(static_cast<std::uint64_t>(encodedImg->size()));
+            file.write(reinterpret_cast<const char *>(encodedImg->data()),
+                       static_cast<std::streamsize>(encodedImg->size()));
+            return;
+        }
+        // only the stored image representation(s) are saved
+        const auto storage = frame->GetImageStorage();
+        Write(static_cast<std::uint8_t>(storage));
+        if (storage != ImageStorageType::COLOR_ONLY) {
+            Write(frame->GetImage());
+        }
+        if (storage != ImageStorageType::GREY_ONLY) {
+            Write(frame->GetColorImage());
+        }
+    }
+
+    void WriteMes(const DepthFrame::Ptr &frame) {
+        Write(frame->GetTimestamp());
+        Write(frame->GetId());
+        Write(frame->GetDepthImage());
+    }
+};
+
+struct BinaryDataReader {
+    const char *data;
+    std::size_t size;
+    std::size_t pos;
+
+    void Require(std::size_t bytes) const {
+        // written as a subtraction, as 'pos + bytes' may overflow for broken lengths
+        if (pos > size || bytes > size - pos) {
+            throw Status(Status::WARNING, "the binary data file is truncated or broken!");
+        }
+    }
+
+    // checks the element count read from the file before any container is sized by it
+    void RequireArray(std::uint64_t count, std::size_t elemSize) const {
+        if (pos > size || (elemSize != 0 && count > (size - pos) / elemSize)) {
+            throw Status(Status::WARNING, "the binary data file is truncated or broken!");
+        }
+    }
+
+    template <typename Type>
+    Type Read() {
+        static_assert(std::is_trivially_copyable_v<Type>);
+        Require(sizeof(Type));
+        Type val;
+        std::memcpy(&val, data + pos, sizeof(Type));
+        pos += sizeof(Type);
+        return val;
+    }
+
+    template <typename Type>
+    void ReadArray(std::vector<Type> &vec) {
+        static_assert(std::is_trivially_copyable_v<Type>);
+        Require(vec.size() * sizeof(Type));
+        std::memcpy(vec.data(), data + pos, vec.size() * sizeof(Type));
+        pos += vec.size() * sizeof(Type);
+    }
+
+    std::string ReadString() {
+        auto len = Read<std::uint64_t>();
+        Require(len);
+        std::string str(data + pos, len);
+        pos += len;
+        return str;
+    }
+
+    Eigen::Vector3d ReadVector3d() {
+        Eigen::Vector3d vec;
+        Require(3 * sizeof(double));
+        std::memcpy(vec.data(), data + pos, 3 * sizeof(double));
+        pos += 3 * sizeof(double);
+        return vec;
+    }
+
+    // the returned mat refers to the mapped memory, no data is copied
+    cv::Mat ReadMat() {
+        auto rows = Read<std::int32_t>();
+        auto cols = Read<std::int32_t>();
+        auto type = Read<std::int32_t>();
+        if (rows <= 0 || cols <= 0) {
+            return {};
+        }
+        pos += (BINARY_DATA_ALIGNMENT - pos % BINARY_DATA_ALIGNMENT) % BINARY_DATA_ALIGNMENT;
+        const std::size_t elemSize = CV_ELEM_SIZE(type);
+        RequireArray(static_cast<std::uint64_t>(rows) * cols, elemSize);
+        const std::size_t bytes = static_cast<std::size_t>(rows) * cols * elemSize;
+        cv::Mat mat(rows, cols, type, const_cast<char *>(data + pos));
+        pos += bytes;
+        return mat;
+    }
+
+    template <typename MesSeqType, typename ReadFunc>
+    void Read(std::map<std::string, MesSeqType> &topicMes, ReadFunc readMes) {
+        auto topicCount = Read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < topicCount; ++i) {
+            auto &mesSeq = topicMes[ReadString()];
+            auto mesCount = Read<std::uint64_t>();
+            for (std::uint64_t j = 0; j < mesCount; ++j) {
+                mesSeq.push_back(readMes());
+            }
+        }
+    }
+
+    // ------------------------
+    // records of measurements
+    // ------------------------
+
+    IMUFrame::Ptr ReadIMUFrame() {
+        auto t = Read<double>();
+        Eigen::Vector3d gyro = ReadVector3d();
+        Eigen::Vector3d acce = ReadVector3d();
+        return IMUFrame::Create(t, gyro, acce);
+    }
+
+    RadarTargetArray::Ptr ReadRadarTargetArray() {
+        auto t = Read<double>();
+        auto targetCount = Read<std::uint64_t>();
+        // time stamp, position and radial velocity of each target
+        RequireArray(targetCount, 5 * sizeof(double));
+        std::vector<RadarTarget::Ptr> targets(targetCount);
+        for (auto &target : targets) {
+            auto tarTime = Read<double>();
+            Eigen::Vector3d xyz = ReadVector3d();
+            target = RadarTarget::Create(tarTime, xyz, Read<double>());
+        }
+        return RadarTargetArray::Create(t, targets);
+    }
+
+    LiDARFrame::Ptr ReadLiDARFrame() {
+        auto t = Read<double>();
+        auto scan = LiDARScan::Create(Read<double>());
+        auto width = Read<std::uint32_t>();
+        auto height = Read<std::uint32_t>();
+        scan->SetDense(Read<std::uint8_t>() != 0);
+        // x, y, z and time offset arrays
+        RequireArray(static_cast<std::uint64_t>(width) * height, 4 * sizeof(float));
+        scan->Resize(width, height);
+        // the arrays are stored one by one
+        ReadArray(scan->GetX());
+        ReadArray(scan->GetY());
+        ReadArray(scan->GetZ());
+        ReadArray(scan->GetTimeOffsets());
+        return LiDARFrame::Create(t, scan);
+    }
+
+    CameraFrame::Ptr ReadCameraFrame() {
+        auto t = Read<double>();
+        auto id = Read<ns_veta::IndexT>();
+        if (Read<std::uint8_t>() != 0) {
+            // the encoded image is copied, as it's held by a vector
+            auto len = Read<std::uint64_t>();
+            Require(len);
+            auto encodedImg =
+                std::make_shared<std::vector<uchar>>(data + pos, data + pos + len);
+            pos += len;
+            auto frame = CameraFrame::Create(t, cv::Mat(), cv::Mat(), id);
+            frame->SetEncodedImage(encodedImg);
+            return frame;
+        }
+        auto storage = static_cast<ImageStorageType>(Read<std::uint8_t>());
+        if (storage != ImageStorageType::GREY_AND_COLOR) {
+            return CameraFrame::CreateSingleImage(t, ReadMat(), storage, id);
+        }
+        cv::Mat greyImg = ReadMat();
+        cv::Mat colorImg = ReadMat();
+        return CameraFrame::Create(t, greyImg, colorImg, id);
+    }
+
+    DepthFrame::Ptr ReadDepthFrame() {
+        auto t = Read<double>();
+        auto id = Read<ns_veta::IndexT>();
+        return DepthFrame::Create(t, ReadMat(), id);
+    }
+};
+
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_CALIB_DATA_IO_HPP
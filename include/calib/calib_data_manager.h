@@ -43,6 +43,7 @@
 #include "sensor/rgbd.h"
 #include "util/status.hpp"
 #include "veta/veta.h"
+#include "list"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -52,6 +53,10 @@ namespace ns_ikalibr {
 
 struct OpticalFlowTripleTrace;
 using OpticalFlowTripleTracePtr = std::shared_ptr<OpticalFlowTripleTrace>;
+class CalibDataCache;
+using CalibDataCachePtr = std::shared_ptr<CalibDataCache>;
+class CalibDataset;
+using CalibDatasetPtr = std::shared_ptr<CalibDataset>;
 
 class CalibDataManager {
 public:
@@ -74,6 +79,14 @@ private:
     double _alignedStartTimestamp{};
     double _alignedEndTimestamp{};
 
+    // the cache of decoded measurements, images of loaded frames may refer to its mapped memory
+    CalibDataCachePtr _dataCache;
+    // the native dataset loaded instead of the ros bag, loaded images may refer to its memory too
+    CalibDatasetPtr _dataset;
+
+    // the number of message instances of a topic that are decoded together by a worker
+    constexpr static std::size_t DecodeBatchSize = 32;
+
 public:
     // using config information to load and adjust data in this constructor
     CalibDataManager();
@@ -183,7 +196,14 @@ public:
     // load camera, lidar, imu data from the ros bag [according to the config file]
     void LoadCalibData();
 
+    // decode all measurements from the ros bag, and write them to a native iKalibr dataset
+    void SaveAsDataset(const std::string &filename, double chunkDuration);
+
 protected:
+    // read and decode raw measurements from the ros bag, rgbd measurements are stored temporally
+    void ReadCalibDataFromBag(std::map<std::string, std::list<CameraFrame::Ptr>> &rgbdColorMesTemp,
+                              std::map<std::string, std::list<DepthFrame::Ptr>> &rgbdDepthMesTemp);
+
     // make sure the first imu frame is before camera and lidar data
     // assign the '_alignedStartTimestamp' and '_alignedEndTimestamp'
     void AdjustCalibDataSequence();
@@ -220,6 +240,28 @@ protected:
     // output the data status
     void OutputDataStatus() const;
 
+    // gather the decoded (non-null) measurements of each topic in timestamp order, the same order
+    // as datasets are written in (see 'CalibDataset')
+    template <typename MesPtrType, typename MesSeqType>
+    static void GatherDecodedMes(std::map<std::string, std::vector<MesPtrType>> &mesSlots,
+                                 std::map<std::string, MesSeqType> &mesSeq) {
+        for (auto &[topic, mes] : mesSlots) {
+            mes.erase(std::remove(mes.begin(), mes.end(), nullptr), mes.end());
+            if (mes.empty()) {
+                // keep the topic absent, which would be reported in 'CheckTopicExists'
+                continue;
+            }
+            // stable sort, measurements with the same timestamp keep their order in the bag
+            std::stable_sort(mes.begin(), mes.end(),
+                             [](const MesPtrType &m1, const MesPtrType &m2) {
+                                 return m1->GetTimestamp() < m2->GetTimestamp();
+                             });
+            auto &seq = mesSeq[topic];
+            seq.insert(seq.end(), mes.begin(), mes.end());
+        }
+        mesSlots.clear();
+    }
+
     template <typename MesSeqType>
     static void CheckTopicExists(const std::string &topic,
                                  const std::map<std::string, MesSeqType> &mesSeq) {
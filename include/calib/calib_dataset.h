@@ -0,0 +1,159 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_CALIB_DATASET_H
+#define IKALIBR_CALIB_DATASET_H
+
+#include "sensor/camera.h"
+#include "sensor/imu.h"
+#include "sensor/lidar.h"
+#include "sensor/radar.h"
+#include "sensor/rgbd.h"
+#include "list"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+/**
+ * the native iKalibr dataset, which is converted from a ros bag by the tool
+ * 'ikalibr_bag_to_dataset' and loaded instead of the bag if 'DataStream::DatasetPath' is set.
+ * Decoded measurements are grouped by topic, and by time within a topic (chunks), an index of
+ * chunks (time range, offset and record count) is stored at the end of the file:
+ *
+ * | MAGIC | VERSION | index offset | chunks of topic 1 | ... | chunks of topic n | index | MAGIC |
+ *
+ * the file is memory-mapped, loading a time piece of topics is chunk lookups in the index, rather
+ * than scanning and deserializing ros messages in the bag. As the data cache does, image data of
+ * loaded frames refer to the mapped memory directly, thus the dataset object should outlive them.
+ */
+class CalibDataset {
+public:
+    using Ptr = std::shared_ptr<CalibDataset>;
+
+    template <typename MesSeqType>
+    using TopicMes = std::map<std::string, MesSeqType>;
+
+    enum class MesKind : std::uint8_t { IMU, RADAR, LIDAR, CAMERA, RGBD_COLOR, RGBD_DEPTH };
+
+    struct ChunkIndex {
+        // the time range of measurements in this chunk
+        double sTime;
+        double eTime;
+        // the offset of the first record in the file, and the number of records
+        std::uint64_t offset;
+        std::uint64_t count;
+    };
+
+    struct TopicIndex {
+        MesKind kind;
+        // the sensor type (i.e., the data loader) used when decoding
+        std::string type;
+        // chunks in time order
+        std::vector<ChunkIndex> chunks;
+    };
+
+private:
+    const static std::string MAGIC;
+    const static std::uint32_t VERSION;
+
+    std::string _filename;
+    // the decoding-related preferences when the dataset was converted
+    std::string _decodeDescriptor;
+    std::map<std::string, TopicIndex> _index;
+
+    // the memory mapping of the dataset file
+    void *_mapAddr;
+    std::size_t _mapSize;
+
+public:
+    // open the dataset, the file is memory-mapped and its index is read, throws if failed
+    explicit CalibDataset(std::string filename);
+
+    static CalibDataset::Ptr Create(const std::string &filename);
+
+    CalibDataset(const CalibDataset &) = delete;
+
+    CalibDataset &operator=(const CalibDataset &) = delete;
+
+    virtual ~CalibDataset();
+
+    [[nodiscard]] const std::string &GetFilename() const;
+
+    [[nodiscard]] const std::map<std::string, TopicIndex> &GetIndex() const;
+
+    /**
+     * load measurements of topics in 'Configor::DataStream', the time piece is determined by
+     * 'BeginTime' and 'Duration' in the same way as the ros bag is read, while timestamps of
+     * measurements rather than bag record times are used
+     */
+    void Load(TopicMes<std::vector<IMUFrame::Ptr>> &imuMes,
+              TopicMes<std::vector<RadarTargetArray::Ptr>> &radarMes,
+              TopicMes<std::vector<LiDARFrame::Ptr>> &lidarMes,
+              TopicMes<std::vector<CameraFrame::Ptr>> &camMes,
+              TopicMes<std::list<CameraFrame::Ptr>> &rgbdColorMes,
+              TopicMes<std::list<DepthFrame::Ptr>> &rgbdDepthMes) const;
+
+    // write measurements decoded from the ros bag to a dataset, chunks span 'chunkDuration' seconds
+    static void Write(const std::string &filename,
+                      const TopicMes<std::vector<IMUFrame::Ptr>> &imuMes,
+                      const TopicMes<std::vector<RadarTargetArray::Ptr>> &radarMes,
+                      const TopicMes<std::vector<LiDARFrame::Ptr>> &lidarMes,
+                      const TopicMes<std::vector<CameraFrame::Ptr>> &camMes,
+                      const TopicMes<std::list<CameraFrame::Ptr>> &rgbdColorMes,
+                      const TopicMes<std::list<DepthFrame::Ptr>> &rgbdDepthMes,
+                      double chunkDuration);
+
+    // the descriptor of decoding-related preferences in 'Configor::Preference'
+    static std::string DecodeDescriptor();
+
+protected:
+    // the kinds and types of topics in 'Configor::DataStream'
+    static std::map<std::string, std::pair<MesKind, std::string>> ConfiguredTopics();
+
+    template <typename MesSeqType, typename ReadFunc>
+    void LoadTopic(const std::string &topic,
+                   double sTime,
+                   double eTime,
+                   MesSeqType &mesSeq,
+                   ReadFunc readMes) const;
+
+    void Unmap();
+};
+
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_CALIB_DATASET_H
@@ -42,6 +42,10 @@
 #include "calib/calib_data_manager.h"
 #include "calib/time_deriv.hpp"
 #include "ceres/ceres.h"
+#include "unordered_set"
+#include "functional"
+#include "optional"
+#include "Eigen/Sparse"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -53,6 +57,8 @@ struct PointToSurfelCorr;
 using PointToSurfelCorrPtr = std::shared_ptr<PointToSurfelCorr>;
 struct VisualReProjCorr;
 using VisualReProjCorrPtr = std::shared_ptr<VisualReProjCorr>;
+struct VisualReProjCorrSeq;
+using VisualReProjCorrSeqPtr = std::shared_ptr<VisualReProjCorrSeq>;
 struct OpticalFlowCorr;
 using OpticalFlowCorrPtr = std::shared_ptr<OpticalFlowCorr>;
 
@@ -133,6 +139,14 @@ private:
     SplineBundleType::Ptr splines;
     CalibParamManager::Ptr parMagr;
 
+    // landmark (inverse) depths, which are eliminated first in schur-based linear solvers
+    std::unordered_set<double *> landmarkParams;
+
+    // named groups of residual blocks, which can be swapped out from the problem as a whole
+    std::map<std::string, std::vector<ceres::ResidualBlockId>> residualGroups;
+    // the group that newly added residual blocks are recorded to (if any)
+    std::vector<ceres::ResidualBlockId> *curResidualGroup = nullptr;
+
     // manifolds
     static std::shared_ptr<ceres::EigenQuaternionManifold> QUATER_MANIFOLD;
     static std::shared_ptr<ceres::SphereManifold<3>> GRAVITY_MANIFOLD;
@@ -153,15 +167,65 @@ public:
         const ceres::Solver::Options &options = Estimator::DefaultSolverOptions(),
         const SpatialTemporalPrioriPtr &priori = nullptr);
 
+    /**
+     * the gauss-newton hessian matrix 'J^T * J' (in tangent spaces) of the considered param blocks,
+     * which is formed sparsely, as most param blocks (knots) are only coupled with their neighbors
+     */
+    Eigen::SparseMatrix<double> GetSparseHessianMatrix(
+        const std::vector<double *> &consideredParBlocks, int numThread = 1);
+
     Eigen::MatrixXd GetHessianMatrix(const std::vector<double *> &consideredParBlocks,
                                      int numThread = 1);
 
+    /**
+     * the joint covariance matrix (in tangent spaces) of the given param blocks, where all the
+     * other param blocks are marginalized, using 'ceres::Covariance'. 'gaugeBlocks' are held
+     * constant temporarily in computation to fix the free gauge of the problem (e.g., the yaw of
+     * splines about the gravity), otherwise the covariance is singular by construction.
+     * std::nullopt would be returned if it can not be computed (the jacobian is rank deficient)
+     */
+    std::optional<Eigen::MatrixXd> GetMarginalCovariance(const std::vector<double *> &parBlocks,
+                                                         const std::vector<double *> &gaugeBlocks,
+                                                         int numThread = 1);
+
+    /**
+     * residual blocks added in 'adder' are recorded as a named group, so that they can be removed
+     * from this estimator later (e.g., data associations renewed between batch optimizations)
+     */
+    void AddResidualGroup(const std::string &name, const std::function<void()> &adder);
+
+    [[nodiscard]] bool HasResidualGroup(const std::string &name) const;
+
+    [[nodiscard]] std::vector<std::string> GetResidualGroupNames() const;
+
+    /**
+     * remove residual blocks of this group, landmarks that are only involved in these residual
+     * blocks are removed as well, as they are owned by the data associations
+     */
+    void RemoveResidualGroup(const std::string &name);
+
+    /**
+     * set all param blocks in this estimator variable, then lock splines, gravity, imu intrinsics,
+     * and sensor extrinsics (temporal ones are bounded if optimized) according to 'option'. Other
+     * param blocks (e.g., camera intrinsics) are locked when their factors are added
+     */
+    void ResetParamBlocksConstancy(Opt option);
+
 public:
     void AddIMUGyroMeasurement(const IMUFrame::Ptr &imuFrame,
                                const std::string &topic,
                                Opt option,
                                double gyroWeight);
 
+    /**
+     * cost functions of measurements are created in parallel, and then added to the problem in
+     * order (see 'CreateResidualsInParallel')
+     */
+    void AddIMUGyroMeasurements(const std::vector<IMUFrame::Ptr> &imuFrames,
+                                const std::string &topic,
+                                Opt option,
+                                double gyroWeight);
+
     /**
      * param blocks:
      * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | ACCE_BIAS | ACCE_MAP_COEFF | GRAVITY |
@@ -173,6 +237,12 @@ public:
                                Opt option,
                                double acceWeight);
 
+    template <TimeDeriv::ScaleSplineType type>
+    void AddIMUAcceMeasurements(const std::vector<IMUFrame::Ptr> &imuFrames,
+                                const std::string &topic,
+                                Opt option,
+                                double acceWeight);
+
     void AddInertialAlignment(const std::vector<IMUFrame::Ptr> &data,
                               const std::string &imuTopic,
                               double sTimeByBr,
@@ -298,6 +368,16 @@ public:
                                          Opt option,
                                          double weight);
 
+    /**
+     * the weight of each correspondence is 'weight * corr->weight'. Correspondences in the same
+     * knot segment are batched into one residual block when possible (see 'BatchedFactor')
+     */
+    template <TimeDeriv::ScaleSplineType type>
+    void AddLiDARPointToSurfelConstraints(const std::vector<PointToSurfelCorrPtr> &corrs,
+                                          const std::string &topic,
+                                          Opt option,
+                                          double weight);
+
     /**
      * param blocks:
      * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | SO3_DnToBr | POS_DnInBr | TO_DnToBr ]
@@ -308,6 +388,12 @@ public:
                                         Opt option,
                                         double weight);
 
+    template <TimeDeriv::ScaleSplineType type>
+    void AddRGBDPointToSurfelConstraints(const std::vector<PointToSurfelCorrPtr> &corrs,
+                                         const std::string &topic,
+                                         Opt option,
+                                         double weight);
+
     /**
      * param blocks:
      * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | SO3_CmToBr | POS_CmInBr | TO_CmToBr |
@@ -321,6 +407,17 @@ public:
                                Opt option,
                                double weight);
 
+    /**
+     * the weight of each correspondence is 'weight * corr->weight', where the inverse depth is the
+     * one of the first observation of the sequence
+     */
+    template <TimeDeriv::ScaleSplineType type>
+    void AddVisualReprojections(const std::vector<VisualReProjCorrSeqPtr> &corrSeqs,
+                                const std::string &topic,
+                                double *globalScale,
+                                Opt option,
+                                double weight);
+
     /**
      * param blocks:
      * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | SO3_DnToBr | POS_DnInBr | TO_DnToBr |
@@ -430,6 +527,60 @@ public:
                                                bool estVelDirOnly);
 
 protected:
+    // the marginal covariance of param blocks computed on the problem as it is
+    std::optional<Eigen::MatrixXd> ComputeMarginalCovariance(const std::vector<double *> &parBlocks,
+                                                             int numThread);
+
+    // a residual whose cost (and loss) function is created but not added to the problem yet
+    struct PendingResidual {
+        ceres::CostFunction *costFunc = nullptr;
+        ceres::LossFunction *lossFunc = nullptr;
+        SplineMetaType so3Meta, scaleMeta;
+    };
+
+    /**
+     * runs 'creator(i, residual)' for i in [0, count) using available threads. Creators only query
+     * splines and parameters, and leave the cost function null for invalid measurements (e.g., out
+     * of the spline range). Registration into the problem is left to the caller, which is serial
+     */
+    static std::vector<PendingResidual> CreateResidualsInParallel(
+        std::size_t count, const std::function<void(int, PendingResidual &)> &creator);
+
+    // the thread-safe parts of the 'Add...' methods above, return false for invalid measurements
+    bool CreateIMUGyroResidual(const IMUFrame::Ptr &imuFrame,
+                               const std::string &topic,
+                               Opt option,
+                               double gyroWeight,
+                               PendingResidual &residual);
+
+    template <TimeDeriv::ScaleSplineType type>
+    bool CreateIMUAcceResidual(const IMUFrame::Ptr &imuFrame,
+                               const std::string &topic,
+                               Opt option,
+                               double acceWeight,
+                               PendingResidual &residual);
+
+    template <TimeDeriv::ScaleSplineType type>
+    bool CreateLiDARPointToSurfelResidual(const PointToSurfelCorrPtr &ptsCorr,
+                                          const std::string &topic,
+                                          Opt option,
+                                          double weight,
+                                          PendingResidual &residual);
+
+    template <TimeDeriv::ScaleSplineType type>
+    bool CreateRGBDPointToSurfelResidual(const PointToSurfelCorrPtr &ptsCorr,
+                                         const std::string &topic,
+                                         Opt option,
+                                         double weight,
+                                         PendingResidual &residual);
+
+    template <TimeDeriv::ScaleSplineType type>
+    bool CreateVisualReprojectionResidual(const VisualReProjCorrPtr &visualCorr,
+                                          const std::string &topic,
+                                          Opt option,
+                                          double weight,
+                                          PendingResidual &residual);
+
     void AddSo3KnotsData(std::vector<double *> &paramBlockVec,
                          const SplineBundleType::So3SplineType &spline,
                          const SplineMetaType &splineMeta,
@@ -440,7 +591,94 @@ protected:
                         const SplineMetaType &splineMeta,
                         bool setToConst);
 
-    static Eigen::MatrixXd CRSMatrix2EigenMatrix(ceres::CRSMatrix *jacobian_crs_matrix);
+    // organize param blocks of the (single or batched) inertial cost function, and add it
+    void AddIMUGyroResidualBlock(ceres::CostFunction *costFunc,
+                                 const SplineMetaType &so3Meta,
+                                 const std::string &topic,
+                                 Opt option);
+
+    void AddIMUAcceResidualBlock(ceres::CostFunction *costFunc,
+                                 const SplineMetaType &so3Meta,
+                                 const SplineMetaType &scaleMeta,
+                                 const std::string &topic,
+                                 Opt option);
+
+    // organize param blocks of the (single or batched) point-to-surfel cost function, and add it
+    void AddLiDARPointToSurfelResidualBlock(ceres::CostFunction *costFunc,
+                                            ceres::LossFunction *lossFunc,
+                                            const SplineMetaType &so3Meta,
+                                            const SplineMetaType &scaleMeta,
+                                            const std::string &topic,
+                                            Opt option);
+
+    void AddRGBDPointToSurfelResidualBlock(ceres::CostFunction *costFunc,
+                                           ceres::LossFunction *lossFunc,
+                                           const SplineMetaType &so3Meta,
+                                           const SplineMetaType &scaleMeta,
+                                           const std::string &topic,
+                                           Opt option);
+
+    void AddVisualReprojectionResidualBlock(ceres::CostFunction *costFunc,
+                                            ceres::LossFunction *lossFunc,
+                                            const SplineMetaType &so3Meta,
+                                            const SplineMetaType &scaleMeta,
+                                            const std::string &topic,
+                                            double *globalScale,
+                                            double *invDepth,
+                                            Opt option);
+
+    using BatchAdder =
+        std::function<void(ceres::CostFunction *, const SplineMetaType &, const SplineMetaType &)>;
+
+    /**
+     * stably sorts point-to-surfel correspondences by their timestamps, so that the ones involving
+     * the same knots are adjacent and could be batched
+     */
+    static std::vector<PointToSurfelCorrPtr> SortedByTimestamp(
+        const std::vector<PointToSurfelCorrPtr> &corrs);
+
+    /**
+     * batches analytic point-to-surfel factors of unpadded time offsets by knot segments, each
+     * batch is passed to 'adder' with its so3 and scale metas
+     */
+    template <TimeDeriv::ScaleSplineType type>
+    void AddPointToSurfelBatches(const std::vector<PointToSurfelCorrPtr> &corrs,
+                                 double timeOffset,
+                                 double weight,
+                                 const BatchAdder &adder);
+
+    using PendingAdder = std::function<void(ceres::CostFunction *,
+                                            ceres::LossFunction *,
+                                            const SplineMetaType &,
+                                            const SplineMetaType &)>;
+
+    /**
+     * passes created residuals to 'adder' in order, where consecutive ones involving the same knots
+     * (see 'InvolveSameKnots') are stacked into a 'BatchedFactor' block, which applies the loss of
+     * each residual itself. Residuals without any mate are passed as they are. This batches the
+     * autodiff factors, including the ones of padded time offsets, for which no analytic factor is
+     * available. Ownership of cost and loss functions is taken, invalid residuals are skipped
+     */
+    static void AddPendingResidualsInBatches(std::vector<PendingResidual> &residuals,
+                                             const PendingAdder &adder);
+
+    // whether two spline metas involve the same knots, i.e., the same segments and time ranges
+    static bool InvolveSameKnots(const SplineMetaType &m1, const SplineMetaType &m2);
+
+    static Eigen::SparseMatrix<double, Eigen::RowMajor> CRSMatrix2EigenSparseMatrix(
+        const ceres::CRSMatrix &crsMatrix);
+
+    // add the residual block to the problem, and record it to the current residual group
+    ceres::ResidualBlockId AddResidualBlockToProblem(ceres::CostFunction *costFunc,
+                                                     ceres::LossFunction *lossFunc,
+                                                     const std::vector<double *> &paramBlocks);
+
+    /**
+     * the elimination ordering for schur-based linear solvers: landmark (inverse) depths are in
+     * the first group, all other param blocks are in the second one. A nullptr would be returned
+     * if no landmark is involved, where ceres finds the ordering itself
+     */
+    std::shared_ptr<ceres::ParameterBlockOrdering> LandmarkFirstOrdering() const;
 
     std::optional<std::pair<Eigen::Vector3d, Eigen::Matrix3d>> InertialVelIntegration(
         const std::vector<IMUFrame::Ptr> &data,
@@ -37,6 +37,7 @@
 
 #include "calib/estimator.h"
 #include "factor/imu_acce_factor.hpp"
+#include "factor/batched_factor.hpp"
 #include "factor/lin_scale_factor.hpp"
 #include "factor/point_to_surfel_factor.hpp"
 #include "factor/radar_factor.hpp"
@@ -55,12 +56,13 @@ namespace ns_ikalibr {
  *   SO3_BiToBr | POS_BiInBr | TO_BiToBr ]
  */
 template <TimeDeriv::ScaleSplineType type>
-void Estimator::AddIMUAcceMeasurement(const IMUFrame::Ptr &imuFrame,
+bool Estimator::CreateIMUAcceResidual(const IMUFrame::Ptr &imuFrame,
                                       const std::string &topic,
                                       Opt option,
-                                      double acceWeight) {
+                                      double acceWeight,
+                                      PendingResidual &residual) {
     // prepare metas for splines
-    SplineMetaType so3Meta, scaleMeta;
+    SplineMetaType &so3Meta = residual.so3Meta, &scaleMeta = residual.scaleMeta;
 
     // different relative control points finding [single vs. range]
     // for the inertial measurements from the reference IMU, there is no need to consider a time
@@ -73,7 +75,7 @@ void Estimator::AddIMUAcceMeasurement(const IMUFrame::Ptr &imuFrame,
             !splines->TimeInRangeForSo3(maxTime, Configor::Preference::SO3_SPLINE) ||
             !splines->TimeInRangeForRd(minTime, Configor::Preference::SCALE_SPLINE) ||
             !splines->TimeInRangeForRd(maxTime, Configor::Preference::SCALE_SPLINE)) {
-            return;
+            return false;
         }
         splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, {{minTime, maxTime}},
                                         so3Meta);
@@ -85,7 +87,7 @@ void Estimator::AddIMUAcceMeasurement(const IMUFrame::Ptr &imuFrame,
         // check point time stamp
         if (!splines->TimeInRangeForSo3(curTime, Configor::Preference::SO3_SPLINE) ||
             !splines->TimeInRangeForRd(curTime, Configor::Preference::SCALE_SPLINE)) {
-            return;
+            return false;
         }
         splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, {{curTime, curTime}},
                                         so3Meta);
@@ -94,97 +96,136 @@ void Estimator::AddIMUAcceMeasurement(const IMUFrame::Ptr &imuFrame,
     }
     // create a cost function
     constexpr int derivIMU = TimeDeriv::Deriv<type, TimeDeriv::LIN_ACCE>();
-    auto costFunc = IMUAcceFactor<Configor::Prior::SplineOrder, derivIMU>::Create(
-        so3Meta, scaleMeta, imuFrame, acceWeight);
-
-    // so3 knots param block [each has four sub params]
-    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(4);
-    }
-    // pos knots param block [each has three sub params]
-    for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(3);
-    }
-
-    // ACCE_BIAS
-    costFunc->AddParameterBlock(3);
-    // ACCE_MAP_COEFF
-    costFunc->AddParameterBlock(6);
-    // GRAVITY
-    costFunc->AddParameterBlock(3);
-    // SO3_BiToBr
-    costFunc->AddParameterBlock(4);
-    // POS_BiInBr
-    costFunc->AddParameterBlock(3);
-    // TO_BiToBr
-    costFunc->AddParameterBlock(1);
-
-    costFunc->SetNumResiduals(3);
-
-    // organize the param block vector
-    std::vector<double *> paramBlockVec;
-
-    // so3 knots param block
-    AddSo3KnotsData(paramBlockVec, splines->GetSo3Spline(Configor::Preference::SO3_SPLINE), so3Meta,
-                    !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
-
-    // lin acce knots
-    AddRdKnotsData(paramBlockVec, splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
-                   scaleMeta, !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
-
-    // ACCE_BIAS
-    auto acceBias = parMagr->INTRI.IMU.at(topic)->ACCE.BIAS.data();
-    paramBlockVec.push_back(acceBias);
-    // ACCE_MAP_COEFF
-    auto aceMapCoeff = parMagr->INTRI.IMU.at(topic)->ACCE.MAP_COEFF.data();
-    paramBlockVec.push_back(aceMapCoeff);
-    // GRAVITY
-    auto gravity = parMagr->GRAVITY.data();
-    paramBlockVec.push_back(gravity);
-    // SO3_BiToBc
-    auto SO3_BiToBc = parMagr->EXTRI.SO3_BiToBr.at(topic).data();
-    paramBlockVec.push_back(SO3_BiToBc);
-    // POS_BiInBc
-    auto POS_BiInBc = parMagr->EXTRI.POS_BiInBr.at(topic).data();
-    paramBlockVec.push_back(POS_BiInBc);
-    // TIME_OFFSET_BiToBc
-    auto TIME_OFFSET_BiToBc = &parMagr->TEMPORAL.TO_BiToBr.at(topic);
-    paramBlockVec.push_back(TIME_OFFSET_BiToBc);
-
-    // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
-    this->SetManifold(gravity, GRAVITY_MANIFOLD.get());
-    this->SetManifold(SO3_BiToBc, QUATER_MANIFOLD.get());
-
-    if (!IsOptionWith(Opt::OPT_ACCE_BIAS, option)) {
-        this->SetParameterBlockConstant(acceBias);
-    }
+    using Factor = IMUAcceFactor<Configor::Prior::SplineOrder, derivIMU>;
+    const bool fixedArity = IsFixedAritySplineMeta(so3Meta) && IsFixedAritySplineMeta(scaleMeta);
+    ceres::CostFunction *costFunc;
+    if (fixedArity && Configor::Preference::UseAnalyticJacobian) {
+        // closed-form jacobians
+        costFunc = IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, derivIMU>::Create(
+            so3Meta, scaleMeta, imuFrame, parMagr->TEMPORAL.TO_BiToBr.at(topic), acceWeight);
+    } else if (fixedArity) {
+        // the knot count is known at compile time, use statically sized jets
+        costFunc = Factor::CreateFixedArity(so3Meta, scaleMeta, imuFrame, acceWeight);
+    } else {
+        auto dynCostFunc = Factor::Create(so3Meta, scaleMeta, imuFrame, acceWeight);
 
-    if (!IsOptionWith(Opt::OPT_ACCE_MAP_COEFF, option)) {
-        this->SetParameterBlockConstant(aceMapCoeff);
-    }
+        // so3 knots param block [each has four sub params]
+        for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
+            dynCostFunc->AddParameterBlock(4);
+        }
+        // pos knots param block [each has three sub params]
+        for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
+            dynCostFunc->AddParameterBlock(3);
+        }
 
-    if (!IsOptionWith(Opt::OPT_GRAVITY, option)) {
-        this->SetParameterBlockConstant(gravity);
-    }
+        // ACCE_BIAS
+        dynCostFunc->AddParameterBlock(3);
+        // ACCE_MAP_COEFF
+        dynCostFunc->AddParameterBlock(6);
+        // GRAVITY
+        dynCostFunc->AddParameterBlock(3);
+        // SO3_BiToBr
+        dynCostFunc->AddParameterBlock(4);
+        // POS_BiInBr
+        dynCostFunc->AddParameterBlock(3);
+        // TO_BiToBr
+        dynCostFunc->AddParameterBlock(1);
+
+        dynCostFunc->SetNumResiduals(3);
+        costFunc = dynCostFunc;
+    }
+
+    residual.costFunc = costFunc;
+    return true;
+}
 
-    if (!IsOptionWith(Opt::OPT_SO3_BiToBr, option)) {
-        this->SetParameterBlockConstant(SO3_BiToBc);
+template <TimeDeriv::ScaleSplineType type>
+void Estimator::AddIMUAcceMeasurement(const IMUFrame::Ptr &imuFrame,
+                                      const std::string &topic,
+                                      Opt option,
+                                      double acceWeight) {
+    PendingResidual res;
+    if (this->CreateIMUAcceResidual<type>(imuFrame, topic, option, acceWeight, res)) {
+        this->AddIMUAcceResidualBlock(res.costFunc, res.so3Meta, res.scaleMeta, topic, option);
     }
+}
 
-    if (!IsOptionWith(Opt::OPT_POS_BiInBr, option)) {
-        this->SetParameterBlockConstant(POS_BiInBc);
+/**
+ * inertial measurements involving the same knots share the same param blocks, they are stacked
+ * into a single 'BatchedFactor' block. Analytic factors (fixed knots, i.e., no time padding)
+ * further share the knot-related quantities in a batch, while autodiff ones are stacked as is
+ */
+template <TimeDeriv::ScaleSplineType type>
+void Estimator::AddIMUAcceMeasurements(const std::vector<IMUFrame::Ptr> &imuFrames,
+                                       const std::string &topic,
+                                       Opt option,
+                                       double acceWeight) {
+    if (!Configor::Preference::UseAnalyticJacobian ||
+        (IsOptionWith(Opt::OPT_TO_BiToBr, option) && Configor::DataStream::ReferIMU != topic)) {
+        auto residuals = CreateResidualsInParallel(
+            imuFrames.size(),
+            [this, &imuFrames, &topic, option, acceWeight](int i, PendingResidual &res) {
+                this->CreateIMUAcceResidual<type>(imuFrames.at(i), topic, option, acceWeight, res);
+            });
+        AddPendingResidualsInBatches(
+            residuals, [this, &topic, option](ceres::CostFunction *costFunc, ceres::LossFunction *,
+                                              const SplineMetaType &so3Meta,
+                                              const SplineMetaType &scaleMeta) {
+                this->AddIMUAcceResidualBlock(costFunc, so3Meta, scaleMeta, topic, option);
+            });
+        return;
     }
+    constexpr int derivIMU = TimeDeriv::Deriv<type, TimeDeriv::LIN_ACCE>();
+    using Factor = IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, derivIMU>;
+
+    const double TO_BiToBr = parMagr->TEMPORAL.TO_BiToBr.at(topic);
+    auto residuals = CreateResidualsInParallel(
+        imuFrames.size(),
+        [this, &imuFrames, TO_BiToBr, acceWeight](int i, PendingResidual &res) {
+            const auto &frame = imuFrames.at(i);
+            double curTime = frame->GetTimestamp() + TO_BiToBr;
+
+            // check point time stamp
+            if (!splines->TimeInRangeForSo3(curTime, Configor::Preference::SO3_SPLINE) ||
+                !splines->TimeInRangeForRd(curTime, Configor::Preference::SCALE_SPLINE)) {
+                return;
+            }
+            splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE,
+                                            {{curTime, curTime}}, res.so3Meta);
+            splines->CalculateRdSplineMeta(Configor::Preference::SCALE_SPLINE,
+                                           {{curTime, curTime}}, res.scaleMeta);
+            res.costFunc = new Factor(res.so3Meta, res.scaleMeta, frame, TO_BiToBr, acceWeight);
+        });
+
+    std::vector<std::unique_ptr<Factor>> batch;
+    SplineMetaType batchSo3Meta, batchScaleMeta;
+
+    auto AddBatch = [&]() {
+        if (!batch.empty()) {
+            this->AddIMUAcceResidualBlock(BatchedFactor<Factor>::Create(std::move(batch)),
+                                          batchSo3Meta, batchScaleMeta, topic, option);
+            batch.clear();
+        }
+    };
 
-    if (!IsOptionWith(Opt::OPT_TO_BiToBr, option)) {
-        this->SetParameterBlockConstant(TIME_OFFSET_BiToBc);
-    } else {
-        // set bound
-        this->SetParameterLowerBound(TIME_OFFSET_BiToBc, 0, -Configor::Prior::TimeOffsetPadding);
-        this->SetParameterUpperBound(TIME_OFFSET_BiToBc, 0, Configor::Prior::TimeOffsetPadding);
+    for (const auto &res : residuals) {
+        if (res.costFunc == nullptr) {
+            continue;
+        }
+        const auto &so3Meta = res.so3Meta, &scaleMeta = res.scaleMeta;
+        // a new segment (of either spline) starts
+        if (!batch.empty() &&
+            (so3Meta.segments.front().t0 != batchSo3Meta.segments.front().t0 ||
+             scaleMeta.segments.front().t0 != batchScaleMeta.segments.front().t0)) {
+            AddBatch();
+        }
+        if (batch.empty()) {
+            batchSo3Meta = so3Meta, batchScaleMeta = scaleMeta;
+        }
+        batch.emplace_back(static_cast<Factor *>(res.costFunc));
     }
+    AddBatch();
 }
-
 /**
  * param blocks:
  * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | SO3_RjToBr | POS_RjInBr | TO_RjToBr ]
@@ -227,23 +268,35 @@ void Estimator::AddRadarMeasurement(const RadarTarget::Ptr &radarFrame,
     static constexpr int derivRadar = TimeDeriv::Deriv<type, TimeDeriv::LIN_VEL>();
 
     // create a cost function
-    auto costFunc = RadarFactor<Configor::Prior::SplineOrder, derivRadar>::Create(
-        so3Meta, scaleMeta, radarFrame, weight);
+    using Factor = RadarFactor<Configor::Prior::SplineOrder, derivRadar>;
+    const bool fixedArity = IsFixedAritySplineMeta(so3Meta) && IsFixedAritySplineMeta(scaleMeta);
+    ceres::CostFunction *costFunc;
+    if (fixedArity && Configor::Preference::UseAnalyticJacobian) {
+        // closed-form jacobians
+        costFunc = RadarAnalyticFactor<Configor::Prior::SplineOrder, derivRadar>::Create(
+            so3Meta, scaleMeta, radarFrame, parMagr->TEMPORAL.TO_RjToBr.at(topic), weight);
+    } else if (fixedArity) {
+        // the knot count is known at compile time, use statically sized jets
+        costFunc = Factor::CreateFixedArity(so3Meta, scaleMeta, radarFrame, weight);
+    } else {
+        auto dynCostFunc = Factor::Create(so3Meta, scaleMeta, radarFrame, weight);
 
-    // so3 knots param block [each has four sub params]
-    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(4);
-    }
-    // pos knots param block [each has three sub params]
-    for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(3);
-    }
-    costFunc->AddParameterBlock(4);  // SO3_RtoB
-    costFunc->AddParameterBlock(3);  // POS_RinB
-    costFunc->AddParameterBlock(1);  // TIME_OFFSET_RtoB
+        // so3 knots param block [each has four sub params]
+        for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
+            dynCostFunc->AddParameterBlock(4);
+        }
+        // pos knots param block [each has three sub params]
+        for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
+            dynCostFunc->AddParameterBlock(3);
+        }
+        dynCostFunc->AddParameterBlock(4);  // SO3_RtoB
+        dynCostFunc->AddParameterBlock(3);  // POS_RinB
+        dynCostFunc->AddParameterBlock(1);  // TIME_OFFSET_RtoB
 
-    // the Residual
-    costFunc->SetNumResiduals(1);
+        // the Residual
+        dynCostFunc->SetNumResiduals(1);
+        costFunc = dynCostFunc;
+    }
 
     // organize the param block vector
     std::vector<double *> paramBlockVec;
@@ -269,7 +322,7 @@ void Estimator::AddRadarMeasurement(const RadarTarget::Ptr &radarFrame,
     // remove dynamic targets (outliers)
     // this->AddResidualBlockToProblem(costFunc, new ceres::HuberLoss(weight * weight * 0.125),
     // paramBlockVec);
-    this->AddResidualBlock(
+    this->AddResidualBlockToProblem(
         costFunc, new ceres::HuberLoss(Configor::Prior::LossForRadarDopplerFactor * weight),
         paramBlockVec);
     this->SetManifold(SO3_RjToBr, QUATER_MANIFOLD.get());
@@ -329,7 +382,7 @@ void Estimator::AddLinearScaleConstraint(double timeByBr,
                    scaleMeta, !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 }
 
 /**
@@ -337,12 +390,13 @@ void Estimator::AddLinearScaleConstraint(double timeByBr,
  * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | SO3_LkToBr | POS_LkInBr | TO_LkToBr ]
  */
 template <TimeDeriv::ScaleSplineType type>
-void Estimator::AddLiDARPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsCorr,
-                                                const std::string &topic,
-                                                Opt option,
-                                                double weight) {
+bool Estimator::CreateLiDARPointToSurfelResidual(const PointToSurfelCorrPtr &ptsCorr,
+                                                 const std::string &topic,
+                                                 Opt option,
+                                                 double weight,
+                                                 PendingResidual &residual) {
     // prepare metas for splines
-    SplineMetaType so3Meta, scaleMeta;
+    SplineMetaType &so3Meta = residual.so3Meta, &scaleMeta = residual.scaleMeta;
 
     // different relative control points finding [single vs. range]
     if (IsOptionWith(Opt::OPT_TO_LkToBr, option)) {
@@ -354,7 +408,7 @@ void Estimator::AddLiDARPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsC
             !splines->TimeInRangeForSo3(maxTime, Configor::Preference::SO3_SPLINE) ||
             !splines->TimeInRangeForRd(minTime, Configor::Preference::SCALE_SPLINE) ||
             !splines->TimeInRangeForRd(maxTime, Configor::Preference::SCALE_SPLINE)) {
-            return;
+            return false;
         }
 
         splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, {{minTime, maxTime}},
@@ -367,7 +421,7 @@ void Estimator::AddLiDARPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsC
         // check point time stamp
         if (!splines->TimeInRangeForSo3(curTime, Configor::Preference::SO3_SPLINE) ||
             !splines->TimeInRangeForRd(curTime, Configor::Preference::SCALE_SPLINE)) {
-            return;
+            return false;
         }
 
         splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, {{curTime, curTime}},
@@ -377,68 +431,85 @@ void Estimator::AddLiDARPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsC
     }
     static constexpr int derivLiDAR = TimeDeriv::Deriv<type, TimeDeriv::LIN_POS>();
     // create a cost function
-    auto costFunc = PointToSurfelFactor<Configor::Prior::SplineOrder, derivLiDAR>::Create(
-        so3Meta, scaleMeta, ptsCorr, weight);
-
-    // so3 knots param block [each has four sub params]
-    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(4);
-    }
-    // pos knots param block [each has three sub params]
-    for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(3);
-    }
-
-    costFunc->AddParameterBlock(4);
-    costFunc->AddParameterBlock(3);
-    costFunc->AddParameterBlock(1);
-
-    costFunc->SetNumResiduals(1);
-
-    // organize the param block vector
-    std::vector<double *> paramBlockVec;
-
-    // so3 knots param block
-    AddSo3KnotsData(paramBlockVec, splines->GetSo3Spline(Configor::Preference::SO3_SPLINE), so3Meta,
-                    !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
-
-    // lin acce knots
-    AddRdKnotsData(paramBlockVec, splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
-                   scaleMeta, !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
-
-    // SO3_LkToBr
-    auto SO3_LkToBr = parMagr->EXTRI.SO3_LkToBr.at(topic).data();
-    paramBlockVec.push_back(SO3_LkToBr);
-
-    // POS_LkInBr
-    auto POS_LkInBr = parMagr->EXTRI.POS_LkInBr.at(topic).data();
-    paramBlockVec.push_back(POS_LkInBr);
+    using Factor = PointToSurfelFactor<Configor::Prior::SplineOrder, derivLiDAR>;
+    const bool fixedArity = IsFixedAritySplineMeta(so3Meta) && IsFixedAritySplineMeta(scaleMeta);
+    ceres::CostFunction *costFunc;
+    if (fixedArity && Configor::Preference::UseAnalyticJacobian) {
+        // closed-form jacobians
+        costFunc = PointToSurfelAnalyticFactor<Configor::Prior::SplineOrder, derivLiDAR>::Create(
+            so3Meta, scaleMeta, ptsCorr, parMagr->TEMPORAL.TO_LkToBr.at(topic), weight);
+    } else if (fixedArity) {
+        // the knot count is known at compile time, use statically sized jets
+        costFunc = Factor::CreateFixedArity(so3Meta, scaleMeta, ptsCorr, weight);
+    } else {
+        auto dynCostFunc = Factor::Create(so3Meta, scaleMeta, ptsCorr, weight);
 
-    // TO_LkToBr
-    auto TO_LkToBr = &parMagr->TEMPORAL.TO_LkToBr.at(topic);
-    paramBlockVec.push_back(TO_LkToBr);
+        // so3 knots param block [each has four sub params]
+        for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
+            dynCostFunc->AddParameterBlock(4);
+        }
+        // pos knots param block [each has three sub params]
+        for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
+            dynCostFunc->AddParameterBlock(3);
+        }
 
-    // pass to problem
-    this->AddResidualBlock(
-        costFunc, new ceres::HuberLoss(Configor::Prior::LossForPointToSurfelFactor * weight),
-        paramBlockVec);
-    this->SetManifold(SO3_LkToBr, QUATER_MANIFOLD.get());
+        dynCostFunc->AddParameterBlock(4);
+        dynCostFunc->AddParameterBlock(3);
+        dynCostFunc->AddParameterBlock(1);
 
-    if (!IsOptionWith(Opt::OPT_SO3_LkToBr, option)) {
-        this->SetParameterBlockConstant(SO3_LkToBr);
+        dynCostFunc->SetNumResiduals(1);
+        costFunc = dynCostFunc;
     }
 
-    if (!IsOptionWith(Opt::OPT_POS_LkInBr, option)) {
-        this->SetParameterBlockConstant(POS_LkInBr);
+    residual.costFunc = costFunc;
+    residual.lossFunc = new ceres::HuberLoss(Configor::Prior::LossForPointToSurfelFactor * weight);
+    return true;
+}
+
+template <TimeDeriv::ScaleSplineType type>
+void Estimator::AddLiDARPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsCorr,
+                                                const std::string &topic,
+                                                Opt option,
+                                                double weight) {
+    PendingResidual res;
+    if (this->CreateLiDARPointToSurfelResidual<type>(ptsCorr, topic, option, weight, res)) {
+        this->AddLiDARPointToSurfelResidualBlock(res.costFunc, res.lossFunc, res.so3Meta,
+                                                 res.scaleMeta, topic, option);
     }
+}
 
-    if (!IsOptionWith(Opt::OPT_TO_LkToBr, option)) {
-        this->SetParameterBlockConstant(TO_LkToBr);
-    } else {
-        // set bound
-        this->SetParameterLowerBound(TO_LkToBr, 0, -Configor::Prior::TimeOffsetPadding);
-        this->SetParameterUpperBound(TO_LkToBr, 0, Configor::Prior::TimeOffsetPadding);
+template <TimeDeriv::ScaleSplineType type>
+void Estimator::AddLiDARPointToSurfelConstraints(const std::vector<PointToSurfelCorrPtr> &corrs,
+                                                 const std::string &topic,
+                                                 Opt option,
+                                                 double weight) {
+    if (!Configor::Preference::UseAnalyticJacobian || IsOptionWith(Opt::OPT_TO_LkToBr, option)) {
+        auto sortedCorrs = SortedByTimestamp(corrs);
+        auto residuals = CreateResidualsInParallel(
+            sortedCorrs.size(),
+            [this, &sortedCorrs, &topic, option, weight](int i, PendingResidual &res) {
+                const auto &corr = sortedCorrs.at(i);
+                this->CreateLiDARPointToSurfelResidual<type>(corr, topic, option,
+                                                             weight * corr->weight, res);
+            });
+        AddPendingResidualsInBatches(
+            residuals, [this, &topic, option](ceres::CostFunction *costFunc,
+                                              ceres::LossFunction *lossFunc,
+                                              const SplineMetaType &so3Meta,
+                                              const SplineMetaType &scaleMeta) {
+                this->AddLiDARPointToSurfelResidualBlock(costFunc, lossFunc, so3Meta, scaleMeta,
+                                                         topic, option);
+            });
+        return;
     }
+    this->AddPointToSurfelBatches<type>(
+        corrs, parMagr->TEMPORAL.TO_LkToBr.at(topic), weight,
+        [this, &topic, option](ceres::CostFunction *costFunc, const SplineMetaType &so3Meta,
+                               const SplineMetaType &scaleMeta) {
+            // robust losses are applied to each correspondence by the batched factor
+            this->AddLiDARPointToSurfelResidualBlock(costFunc, nullptr, so3Meta, scaleMeta, topic,
+                                                     option);
+        });
 }
 
 /**
@@ -446,12 +517,13 @@ void Estimator::AddLiDARPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsC
  * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | SO3_DnToBr | POS_DnInBr | TO_DnToBr ]
  */
 template <TimeDeriv::ScaleSplineType type>
-void Estimator::AddRGBDPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsCorr,
-                                               const std::string &topic,
-                                               Opt option,
-                                               double weight) {
+bool Estimator::CreateRGBDPointToSurfelResidual(const PointToSurfelCorrPtr &ptsCorr,
+                                                const std::string &topic,
+                                                Opt option,
+                                                double weight,
+                                                PendingResidual &residual) {
     // prepare metas for splines
-    SplineMetaType so3Meta, scaleMeta;
+    SplineMetaType &so3Meta = residual.so3Meta, &scaleMeta = residual.scaleMeta;
 
     // different relative control points finding [single vs. range]
     if (IsOptionWith(Opt::OPT_TO_DnToBr, option)) {
@@ -463,7 +535,7 @@ void Estimator::AddRGBDPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsCo
             !splines->TimeInRangeForSo3(maxTime, Configor::Preference::SO3_SPLINE) ||
             !splines->TimeInRangeForRd(minTime, Configor::Preference::SCALE_SPLINE) ||
             !splines->TimeInRangeForRd(maxTime, Configor::Preference::SCALE_SPLINE)) {
-            return;
+            return false;
         }
 
         splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, {{minTime, maxTime}},
@@ -476,7 +548,7 @@ void Estimator::AddRGBDPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsCo
         // check point time stamp
         if (!splines->TimeInRangeForSo3(curTime, Configor::Preference::SO3_SPLINE) ||
             !splines->TimeInRangeForRd(curTime, Configor::Preference::SCALE_SPLINE)) {
-            return;
+            return false;
         }
 
         splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, {{curTime, curTime}},
@@ -486,69 +558,151 @@ void Estimator::AddRGBDPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsCo
     }
     static constexpr int derivLiDAR = TimeDeriv::Deriv<type, TimeDeriv::LIN_POS>();
     // create a cost function
-    auto costFunc = PointToSurfelFactor<Configor::Prior::SplineOrder, derivLiDAR>::Create(
-        so3Meta, scaleMeta, ptsCorr, weight);
-
-    // so3 knots param block [each has four sub params]
-    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(4);
-    }
-    // pos knots param block [each has three sub params]
-    for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(3);
-    }
-
-    costFunc->AddParameterBlock(4);
-    costFunc->AddParameterBlock(3);
-    costFunc->AddParameterBlock(1);
-
-    costFunc->SetNumResiduals(1);
-
-    // organize the param block vector
-    std::vector<double *> paramBlockVec;
-
-    // so3 knots param block
-    AddSo3KnotsData(paramBlockVec, splines->GetSo3Spline(Configor::Preference::SO3_SPLINE), so3Meta,
-                    !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
-
-    // lin acce knots
-    AddRdKnotsData(paramBlockVec, splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
-                   scaleMeta, !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+    using Factor = PointToSurfelFactor<Configor::Prior::SplineOrder, derivLiDAR>;
+    const bool fixedArity = IsFixedAritySplineMeta(so3Meta) && IsFixedAritySplineMeta(scaleMeta);
+    ceres::CostFunction *costFunc;
+    if (fixedArity && Configor::Preference::UseAnalyticJacobian) {
+        // closed-form jacobians
+        costFunc = PointToSurfelAnalyticFactor<Configor::Prior::SplineOrder, derivLiDAR>::Create(
+            so3Meta, scaleMeta, ptsCorr, parMagr->TEMPORAL.TO_DnToBr.at(topic), weight);
+    } else if (fixedArity) {
+        // the knot count is known at compile time, use statically sized jets
+        costFunc = Factor::CreateFixedArity(so3Meta, scaleMeta, ptsCorr, weight);
+    } else {
+        auto dynCostFunc = Factor::Create(so3Meta, scaleMeta, ptsCorr, weight);
 
-    // SO3_DnToBr
-    auto SO3_DnToBr = parMagr->EXTRI.SO3_DnToBr.at(topic).data();
-    paramBlockVec.push_back(SO3_DnToBr);
+        // so3 knots param block [each has four sub params]
+        for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
+            dynCostFunc->AddParameterBlock(4);
+        }
+        // pos knots param block [each has three sub params]
+        for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
+            dynCostFunc->AddParameterBlock(3);
+        }
 
-    // POS_DnInBr
-    auto POS_DnInBr = parMagr->EXTRI.POS_DnInBr.at(topic).data();
-    paramBlockVec.push_back(POS_DnInBr);
+        dynCostFunc->AddParameterBlock(4);
+        dynCostFunc->AddParameterBlock(3);
+        dynCostFunc->AddParameterBlock(1);
 
-    // TO_DnToBr
-    auto TO_DnToBr = &parMagr->TEMPORAL.TO_DnToBr.at(topic);
-    paramBlockVec.push_back(TO_DnToBr);
+        dynCostFunc->SetNumResiduals(1);
+        costFunc = dynCostFunc;
+    }
 
-    // pass to problem
-    this->AddResidualBlock(
-        costFunc,
-        // we use 'Configor::Prior::LossForLiDARFactor' for rgbds here
-        new ceres::HuberLoss(Configor::Prior::LossForPointToSurfelFactor * weight), paramBlockVec);
-    this->SetManifold(SO3_DnToBr, QUATER_MANIFOLD.get());
+    residual.costFunc = costFunc;
+    // we use 'Configor::Prior::LossForPointToSurfelFactor' for rgbds here
+    residual.lossFunc = new ceres::HuberLoss(Configor::Prior::LossForPointToSurfelFactor * weight);
+    return true;
+}
 
-    if (!IsOptionWith(Opt::OPT_SO3_DnToBr, option)) {
-        this->SetParameterBlockConstant(SO3_DnToBr);
+template <TimeDeriv::ScaleSplineType type>
+void Estimator::AddRGBDPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsCorr,
+                                               const std::string &topic,
+                                               Opt option,
+                                               double weight) {
+    PendingResidual res;
+    if (this->CreateRGBDPointToSurfelResidual<type>(ptsCorr, topic, option, weight, res)) {
+        this->AddRGBDPointToSurfelResidualBlock(res.costFunc, res.lossFunc, res.so3Meta,
+                                                res.scaleMeta, topic, option);
     }
+}
 
-    if (!IsOptionWith(Opt::OPT_POS_DnInBr, option)) {
-        this->SetParameterBlockConstant(POS_DnInBr);
+template <TimeDeriv::ScaleSplineType type>
+void Estimator::AddRGBDPointToSurfelConstraints(const std::vector<PointToSurfelCorrPtr> &corrs,
+                                                const std::string &topic,
+                                                Opt option,
+                                                double weight) {
+    if (!Configor::Preference::UseAnalyticJacobian || IsOptionWith(Opt::OPT_TO_DnToBr, option)) {
+        auto sortedCorrs = SortedByTimestamp(corrs);
+        auto residuals = CreateResidualsInParallel(
+            sortedCorrs.size(),
+            [this, &sortedCorrs, &topic, option, weight](int i, PendingResidual &res) {
+                const auto &corr = sortedCorrs.at(i);
+                this->CreateRGBDPointToSurfelResidual<type>(corr, topic, option,
+                                                            weight * corr->weight, res);
+            });
+        AddPendingResidualsInBatches(
+            residuals, [this, &topic, option](ceres::CostFunction *costFunc,
+                                              ceres::LossFunction *lossFunc,
+                                              const SplineMetaType &so3Meta,
+                                              const SplineMetaType &scaleMeta) {
+                this->AddRGBDPointToSurfelResidualBlock(costFunc, lossFunc, so3Meta, scaleMeta,
+                                                        topic, option);
+            });
+        return;
     }
+    this->AddPointToSurfelBatches<type>(
+        corrs, parMagr->TEMPORAL.TO_DnToBr.at(topic), weight,
+        [this, &topic, option](ceres::CostFunction *costFunc, const SplineMetaType &so3Meta,
+                               const SplineMetaType &scaleMeta) {
+            // robust losses are applied to each correspondence by the batched factor
+            this->AddRGBDPointToSurfelResidualBlock(costFunc, nullptr, so3Meta, scaleMeta, topic,
+                                                    option);
+        });
+}
 
-    if (!IsOptionWith(Opt::OPT_TO_DnToBr, option)) {
-        this->SetParameterBlockConstant(TO_DnToBr);
-    } else {
-        // set bound
-        this->SetParameterLowerBound(TO_DnToBr, 0, -Configor::Prior::TimeOffsetPadding);
-        this->SetParameterUpperBound(TO_DnToBr, 0, Configor::Prior::TimeOffsetPadding);
+template <TimeDeriv::ScaleSplineType type>
+void Estimator::AddPointToSurfelBatches(const std::vector<PointToSurfelCorrPtr> &corrs,
+                                        double timeOffset,
+                                        double weight,
+                                        const BatchAdder &adder) {
+    constexpr int deriv = TimeDeriv::Deriv<type, TimeDeriv::LIN_POS>();
+    using Factor = PointToSurfelAnalyticFactor<Configor::Prior::SplineOrder, deriv>;
+
+    // correspondences stamped at the same time are made adjacent, so that they share the spline
+    // evaluation in the batched factor
+    auto sortedCorrs = SortedByTimestamp(corrs);
+
+    auto residuals = CreateResidualsInParallel(
+        sortedCorrs.size(),
+        [this, &sortedCorrs, timeOffset, weight](int i, PendingResidual &res) {
+            const auto &corr = sortedCorrs.at(i);
+            double curTime = corr->timestamp + timeOffset;
+
+            // check point time stamp
+            if (!splines->TimeInRangeForSo3(curTime, Configor::Preference::SO3_SPLINE) ||
+                !splines->TimeInRangeForRd(curTime, Configor::Preference::SCALE_SPLINE)) {
+                return;
+            }
+            splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE,
+                                            {{curTime, curTime}}, res.so3Meta);
+            splines->CalculateRdSplineMeta(Configor::Preference::SCALE_SPLINE,
+                                           {{curTime, curTime}}, res.scaleMeta);
+            const double corrWeight = weight * corr->weight;
+            res.costFunc = new Factor(res.so3Meta, res.scaleMeta, corr, timeOffset, corrWeight);
+            res.lossFunc =
+                new ceres::HuberLoss(Configor::Prior::LossForPointToSurfelFactor * corrWeight);
+        });
+
+    std::vector<std::unique_ptr<Factor>> batch;
+    std::vector<std::unique_ptr<ceres::LossFunction>> lossFuncs;
+    SplineMetaType batchSo3Meta, batchScaleMeta;
+
+    auto AddBatch = [&]() {
+        if (!batch.empty()) {
+            adder(BatchedFactor<Factor>::Create(std::move(batch), std::move(lossFuncs)),
+                  batchSo3Meta, batchScaleMeta);
+            batch.clear(), lossFuncs.clear();
+        }
+    };
+
+    for (const auto &res : residuals) {
+        if (res.costFunc == nullptr) {
+            continue;
+        }
+        const auto &so3Meta = res.so3Meta, &scaleMeta = res.scaleMeta;
+        // a new segment (of either spline) starts
+        if (!batch.empty() &&
+            (so3Meta.segments.front().t0 != batchSo3Meta.segments.front().t0 ||
+             scaleMeta.segments.front().t0 != batchScaleMeta.segments.front().t0)) {
+            AddBatch();
+        }
+        if (batch.empty()) {
+            batchSo3Meta = so3Meta, batchScaleMeta = scaleMeta;
+        }
+        batch.emplace_back(static_cast<Factor *>(res.costFunc));
+        lossFuncs.emplace_back(res.lossFunc);
     }
+    AddBatch();
 }
 
 /**
@@ -557,14 +711,13 @@ void Estimator::AddRGBDPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsCo
  * READOUT_TIME | FX | FY | CX | CY | GLOBAL_SCALE | INV_DEPTH ]
  */
 template <TimeDeriv::ScaleSplineType type>
-void Estimator::AddVisualReprojection(const VisualReProjCorr::Ptr &visualCorr,
-                                      const std::string &topic,
-                                      double *globalScale,
-                                      double *invDepth,
-                                      Opt option,
-                                      double weight) {
+bool Estimator::CreateVisualReprojectionResidual(const VisualReProjCorrPtr &visualCorr,
+                                                 const std::string &topic,
+                                                 Opt option,
+                                                 double weight,
+                                                 PendingResidual &residual) {
     // prepare metas for splines
-    SplineMetaType so3Meta, scaleMeta;
+    SplineMetaType &so3Meta = residual.so3Meta, &scaleMeta = residual.scaleMeta;
 
     const double TO_PADDING = Configor::Prior::TimeOffsetPadding;
     const double RT_PADDING = Configor::Prior::ReadoutTimePadding;
@@ -585,7 +738,7 @@ void Estimator::AddVisualReprojection(const VisualReProjCorr::Ptr &visualCorr,
     );
 
     if (!TimeInRangeForSplines(timePairI) || !TimeInRangeForSplines(timePairJ)) {
-        return;
+        return false;
     }
 
     if (timePairI.first < timePairJ.first) {
@@ -631,87 +784,52 @@ void Estimator::AddVisualReprojection(const VisualReProjCorr::Ptr &visualCorr,
 
     costFunc->SetNumResiduals(2);
 
-    // organize the param block vector
-    std::vector<double *> paramBlockVec;
-
-    // so3 knots param block
-    AddSo3KnotsData(paramBlockVec, splines->GetSo3Spline(Configor::Preference::SO3_SPLINE), so3Meta,
-                    !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
-
-    // lin acce knots
-    AddRdKnotsData(paramBlockVec, splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
-                   scaleMeta, !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
-
-    auto SO3_CmToBr = parMagr->EXTRI.SO3_CmToBr.at(topic).data();
-    paramBlockVec.push_back(SO3_CmToBr);
-
-    auto POS_CmInBr = parMagr->EXTRI.POS_CmInBr.at(topic).data();
-    paramBlockVec.push_back(POS_CmInBr);
-
-    paramBlockVec.push_back(TO_CmToBr);
-    paramBlockVec.push_back(RS_READOUT);
-
-    auto &intri = parMagr->INTRI.Camera.at(topic);
-    paramBlockVec.push_back(intri->FXAddress());
-    paramBlockVec.push_back(intri->FYAddress());
-    paramBlockVec.push_back(intri->CXAddress());
-    paramBlockVec.push_back(intri->CYAddress());
-
-    paramBlockVec.push_back(globalScale);
-    paramBlockVec.push_back(invDepth);
-
-    // pass to problem
-    this->AddResidualBlock(costFunc,
-                           new ceres::HuberLoss(Configor::Prior::LossForReprojFactor * weight),
-                           paramBlockVec);
-    this->SetManifold(SO3_CmToBr, QUATER_MANIFOLD.get());
-
-    if (!IsOptionWith(Opt::OPT_SO3_CmToBr, option)) {
-        this->SetParameterBlockConstant(SO3_CmToBr);
-    }
-
-    if (!IsOptionWith(Opt::OPT_POS_CmInBr, option)) {
-        this->SetParameterBlockConstant(POS_CmInBr);
-    }
-
-    if (!IsOptionWith(Opt::OPT_TO_CmToBr, option)) {
-        this->SetParameterBlockConstant(TO_CmToBr);
-    } else {
-        // set bound
-        this->SetParameterLowerBound(TO_CmToBr, 0, -TO_PADDING);
-        this->SetParameterUpperBound(TO_CmToBr, 0, TO_PADDING);
-    }
-
-    if (!IsOptionWith(Opt::OPT_RS_CAM_READOUT_TIME, option)) {
-        this->SetParameterBlockConstant(RS_READOUT);
-    } else {
-        // set bound
-        this->SetParameterLowerBound(RS_READOUT, 0, 0.0);
-        this->SetParameterUpperBound(RS_READOUT, 0, RT_PADDING);
-    }
-
-    if (!IsOptionWith(Opt::OPT_CAM_FOCAL_LEN, option)) {
-        this->SetParameterBlockConstant(intri->FXAddress());
-        this->SetParameterBlockConstant(intri->FYAddress());
-    }
+    residual.costFunc = costFunc;
+    residual.lossFunc = new ceres::HuberLoss(Configor::Prior::LossForReprojFactor * weight);
+    return true;
+}
 
-    if (!IsOptionWith(Opt::OPT_CAM_PRINCIPAL_POINT, option)) {
-        this->SetParameterBlockConstant(intri->CXAddress());
-        this->SetParameterBlockConstant(intri->CYAddress());
+template <TimeDeriv::ScaleSplineType type>
+void Estimator::AddVisualReprojection(const VisualReProjCorr::Ptr &visualCorr,
+                                      const std::string &topic,
+                                      double *globalScale,
+                                      double *invDepth,
+                                      Opt option,
+                                      double weight) {
+    PendingResidual res;
+    if (this->CreateVisualReprojectionResidual<type>(visualCorr, topic, option, weight, res)) {
+        this->AddVisualReprojectionResidualBlock(res.costFunc, res.lossFunc, res.so3Meta,
+                                                 res.scaleMeta, topic, globalScale, invDepth,
+                                                 option);
     }
+}
 
-    if (!IsOptionWith(Opt::OPT_VISUAL_GLOBAL_SCALE, option)) {
-        this->SetParameterBlockConstant(globalScale);
-    } else {
-        // set bound
-        this->SetParameterLowerBound(globalScale, 0, 1E-3);
+template <TimeDeriv::ScaleSplineType type>
+void Estimator::AddVisualReprojections(const std::vector<VisualReProjCorrSeqPtr> &corrSeqs,
+                                       const std::string &topic,
+                                       double *globalScale,
+                                       Opt option,
+                                       double weight) {
+    // flatten the sequences, each correspondence is kept with the inverse depth it refers to
+    std::vector<std::pair<VisualReProjCorrPtr, double *>> corrs;
+    for (const auto &seq : corrSeqs) {
+        for (const auto &corr : seq->corrs) {
+            corrs.emplace_back(corr, seq->invDepthFir.get());
+        }
     }
-
-    if (!IsOptionWith(Opt::OPT_VISUAL_DEPTH, option)) {
-        this->SetParameterBlockConstant(invDepth);
-    } else {
-        // set bound
-        this->SetParameterLowerBound(invDepth, 0, 1E-3);
+    auto residuals = CreateResidualsInParallel(
+        corrs.size(), [this, &corrs, &topic, option, weight](int i, PendingResidual &res) {
+            const auto &corr = corrs.at(i).first;
+            this->CreateVisualReprojectionResidual<type>(corr, topic, option,
+                                                         weight * corr->weight, res);
+        });
+    for (int i = 0; i < static_cast<int>(residuals.size()); ++i) {
+        const auto &res = residuals.at(i);
+        if (res.costFunc != nullptr) {
+            this->AddVisualReprojectionResidualBlock(res.costFunc, res.lossFunc, res.so3Meta,
+                                                     res.scaleMeta, topic, globalScale,
+                                                     corrs.at(i).second, option);
+        }
     }
 }
 
@@ -816,14 +934,16 @@ void Estimator::AddRGBDOpticalFlowConstraint(const OpticalFlowCorr::Ptr &ofCorr,
 
     if constexpr (IsInvDepth) {
         paramBlockVec.push_back(&ofCorr->invDepth);
+        landmarkParams.insert(&ofCorr->invDepth);
     } else {
         paramBlockVec.push_back(&ofCorr->depth);
+        landmarkParams.insert(&ofCorr->depth);
     }
 
     // pass to problem
-    this->AddResidualBlock(costFunc,
-                           new ceres::HuberLoss(Configor::Prior::LossForOpticalFlowFactor * weight),
-                           paramBlockVec);
+    this->AddResidualBlockToProblem(
+        costFunc, new ceres::HuberLoss(Configor::Prior::LossForOpticalFlowFactor * weight),
+        paramBlockVec);
     this->SetManifold(SO3_DnToBr, QUATER_MANIFOLD.get());
 
     if (!IsOptionWith(Opt::OPT_SO3_DnToBr, option)) {
@@ -973,14 +1093,16 @@ void Estimator::AddVisualOpticalFlowConstraint(const OpticalFlowCorr::Ptr &ofCor
 
     if constexpr (IsInvDepth) {
         paramBlockVec.push_back(&ofCorr->invDepth);
+        landmarkParams.insert(&ofCorr->invDepth);
     } else {
         paramBlockVec.push_back(&ofCorr->depth);
+        landmarkParams.insert(&ofCorr->depth);
     }
 
     // pass to problem
-    this->AddResidualBlock(costFunc,
-                           new ceres::HuberLoss(Configor::Prior::LossForOpticalFlowFactor * weight),
-                           paramBlockVec);
+    this->AddResidualBlockToProblem(
+        costFunc, new ceres::HuberLoss(Configor::Prior::LossForOpticalFlowFactor * weight),
+        paramBlockVec);
     this->SetManifold(SO3_CmToBr, QUATER_MANIFOLD.get());
 
     if (!IsOptionWith(Opt::OPT_SO3_CmToBr, option)) {
@@ -1141,14 +1263,16 @@ void Estimator::AddVisualOpticalFlowReprojConstraint(const OpticalFlowCorrPtr &o
 
     if constexpr (IsInvDepth) {
         paramBlockVec.push_back(&ofCorr->invDepth);
+        landmarkParams.insert(&ofCorr->invDepth);
     } else {
         paramBlockVec.push_back(&ofCorr->depth);
+        landmarkParams.insert(&ofCorr->depth);
     }
 
     // pass to problem
-    this->AddResidualBlock(costFunc,
-                           new ceres::HuberLoss(Configor::Prior::LossForReprojFactor * weight),
-                           paramBlockVec);
+    this->AddResidualBlockToProblem(
+        costFunc, new ceres::HuberLoss(Configor::Prior::LossForReprojFactor * weight),
+        paramBlockVec);
     this->SetManifold(SO3_CmToBr, QUATER_MANIFOLD.get());
 
     if (!IsOptionWith(Opt::OPT_SO3_CmToBr, option)) {
@@ -1310,14 +1434,16 @@ void Estimator::AddRGBDOpticalFlowReprojConstraint(const OpticalFlowCorrPtr &ofC
 
     if constexpr (IsInvDepth) {
         paramBlockVec.push_back(&ofCorr->invDepth);
+        landmarkParams.insert(&ofCorr->invDepth);
     } else {
         paramBlockVec.push_back(&ofCorr->depth);
+        landmarkParams.insert(&ofCorr->depth);
     }
 
     // pass to problem
-    this->AddResidualBlock(costFunc,
-                           new ceres::HuberLoss(Configor::Prior::LossForReprojFactor * weight),
-                           paramBlockVec);
+    this->AddResidualBlockToProblem(
+        costFunc, new ceres::HuberLoss(Configor::Prior::LossForReprojFactor * weight),
+        paramBlockVec);
     this->SetManifold(SO3_DnToBr, QUATER_MANIFOLD.get());
 
     if (!IsOptionWith(Opt::OPT_SO3_DnToBr, option)) {
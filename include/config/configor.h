@@ -66,10 +66,11 @@ enum class OutputOption : std::uint32_t {
     RadarDopplerErrors = 1 << 12,
     VisualOpticalFlowErrors = 1 << 13,
     LiDARPointToSurfelErrors = 1 << 14,
+    SpatTempCovariance = 1 << 15,
     ALL = ParamInEachIter | BSplines | LiDARMaps | VisualMaps | RadarMaps | HessianMat |
           VisualLiDARCovisibility | VisualKinematics | ColorizedLiDARMap | AlignedInertialMes |
           VisualReprojErrors | RadarDopplerErrors | VisualOpticalFlowErrors |
-          LiDARPointToSurfelErrors
+          LiDARPointToSurfelErrors | SpatTempCovariance
 };
 
 struct Configor {
@@ -160,6 +161,8 @@ public:
             std::string Intrinsics;
             std::string DepthTopic;
             double DepthFactor;
+            // the max time distance between matched color and depth images
+            double DepthSyncTolerance;
             double Weight;
             int TrackLengthMin;
 
@@ -168,6 +171,7 @@ public:
                   Intrinsics(),
                   DepthTopic(),
                   DepthFactor(),
+                  DepthSyncTolerance(),
                   Weight(),
                   TrackLengthMin(){};
 
@@ -175,7 +179,10 @@ public:
             template <class Archive>
             void serialize(Archive &ar) {
                 ar(CEREAL_NVP(Type), CEREAL_NVP(Intrinsics), CEREAL_NVP(DepthTopic),
-                   CEREAL_NVP(DepthFactor), CEREAL_NVP(Weight), CEREAL_NVP(TrackLengthMin));
+                   CEREAL_NVP(DepthFactor));
+                // optional fields fall back to their documented defaults (see the template)
+                OptionalNVP(ar, "DepthSyncTolerance", DepthSyncTolerance, 1E-3);
+                ar(CEREAL_NVP(Weight), CEREAL_NVP(TrackLengthMin));
             }
         };
 
@@ -212,6 +219,9 @@ public:
         static std::string ReferIMU;
 
         static std::string BagPath;
+        // the native iKalibr dataset converted from the ros bag, which is loaded instead of the
+        // ros bag if it's not empty
+        static std::string DatasetPath;
         static double BeginTime;
         static double Duration;
 
@@ -224,8 +234,10 @@ public:
         void serialize(Archive &ar) {
             ar(CEREAL_NVP(IMUTopics), CEREAL_NVP(RadarTopics), CEREAL_NVP(LiDARTopics),
                CEREAL_NVP(CameraTopics), CEREAL_NVP(RGBDTopics), CEREAL_NVP(ReferIMU),
-               CEREAL_NVP(BagPath), CEREAL_NVP(BeginTime), CEREAL_NVP(Duration),
-               CEREAL_NVP(OutputPath));
+               CEREAL_NVP(BagPath));
+            // optional fields fall back to their documented defaults (see the template)
+            OptionalNVP(ar, "DatasetPath", DatasetPath, "");
+            ar(CEREAL_NVP(BeginTime), CEREAL_NVP(Duration), CEREAL_NVP(OutputPath));
         }
     } dataStream;
 
@@ -252,17 +264,30 @@ public:
         static struct NDTLiDAROdometer {
             static double Resolution;
             static double KeyFrameDownSample;
+            // the sliding local map (ndt target) keeps key frames within this radius (m) of the
+            // latest one, and at most 'LocalMapKeyFrameMax' key frames
+            static double LocalMapRadius;
+            static int LocalMapKeyFrameMax;
 
         public:
             template <class Archive>
             void serialize(Archive &ar) {
                 ar(CEREAL_NVP(Resolution), CEREAL_NVP(KeyFrameDownSample));
+                // optional fields fall back to their documented defaults (see the template)
+                OptionalNVP(ar, "LocalMapRadius", LocalMapRadius, 30.0);
+                OptionalNVP(ar, "LocalMapKeyFrameMax", LocalMapKeyFrameMax, 100);
             }
         } ndtLiDAROdometer;
 
         static struct LiDARDataAssociate {
             static double PointToSurfelMax;
             static double PlanarityMin;
+            // leaf size of the on-the-fly voxel hashing when assembling the global lidar map, which
+            // avoids materializing the full-resolution map. Non-positive value means disabled
+            static double MapVoxelLeafSize;
+            // surfel maps are reused across data association rounds, and only their parts where
+            // map points moved farther than this tolerance (m) are rebuilt. Zero means exact
+            static double SurfelMapUpdateTolerance;
 
             const static std::uint8_t QueryDepthMin;
             const static std::uint8_t QueryDepthMax;
@@ -271,6 +296,9 @@ public:
             // 0.1, 0.2, 0.4, 0.8, 1.6, ...
             const static double MapResolution;
             const static std::uint8_t MapDepthLevels;
+            // depth of subtrees the surfel map is partitioned into, which should not be less than
+            // the query depths of surfels
+            const static std::uint8_t MapSubtreeDepth;
 
             const static int PointToSurfelCountInScan;
 
@@ -278,6 +306,9 @@ public:
             template <class Archive>
             void serialize(Archive &ar) {
                 ar(CEREAL_NVP(PointToSurfelMax), CEREAL_NVP(PlanarityMin));
+                // optional fields fall back to their documented defaults (see the template)
+                OptionalNVP(ar, "MapVoxelLeafSize", MapVoxelLeafSize, 0.0);
+                OptionalNVP(ar, "SurfelMapUpdateTolerance", SurfelMapUpdateTolerance, 0.005);
             }
         } lidarDataAssociate;
 
@@ -304,6 +335,15 @@ public:
 
     static struct Preference {
         static bool UseCudaInSolving;
+        // evaluate the hot spline-based factors (inertial, radar doppler and point-to-surfel) with
+        // closed-form jacobians rather than automatic differentiation when possible
+        static bool UseAnalyticJacobian;
+        // linear solver used when cuda is not used: 'DENSE_SCHUR', 'SPARSE_SCHUR',
+        // 'SPARSE_NORMAL_CHOLESKY' or 'ITERATIVE_SCHUR', and the preconditioner of the iterative
+        // one: 'JACOBI', 'SCHUR_JACOBI', 'CLUSTER_JACOBI' or 'CLUSTER_TRIDIAGONAL'
+        static std::string LinearSolver;
+        static std::string Preconditioner;
+        const static std::set<std::string> LinearSolverTypes, PreconditionerTypes;
         static OutputOption Outputs;
         static std::set<std::string> OutputsStr;
         // str for file configuration, and enum for internal use
@@ -311,6 +351,22 @@ public:
         static CerealArchiveType::Enum OutputDataFormat;
         const static std::map<CerealArchiveType::Enum, std::string> FileExtension;
         static int ThreadsToUse;
+        // directory of the decoded-measurement cache, empty means the cache is disabled
+        static std::string DataCachePath;
+        // keep encoded camera images in memory and decode them on demand, the number of frames
+        // holding decoded images is bounded by 'DecodedImageCacheSize'
+        static bool KeepImagesEncoded;
+        static int DecodedImageCacheSize;
+        // image representation(s) stored in camera frames: 'GREY_AND_COLOR', 'GREY_ONLY' or
+        // 'COLOR_ONLY', the one not stored is derived on demand
+        static std::string ImageStorage;
+        // run without any visualization (e.g., on servers without display): the viewer is never
+        // created, and parameters are not copied back after each solver iteration for drawing
+        static bool Headless;
+        // time resolution (second) of the per-scan pose lookup tables in scan undistortion, poses
+        // of points are interpolated from the tables rather than evaluated from splines, which
+        // trades a slight accuracy for speed. Non-positive value means the exact evaluation
+        static double UndistortionLUTResolution;
 
         const static std::string SO3_SPLINE, SCALE_SPLINE;
 
@@ -323,9 +379,20 @@ public:
     public:
         template <class Archive>
         void serialize(Archive &ar) {
-            ar(CEREAL_NVP(UseCudaInSolving), cereal::make_nvp("Outputs", OutputsStr),
-               cereal::make_nvp("OutputDataFormat", OutputDataFormatStr), CEREAL_NVP(ThreadsToUse),
-               CEREAL_NVP(SplineScaleInViewer), CEREAL_NVP(CoordSScaleInViewer));
+            ar(CEREAL_NVP(UseCudaInSolving));
+            // optional fields fall back to their documented defaults (see the template)
+            OptionalNVP(ar, "UseAnalyticJacobian", UseAnalyticJacobian, false);
+            OptionalNVP(ar, "LinearSolver", LinearSolver, "DENSE_SCHUR");
+            OptionalNVP(ar, "Preconditioner", Preconditioner, "SCHUR_JACOBI");
+            ar(cereal::make_nvp("Outputs", OutputsStr),
+               cereal::make_nvp("OutputDataFormat", OutputDataFormatStr), CEREAL_NVP(ThreadsToUse));
+            OptionalNVP(ar, "DataCachePath", DataCachePath, "");
+            OptionalNVP(ar, "KeepImagesEncoded", KeepImagesEncoded, false);
+            OptionalNVP(ar, "DecodedImageCacheSize", DecodedImageCacheSize, 200);
+            OptionalNVP(ar, "ImageStorage", ImageStorage, "GREY_AND_COLOR");
+            OptionalNVP(ar, "Headless", Headless, false);
+            OptionalNVP(ar, "UndistortionLUTResolution", UndistortionLUTResolution, 0.0);
+            ar(CEREAL_NVP(SplineScaleInViewer), CEREAL_NVP(CoordSScaleInViewer));
         }
     } preference;
 
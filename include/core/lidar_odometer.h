@@ -39,6 +39,7 @@
 #include "util/cloud_define.hpp"
 #include "ctraj/core/pose.hpp"
 #include "pclomp/ndt_omp.hpp"
+#include "deque"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -59,11 +60,24 @@ private:
     // the key frame index in the '_frames'
     std::vector<std::size_t> _keyFrameIdx;
     std::vector<LiDARFramePtr> _frames;
+    // the position and yaw-pitch-roll of the last key frame, kept per odometer (rather than
+    // shared), so that odometers of different lidars can run concurrently
+    Eigen::Vector3d _lastKeyFramePos;
+    Eigen::Vector3d _lastKeyFrameYPR;
 
-    // the global map
+    // the global map (all key frames, only for visualization)
     IKalibrPointCloud::Ptr _map;
     double _mapTime;
 
+    // the sliding local map, i.e., the ndt target, which is bounded spatially (key frames within
+    // '_localMapRadius' of the latest one) and in size (at most '_localMapKeyFrameMax' key frames),
+    // so that the cost of updating the ndt target does not grow with the sequence length
+    double _localMapRadius;
+    std::size_t _localMapKeyFrameMax;
+    // key frame clouds (in the map frame) and their positions in the local map
+    std::deque<std::pair<Eigen::Vector3d, IKalibrPointCloud::Ptr>> _localMapKeyFrames;
+    IKalibrPointCloud::Ptr _localMap;
+
     // ndt
     pclomp::NormalDistributionsTransform<IKalibrPoint, IKalibrPoint>::Ptr _ndt;
 
@@ -73,9 +87,15 @@ private:
     std::vector<ns_ctraj::Posed> _poseSeq;
 
 public:
-    LiDAROdometer(float ndtResolution, int threads);
+    LiDAROdometer(float ndtResolution,
+                  int threads,
+                  double localMapRadius,
+                  std::size_t localMapKeyFrameMax);
 
-    static LiDAROdometer::Ptr Create(float ndtResolution, int threads);
+    static LiDAROdometer::Ptr Create(float ndtResolution,
+                                     int threads,
+                                     double localMapRadius,
+                                     std::size_t localMapKeyFrameMax);
 
     ns_ctraj::Posed FeedFrame(const LiDARFramePtr &frame,
                               const Eigen::Matrix4d &predCurToLast = Eigen::Matrix4d::Identity(),
@@ -92,6 +112,8 @@ public:
 
     [[nodiscard]] const IKalibrPointCloud::Ptr &GetMap() const;
 
+    [[nodiscard]] const IKalibrPointCloud::Ptr &GetLocalMap() const;
+
     [[nodiscard]] const std::vector<LiDARFramePtr> &GetFramesVec() const;
 
     [[nodiscard]] const pclomp::NormalDistributionsTransform<IKalibrPoint, IKalibrPoint>::Ptr &
@@ -102,7 +124,9 @@ public:
 protected:
     bool CheckKeyFrame(const ns_ctraj::Posed &LtoM);
 
-    void UpdateMap(const LiDARFramePtr &frame, const ns_ctraj::Posed &LtoM);
+    void UpdateMap(const IKalibrPointCloud::Ptr &scan, const ns_ctraj::Posed &LtoM);
+
+    void UpdateLocalMap(const Eigen::Vector3d &pos, const IKalibrPointCloud::Ptr &cloudInMap);
 
     static void DownSampleCloud(const IKalibrPointCloud::Ptr &inCloud,
                                 const IKalibrPointCloud::Ptr &outCloud,
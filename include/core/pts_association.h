@@ -48,6 +48,8 @@ namespace ns_ikalibr {
 
 struct PointToSurfelCorr;
 using PointToSurfelCorrPtr = std::shared_ptr<PointToSurfelCorr>;
+class LiDARScan;
+using LiDARScanPtr = std::shared_ptr<LiDARScan>;
 
 struct PointToSurfelCondition {
     double pointToSurfelMax;
@@ -77,47 +79,62 @@ struct PointToSurfelCondition {
 class PointToSurfelAssociator {
 public:
     using Ptr = std::shared_ptr<PointToSurfelAssociator>;
+    using SurfelMapPtr = std::shared_ptr<ufo::map::SurfelMap>;
 
 protected:
-    ufo::map::SurfelMap _smp;
+    double _resolution;
+    std::uint8_t _depth;
+    /**
+     * the map is partitioned into subtrees (octree nodes at depth 'MapSubtreeDepth'), which are
+     * hashed into buckets, each bucket maintains an independent surfel map. Surfels not deeper
+     * than the subtree depth are identical to the ones in a single map, while buckets can be
+     * built concurrently and rebuilt individually
+     */
+    double _subtreeSize;
+    std::vector<SurfelMapPtr> _smps;
+    // points that surfel maps of buckets are built from, only retained for a positive tolerance
+    std::vector<std::vector<ufo::map::Point3>> _bucketPts;
 
 public:
+    explicit PointToSurfelAssociator(double resolution, std::uint8_t depth);
+
     explicit PointToSurfelAssociator(const IKalibrPointCloud::Ptr &mapInW,
                                      double resolution,
                                      std::uint8_t depth);
 
+    static Ptr Create(double resolution, std::uint8_t depth);
+
     static Ptr Create(const IKalibrPointCloud::Ptr &mapInW, double resolution, std::uint8_t depth);
 
-    std::vector<PointToSurfelCorrPtr> Association(const IKalibrPointCloud::Ptr &mapCloud,
-                                                  const IKalibrPointCloud::Ptr &rawCloud,
+    /**
+     * update surfel maps using the new map in a warm-started manner, only buckets whose points
+     * are changed (moved farther than 'tolerance', or with different counts) are rebuilt
+     * @param mapInW the new map in the world frame
+     * @param tolerance the displacement tolerance of points, zero means exact rebuilding, where
+     * all buckets are rebuilt and their points are not retained
+     * @return the number of rebuilt buckets
+     */
+    std::size_t Update(const IKalibrPointCloud::Ptr &mapInW, double tolerance = 0.0);
+
+    /**
+     * associate points to surfels, the compact scans are read directly (no pcl conversions)
+     * @param mapScan the (undistorted) scan in the map frame, used to query surfels
+     * @param rawScan the raw scan, point-wise aligned with 'mapScan'
+     */
+    std::vector<PointToSurfelCorrPtr> Association(const LiDARScanPtr &mapScan,
+                                                  const LiDARScanPtr &rawScan,
                                                   const PointToSurfelCondition &condition);
 
     static double SurfelScore(const ufo::map::SurfelMap &m, const ufo::map::Node &n);
 
-    [[nodiscard]] const ufo::map::SurfelMap &GetSurfelMap() const;
+    [[nodiscard]] const std::vector<SurfelMapPtr> &GetSurfelMaps() const;
 
 protected:
     static double PointToSurfel(const ufo::map::SurfelMap::Surfel &s, const ufo::map::Point3 &p);
 
     static Eigen::Vector4d SurfelCoeffs(const ufo::map::SurfelMap::Surfel &s);
 
-    template <typename PointType>
-    void InsertCloudToSurfelMap(ufo::map::SurfelMap &map, pcl::PointCloud<PointType> &pclCloud) {
-        int cloudSize = pclCloud.size();
-
-        ufo::map::PointCloud ufoCloud;
-        ufoCloud.resize(cloudSize);
-
-#pragma omp parallel for num_threads(omp_get_max_threads()) default(none) \
-    shared(ufoCloud, cloudSize, pclCloud)
-        for (int i = 0; i < cloudSize; i++) {
-            ufoCloud[i].x = pclCloud.points[i].x;
-            ufoCloud[i].y = pclCloud.points[i].y;
-            ufoCloud[i].z = pclCloud.points[i].z;
-        }
-
-        map.insertSurfelPoint(std::begin(ufoCloud), std::end(ufoCloud));
-    }
+    [[nodiscard]] std::size_t BucketIndex(float x, float y, float z) const;
 };
 }  // namespace ns_ikalibr
 #endif  // IKALIBR_PTS_ASSOCIATION_H
@@ -46,6 +46,9 @@ namespace ns_ikalibr {
 struct LiDARFrame;
 using LiDARFramePtr = std::shared_ptr<LiDARFrame>;
 
+class LiDARScan;
+using LiDARScanPtr = std::shared_ptr<LiDARScan>;
+
 struct CalibParamManager;
 using CalibParamManagerPtr = std::shared_ptr<CalibParamManager>;
 
@@ -65,6 +68,17 @@ public:
         ALL = UNDIST_SO3 | UNDIST_POS
     };
 
+protected:
+    // poses of the reference imu in the world frame sampled uniformly over the time span of a scan,
+    // poses of points are interpolated from these samples rather than evaluated from splines
+    struct PoseLookUpTable {
+        double st = 0.0, dt = 0.0;
+        Eigen::aligned_vector<Sophus::SO3d> so3;
+        Eigen::aligned_vector<Eigen::Vector3d> pos;
+
+        [[nodiscard]] Sophus::SE3d Interpolate(double t) const;
+    };
+
 private:
     const SplineBundleType::So3SplineType &_so3Spline;
     const SplineBundleType::RdSplineType &_posSpline;
@@ -93,6 +107,16 @@ protected:
     std::optional<LiDARFramePtr> UndistortToRef(const LiDARFramePtr &lidarFrame,
                                                 const std::string &topic,
                                                 bool correctPos);
+
+    // returns the lookup table of a scan when 'Preference::UndistortionLUTResolution' is positive,
+    // otherwise (or no point is in the time range of splines) nothing is returned
+    [[nodiscard]] std::optional<PoseLookUpTable> CreatePoseLookUpTable(const LiDARScanPtr &scan,
+                                                                       double TO_LkToBr) const;
+
+    // pose of the reference imu in the world frame, interpolated from the lookup table if it is
+    // given, otherwise evaluated from splines. Nothing is returned if 'timeByBr' is out of range
+    [[nodiscard]] std::optional<Sophus::SE3d> GetRefIMUToW(
+        double timeByBr, const std::optional<PoseLookUpTable> &lut) const;
 };
 }  // namespace ns_ikalibr
 
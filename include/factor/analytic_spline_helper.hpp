@@ -0,0 +1,356 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#ifndef IKALIBR_ANALYTIC_SPLINE_HELPER_HPP
+#define IKALIBR_ANALYTIC_SPLINE_HELPER_HPP
+
+#include "ctraj/utils/eigen_utils.hpp"
+#include "ctraj/utils/sophus_utils.hpp"
+#include "util/utils.h"
+#include "array"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+/**
+ * closed-form evaluation of uniform B-splines (so3 and Rd) together with the jacobians of the
+ * evaluated quantities w.r.t. the knots, which is the basis of the analytic factors. The
+ * conventions follow 'ns_ctraj::CeresSplineHelperJet': the so3 spline is the cumulative one
+ * (knots are 'SO3_BrToBr0'), angular velocities and accelerations are expressed in the body frame.
+ * All so3 jacobians are given w.r.t. left (global) perturbations, i.e., 'R <- Exp(phi) * R'.
+ */
+template <int Order>
+struct AnalyticSplineHelper {
+public:
+    static constexpr int N = Order;
+    static constexpr int DEG = Order - 1;
+
+    using VecN = Eigen::Matrix<double, N, 1>;
+    using MatN = Eigen::Matrix<double, N, N>;
+
+    struct So3State {
+        Sophus::SO3d rot;
+        // angular velocity, acceleration and jerk in the body frame
+        Eigen::Vector3d vel, acce, jerk;
+        // jacobians of 'rot', 'vel' and 'acce' w.r.t. each knot (left perturbation)
+        std::array<Eigen::Matrix3d, N> rotJac, velJac, acceJac;
+    };
+
+    /**
+     * quantities that only depend on the knots, which can be shared by all evaluations in the same
+     * segment (e.g., a batch of measurements)
+     */
+    struct So3Knots {
+        // relative rotations between neighbor knots, i.e., 'Log(knot_i^T * knot_{i+1})'
+        std::array<Eigen::Vector3d, DEG> delta;
+        // d(delta_i) / d(knot_{i+1}), which equals to -d(delta_i) / d(knot_i)
+        std::array<Eigen::Matrix3d, DEG> deltaJac;
+    };
+
+    // basis weights of the 0, 1, 2 and 3-order time derivatives at a time (see 'Weights')
+    using Basis = std::array<VecN, 4>;
+
+public:
+    /**
+     * the blending matrix of the uniform B-spline, 'cumulative' for the so3 spline
+     */
+    static const MatN &BlendingMatrix(bool cumulative) {
+        static const MatN blending = ComputeBlendingMatrix(false);
+        static const MatN cumulativeBlending = ComputeBlendingMatrix(true);
+        return cumulative ? cumulativeBlending : blending;
+    }
+
+    /**
+     * the basis weights of 'deriv'-order time derivative at normalized time 'u', derivatives
+     * higher than the spline degree vanish
+     */
+    static VecN Weights(int deriv, double u, double dtInv, bool cumulative) {
+        VecN base = VecN::Zero();
+        for (int j = deriv; j < N; ++j) {
+            // the 'deriv'-order derivative of 'u^j'
+            double coeff = 1.0;
+            for (int k = 0; k < deriv; ++k) {
+                coeff *= j - k;
+            }
+            base(j) = coeff * std::pow(u, j - deriv);
+        }
+        return std::pow(dtInv, deriv) * BlendingMatrix(cumulative) * base;
+    }
+
+    static void ComputeBasis(double u, double dtInv, bool cumulative, Basis &basis) {
+        for (int deriv = 0; deriv < static_cast<int>(basis.size()); ++deriv) {
+            basis[deriv] = Weights(deriv, u, dtInv, cumulative);
+        }
+    }
+
+    /**
+     * the basis at 'time' of a spline meta covering a single time point (see
+     * 'IsFixedAritySplineMeta'). Analytic factors are only created for such metas, whose time
+     * offsets are not estimated, thus they compute their bases once at construction
+     */
+    template <class SplineMeta>
+    static Basis BasisAt(const SplineMeta &meta, double time, bool cumulative) {
+        // the knots are exactly the ones of the segment, hence the index is always zero
+        std::pair<std::size_t, double> iu;
+        meta.ComputeSplineIndex(time, iu.first, iu.second);
+        Basis basis;
+        ComputeBasis(iu.second, 1.0 / meta.segments.front().dt, cumulative, basis);
+        return basis;
+    }
+
+    /**
+     * evaluates a Rd spline using the weights from 'Weights(deriv, u, dtInv, false)', the
+     * jacobian w.r.t. the i-th knot is 'weights(i) * I'
+     */
+    static Eigen::Vector3d EvaluateRd(const double *const *knots, const VecN &weights) {
+        Eigen::Vector3d value = Eigen::Vector3d::Zero();
+        for (int i = 0; i < N; ++i) {
+            value += weights(i) * Eigen::Map<const Eigen::Vector3d>(knots[i]);
+        }
+        return value;
+    }
+
+    static void PrepareSo3(const double *const *knots, bool computeJacobians, So3Knots &so3Knots) {
+        for (int i = 0; i < DEG; ++i) {
+            Eigen::Map<const Sophus::SO3d> q0(knots[i]), q1(knots[i + 1]);
+            so3Knots.delta[i] = (q0.inverse() * q1).log();
+            if (computeJacobians) {
+                so3Knots.deltaJac[i] = RightJacobianInv(so3Knots.delta[i]) * q1.inverse().matrix();
+            }
+        }
+    }
+
+    /**
+     * evaluates the so3 spline and its body-frame time derivatives up to 'maxDeriv' (at most 3,
+     * i.e., the jerk). Jacobians are only computed for the rotation, velocity and acceleration.
+     */
+    static void EvaluateSo3(const double *const *knots,
+                            double u,
+                            double dtInv,
+                            int maxDeriv,
+                            bool computeJacobians,
+                            So3State &state) {
+        So3Knots so3Knots;
+        PrepareSo3(knots, computeJacobians, so3Knots);
+        EvaluateSo3(knots, so3Knots, u, dtInv, maxDeriv, computeJacobians, state);
+    }
+
+    /**
+     * the same as the one above, where 'so3Knots' is prepared by 'PrepareSo3' in advance
+     */
+    static void EvaluateSo3(const double *const *knots,
+                            const So3Knots &so3Knots,
+                            double u,
+                            double dtInv,
+                            int maxDeriv,
+                            bool computeJacobians,
+                            So3State &state) {
+        Basis basis;
+        ComputeBasis(u, dtInv, true, basis);
+        EvaluateSo3(knots, so3Knots, basis, maxDeriv, computeJacobians, state);
+    }
+
+    /**
+     * the same as the one above, where the cumulative 'basis' is given (see 'BasisAt')
+     */
+    static void EvaluateSo3(const double *const *knots,
+                            const So3Knots &so3Knots,
+                            const Basis &basis,
+                            int maxDeriv,
+                            bool computeJacobians,
+                            So3State &state) {
+        const auto &delta = so3Knots.delta;
+        const VecN &coeff = basis[0], &dCoeff = basis[1];
+        const VecN &ddCoeff = basis[2], &dddCoeff = basis[3];
+
+        state.rot = Eigen::Map<const Sophus::SO3d>(knots[0]);
+        state.vel.setZero(), state.acce.setZero(), state.jerk.setZero();
+
+        // jacobians w.r.t. the relative rotations between neighbor knots ('delta')
+        std::array<Eigen::Matrix3d, DEG> rotJac, velJac, acceJac;
+
+        for (int i = 0; i < DEG; ++i) {
+            const double k = coeff(i + 1), dk = dCoeff(i + 1);
+            const double ddk = ddCoeff(i + 1), dddk = dddCoeff(i + 1);
+            const Eigen::Vector3d kDelta = k * delta[i];
+            const Sophus::SO3d expKDelta = Sophus::SO3d::exp(kDelta);
+
+            state.rot = state.rot * expKDelta;
+            if (computeJacobians) {
+                rotJac[i] = k * state.rot.matrix() * RightJacobian(kDelta);
+            }
+            if (maxDeriv < 1) {
+                continue;
+            }
+
+            // 'Exp(-k * delta)', which rotates the velocity and acceleration of the last knots
+            const Eigen::Matrix3d E = expKDelta.inverse().matrix();
+            const Eigen::Matrix3d JrNegKDelta = computeJacobians ? RightJacobian(-kDelta)
+                                                                 : Eigen::Matrix3d::Identity();
+            const Eigen::Vector3d dkDelta = dk * delta[i], ddkDelta = ddk * delta[i];
+            const Eigen::Vector3d lastVel = state.vel, lastAcce = state.acce;
+
+            state.vel = E * lastVel + dkDelta;
+            if (computeJacobians) {
+                for (int j = 0; j < i; ++j) {
+                    velJac[j] = E * velJac[j];
+                }
+                velJac[i] = k * E * Sophus::SO3d::hat(lastVel) * JrNegKDelta +
+                            dk * Eigen::Matrix3d::Identity();
+            }
+            if (maxDeriv < 2) {
+                continue;
+            }
+
+            state.acce = E * lastAcce + ddkDelta + state.vel.cross(dkDelta);
+            if (computeJacobians) {
+                const Eigen::Matrix3d dkDeltaHat = Sophus::SO3d::hat(dkDelta);
+                for (int j = 0; j < i; ++j) {
+                    acceJac[j] = E * acceJac[j] - dkDeltaHat * velJac[j];
+                }
+                acceJac[i] = k * E * Sophus::SO3d::hat(lastAcce) * JrNegKDelta +
+                             ddk * Eigen::Matrix3d::Identity() - dkDeltaHat * velJac[i] +
+                             dk * Sophus::SO3d::hat(state.vel);
+            }
+            if (maxDeriv < 3) {
+                continue;
+            }
+
+            state.jerk = E * (state.jerk - dkDelta.cross(lastAcce)) + dddk * delta[i] +
+                         state.acce.cross(dkDelta) + state.vel.cross(ddkDelta);
+        }
+
+        if (!computeJacobians) {
+            return;
+        }
+
+        // from relative rotations to knots
+        for (int i = 0; i < N; ++i) {
+            state.rotJac[i].setZero(), state.velJac[i].setZero(), state.acceJac[i].setZero();
+        }
+        // the first knot directly contributes to the rotation
+        state.rotJac[0].setIdentity();
+
+        for (int i = 0; i < DEG; ++i) {
+            const Eigen::Matrix3d &deltaJac = so3Knots.deltaJac[i];
+
+            const Eigen::Matrix3d rotDeltaJac = rotJac[i] * deltaJac;
+            state.rotJac[i] -= rotDeltaJac, state.rotJac[i + 1] += rotDeltaJac;
+            if (maxDeriv >= 1) {
+                const Eigen::Matrix3d velDeltaJac = velJac[i] * deltaJac;
+                state.velJac[i] -= velDeltaJac, state.velJac[i + 1] += velDeltaJac;
+            }
+            if (maxDeriv >= 2) {
+                const Eigen::Matrix3d acceDeltaJac = acceJac[i] * deltaJac;
+                state.acceJac[i] -= acceDeltaJac, state.acceJac[i + 1] += acceDeltaJac;
+            }
+        }
+    }
+
+    /**
+     * maps a jacobian w.r.t. the left perturbation of a rotation to the one w.r.t. the four
+     * (x, y, z, w) coefficients of the quaternion 'q', such that it is consistent with
+     * 'ceres::EigenQuaternionManifold' (whose tangent is half of the rotation vector)
+     */
+    template <int Rows>
+    static void QuaternionJacobian(const Eigen::Matrix<double, Rows, 3> &jacobian,
+                                   const double *q,
+                                   double *jacobianInQ) {
+        Eigen::Matrix<double, 4, 3> plusJac;
+        plusJac << q[3], q[2], -q[1], -q[2], q[3], q[0], q[1], -q[0], q[3], -q[0], -q[1], -q[2];
+        Eigen::Map<Eigen::Matrix<double, Rows, 4, Eigen::RowMajor>> jac(jacobianInQ);
+        jac = 2.0 * jacobian * plusJac.transpose();
+    }
+
+    static Eigen::Matrix3d RightJacobian(const Eigen::Vector3d &phi) {
+        const double theta2 = phi.squaredNorm();
+        const Eigen::Matrix3d phiHat = Sophus::SO3d::hat(phi);
+        if (theta2 < 1E-10) {
+            return Eigen::Matrix3d::Identity() - 0.5 * phiHat;
+        }
+        const double theta = std::sqrt(theta2);
+        return Eigen::Matrix3d::Identity() - (1.0 - std::cos(theta)) / theta2 * phiHat +
+               (theta - std::sin(theta)) / (theta2 * theta) * phiHat * phiHat;
+    }
+
+    static Eigen::Matrix3d RightJacobianInv(const Eigen::Vector3d &phi) {
+        const double theta2 = phi.squaredNorm();
+        const Eigen::Matrix3d phiHat = Sophus::SO3d::hat(phi);
+        if (theta2 < 1E-10) {
+            return Eigen::Matrix3d::Identity() + 0.5 * phiHat;
+        }
+        const double theta = std::sqrt(theta2);
+        return Eigen::Matrix3d::Identity() + 0.5 * phiHat +
+               (1.0 / theta2 - (1.0 + std::cos(theta)) / (2.0 * theta * std::sin(theta))) *
+                   phiHat * phiHat;
+    }
+
+protected:
+    static MatN ComputeBlendingMatrix(bool cumulative) {
+        auto Binomial = [](int n, int k) {
+            double res = 1.0;
+            for (int i = 1; i <= k; ++i) {
+                res = res * (n - k + i) / i;
+            }
+            return res;
+        };
+        MatN m = MatN::Zero();
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j) {
+                double sum = 0.0;
+                for (int s = j; s < N; ++s) {
+                    sum += std::pow(-1.0, s - j) * Binomial(N, s - j) *
+                           std::pow(N - s - 1.0, N - 1.0 - i);
+                }
+                m(j, i) = Binomial(N - 1, N - 1 - i) * sum;
+            }
+        }
+        if (cumulative) {
+            for (int i = 0; i < N; ++i) {
+                for (int j = i + 1; j < N; ++j) {
+                    m.row(i) += m.row(j);
+                }
+            }
+        }
+        double factorial = 1.0;
+        for (int i = 2; i < N; ++i) {
+            factorial *= i;
+        }
+        return m / factorial;
+    }
+};
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_ANALYTIC_SPLINE_HELPER_HPP
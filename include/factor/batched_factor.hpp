@@ -0,0 +1,214 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_BATCHED_FACTOR_HPP
+#define IKALIBR_BATCHED_FACTOR_HPP
+
+#include "ceres/cost_function.h"
+#include "ceres/loss_function.h"
+#include "util/utils.h"
+#include "util/status.hpp"
+#include "memory"
+#include "vector"
+#include "limits"
+#include "type_traits"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+/**
+ * whether the analytic 'Factor' could share the knot-related quantities in a batch, i.e., it
+ * provides the 'SharedKnots' type (see 'BatchedFactor')
+ */
+template <class Factor, class = void>
+struct HasSharedKnots : std::false_type {};
+
+template <class Factor>
+struct HasSharedKnots<Factor, std::void_t<typename Factor::SharedKnots>> : std::true_type {};
+
+// the knot-related quantities shared in a batch, a placeholder for factors without them
+template <class Factor, bool = HasSharedKnots<Factor>::value>
+struct SharedKnotsOf {
+    using type = std::nullptr_t;
+};
+
+template <class Factor>
+struct SharedKnotsOf<Factor, true> {
+    using type = typename Factor::SharedKnots;
+};
+
+/**
+ * stacks factors that share the same param blocks (e.g., measurements falling in the same knot
+ * segment) into a single residual block, so that ceres maintains one block rather than one for
+ * each measurement. Any 'ceres::CostFunction' could be batched, where each factor is evaluated
+ * by its 'Evaluate(sKnots, sResiduals, sJacobians)'. Analytic factors could further provide:
+ * (1) 'SharedKnots' and the static 'PrepareKnots(sKnots, computeJacobians, sharedKnots)', which
+ *     computes knot-related quantities once for each evaluation of the batch;
+ * (2) 'EvaluateWithKnots(sKnots, sharedKnots, sResiduals, sJacobians)', which is numerically
+ *     identical to its 'Evaluate(sKnots, sResiduals, sJacobians)'.
+ * residuals of the i-th factor are stored in rows [i * M, (i + 1) * M), where 'M' is the residual
+ * count of a single factor. Attention: the batched block should not be used with a loss function,
+ * as the loss would be applied to the squared norm of the whole batch. Robust losses of single
+ * factors are passed to the batch instead, which corrects the residuals (and jacobians) of each
+ * factor in the same way ceres does for a residual block (see 'Robustify').
+ */
+template <class Factor>
+class BatchedFactor : public ceres::CostFunction {
+private:
+    std::vector<std::unique_ptr<Factor>> _factors;
+    // empty, or one (possibly null) loss function for each factor
+    std::vector<std::unique_ptr<ceres::LossFunction>> _lossFuncs;
+
+public:
+    explicit BatchedFactor(std::vector<std::unique_ptr<Factor>> factors,
+                           std::vector<std::unique_ptr<ceres::LossFunction>> lossFuncs = {})
+        : _factors(std::move(factors)),
+          _lossFuncs(std::move(lossFuncs)) {
+        if (_factors.empty()) {
+            throw Status(Status::CRITICAL, "the batched factor is created without any factor!");
+        }
+        if (!_lossFuncs.empty() && _lossFuncs.size() != _factors.size()) {
+            throw Status(Status::CRITICAL,
+                         "the batched factor is created with {} factors but {} loss functions!",
+                         _factors.size(), _lossFuncs.size());
+        }
+        const auto &front = _factors.front();
+        for (const auto &factor : _factors) {
+            if (factor->num_residuals() != front->num_residuals() ||
+                factor->parameter_block_sizes() != front->parameter_block_sizes()) {
+                throw Status(Status::CRITICAL,
+                             "factors with different layouts are stacked in a batched factor!");
+            }
+        }
+        set_num_residuals(front->num_residuals() * static_cast<int>(_factors.size()));
+        *mutable_parameter_block_sizes() = front->parameter_block_sizes();
+    }
+
+    static auto Create(std::vector<std::unique_ptr<Factor>> factors,
+                       std::vector<std::unique_ptr<ceres::LossFunction>> lossFuncs = {}) {
+        return new BatchedFactor(std::move(factors), std::move(lossFuncs));
+    }
+
+    [[nodiscard]] std::size_t BatchSize() const { return _factors.size(); }
+
+public:
+    bool Evaluate(double const *const *sKnots,
+                  double *sResiduals,
+                  double **sJacobians) const override {
+        [[maybe_unused]] typename SharedKnotsOf<Factor>::type sharedKnots{};
+        if constexpr (HasSharedKnots<Factor>::value) {
+            Factor::PrepareKnots(sKnots, sJacobians != nullptr, sharedKnots);
+        }
+
+        const auto &blockSizes = parameter_block_sizes();
+        const int rows = _factors.front()->num_residuals();
+
+        // the jacobians of each factor are the row blocks of the batched (row-major) ones
+        std::vector<double *> jacobians(blockSizes.size(), nullptr);
+        for (int i = 0; i < static_cast<int>(_factors.size()); ++i) {
+            if (sJacobians != nullptr) {
+                for (int j = 0; j < static_cast<int>(blockSizes.size()); ++j) {
+                    jacobians[j] = sJacobians[j] == nullptr
+                                       ? nullptr
+                                       : sJacobians[j] + i * rows * blockSizes[j];
+                }
+            }
+            double **jacobiansOfFactor = sJacobians == nullptr ? nullptr : jacobians.data();
+            bool fine;
+            if constexpr (HasSharedKnots<Factor>::value) {
+                fine = _factors[i]->EvaluateWithKnots(sKnots, sharedKnots, sResiduals + i * rows,
+                                                      jacobiansOfFactor);
+            } else {
+                fine = _factors[i]->Evaluate(sKnots, sResiduals + i * rows, jacobiansOfFactor);
+            }
+            if (!fine) {
+                return false;
+            }
+            if (!_lossFuncs.empty() && _lossFuncs[i] != nullptr) {
+                Robustify(*_lossFuncs[i], rows, sResiduals + i * rows,
+                          sJacobians == nullptr ? nullptr : jacobians.data());
+            }
+        }
+        return true;
+    }
+
+protected:
+    /**
+     * corrects residuals 'r' and jacobians 'J' of a single factor, such that the squared norm of
+     * the corrected residuals is 'rho(s)', where 's = |r|^2'. Given 'f = sqrt(rho(s) / s)':
+     *     r' = f * r,  J' = f * J + (rho'(s) * s - rho(s)) / (f * s^2) * r * r^T * J,
+     * whose cost and gradient are identical to the ones of a block with the loss function.
+     * Attention: the Gauss-Newton Hessian 'J'^T * J'' is not the corrected one ceres builds for a
+     * block with the loss function (which involves 'rho''(s)'), thus the steps, and hence the
+     * convergence, could differ from the ones of unbatched blocks with robust losses
+     */
+    void Robustify(const ceres::LossFunction &lossFunc,
+                   int rows,
+                   double *residuals,
+                   double **jacobians) const {
+        using RowMajorMat = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+        const auto &blockSizes = parameter_block_sizes();
+
+        Eigen::Map<Eigen::VectorXd> r(residuals, rows);
+        const double sqNorm = r.squaredNorm();
+        double rho[3];
+        lossFunc.Evaluate(sqNorm, rho);
+
+        double scale, rCoeff = 0.0;
+        if (sqNorm < std::numeric_limits<double>::epsilon()) {
+            // the limit of the above when 's' approaches zero
+            scale = std::sqrt(rho[1]);
+        } else {
+            scale = std::sqrt(rho[0] / sqNorm);
+            rCoeff = (rho[1] * sqNorm - rho[0]) / (scale * sqNorm * sqNorm);
+        }
+
+        if (jacobians != nullptr) {
+            for (int j = 0; j < static_cast<int>(blockSizes.size()); ++j) {
+                if (jacobians[j] == nullptr) {
+                    continue;
+                }
+                Eigen::Map<RowMajorMat> jac(jacobians[j], rows, blockSizes[j]);
+                const Eigen::RowVectorXd rTJac = r.transpose() * jac;
+                jac = scale * jac + rCoeff * r * rTJac;
+            }
+        }
+        r *= scale;
+    }
+};
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_BATCHED_FACTOR_HPP
@@ -0,0 +1,146 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#ifndef IKALIBR_FIXED_ARITY_COST_FUNCTION_HPP
+#define IKALIBR_FIXED_ARITY_COST_FUNCTION_HPP
+
+#include "ceres/autodiff_cost_function.h"
+#include "ceres/sized_cost_function.h"
+#include "ctraj/spline/spline_segment.h"
+#include "util/utils.h"
+#include "memory"
+#include "utility"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+/**
+ * adapts a factor written for 'ceres::DynamicAutoDiffCostFunction', i.e., whose operator()
+ * takes '(T const *const *sKnots, T *sResiduals)', to the fixed-arity signature required by
+ * 'ceres::AutoDiffCostFunction', so that the same factor can be evaluated with statically sized
+ * jets whenever its parameter block layout is known at compile time
+ */
+template <typename Functor>
+struct FixedArityFunctor {
+private:
+    std::unique_ptr<Functor> _functor;
+
+public:
+    explicit FixedArityFunctor(Functor *functor)
+        : _functor(functor) {}
+
+    /**
+     * ceres passes parameter blocks one by one, followed by the residual array
+     */
+    template <typename T, typename... Blocks>
+    bool operator()(const T *firstBlock, Blocks... otherBlocks) const {
+        const T *blocks[] = {firstBlock, otherBlocks...};
+        // the last pointer is the (writable) residual array
+        auto residuals = const_cast<T *>(blocks[sizeof...(Blocks)]);
+        return (*_functor)(blocks, residuals);
+    }
+};
+
+namespace detail {
+template <int Size, std::size_t... Idx>
+std::integer_sequence<int, (static_cast<void>(Idx), Size)...> RepeatBlockSize(
+    std::index_sequence<Idx...>);
+
+template <typename... Seqs>
+struct ConcatBlockSizes;
+
+template <int... Sizes>
+struct ConcatBlockSizes<std::integer_sequence<int, Sizes...>> {
+    using type = std::integer_sequence<int, Sizes...>;
+};
+
+template <int... SizesA, int... SizesB, typename... Seqs>
+struct ConcatBlockSizes<std::integer_sequence<int, SizesA...>,
+                        std::integer_sequence<int, SizesB...>,
+                        Seqs...> {
+    using type =
+        typename ConcatBlockSizes<std::integer_sequence<int, SizesA..., SizesB...>, Seqs...>::type;
+};
+
+template <int NumResiduals, typename Sizes>
+struct SizedCostFunctionOf;
+
+template <int NumResiduals, int... Sizes>
+struct SizedCostFunctionOf<NumResiduals, std::integer_sequence<int, Sizes...>> {
+    using type = ceres::SizedCostFunction<NumResiduals, Sizes...>;
+};
+}  // namespace detail
+
+/**
+ * 'Count' parameter blocks, each has 'Size' sub params, e.g., the knots of a spline segment
+ */
+template <int Count, int Size>
+using RepeatedBlockSizes =
+    decltype(detail::RepeatBlockSize<Size>(std::make_index_sequence<Count>()));
+
+template <int... Sizes>
+using BlockSizes = std::integer_sequence<int, Sizes...>;
+
+template <typename... Seqs>
+using ConcatBlockSizes = typename detail::ConcatBlockSizes<Seqs...>::type;
+
+/**
+ * the 'ceres::SizedCostFunction' base of analytic factors whose block sizes are given by 'Sizes'
+ */
+template <int NumResiduals, typename Sizes>
+using SizedCostFunctionOf = typename detail::SizedCostFunctionOf<NumResiduals, Sizes>::type;
+
+/**
+ * creates a 'ceres::AutoDiffCostFunction' whose parameter block sizes are given by 'Sizes'
+ */
+template <int NumResiduals, typename Functor, int... Sizes>
+ceres::CostFunction *CreateFixedArityCostFunction(Functor *functor,
+                                                  std::integer_sequence<int, Sizes...>) {
+    return new ceres::AutoDiffCostFunction<FixedArityFunctor<Functor>, NumResiduals, Sizes...>(
+        new FixedArityFunctor<Functor>(functor));
+}
+
+/**
+ * a spline meta involves exactly 'Order' knots if it covers a single time point (a single
+ * segment with a single interval), which is the case when the time offset is not optimized. In
+ * this case, the knot count is known at compile time and the fixed-arity cost function applies
+ */
+template <int Order>
+bool IsFixedAritySplineMeta(const ns_ctraj::SplineMeta<Order> &meta) {
+    return meta.NumParameters() == Order;
+}
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_FIXED_ARITY_COST_FUNCTION_HPP
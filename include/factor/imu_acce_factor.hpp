@@ -41,6 +41,8 @@
 #include "ctraj/spline/ceres_spline_helper.h"
 #include "ctraj/spline/ceres_spline_helper_jet.h"
 #include "ceres/dynamic_autodiff_cost_function.h"
+#include "factor/fixed_arity_cost_function.hpp"
+#include "factor/analytic_spline_helper.hpp"
 #include "sensor/imu.h"
 #include "util/utils.h"
 #include "config/configor.h"
@@ -79,6 +81,23 @@ public:
             new IMUAcceFactor(rotMeta, linScaleMeta, imuFrame, weight));
     }
 
+    /**
+     * param blocks when both the so3 and scale metas involve exactly 'Order' knots:
+     * [ SO3 x Order | LIN_SCALE x Order | ACCE_BIAS | ACCE_MAP_COEFF | GRAVITY |
+     *   SO3_BiToBr | POS_BiInBr | TO_BiToBr ]
+     */
+    using FixedBlockSizes = ConcatBlockSizes<RepeatedBlockSizes<Order, 4>,
+                                             RepeatedBlockSizes<Order, 3>,
+                                             BlockSizes<3, 6, 3, 4, 3, 1>>;
+
+    static ceres::CostFunction *CreateFixedArity(const ns_ctraj::SplineMeta<Order> &rotMeta,
+                                                 const ns_ctraj::SplineMeta<Order> &linScaleMeta,
+                                                 const IMUFrame::Ptr &imuFrame,
+                                                 double weight) {
+        return CreateFixedArityCostFunction<3>(
+            new IMUAcceFactor(rotMeta, linScaleMeta, imuFrame, weight), FixedBlockSizes());
+    }
+
     static std::size_t TypeHashCode() { return typeid(IMUAcceFactor).hash_code(); }
 
 public:
@@ -167,8 +186,197 @@ public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+/**
+ * the analytic counterpart of 'IMUAcceFactor' for so3 and scale metas involving exactly 'Order'
+ * knots, 'IMUAcceFactor' is kept as the autodiff reference
+ */
+template <int Order, int TimeDeriv>
+struct IMUAcceAnalyticFactor
+    : public SizedCostFunctionOf<3, typename IMUAcceFactor<Order, TimeDeriv>::FixedBlockSizes> {
+private:
+    using Helper = AnalyticSplineHelper<Order>;
+
+    ns_ctraj::SplineMeta<Order> _so3Meta, _scaleMeta;
+    IMUFrame::Ptr _imuFrame{};
+
+    // the spline bases at the (time-offset-corrected) time stamp of the measurement, the time
+    // offset is not estimated for analytic factors, thus they are computed once at construction
+    typename Helper::Basis _so3Basis, _scaleBasis;
+    double _weight;
+
+public:
+    explicit IMUAcceAnalyticFactor(ns_ctraj::SplineMeta<Order> rotMeta,
+                                   ns_ctraj::SplineMeta<Order> linScaleMeta,
+                                   IMUFrame::Ptr imuFrame,
+                                   double TO_BiToBr,
+                                   double weight)
+        : _so3Meta(std::move(rotMeta)),
+          _scaleMeta(std::move(linScaleMeta)),
+          _imuFrame(std::move(imuFrame)),
+          _so3Basis(Helper::BasisAt(_so3Meta, _imuFrame->GetTimestamp() + TO_BiToBr, true)),
+          _scaleBasis(Helper::BasisAt(_scaleMeta, _imuFrame->GetTimestamp() + TO_BiToBr, false)),
+          _weight(weight) {}
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &rotMeta,
+                       const ns_ctraj::SplineMeta<Order> &linScaleMeta,
+                       const IMUFrame::Ptr &imuFrame,
+                       double TO_BiToBr,
+                       double weight) {
+        return new IMUAcceAnalyticFactor(rotMeta, linScaleMeta, imuFrame, TO_BiToBr, weight);
+    }
+
+    static std::size_t TypeHashCode() { return typeid(IMUAcceAnalyticFactor).hash_code(); }
+
+public:
+    /**
+     * param blocks:
+     * [ SO3 x Order | LIN_SCALE x Order | ACCE_BIAS | ACCE_MAP_COEFF | GRAVITY |
+     *   SO3_BiToBr | POS_BiInBr | TO_BiToBr ]
+     */
+    bool Evaluate(double const *const *sKnots,
+                  double *sResiduals,
+                  double **sJacobians) const override {
+        SharedKnots so3Knots;
+        PrepareKnots(sKnots, sJacobians != nullptr, so3Knots);
+        return EvaluateWithKnots(sKnots, so3Knots, sResiduals, sJacobians);
+    }
+
+    // knot-related quantities shared by measurements in the same segment (see 'BatchedFactor')
+    using SharedKnots = typename Helper::So3Knots;
+
+    static void PrepareKnots(double const *const *sKnots,
+                             bool computeJacobians,
+                             SharedKnots &so3Knots) {
+        Helper::PrepareSo3(sKnots, computeJacobians, so3Knots);
+    }
+
+    bool EvaluateWithKnots(double const *const *sKnots,
+                           const SharedKnots &so3Knots,
+                           double *sResiduals,
+                           double **sJacobians) const {
+        constexpr int LIN_SCALE_OFFSET = Order;
+        constexpr int ACCE_BIAS_OFFSET = LIN_SCALE_OFFSET + Order;
+        constexpr int ACCE_MAP_COEFF_OFFSET = ACCE_BIAS_OFFSET + 1;
+        constexpr int GRAVITY_OFFSET = ACCE_MAP_COEFF_OFFSET + 1;
+        constexpr int SO3_BiToBr_OFFSET = GRAVITY_OFFSET + 1;
+        constexpr int POS_BiInBr_OFFSET = SO3_BiToBr_OFFSET + 1;
+        constexpr int TO_BiToBr_OFFSET = POS_BiInBr_OFFSET + 1;
+
+        Eigen::Map<const Sophus::SO3d> SO3_BiToBr(sKnots[SO3_BiToBr_OFFSET]);
+        Eigen::Map<const Eigen::Vector3d> POS_BiInBr(sKnots[POS_BiInBr_OFFSET]);
+
+        // the angular jerk is only required by the jacobian of the time offset
+        const bool toJac = sJacobians != nullptr && sJacobians[TO_BiToBr_OFFSET] != nullptr;
+        typename Helper::So3State so3;
+        Helper::EvaluateSo3(sKnots, so3Knots, _so3Basis, toJac ? 3 : 2, sJacobians != nullptr,
+                            so3);
+
+        const auto &scaleWeights = _scaleBasis[TimeDeriv];
+        const Eigen::Vector3d ACCE_BrToBr0InBr0 =
+            Helper::EvaluateRd(sKnots + LIN_SCALE_OFFSET, scaleWeights);
+
+        Eigen::Map<const Eigen::Vector3d> acceBias(sKnots[ACCE_BIAS_OFFSET]);
+        Eigen::Map<const Eigen::Vector3d> gravity(sKnots[GRAVITY_OFFSET]);
+
+        auto acceCoeff = sKnots[ACCE_MAP_COEFF_OFFSET];
+        Eigen::Matrix3d acceMapMat = Eigen::Matrix3d::Zero();
+        acceMapMat.diagonal() = Eigen::Map<const Eigen::Vector3d>(acceCoeff, 3);
+        acceMapMat(0, 1) = *(acceCoeff + 3);
+        acceMapMat(0, 2) = *(acceCoeff + 4);
+        acceMapMat(1, 2) = *(acceCoeff + 5);
+
+        // the specific force of the imu expressed in the reference imu frame, which equals to
+        // 'SO3_BrToBr0^T * (POS_ACCE_BiToBr0InBr0 - gravity)' in 'IMUAcceFactor'
+        const Eigen::Matrix3d SO3_Br0ToBr = so3.rot.matrix().transpose();
+        const Eigen::Vector3d acceMinusGrav = ACCE_BrToBr0InBr0 - gravity;
+        const Eigen::Vector3d velCrossPos = so3.vel.cross(POS_BiInBr);
+        const Eigen::Vector3d forceInBr = SO3_Br0ToBr * acceMinusGrav +
+                                          so3.acce.cross(POS_BiInBr) + so3.vel.cross(velCrossPos);
+        const Eigen::Vector3d forceInBi = SO3_BiToBr.inverse() * forceInBr;
+
+        Eigen::Map<Eigen::Vector3d> residuals(sResiduals);
+        residuals = _weight * (acceMapMat * forceInBi + acceBias - _imuFrame->GetAcce());
+
+        if (sJacobians == nullptr) {
+            return true;
+        }
+
+        // the jacobian of the residuals w.r.t. 'forceInBr'
+        const Eigen::Matrix3d forceJac = _weight * acceMapMat * SO3_BiToBr.matrix().transpose();
+        const Eigen::Matrix3d velHat = Sophus::SO3d::hat(so3.vel);
+        const Eigen::Matrix3d posHat = Sophus::SO3d::hat(POS_BiInBr);
+
+        const Eigen::Matrix3d rotJacHelper =
+            forceJac * SO3_Br0ToBr * Sophus::SO3d::hat(acceMinusGrav);
+        const Eigen::Matrix3d velJacHelper =
+            -forceJac * (Sophus::SO3d::hat(velCrossPos) + velHat * posHat);
+        const Eigen::Matrix3d acceJacHelper = -forceJac * posHat;
+        for (int i = 0; i < Order; ++i) {
+            if (sJacobians[i] != nullptr) {
+                Helper::template QuaternionJacobian<3>(
+                    rotJacHelper * so3.rotJac[i] + velJacHelper * so3.velJac[i] +
+                        acceJacHelper * so3.acceJac[i],
+                    sKnots[i], sJacobians[i]);
+            }
+        }
+        for (int i = 0; i < Order; ++i) {
+            if (sJacobians[LIN_SCALE_OFFSET + i] != nullptr) {
+                Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jac(
+                    sJacobians[LIN_SCALE_OFFSET + i]);
+                jac = scaleWeights(i) * forceJac * SO3_Br0ToBr;
+            }
+        }
+        if (sJacobians[ACCE_BIAS_OFFSET] != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jac(
+                sJacobians[ACCE_BIAS_OFFSET]);
+            jac = _weight * Eigen::Matrix3d::Identity();
+        }
+        if (sJacobians[ACCE_MAP_COEFF_OFFSET] != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 6, Eigen::RowMajor>> jac(
+                sJacobians[ACCE_MAP_COEFF_OFFSET]);
+            jac.setZero();
+            jac.diagonal() = forceInBi;
+            jac(0, 3) = forceInBi(1), jac(0, 4) = forceInBi(2), jac(1, 5) = forceInBi(2);
+            jac *= _weight;
+        }
+        if (sJacobians[GRAVITY_OFFSET] != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jac(
+                sJacobians[GRAVITY_OFFSET]);
+            jac = -forceJac * SO3_Br0ToBr;
+        }
+        if (sJacobians[SO3_BiToBr_OFFSET] != nullptr) {
+            Helper::template QuaternionJacobian<3>(forceJac * Sophus::SO3d::hat(forceInBr),
+                                                   sKnots[SO3_BiToBr_OFFSET],
+                                                   sJacobians[SO3_BiToBr_OFFSET]);
+        }
+        if (sJacobians[POS_BiInBr_OFFSET] != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jac(
+                sJacobians[POS_BiInBr_OFFSET]);
+            jac = forceJac * (Sophus::SO3d::hat(so3.acce) + velHat * velHat);
+        }
+        if (toJac) {
+            const Eigen::Vector3d acceDot =
+                Helper::EvaluateRd(sKnots + LIN_SCALE_OFFSET, _scaleBasis[TimeDeriv + 1]);
+            const Eigen::Vector3d forceDot = -velHat * SO3_Br0ToBr * acceMinusGrav +
+                                             SO3_Br0ToBr * acceDot + so3.jerk.cross(POS_BiInBr) +
+                                             so3.acce.cross(velCrossPos) +
+                                             so3.vel.cross(so3.acce.cross(POS_BiInBr));
+            Eigen::Map<Eigen::Vector3d> jac(sJacobians[TO_BiToBr_OFFSET]);
+            jac = forceJac * forceDot;
+        }
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
 extern template struct IMUAcceFactor<Configor::Prior::SplineOrder, 2>;
 extern template struct IMUAcceFactor<Configor::Prior::SplineOrder, 1>;
 extern template struct IMUAcceFactor<Configor::Prior::SplineOrder, 0>;
+extern template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 2>;
+extern template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 1>;
+extern template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 0>;
 }  // namespace ns_ikalibr
 #endif  // IKALIBR_IMU_ACCE_FACTOR_HPP
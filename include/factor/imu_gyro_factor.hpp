@@ -40,6 +40,8 @@
 #include "ctraj/spline/spline_segment.h"
 #include "ctraj/spline/ceres_spline_helper_jet.h"
 #include "ceres/dynamic_autodiff_cost_function.h"
+#include "factor/fixed_arity_cost_function.hpp"
+#include "factor/analytic_spline_helper.hpp"
 #include "sensor/imu.h"
 #include "util/utils.h"
 #include "config/configor.h"
@@ -72,6 +74,20 @@ public:
             new IMUGyroFactor(so3Meta, frame, weight));
     }
 
+    /**
+     * param blocks when the so3 meta involves exactly 'Order' knots:
+     * [ SO3 x Order | GYRO_BIAS | GYRO_MAP_COEFF | SO3_AtoG | SO3_BiToBr | TO_BiToBr ]
+     */
+    using FixedBlockSizes =
+        ConcatBlockSizes<RepeatedBlockSizes<Order, 4>, BlockSizes<3, 6, 4, 4, 1>>;
+
+    static ceres::CostFunction *CreateFixedArity(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                                                 const IMUFrame::Ptr &frame,
+                                                 double weight) {
+        return CreateFixedArityCostFunction<3>(new IMUGyroFactor(so3Meta, frame, weight),
+                                               FixedBlockSizes());
+    }
+
     static std::size_t TypeHashCode() { return typeid(IMUGyroFactor).hash_code(); }
 
 public:
@@ -131,7 +147,150 @@ public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+/**
+ * the analytic counterpart of 'IMUGyroFactor' for so3 metas involving exactly 'Order' knots,
+ * 'IMUGyroFactor' is kept as the autodiff reference
+ */
+template <int Order>
+struct IMUGyroAnalyticFactor
+    : public SizedCostFunctionOf<3, typename IMUGyroFactor<Order>::FixedBlockSizes> {
+private:
+    using Helper = AnalyticSplineHelper<Order>;
+
+    ns_ctraj::SplineMeta<Order> _so3Meta;
+    IMUFrame::Ptr _frame{};
+
+    // the spline basis at the (time-offset-corrected) time stamp of the measurement, the time
+    // offset is not estimated for analytic factors, thus it's computed once at construction
+    typename Helper::Basis _so3Basis;
+    double _weight;
+
+public:
+    explicit IMUGyroAnalyticFactor(ns_ctraj::SplineMeta<Order> so3Meta,
+                                   IMUFrame::Ptr frame,
+                                   double TO_BiToBr,
+                                   double weight)
+        : _so3Meta(std::move(so3Meta)),
+          _frame(std::move(frame)),
+          _so3Basis(Helper::BasisAt(_so3Meta, _frame->GetTimestamp() + TO_BiToBr, true)),
+          _weight(weight) {}
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                       const IMUFrame::Ptr &frame,
+                       double TO_BiToBr,
+                       double weight) {
+        return new IMUGyroAnalyticFactor(so3Meta, frame, TO_BiToBr, weight);
+    }
+
+    static std::size_t TypeHashCode() { return typeid(IMUGyroAnalyticFactor).hash_code(); }
+
+public:
+    /**
+     * param blocks:
+     * [ SO3 x Order | GYRO_BIAS | GYRO_MAP_COEFF | SO3_AtoG | SO3_BiToBr | TO_BiToBr ]
+     */
+    bool Evaluate(double const *const *sKnots,
+                  double *sResiduals,
+                  double **sJacobians) const override {
+        SharedKnots so3Knots;
+        PrepareKnots(sKnots, sJacobians != nullptr, so3Knots);
+        return EvaluateWithKnots(sKnots, so3Knots, sResiduals, sJacobians);
+    }
+
+    // knot-related quantities shared by measurements in the same segment (see 'BatchedFactor')
+    using SharedKnots = typename Helper::So3Knots;
+
+    static void PrepareKnots(double const *const *sKnots,
+                             bool computeJacobians,
+                             SharedKnots &so3Knots) {
+        Helper::PrepareSo3(sKnots, computeJacobians, so3Knots);
+    }
+
+    bool EvaluateWithKnots(double const *const *sKnots,
+                           const SharedKnots &so3Knots,
+                           double *sResiduals,
+                           double **sJacobians) const {
+        // array offset
+        constexpr int GYRO_BIAS_OFFSET = Order;
+        constexpr int GYRO_MAP_COEFF_OFFSET = GYRO_BIAS_OFFSET + 1;
+        constexpr int SO3_AtoG_OFFSET = GYRO_MAP_COEFF_OFFSET + 1;
+        constexpr int SO3_BiToBr_OFFSET = SO3_AtoG_OFFSET + 1;
+        constexpr int TO_BiToBr_OFFSET = SO3_BiToBr_OFFSET + 1;
+
+        // the angular acceleration is only required by the jacobian of the time offset
+        const bool toJac = sJacobians != nullptr && sJacobians[TO_BiToBr_OFFSET] != nullptr;
+        typename Helper::So3State so3;
+        Helper::EvaluateSo3(sKnots, so3Knots, _so3Basis, toJac ? 2 : 1, sJacobians != nullptr,
+                            so3);
+
+        Eigen::Map<const Eigen::Vector3d> gyroBias(sKnots[GYRO_BIAS_OFFSET]);
+        auto gyroCoeff = sKnots[GYRO_MAP_COEFF_OFFSET];
+        Eigen::Matrix3d gyroMapMat = Eigen::Matrix3d::Zero();
+        gyroMapMat.diagonal() = Eigen::Map<const Eigen::Vector3d>(gyroCoeff, 3);
+        gyroMapMat(0, 1) = *(gyroCoeff + 3);
+        gyroMapMat(0, 2) = *(gyroCoeff + 4);
+        gyroMapMat(1, 2) = *(gyroCoeff + 5);
+
+        Eigen::Map<const Sophus::SO3d> SO3_AtoG(sKnots[SO3_AtoG_OFFSET]);
+        Eigen::Map<const Sophus::SO3d> SO3_BiToBr(sKnots[SO3_BiToBr_OFFSET]);
+
+        // 'SO3_AtoG * SO3_BiToBr0^T * SO3_VEL_BrToBr0InBr0' reduces to the one below
+        const Eigen::Matrix3d SO3_BrToG = SO3_AtoG.matrix() * SO3_BiToBr.matrix().transpose();
+        const Eigen::Vector3d angVelInG = SO3_BrToG * so3.vel;
+
+        Eigen::Map<Eigen::Vector3d> residuals(sResiduals);
+        residuals = _weight * (gyroMapMat * angVelInG + gyroBias - _frame->GetGyro());
+
+        if (sJacobians == nullptr) {
+            return true;
+        }
+
+        const Eigen::Matrix3d weightedMapMat = _weight * gyroMapMat;
+        const Eigen::Matrix3d velJacHelper = weightedMapMat * SO3_BrToG;
+
+        for (int i = 0; i < Order; ++i) {
+            if (sJacobians[i] != nullptr) {
+                Helper::template QuaternionJacobian<3>(velJacHelper * so3.velJac[i], sKnots[i],
+                                                       sJacobians[i]);
+            }
+        }
+        if (sJacobians[GYRO_BIAS_OFFSET] != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jac(
+                sJacobians[GYRO_BIAS_OFFSET]);
+            jac = _weight * Eigen::Matrix3d::Identity();
+        }
+        if (sJacobians[GYRO_MAP_COEFF_OFFSET] != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 6, Eigen::RowMajor>> jac(
+                sJacobians[GYRO_MAP_COEFF_OFFSET]);
+            jac.setZero();
+            jac.diagonal() = angVelInG;
+            jac(0, 3) = angVelInG(1), jac(0, 4) = angVelInG(2), jac(1, 5) = angVelInG(2);
+            jac *= _weight;
+        }
+        if (sJacobians[SO3_AtoG_OFFSET] != nullptr) {
+            Helper::template QuaternionJacobian<3>(-weightedMapMat * Sophus::SO3d::hat(angVelInG),
+                                                   sKnots[SO3_AtoG_OFFSET],
+                                                   sJacobians[SO3_AtoG_OFFSET]);
+        }
+        if (sJacobians[SO3_BiToBr_OFFSET] != nullptr) {
+            Helper::template QuaternionJacobian<3>(velJacHelper * Sophus::SO3d::hat(so3.vel),
+                                                   sKnots[SO3_BiToBr_OFFSET],
+                                                   sJacobians[SO3_BiToBr_OFFSET]);
+        }
+        if (toJac) {
+            Eigen::Map<Eigen::Vector3d> jac(sJacobians[TO_BiToBr_OFFSET]);
+            jac = velJacHelper * so3.acce;
+        }
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
 extern template struct IMUGyroFactor<Configor ::Prior::SplineOrder>;
+extern template struct IMUGyroAnalyticFactor<Configor::Prior::SplineOrder>;
 }  // namespace ns_ikalibr
 
 #endif  // IKALIBR_IMU_GYRO_FACTOR_HPP
@@ -40,9 +40,12 @@
 #include "ctraj/spline/spline_segment.h"
 #include "ctraj/spline/ceres_spline_helper_jet.h"
 #include "ceres/dynamic_autodiff_cost_function.h"
+#include "factor/fixed_arity_cost_function.hpp"
+#include "factor/analytic_spline_helper.hpp"
 #include "util/utils.h"
 #include "config/configor.h"
 #include "factor/data_correspondence.h"
+#include "limits"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -79,6 +82,22 @@ public:
             new PointToSurfelFactor(so3Meta, scaleMeta, ptsCorr, weight));
     }
 
+    /**
+     * param blocks when both the so3 and scale metas involve exactly 'Order' knots:
+     * [ SO3 x Order | LIN_SCALE x Order | SO3_LkToBr | POS_LkInBr | TO_LkToBr ]
+     */
+    using FixedBlockSizes = ConcatBlockSizes<RepeatedBlockSizes<Order, 4>,
+                                             RepeatedBlockSizes<Order, 3>,
+                                             BlockSizes<4, 3, 1>>;
+
+    static ceres::CostFunction *CreateFixedArity(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                                                 const ns_ctraj::SplineMeta<Order> &scaleMeta,
+                                                 const PointToSurfelCorr::Ptr &ptsCorr,
+                                                 double weight) {
+        return CreateFixedArityCostFunction<1>(
+            new PointToSurfelFactor(so3Meta, scaleMeta, ptsCorr, weight), FixedBlockSizes());
+    }
+
     static std::size_t TypeHashCode() { return typeid(PointToSurfelFactor).hash_code(); }
 
 public:
@@ -136,8 +155,172 @@ public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+/**
+ * the analytic counterpart of 'PointToSurfelFactor' for so3 and scale metas involving exactly
+ * 'Order' knots, 'PointToSurfelFactor' is kept as the autodiff reference
+ */
+template <int Order, int TimeDeriv>
+struct PointToSurfelAnalyticFactor
+    : public SizedCostFunctionOf<1,
+                                 typename PointToSurfelFactor<Order, TimeDeriv>::FixedBlockSizes> {
+private:
+    using Helper = AnalyticSplineHelper<Order>;
+
+    ns_ctraj::SplineMeta<Order> _so3Meta, _scaleMeta;
+    PointToSurfelCorr::Ptr _ptsCorr;
+
+    // the (time-offset-corrected) time stamp of the point and the spline bases at it, the time
+    // offset is not estimated for analytic factors, thus they are computed once at construction
+    double _timeByBr;
+    typename Helper::Basis _so3Basis, _scaleBasis;
+    double _weight;
+
+public:
+    explicit PointToSurfelAnalyticFactor(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                                         const ns_ctraj::SplineMeta<Order> &scaleMeta,
+                                         PointToSurfelCorr::Ptr ptsCorr,
+                                         double TO_LkToBr,
+                                         double weight)
+        : _so3Meta(so3Meta),
+          _scaleMeta(scaleMeta),
+          _ptsCorr(std::move(ptsCorr)),
+          _timeByBr(_ptsCorr->timestamp + TO_LkToBr),
+          _so3Basis(Helper::BasisAt(_so3Meta, _timeByBr, true)),
+          _scaleBasis(Helper::BasisAt(_scaleMeta, _timeByBr, false)),
+          _weight(weight) {}
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                       const ns_ctraj::SplineMeta<Order> &scaleMeta,
+                       const PointToSurfelCorr::Ptr &ptsCorr,
+                       double TO_LkToBr,
+                       double weight) {
+        return new PointToSurfelAnalyticFactor(so3Meta, scaleMeta, ptsCorr, TO_LkToBr, weight);
+    }
+
+    static std::size_t TypeHashCode() { return typeid(PointToSurfelAnalyticFactor).hash_code(); }
+
+public:
+    /**
+     * knot-related quantities shared by correspondences in the same segment (see 'BatchedFactor').
+     * The last spline evaluation is kept as well and reused by the following correspondences
+     * stamped at the same time, e.g., points from one firing of a spinning lidar
+     */
+    struct SharedKnots {
+        typename Helper::So3Knots so3Knots;
+
+        double timeByBr = std::numeric_limits<double>::quiet_NaN();
+        typename Helper::So3State so3;
+        typename Helper::VecN scaleWeights;
+        Eigen::Vector3d POS_BrInBr0;
+        Eigen::Vector3d POS_VEL_BrInBr0;
+    };
+
+    static void PrepareKnots(double const *const *sKnots,
+                             bool computeJacobians,
+                             SharedKnots &sharedKnots) {
+        Helper::PrepareSo3(sKnots, computeJacobians, sharedKnots.so3Knots);
+        sharedKnots.timeByBr = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    /**
+     * param blocks:
+     * [ SO3 x Order | LIN_SCALE x Order | SO3_LkToBr | POS_LkInBr | TO_LkToBr ]
+     */
+    bool Evaluate(double const *const *sKnots,
+                  double *sResiduals,
+                  double **sJacobians) const override {
+        SharedKnots sharedKnots;
+        PrepareKnots(sKnots, sJacobians != nullptr, sharedKnots);
+        return EvaluateWithKnots(sKnots, sharedKnots, sResiduals, sJacobians);
+    }
+
+    bool EvaluateWithKnots(double const *const *sKnots,
+                           SharedKnots &sharedKnots,
+                           double *sResiduals,
+                           double **sJacobians) const {
+        constexpr int LIN_SCALE_OFFSET = Order;
+        constexpr int SO3_LkToBr_OFFSET = LIN_SCALE_OFFSET + Order;
+        constexpr int POS_LkInBr_OFFSET = SO3_LkToBr_OFFSET + 1;
+        constexpr int TO_LkToBr_OFFSET = POS_LkInBr_OFFSET + 1;
+
+        Eigen::Map<const Sophus::SO3d> SO3_LkToBr(sKnots[SO3_LkToBr_OFFSET]);
+        Eigen::Map<const Eigen::Vector3d> POS_LkInBr(sKnots[POS_LkInBr_OFFSET]);
+
+        // the angular velocity is only required by the jacobian of the time offset
+        const bool toJac = sJacobians != nullptr && sJacobians[TO_LkToBr_OFFSET] != nullptr;
+
+        // the spline is evaluated only for a new time stamp, as the requested jacobians are the
+        // same for all correspondences of a single evaluation
+        if (_timeByBr != sharedKnots.timeByBr) {
+            Helper::EvaluateSo3(sKnots, sharedKnots.so3Knots, _so3Basis, toJac ? 1 : 0,
+                                sJacobians != nullptr, sharedKnots.so3);
+
+            sharedKnots.scaleWeights = _scaleBasis[TimeDeriv];
+            sharedKnots.POS_BrInBr0 =
+                Helper::EvaluateRd(sKnots + LIN_SCALE_OFFSET, sharedKnots.scaleWeights);
+            if (toJac) {
+                sharedKnots.POS_VEL_BrInBr0 =
+                    Helper::EvaluateRd(sKnots + LIN_SCALE_OFFSET, _scaleBasis[TimeDeriv + 1]);
+            }
+            sharedKnots.timeByBr = _timeByBr;
+        }
+        const auto &so3 = sharedKnots.so3;
+        const auto &scaleWeights = sharedKnots.scaleWeights;
+
+        // construct the residuals
+        const Eigen::Vector3d pointInLkRotated = SO3_LkToBr * _ptsCorr->pInScan;
+        const Eigen::Vector3d pointInBr = pointInLkRotated + POS_LkInBr;
+        const Eigen::Vector3d pointInBrRotated = so3.rot * pointInBr;
+        const Eigen::Vector3d pointInBr0 = pointInBrRotated + sharedKnots.POS_BrInBr0;
+
+        const Eigen::Vector3d planeNorm = _ptsCorr->surfelInW.head(3);
+        sResiduals[0] = _weight * (pointInBr0.dot(planeNorm) + _ptsCorr->surfelInW(3));
+
+        if (sJacobians == nullptr) {
+            return true;
+        }
+
+        const Eigen::RowVector3d normJac = _weight * planeNorm.transpose();
+        const Eigen::RowVector3d rotJacHelper = -normJac * Sophus::SO3d::hat(pointInBrRotated);
+        for (int i = 0; i < Order; ++i) {
+            if (sJacobians[i] != nullptr) {
+                Helper::template QuaternionJacobian<1>(rotJacHelper * so3.rotJac[i], sKnots[i],
+                                                       sJacobians[i]);
+            }
+        }
+        for (int i = 0; i < Order; ++i) {
+            if (sJacobians[LIN_SCALE_OFFSET + i] != nullptr) {
+                Eigen::Map<Eigen::RowVector3d> jac(sJacobians[LIN_SCALE_OFFSET + i]);
+                jac = scaleWeights(i) * normJac;
+            }
+        }
+        const Eigen::RowVector3d normJacInBr = normJac * so3.rot.matrix();
+        if (sJacobians[SO3_LkToBr_OFFSET] != nullptr) {
+            Helper::template QuaternionJacobian<1>(
+                -normJacInBr * Sophus::SO3d::hat(pointInLkRotated), sKnots[SO3_LkToBr_OFFSET],
+                sJacobians[SO3_LkToBr_OFFSET]);
+        }
+        if (sJacobians[POS_LkInBr_OFFSET] != nullptr) {
+            Eigen::Map<Eigen::RowVector3d> jac(sJacobians[POS_LkInBr_OFFSET]);
+            jac = normJacInBr;
+        }
+        if (toJac) {
+            sJacobians[TO_LkToBr_OFFSET][0] = normJacInBr.dot(so3.vel.cross(pointInBr)) +
+                                              normJac.dot(sharedKnots.POS_VEL_BrInBr0);
+        }
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
 extern template struct PointToSurfelFactor<Configor::Prior::SplineOrder, 2>;
 extern template struct PointToSurfelFactor<Configor::Prior::SplineOrder, 1>;
 extern template struct PointToSurfelFactor<Configor::Prior::SplineOrder, 0>;
+extern template struct PointToSurfelAnalyticFactor<Configor::Prior::SplineOrder, 2>;
+extern template struct PointToSurfelAnalyticFactor<Configor::Prior::SplineOrder, 1>;
+extern template struct PointToSurfelAnalyticFactor<Configor::Prior::SplineOrder, 0>;
 }  // namespace ns_ikalibr
 #endif  // IKALIBR_POINT_TO_SURFEL_FACTOR_HPP
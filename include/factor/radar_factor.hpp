@@ -40,6 +40,8 @@
 #include "ctraj/spline/spline_segment.h"
 #include "ctraj/spline/ceres_spline_helper_jet.h"
 #include "ceres/dynamic_autodiff_cost_function.h"
+#include "factor/fixed_arity_cost_function.hpp"
+#include "factor/analytic_spline_helper.hpp"
 #include "sensor/radar.h"
 #include "util/utils.h"
 #include "config/configor.h"
@@ -79,6 +81,22 @@ public:
             new RadarFactor(so3Meta, scaleMeta, frame, weight));
     }
 
+    /**
+     * param blocks when both the so3 and scale metas involve exactly 'Order' knots:
+     * [ SO3 x Order | LIN_SCALE x Order | SO3_RjToBr | POS_RjInBr | TO_RjToBr ]
+     */
+    using FixedBlockSizes = ConcatBlockSizes<RepeatedBlockSizes<Order, 4>,
+                                             RepeatedBlockSizes<Order, 3>,
+                                             BlockSizes<4, 3, 1>>;
+
+    static ceres::CostFunction *CreateFixedArity(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                                                 const ns_ctraj::SplineMeta<Order> &scaleMeta,
+                                                 const RadarTarget::Ptr &frame,
+                                                 double weight) {
+        return CreateFixedArityCostFunction<1>(new RadarFactor(so3Meta, scaleMeta, frame, weight),
+                                               FixedBlockSizes());
+    }
+
     static std::size_t TypeHashCode() { return typeid(RadarFactor).hash_code(); }
 
 public:
@@ -136,9 +154,140 @@ public:
     }
 };
 
+/**
+ * the analytic counterpart of 'RadarFactor' for so3 and scale metas involving exactly 'Order'
+ * knots, 'RadarFactor' is kept as the autodiff reference
+ */
+template <int Order, int TimeDeriv>
+struct RadarAnalyticFactor
+    : public SizedCostFunctionOf<1, typename RadarFactor<Order, TimeDeriv>::FixedBlockSizes> {
+private:
+    using Helper = AnalyticSplineHelper<Order>;
+
+    ns_ctraj::SplineMeta<Order> _so3Meta, _scaleMeta;
+
+    RadarTarget::Ptr _frame;
+
+    // the spline bases at the (time-offset-corrected) time stamp of the measurement, the time
+    // offset is not estimated for analytic factors, thus they are computed once at construction
+    typename Helper::Basis _so3Basis, _scaleBasis;
+    double _weight;
+
+public:
+    explicit RadarAnalyticFactor(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                                 const ns_ctraj::SplineMeta<Order> &scaleMeta,
+                                 RadarTarget::Ptr frame,
+                                 double TO_RjToBr,
+                                 double weight)
+        : _so3Meta(so3Meta),
+          _scaleMeta(scaleMeta),
+          _frame(std::move(frame)),
+          _so3Basis(Helper::BasisAt(_so3Meta, _frame->GetTimestamp() + TO_RjToBr, true)),
+          _scaleBasis(Helper::BasisAt(_scaleMeta, _frame->GetTimestamp() + TO_RjToBr, false)),
+          _weight(weight) {}
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                       const ns_ctraj::SplineMeta<Order> &scaleMeta,
+                       const RadarTarget::Ptr &frame,
+                       double TO_RjToBr,
+                       double weight) {
+        return new RadarAnalyticFactor(so3Meta, scaleMeta, frame, TO_RjToBr, weight);
+    }
+
+    static std::size_t TypeHashCode() { return typeid(RadarAnalyticFactor).hash_code(); }
+
+public:
+    /**
+     * param blocks:
+     * [ SO3 x Order | LIN_SCALE x Order | SO3_RjToBr | POS_RjInBr | TO_RjToBr ]
+     */
+    bool Evaluate(double const *const *sKnots,
+                  double *sResiduals,
+                  double **sJacobians) const override {
+        constexpr int LIN_SCALE_OFFSET = Order;
+        constexpr int SO3_RjToBr_OFFSET = LIN_SCALE_OFFSET + Order;
+        constexpr int POS_RjInBr_OFFSET = SO3_RjToBr_OFFSET + 1;
+        constexpr int TO_RjToBr_OFFSET = POS_RjInBr_OFFSET + 1;
+
+        Eigen::Map<const Sophus::SO3d> SO3_RjToBr(sKnots[SO3_RjToBr_OFFSET]);
+        Eigen::Map<const Eigen::Vector3d> POS_RjInBr(sKnots[POS_RjInBr_OFFSET]);
+
+        // the angular acceleration is only required by the jacobian of the time offset
+        const bool toJac = sJacobians != nullptr && sJacobians[TO_RjToBr_OFFSET] != nullptr;
+        typename Helper::So3Knots so3Knots;
+        Helper::PrepareSo3(sKnots, sJacobians != nullptr, so3Knots);
+        typename Helper::So3State so3;
+        Helper::EvaluateSo3(sKnots, so3Knots, _so3Basis, toJac ? 2 : 1, sJacobians != nullptr,
+                            so3);
+
+        const auto &scaleWeights = _scaleBasis[TimeDeriv];
+        const Eigen::Vector3d LIN_VEL_BrInBr0 =
+            Helper::EvaluateRd(sKnots + LIN_SCALE_OFFSET, scaleWeights);
+
+        // the velocity of the radar expressed in the reference imu frame, which equals to
+        // 'SO3_BrToBr0^T * (-hat(SO3_BrToBr0 * POS_RjInBr) * ANG_VEL_BrToBr0InBr0 + LIN_VEL)'
+        const Eigen::Matrix3d SO3_Br0ToBr = so3.rot.matrix().transpose();
+        const Eigen::Vector3d linVelInBr =
+            so3.vel.cross(POS_RjInBr) + SO3_Br0ToBr * LIN_VEL_BrInBr0;
+
+        // the jacobian of the residual w.r.t. 'linVelInBr'
+        const Eigen::RowVector3d velJac = -_weight * _frame->GetInvRange() *
+                                          _frame->GetTargetXYZ().transpose() *
+                                          SO3_RjToBr.matrix().transpose();
+
+        sResiduals[0] = velJac.dot(linVelInBr) - _weight * _frame->GetRadialVelocity();
+
+        if (sJacobians == nullptr) {
+            return true;
+        }
+
+        const Eigen::RowVector3d rotJacHelper =
+            velJac * SO3_Br0ToBr * Sophus::SO3d::hat(LIN_VEL_BrInBr0);
+        const Eigen::RowVector3d velJacHelper = -velJac * Sophus::SO3d::hat(POS_RjInBr);
+        for (int i = 0; i < Order; ++i) {
+            if (sJacobians[i] != nullptr) {
+                Helper::template QuaternionJacobian<1>(
+                    rotJacHelper * so3.rotJac[i] + velJacHelper * so3.velJac[i], sKnots[i],
+                    sJacobians[i]);
+            }
+        }
+        for (int i = 0; i < Order; ++i) {
+            if (sJacobians[LIN_SCALE_OFFSET + i] != nullptr) {
+                Eigen::Map<Eigen::RowVector3d> jac(sJacobians[LIN_SCALE_OFFSET + i]);
+                jac = scaleWeights(i) * velJac * SO3_Br0ToBr;
+            }
+        }
+        if (sJacobians[SO3_RjToBr_OFFSET] != nullptr) {
+            Helper::template QuaternionJacobian<1>(velJac * Sophus::SO3d::hat(linVelInBr),
+                                                   sKnots[SO3_RjToBr_OFFSET],
+                                                   sJacobians[SO3_RjToBr_OFFSET]);
+        }
+        if (sJacobians[POS_RjInBr_OFFSET] != nullptr) {
+            Eigen::Map<Eigen::RowVector3d> jac(sJacobians[POS_RjInBr_OFFSET]);
+            jac = velJac * Sophus::SO3d::hat(so3.vel);
+        }
+        if (toJac) {
+            const Eigen::Vector3d LIN_ACCE_BrInBr0 =
+                Helper::EvaluateRd(sKnots + LIN_SCALE_OFFSET, _scaleBasis[TimeDeriv + 1]);
+            const Eigen::Vector3d linVelInBrDot = so3.acce.cross(POS_RjInBr) -
+                                                  so3.vel.cross(SO3_Br0ToBr * LIN_VEL_BrInBr0) +
+                                                  SO3_Br0ToBr * LIN_ACCE_BrInBr0;
+            sJacobians[TO_RjToBr_OFFSET][0] = velJac.dot(linVelInBrDot);
+        }
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
 extern template struct RadarFactor<Configor::Prior::SplineOrder, 2>;
 extern template struct RadarFactor<Configor::Prior::SplineOrder, 1>;
 extern template struct RadarFactor<Configor::Prior::SplineOrder, 0>;
+extern template struct RadarAnalyticFactor<Configor::Prior::SplineOrder, 2>;
+extern template struct RadarAnalyticFactor<Configor::Prior::SplineOrder, 1>;
+extern template struct RadarAnalyticFactor<Configor::Prior::SplineOrder, 0>;
 }  // namespace ns_ikalibr
 
 #endif  // IKALIBR_RADAR_FACTOR_HPP
@@ -59,7 +59,7 @@ public:
             cloud, Configor::Prior::LiDARDataAssociate::MapResolution,
             Configor::Prior::LiDARDataAssociate::MapDepthLevels);
         auto condition = PointToSurfelCondition();
-        viewer->AddSurfelMap(associator->GetSurfelMap(), condition, Viewer::VIEW_ASSOCIATION);
+        viewer->AddSurfelMap(associator->GetSurfelMaps(), condition, Viewer::VIEW_ASSOCIATION);
         viewer->AddCloud(cloud, Viewer::VIEW_ASSOCIATION,
                          ns_viewer::Colour::Black().WithAlpha(0.2f), DefaultPointSize);
         std::cin.get();
@@ -38,6 +38,7 @@
 #include "util/utils.h"
 #include "ctraj/utils/macros.hpp"
 #include "opencv4/opencv2/core.hpp"
+#include "mutex"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -45,15 +46,34 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 
 namespace ns_ikalibr {
 
-class CameraFrame {
+// the image representation(s) stored in a camera frame, the one not stored is derived on demand
+enum class ImageStorageType : std::uint8_t {
+    GREY_AND_COLOR,
+    // the color image is derived from the grey one, i.e., a grey 'color' image
+    GREY_ONLY,
+    // the grey image is derived from the color one, which is identical to the stored one
+    COLOR_ONLY
+};
+
+class CameraFrame : public std::enable_shared_from_this<CameraFrame> {
 public:
     using Ptr = std::shared_ptr<CameraFrame>;
+    // the encoded (compressed) image data, e.g., jpeg or png
+    using EncodedImage = std::shared_ptr<const std::vector<uchar>>;
 
 protected:
     double _timestamp;
-    cv::Mat _greyImg, _colorImg;
+    // if the encoded image is kept, these mats are decoded on first access, and released again
+    // when the frame falls out of the bounded lru cache of decoded images
+    mutable cv::Mat _greyImg, _colorImg;
     ns_veta::IndexT _id;
 
+    EncodedImage _encodedImg;
+    ImageStorageType _storage;
+    mutable std::mutex _decodeMutex;
+
+    friend class DecodedImageCache;
+
 public:
     // constructor
     explicit CameraFrame(double timestamp = INVALID_TIME_STAMP,
@@ -67,11 +87,35 @@ public:
                                    const cv::Mat &colorImg = cv::Mat(),
                                    ns_veta::IndexT id = ns_veta::UndefinedIndexT);
 
-    cv::Mat &GetImage();
+    // creator of frames storing a single image representation, the other one is derived on demand
+    static CameraFrame::Ptr CreateSingleImage(double timestamp,
+                                              const cv::Mat &img,
+                                              ImageStorageType storage,
+                                              ns_veta::IndexT id = ns_veta::UndefinedIndexT);
+
+    /**
+     * for frames keeping encoded images (or a single image representation), the grey/color image
+     * is decoded (derived) on first access. The mat header is returned by value, which shares
+     * (and holds a reference to) the image data, thus the image stays valid while it is in use,
+     * even if the frame is evicted from the decoded image cache by other threads meanwhile
+     */
+    [[nodiscard]] cv::Mat GetImage() const;
+
+    [[nodiscard]] cv::Mat GetColorImage() const;
+
+    // keep the encoded image only, grey and color images would be decoded from it on demand
+    void SetEncodedImage(const EncodedImage &encodedImg);
 
-    cv::Mat &GetColorImage();
+    [[nodiscard]] const EncodedImage &GetEncodedImage() const;
+
+    [[nodiscard]] ImageStorageType GetImageStorage() const;
+
+    // share the stored images (encoded or not) of another frame, nothing is decoded or derived
+    void ShareStoredImages(const CameraFrame &frame);
 
     // release the image mat data to save memory when needed
+    // for frames keeping encoded images, the released images would be decoded again when accessed,
+    // for frames storing a single image, the stored one is kept and the derived one is released
     virtual void ReleaseMat();
 
     [[nodiscard]] double GetTimestamp() const;
@@ -84,7 +128,18 @@ public:
 
     friend std::ostream &operator<<(std::ostream &os, const CameraFrame &frame);
 
-    virtual ~CameraFrame() = default;
+    virtual ~CameraFrame();
+
+protected:
+    // decode the grey or color image if it's unavailable, returns the mat (header) of the image
+    cv::Mat DecodeOnDemand(bool colorImg) const;
+
+    // whether images are decoded or derived on demand, i.e., managed by the decoded image cache
+    [[nodiscard]] bool IsImageOnDemand() const;
+
+    // release decoded (derived) images, called when the frame is evicted from the decoded image
+    // cache, the stored image is kept
+    void ReleaseDecoded() const;
 };
 }  // namespace ns_ikalibr
 
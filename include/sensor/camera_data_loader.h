@@ -53,9 +53,15 @@ public:
 
 protected:
     CameraModelType _model;
+    // keep the encoded image only, grey and color images are decoded on demand
+    bool _keepEncoded;
+    // the image representation(s) to store if images are not kept encoded
+    ImageStorageType _storage;
 
 public:
-    explicit CameraDataLoader(CameraModelType model);
+    explicit CameraDataLoader(CameraModelType model,
+                              bool keepEncoded = false,
+                              ImageStorageType storage = ImageStorageType::GREY_AND_COLOR);
 
     virtual CameraFrame::Ptr UnpackFrame(const rosbag::MessageInstance &msgInstance) = 0;
 
@@ -76,6 +82,9 @@ protected:
     }
 
     static void RefineImgMsgWrongEncoding(const sensor_msgs::Image::Ptr &msg);
+
+    // create the frame from the color (bgr8) image according to '_storage'
+    [[nodiscard]] CameraFrame::Ptr CreateFrame(double timestamp, const cv::Mat &cImg) const;
 };
 
 class SensorImageLoader : public CameraDataLoader {
@@ -83,9 +92,14 @@ public:
     using Ptr = std::shared_ptr<SensorImageLoader>;
 
 public:
-    explicit SensorImageLoader(CameraModelType model);
+    explicit SensorImageLoader(CameraModelType model,
+                               bool keepEncoded = false,
+                               ImageStorageType storage = ImageStorageType::GREY_AND_COLOR);
 
-    static SensorImageLoader::Ptr Create(CameraModelType model);
+    static SensorImageLoader::Ptr Create(
+        CameraModelType model,
+        bool keepEncoded = false,
+        ImageStorageType storage = ImageStorageType::GREY_AND_COLOR);
 
     CameraFrame::Ptr UnpackFrame(const rosbag::MessageInstance &msgInstance) override;
 };
@@ -95,9 +109,14 @@ public:
     using Ptr = std::shared_ptr<SensorImageCompLoader>;
 
 public:
-    explicit SensorImageCompLoader(CameraModelType model);
-
-    static SensorImageCompLoader::Ptr Create(CameraModelType model);
+    explicit SensorImageCompLoader(CameraModelType model,
+                                   bool keepEncoded = false,
+                                   ImageStorageType storage = ImageStorageType::GREY_AND_COLOR);
+
+    static SensorImageCompLoader::Ptr Create(
+        CameraModelType model,
+        bool keepEncoded = false,
+        ImageStorageType storage = ImageStorageType::GREY_AND_COLOR);
 
     CameraFrame::Ptr UnpackFrame(const rosbag::MessageInstance &msgInstance) override;
 };
@@ -74,6 +74,9 @@ protected:
     }
 
     static void InverseMat(cv::Mat &floatMat);
+
+    // check the depth image, and convert it to a float one if it's not a native 16-bit one
+    void FormatDepthMat(cv::Mat &depthMat) const;
 };
 
 class DepthSensorImageLoader : public DepthDataLoader {
@@ -45,6 +45,88 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 
 namespace ns_ikalibr {
 
+/**
+ * a compact struct-of-arrays lidar scan. Positions are stored in separate float arrays, and the
+ * timestamp of each point is stored as a float offset to the base time of the scan, thus a point
+ * takes 16 bytes (rather than 32 bytes of 'IKalibrPoint'), and loops over points are
+ * vectorizable. Points are organized in row-major order (index: row * width + col), and invalid
+ * points are stored with NaN positions, as 'IKalibrPointCloud' does.
+ */
+class LiDARScan {
+public:
+    using Ptr = std::shared_ptr<LiDARScan>;
+
+private:
+    double _baseTime;
+    std::vector<float> _x, _y, _z;
+    // time offsets of points with respect to '_baseTime'
+    std::vector<float> _dt;
+
+    std::uint32_t _width, _height;
+    bool _isDense;
+
+public:
+    explicit LiDARScan(double baseTime = 0.0);
+
+    static LiDARScan::Ptr Create(double baseTime = 0.0);
+
+    // adapters for pcl clouds (array-of-structs ones), point data are copied
+    static LiDARScan::Ptr FromPCL(const IKalibrPointCloud &cloud, double baseTime);
+
+    [[nodiscard]] IKalibrPointCloud::Ptr ToPCL() const;
+
+    // resize as an organized scan, all points are set to invalid ones (NaN)
+    void Resize(std::uint32_t width, std::uint32_t height);
+
+    void Reserve(std::size_t size);
+
+    // append a point, the scan is treated as an unorganized one (height is one)
+    void PushBack(float x, float y, float z, double timestamp);
+
+    void SetPoint(std::size_t idx, float x, float y, float z, double timestamp);
+
+    [[nodiscard]] std::size_t Size() const;
+
+    [[nodiscard]] bool Empty() const;
+
+    [[nodiscard]] std::uint32_t GetWidth() const;
+
+    [[nodiscard]] std::uint32_t GetHeight() const;
+
+    [[nodiscard]] bool IsDense() const;
+
+    void SetDense(bool isDense);
+
+    [[nodiscard]] double GetBaseTime() const;
+
+    // shift timestamps of all points, only the base time is changed
+    void ShiftTime(double dt);
+
+    // transform all points in place, invalid (NaN) points stay invalid
+    void Transform(const Eigen::Matrix4f &trans);
+
+    [[nodiscard]] const std::vector<float> &GetX() const;
+
+    [[nodiscard]] const std::vector<float> &GetY() const;
+
+    [[nodiscard]] const std::vector<float> &GetZ() const;
+
+    [[nodiscard]] const std::vector<float> &GetTimeOffsets() const;
+
+    // mutable arrays, their sizes should be kept
+    std::vector<float> &GetX();
+
+    std::vector<float> &GetY();
+
+    std::vector<float> &GetZ();
+
+    std::vector<float> &GetTimeOffsets();
+
+    [[nodiscard]] double GetTimestamp(std::size_t idx) const;
+
+    [[nodiscard]] bool IsValid(std::size_t idx) const;
+};
+
 struct LiDARFrame {
 public:
     using Ptr = std::shared_ptr<LiDARFrame>;
@@ -52,22 +134,28 @@ public:
 private:
     // the timestamp of this lidar scan
     double _timestamp;
-    // the lidar scan [x, y, z, timestamp]
-    IKalibrPointCloud::Ptr _scan;
+    // the lidar scan [x, y, z, timestamp] in the compact layout
+    LiDARScan::Ptr _scan;
 
 public:
     // constructor
     explicit LiDARFrame(double timestamp = INVALID_TIME_STAMP,
-                        IKalibrPointCloud::Ptr scan = boost::make_shared<IKalibrPointCloud>());
+                        LiDARScan::Ptr scan = LiDARScan::Create());
 
     // creator
-    static LiDARFrame::Ptr Create(
-        double timestamp = INVALID_TIME_STAMP,
-        const IKalibrPointCloud::Ptr &scan = boost::make_shared<IKalibrPointCloud>());
+    static LiDARFrame::Ptr Create(double timestamp = INVALID_TIME_STAMP,
+                                  const LiDARScan::Ptr &scan = LiDARScan::Create());
+
+    // creator from the pcl cloud, which is converted to the compact layout
+    static LiDARFrame::Ptr Create(double timestamp, const IKalibrPointCloud::Ptr &scan);
 
     // access
+    // the scan as a pcl cloud, which is converted from the compact scan when called, thus
+    // modifications on it would not be reflected in this frame
     [[nodiscard]] IKalibrPointCloud::Ptr GetScan() const;
 
+    [[nodiscard]] const LiDARScan::Ptr &GetCompactScan() const;
+
     [[nodiscard]] double GetTimestamp() const;
 
     void SetTimestamp(double timestamp);
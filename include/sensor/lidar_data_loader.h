@@ -39,6 +39,7 @@
 #include "rosbag/message_instance.h"
 #include "util/enum_cast.hpp"
 #include "velodyne_msgs/VelodyneScan.h"
+#include "sensor_msgs/PointCloud2.h"
 #include "sensor/sensor_model.h"
 
 namespace {
@@ -74,6 +75,21 @@ protected:
                 "' for LiDARs! It's incompatible with the type of ros message to load in!");
         }
     }
+
+    /**
+     * parse the point cloud straight from the byte buffer of the 'sensor_msgs::PointCloud2'
+     * message into the compact scan, driven by the offsets of fields. Points that are invalid
+     * (NaN) or out of the range [minRange, maxRange] are dropped on the fly.
+     * @param timeField the name of the per-point time field, any numeric data type is accepted
+     * @param timeScale the factor scaling the time field to seconds
+     * @param absoluteTime whether the time field is absolute or relative to the header stamp
+     */
+    [[nodiscard]] LiDARFrame::Ptr ParsePointCloud2(const sensor_msgs::PointCloud2 &msg,
+                                                   const std::string &timeField,
+                                                   double timeScale,
+                                                   bool absoluteTime,
+                                                   float minRange,
+                                                   float maxRange) const;
 };
 
 class Velodyne16 : public LiDARDataLoader {
@@ -92,6 +108,12 @@ protected:
     [[nodiscard]] LiDARFrame::Ptr UnpackScan(
         const velodyne_msgs::VelodyneScan::ConstPtr &lidarMsg) const;
 
+    // decode a packet into its own columns of the scan, packets are independent of each other
+    void UnpackPacket(const velodyne_msgs::VelodynePacket &packet,
+                      int blockCounter,
+                      double scanTimestamp,
+                      LiDARScan &scan) const;
+
     [[nodiscard]] double GetExactTime(int dsr, int firing) const;
 
     void SetParameters();
@@ -124,6 +146,8 @@ private:
     float COS_VERT_ANGLE[16]{};
     float SIN_VERT_ANGLE[16]{};
     int SCAN_MAPPING_16[16]{};
+    // timing offsets [µs] of lasers in a block: 'dsr * DSR_TOFFSET + firing * FIRING_TOFFSET'
+    float FIRING_DSR_TOFFSET[2][16]{};
 
     typedef struct RawBlock {
         uint16_t header;    ///< UPPER_BANK or LOWER_BANK
@@ -156,7 +180,8 @@ private:
     } Config;
     Config CONFIG{};
 
-    double VLP16_TIME_BLOCK[1824][16]{};
+    static const int TIME_BLOCK_COLS = 1824;
+    double VLP16_TIME_BLOCK[TIME_BLOCK_COLS][16]{};
 };
 
 class VelodynePoints : public LiDARDataLoader {
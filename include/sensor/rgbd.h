@@ -51,6 +51,7 @@ public:
     using Ptr = std::shared_ptr<RGBDFrame>;
 
 protected:
+    // raw depth image, either a native 16-bit one (CV_16UC1) or a float one (CV_32FC1)
     cv::Mat _depthImg;
 
 public:
@@ -70,6 +71,9 @@ public:
 
     cv::Mat &GetDepthImage();
 
+    // the raw depth of the pixel, the depth image could be a native 16-bit or a float one
+    static float RawDepth(const cv::Mat &depthImg, int row, int col);
+
     // release the image mat data to save memory when needed
     void ReleaseMat() override;
 
@@ -86,6 +86,8 @@ class Viewer;
 using ViewerPtr = std::shared_ptr<Viewer>;
 class Estimator;
 using EstimatorPtr = std::shared_ptr<Estimator>;
+class PointToSurfelAssociator;
+using PointToSurfelAssociatorPtr = std::shared_ptr<PointToSurfelAssociator>;
 enum class OptOption : std::uint32_t;
 
 struct ImagesInfo {
@@ -129,9 +131,10 @@ public:
         using Ptr = std::shared_ptr<BackUp>;
 
     public:
-        // estimator
+        // the estimator shared by all batch optimizations (not a snapshot), residual groups and
+        // constancy of param blocks in it always reflect the latest batch optimization
         EstimatorPtr estimator;
-        // visual global scale
+        // visual global scale, which is shared as well and reset at each batch optimization
         std::shared_ptr<double> visualGlobalScale;
         // visual reprojection correspondences contains inverse depth parameters
         std::map<std::string, std::vector<VisualReProjCorrSeqPtr>> visualCorrs;
@@ -186,6 +189,14 @@ private:
     ViewerPtr _viewer;
     // storge results from optimization for by-products-related output
     BackUp::Ptr _backup;
+    // the estimator shared by multi-stage batch optimizations, where raw-measurement residuals are
+    // reused, and data-association residuals are renewed in each stage
+    EstimatorPtr _batchEstimator;
+    // the visual global scale involved in '_batchEstimator'
+    std::shared_ptr<double> _visualGlobalScale;
+    // the point-to-surfel associator shared by data associations of LiDARs in multi-stage batch
+    // optimizations, whose surfel maps are updated rather than built from scratch in each stage
+    PointToSurfelAssociatorPtr _lidarAssociator;
     // storge temporal results from initialization, which would be destroyed after initialization
     InitAsset::Ptr _initAsset;
     // indicates whether the solving is finished
@@ -356,7 +367,7 @@ protected:
     std::map<std::string, std::vector<PointToSurfelCorrPtr>> DataAssociationForLiDARs(
         const IKalibrPointCloudPtr &map,
         const std::map<std::string, std::vector<LiDARFramePtr>> &undistFrames,
-        int ptsCountInEachScan) const;
+        int ptsCountInEachScan);
 
     /**
      * perform data association for pos-derived cameras
@@ -394,7 +405,8 @@ protected:
         int ptsCountInEachScan) const;
 
     /**
-     * the final continuous-time-based batch optimization
+     * the final continuous-time-based batch optimization, the estimator is reused between calls,
+     * where only data-association residuals are renewed and the param constancy is reset
      * @param optOption the option for optimization, deciding which variable (state) would be
      * estimated
      * @param lidarPtsCorrs the point-to-surfel correspondences for LiDARs
@@ -411,7 +423,7 @@ protected:
         const std::map<std::string, std::vector<OpticalFlowCorrPtr>> &rgbdCorrs,
         const std::map<std::string, std::vector<OpticalFlowCorrPtr>> &visualVelCorrs,
         const std::optional<std::map<std::string, std::vector<PointToSurfelCorrPtr>>>
-            &rgbdPtsCorrs = std::nullopt) const;
+            &rgbdPtsCorrs = std::nullopt);
 
     /**
      * compute the pose of IMU in the global (world) coordinate frame
@@ -647,6 +659,19 @@ protected:
      */
     static bool IsRSCamera(const std::string &camTopic);
 
+    /**
+     * assemble the map from lidar frames expressed in the map frame. Valid points of frames are
+     * counted first, and then written concurrently into their disjoint ranges of the preallocated
+     * map
+     * @param frames the lidar frames expressed in the map frame, null ones are skipped
+     * @param leafSize the leaf size of the on-the-fly voxel hashing, points in a voxel are merged
+     * to their centroid, whose time stamp is NaN. Non-positive value means the full-resolution
+     * map is assembled
+     * @return the assembled map
+     */
+    static IKalibrPointCloudPtr AssembleLiDARMap(const std::vector<LiDARFramePtr> &frames,
+                                                 double leafSize);
+
     /**
      * save spatiotemporal calibration results to disk
      * @param par the spatiotemporal parameter manager
@@ -37,6 +37,7 @@
 
 #include "util/cereal_archive_helper.hpp"
 #include "ctraj/core/pose.hpp"
+#include "functional"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -72,6 +73,8 @@ protected:
 
     void SaveHessianMatrix() const;
 
+    void SaveSpatTempCovariance() const;
+
     void VerifyVisualLiDARConsistency() const;
 
     void SaveVisualKinematics() const;
@@ -89,6 +92,10 @@ protected:
     void SaveLiDARPointToSurfelError() const;
 
 protected:
+    // calls 'involver(address, name)' for extrinsics, time offsets and rs readout times
+    void InvolveSpatTempParameters(
+        const std::function<void(double *, const std::string &)> &involver) const;
+
     static bool SavePoseSequence(const Eigen::aligned_vector<ns_ctraj::Posed> &poseSeq,
                                  const std::string &filename,
                                  CerealArchiveType::Enum archiveType);
@@ -63,9 +63,8 @@ void CalibSolver::AddAcceFactor(Estimator::Ptr &estimator,
                                 Estimator::Opt option) const {
     double weight = Configor::DataStream::IMUTopics.at(imuTopic).AcceWeight;
 
-    for (const auto &item : _dataMagr->GetIMUMeasurements(imuTopic)) {
-        estimator->AddIMUAcceMeasurement<type>(item, imuTopic, option, weight);
-    }
+    estimator->AddIMUAcceMeasurements<type>(_dataMagr->GetIMUMeasurements(imuTopic), imuTopic,
+                                            option, weight);
 }
 
 template <TimeDeriv::ScaleSplineType type>
@@ -75,10 +74,7 @@ void CalibSolver::AddLiDARPointToSurfelFactor(Estimator::Ptr &estimator,
                                               Estimator::Opt option) {
     double weight = Configor::DataStream::LiDARTopics.at(lidarTopic).Weight;
 
-    for (const auto &corr : corrs) {
-        estimator->AddLiDARPointTiSurfelConstraint<type>(corr, lidarTopic, option,
-                                                         weight * corr->weight);
-    }
+    estimator->AddLiDARPointToSurfelConstraints<type>(corrs, lidarTopic, option, weight);
 }
 
 template <TimeDeriv::ScaleSplineType type>
@@ -88,10 +84,7 @@ void CalibSolver::AddRGBDPointToSurfelFactor(Estimator::Ptr &estimator,
                                              Estimator::Opt option) {
     double weight = Configor::DataStream::RGBDTopics.at(rgbdTopic).Weight;
 
-    for (const auto &corr : corrs) {
-        estimator->AddRGBDPointTiSurfelConstraint<type>(corr, rgbdTopic, option,
-                                                        weight * corr->weight);
-    }
+    estimator->AddRGBDPointToSurfelConstraints<type>(corrs, rgbdTopic, option, weight);
 }
 
 template <TimeDeriv::ScaleSplineType type>
@@ -102,12 +95,7 @@ void CalibSolver::AddVisualReprojectionFactor(Estimator::Ptr &estimator,
                                               Estimator::Opt option) {
     double weight = Configor::DataStream::CameraTopics.at(camTopic).Weight;
 
-    for (const auto &corr : corrs) {
-        for (const auto &c : corr->corrs) {
-            estimator->AddVisualReprojection<type>(
-                c, camTopic, globalScale, corr->invDepthFir.get(), option, weight * c->weight);
-        }
-    }
+    estimator->AddVisualReprojections<type>(corrs, camTopic, globalScale, option, weight);
 }
 
 template <TimeDeriv::ScaleSplineType type, bool IsInvDepth>
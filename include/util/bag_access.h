@@ -0,0 +1,85 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_BAG_ACCESS_H
+#define IKALIBR_BAG_ACCESS_H
+
+#include "util/utils.h"
+#include "rosbag/message_instance.h"
+#include "ros/serialization.h"
+#include "boost/make_shared.hpp"
+#include "mutex"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+struct BagAccess {
+public:
+    /**
+     * 'rosbag::Bag' is not thread-safe: reading a message reads (and possibly decompresses) the
+     * chunk it lives in using internal buffers of the bag. When messages are unpacked by multiple
+     * threads, all reads from the bag should be serialized by this mutex.
+     */
+    static std::mutex &Mutex();
+
+    /**
+     * instantiate the message from the bag. Only copying its serialized bytes out of the bag is
+     * locked, the deserialization (and decoding by callers) runs concurrently. A null pointer is
+     * returned if the message is not of 'MsgType', the same as 'rosbag::MessageInstance'
+     */
+    template <class MsgType>
+    static boost::shared_ptr<MsgType> Instantiate(const rosbag::MessageInstance &msgInstance) {
+        if (!msgInstance.isType<MsgType>()) {
+            return nullptr;
+        }
+        std::vector<std::uint8_t> buffer;
+        {
+            std::lock_guard<std::mutex> lock(Mutex());
+            buffer.resize(msgInstance.size());
+            ros::serialization::OStream stream(buffer.data(), buffer.size());
+            msgInstance.write(stream);
+        }
+        auto msg = boost::make_shared<MsgType>();
+        ros::serialization::IStream stream(buffer.data(), buffer.size());
+        ros::serialization::deserialize(stream, *msg);
+        return msg;
+    }
+};
+
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_BAG_ACCESS_H
@@ -142,6 +142,27 @@ static inline CerealArchiveType::OutputArchiveVariant GetOutputArchiveVariant(
     }
 }
 
+/**
+ * serializes a name-value pair that is optional in text archives: when it's missing in the loaded
+ * one (e.g., a configuration file written before the field is introduced), the value is set to
+ * 'defaultValue'. Binary archives are not named, thus the field is always required in them
+ */
+template <class Archive, class Type, class DefaultType>
+static inline void OptionalNVP(Archive &ar,
+                               const char *name,
+                               Type &value,
+                               const DefaultType &defaultValue) {
+    if constexpr (Archive::is_loading::value && cereal::traits::is_text_archive<Archive>::value) {
+        try {
+            ar(cereal::make_nvp(name, value));
+        } catch (const cereal::Exception &) {
+            value = defaultValue;
+        }
+    } else {
+        ar(cereal::make_nvp(name, value));
+    }
+}
+
 template <class... Types>
 static inline void SerializeByInputArchiveVariant(const CerealArchiveType::InputArchiveVariant &ar,
                                                   CerealArchiveType::Enum archiveType,
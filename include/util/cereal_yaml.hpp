@@ -355,16 +355,18 @@ private:
         //! Adjust our position such that we are at the node with the given name
         /*! @throws Exception if no such named node exists */
         inline void search(const char *searchName) {
-            auto index = 0;
             const auto len = std::strlen(searchName);
-            for (itsItCurrent = itsItBegin; itsItCurrent != itsItEnd; ++itsItCurrent, ++index) {
-                currentName = itsItCurrent->first.as<std::string>();
-                if ((std::strncmp(searchName, currentName.c_str(), len) == 0) &&
-                    (std::strlen(currentName.c_str()) == len)) {
+            for (auto it = itsItBegin; it != itsItEnd; ++it) {
+                auto name = it->first.as<std::string>();
+                if ((std::strncmp(searchName, name.c_str(), len) == 0) &&
+                    (std::strlen(name.c_str()) == len)) {
+                    itsItCurrent = it;
+                    currentName = name;
                     return;
                 }
             }
 
+            // the position is kept, so that loading could go on if the missing NVP is optional
             throw Exception("YAML Parsing failed - provided NVP (" + std::string(searchName) +
                             ") not found");
         }
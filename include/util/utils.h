@@ -237,6 +237,14 @@ Eigen::Vector3d RotMatToYPR(const Eigen::Matrix3d &R);
 
 double NormalizeAngle(double ang_degree);
 
+// the spatial hash of integer grid coordinates (e.g., indices of voxels)
+std::size_t SpatialHash(std::int64_t ix, std::int64_t iy, std::int64_t iz);
+
+// the hasher of integer grid coordinates for unordered containers, see 'SpatialHash'
+struct SpatialHasher {
+    std::size_t operator()(const Eigen::Vector3i &key) const;
+};
+
 template <typename Derived>
 Eigen::Matrix<typename Derived::Scalar, 3, 3> SkewSymmetric(const Eigen::MatrixBase<Derived> &v3d);
 
@@ -107,11 +107,11 @@ public:
 
     Viewer &PopBackEntity(const std::string &view);
 
-    Viewer &AddSurfelMap(const ufo::map::SurfelMap &smp,
+    Viewer &AddSurfelMap(const std::vector<std::shared_ptr<ufo::map::SurfelMap>> &smps,
                          const PointToSurfelCondition &condition,
                          const std::string &view);
 
-    Viewer &AddPointToSurfel(const ufo::map::SurfelMap &smp,
+    Viewer &AddPointToSurfel(const std::vector<std::shared_ptr<ufo::map::SurfelMap>> &smps,
                              const std::map<std::string, std::vector<PointToSurfelCorrPtr>> &corrs,
                              const std::string &view);
 
@@ -56,11 +56,12 @@ line_width = 1.5
 
 
 def recovery_mat(data, row, col):
-    mat = [[] for elem in range(row)]
-    idx = 0
-    for v in data.values():
-        mat[idx % col].append(v)
-        idx += 1
+    # the hessian matrix is stored sparsely, i.e., non-zeros of its upper triangle in triplets
+    mat = [[0.0 for j in range(col)] for i in range(row)]
+    for r, c, v in zip(data['row_indices'], data['col_indices'], data['values']):
+        mat[r][c] = v
+        if data['upper_triangle']:
+            mat[c][r] = v
     return mat
 
 
@@ -68,13 +69,12 @@ if __name__ == '__main__':
     data = get_array_fields(filename, [])
     rows = data['row']
     cols = data['col']
-    HMat = data['hessian']
     order_size_raw = data['par_order_size']
     order_size = []
     for elem in order_size_raw:
         order_size.append([elem['first'], elem['second']])
 
-    hessian = recovery_mat(HMat, rows, cols)
+    hessian = recovery_mat(data, rows, cols)
     for i in range(len(hessian)):
         for j in range(len(hessian[i])):
             val = hessian[i][j]
@@ -0,0 +1,238 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "calib/calib_data_cache.h"
+#include "calib/calib_data_io.hpp"
+#include "config/configor.h"
+#include "util/status.hpp"
+#include "spdlog/spdlog.h"
+#include "filesystem"
+#include "fstream"
+#include "sstream"
+#include "fcntl.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "unistd.h"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+const std::string CalibDataCache::MAGIC = "IKALIBR-DATA-CACHE";
+const std::uint32_t CalibDataCache::VERSION = 5;
+
+CalibDataCache::CalibDataCache(const std::string &cacheDir)
+    : _descriptor(CacheDescriptor()),
+      _mapAddr(nullptr),
+      _mapSize(0) {
+    _filename = fmt::format("{}/{:016x}.cache", cacheDir, std::hash<std::string>{}(_descriptor));
+}
+
+CalibDataCache::Ptr CalibDataCache::Create(const std::string &cacheDir) {
+    return std::make_shared<CalibDataCache>(cacheDir);
+}
+
+CalibDataCache::~CalibDataCache() { Unmap(); }
+
+const std::string &CalibDataCache::GetFilename() const { return _filename; }
+
+std::string CalibDataCache::CacheDescriptor() {
+    const auto &bagPath = Configor::DataStream::BagPath;
+    std::stringstream stream;
+    stream << fmt::format("bag: '{}', size: {}, mtime: {}\n",
+                          std::filesystem::canonical(bagPath).string(),
+                          std::filesystem::file_size(bagPath),
+                          std::filesystem::last_write_time(bagPath).time_since_epoch().count());
+    for (const auto &[topic, config] : Configor::DataStream::IMUTopics) {
+        stream << fmt::format("imu: '{}', type: '{}'\n", topic, config.Type);
+    }
+    for (const auto &[topic, config] : Configor::DataStream::RadarTopics) {
+        stream << fmt::format("radar: '{}', type: '{}'\n", topic, config.Type);
+    }
+    for (const auto &[topic, config] : Configor::DataStream::LiDARTopics) {
+        stream << fmt::format("lidar: '{}', type: '{}'\n", topic, config.Type);
+    }
+    for (const auto &[topic, config] : Configor::DataStream::CameraTopics) {
+        stream << fmt::format("camera: '{}', type: '{}'\n", topic, config.Type);
+    }
+    for (const auto &[topic, config] : Configor::DataStream::RGBDTopics) {
+        // the sign of the depth factor determines whether depth images are inverted when decoding
+        stream << fmt::format("rgbd: '{}', type: '{}', depth: '{}', inverse depth: {}\n", topic,
+                              config.Type, config.DepthTopic, config.DepthFactor < 0.0);
+    }
+    stream << fmt::format("begin time: {:.9f}, duration: {:.9f}\n", Configor::DataStream::BeginTime,
+                          Configor::DataStream::Duration);
+    stream << fmt::format("keep images encoded: {}, image storage: '{}'\n",
+                          Configor::Preference::KeepImagesEncoded,
+                          Configor::Preference::ImageStorage);
+    return stream.str();
+}
+
+bool CalibDataCache::Load(TopicMes<std::vector<IMUFrame::Ptr>> &imuMes,
+                          TopicMes<std::vector<RadarTargetArray::Ptr>> &radarMes,
+                          TopicMes<std::vector<LiDARFrame::Ptr>> &lidarMes,
+                          TopicMes<std::vector<CameraFrame::Ptr>> &camMes,
+                          TopicMes<std::list<CameraFrame::Ptr>> &rgbdColorMes,
+                          TopicMes<std::list<DepthFrame::Ptr>> &rgbdDepthMes) {
+    if (!std::filesystem::exists(_filename)) {
+        spdlog::info("data cache '{}' dose not exist, data would be loaded from the ros bag.",
+                     _filename);
+        return false;
+    }
+    Unmap();
+
+    int fd = open(_filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        spdlog::warn("open data cache '{}' failed!", _filename);
+        return false;
+    }
+    struct stat fileStat {};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        close(fd);
+        spdlog::warn("stat data cache '{}' failed!", _filename);
+        return false;
+    }
+    // private mapping, writes to the mapped images (if any) are copy-on-write
+    void *addr = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        spdlog::warn("map data cache '{}' failed!", _filename);
+        return false;
+    }
+    _mapAddr = addr, _mapSize = static_cast<std::size_t>(fileStat.st_size);
+
+    TopicMes<std::vector<IMUFrame::Ptr>> imuMesTemp;
+    TopicMes<std::vector<RadarTargetArray::Ptr>> radarMesTemp;
+    TopicMes<std::vector<LiDARFrame::Ptr>> lidarMesTemp;
+    TopicMes<std::vector<CameraFrame::Ptr>> camMesTemp;
+    TopicMes<std::list<CameraFrame::Ptr>> rgbdColorMesTemp;
+    TopicMes<std::list<DepthFrame::Ptr>> rgbdDepthMesTemp;
+
+    BinaryDataReader reader{static_cast<const char *>(_mapAddr), _mapSize, 0};
+    try {
+        if (reader.ReadString() != MAGIC || reader.Read<std::uint32_t>() != VERSION ||
+            reader.ReadString() != _descriptor) {
+            throw Status(Status::WARNING, "the data cache file is outdated!");
+        }
+        reader.Read(imuMesTemp, [&reader]() { return reader.ReadIMUFrame(); });
+        reader.Read(radarMesTemp, [&reader]() { return reader.ReadRadarTargetArray(); });
+        reader.Read(lidarMesTemp, [&reader]() { return reader.ReadLiDARFrame(); });
+        reader.Read(camMesTemp, [&reader]() { return reader.ReadCameraFrame(); });
+        reader.Read(rgbdColorMesTemp, [&reader]() { return reader.ReadCameraFrame(); });
+        reader.Read(rgbdDepthMesTemp, [&reader]() { return reader.ReadDepthFrame(); });
+        if (reader.ReadString() != MAGIC) {
+            throw Status(Status::WARNING, "the data cache file is truncated or broken!");
+        }
+    } catch (const IKalibrStatus &status) {
+        spdlog::warn("load data cache '{}' failed: {}", _filename, status.what);
+        Unmap();
+        return false;
+    } catch (const std::exception &e) {
+        // e.g., 'cv::Exception' or 'std::bad_alloc' when rebuilding frames from broken records
+        spdlog::warn("load data cache '{}' failed: {}", _filename, e.what());
+        Unmap();
+        return false;
+    } catch (...) {
+        spdlog::warn("load data cache '{}' failed: unknown error", _filename);
+        Unmap();
+        return false;
+    }
+
+    imuMes = std::move(imuMesTemp);
+    radarMes = std::move(radarMesTemp);
+    lidarMes = std::move(lidarMesTemp);
+    camMes = std::move(camMesTemp);
+    rgbdColorMes = std::move(rgbdColorMesTemp);
+    rgbdDepthMes = std::move(rgbdDepthMesTemp);
+
+    spdlog::info("calibration data are loaded from data cache '{}'.", _filename);
+    return true;
+}
+
+bool CalibDataCache::Save(const TopicMes<std::vector<IMUFrame::Ptr>> &imuMes,
+                          const TopicMes<std::vector<RadarTargetArray::Ptr>> &radarMes,
+                          const TopicMes<std::vector<LiDARFrame::Ptr>> &lidarMes,
+                          const TopicMes<std::vector<CameraFrame::Ptr>> &camMes,
+                          const TopicMes<std::list<CameraFrame::Ptr>> &rgbdColorMes,
+                          const TopicMes<std::list<DepthFrame::Ptr>> &rgbdDepthMes) const {
+    auto cacheDir = std::filesystem::path(_filename).parent_path();
+    if (!std::filesystem::exists(cacheDir) && !std::filesystem::create_directories(cacheDir)) {
+        spdlog::warn("create data cache directory '{}' failed!", cacheDir.string());
+        return false;
+    }
+    spdlog::info("saving calibration data to data cache '{}'...", _filename);
+
+    // write to a temporary file first, an interrupted saving would not leave a broken cache
+    const std::string tmpFilename = _filename + ".tmp";
+    std::ofstream file(tmpFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        spdlog::warn("open data cache '{}' failed!", tmpFilename);
+        return false;
+    }
+    BinaryDataWriter writer{file};
+    writer.Write(MAGIC);
+    writer.Write(VERSION);
+    writer.Write(_descriptor);
+
+    auto WriteMes = [&writer](const auto &mes) { writer.WriteMes(mes); };
+    writer.Write(imuMes, WriteMes);
+    writer.Write(radarMes, WriteMes);
+    writer.Write(lidarMes, WriteMes);
+    writer.Write(camMes, WriteMes);
+    writer.Write(rgbdColorMes, WriteMes);
+    writer.Write(rgbdDepthMes, WriteMes);
+    writer.Write(MAGIC);
+    file.close();
+
+    if (!file) {
+        spdlog::warn("write data cache '{}' failed!", tmpFilename);
+        std::filesystem::remove(tmpFilename);
+        return false;
+    }
+    std::filesystem::rename(tmpFilename, _filename);
+    spdlog::info("calibration data are saved to data cache '{}'.", _filename);
+    return true;
+}
+
+void CalibDataCache::Unmap() {
+    if (_mapAddr != nullptr) {
+        munmap(_mapAddr, _mapSize);
+        _mapAddr = nullptr, _mapSize = 0;
+    }
+}
+
+}  // namespace ns_ikalibr
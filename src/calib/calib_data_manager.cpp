@@ -33,6 +33,8 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "calib/calib_data_manager.h"
+#include "calib/calib_data_cache.h"
+#include "calib/calib_dataset.h"
 #include "core/optical_flow_trace.h"
 #include "opencv4/opencv2/imgcodecs.hpp"
 #include "rosbag/view.h"
@@ -61,153 +63,30 @@ CalibDataManager::Ptr CalibDataManager::Create() { return std::make_shared<Calib
 void CalibDataManager::LoadCalibData() {
     spdlog::info("loading calibration data...");
 
-    // open the ros bag
-    auto bag = std::make_unique<rosbag::Bag>();
-    if (!std::filesystem::exists(Configor::DataStream::BagPath)) {
-        spdlog::error("the ros bag path '{}' is invalid!", Configor::DataStream::BagPath);
-    } else {
-        bag->open(Configor::DataStream::BagPath, rosbag::BagMode::Read);
-    }
-
-    auto view = rosbag::View();
-
-    // using a temp view to check the time range of the source ros bag
-    auto viewTemp = rosbag::View();
-
-    std::vector<std::string> topicsToQuery;
-    // add topics to vector
-    for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
-        topicsToQuery.push_back(topic);
-    }
-    for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
-        topicsToQuery.push_back(topic);
-    }
-    for (const auto &[topic, _] : Configor::DataStream::LiDARTopics) {
-        topicsToQuery.push_back(topic);
-    }
-    for (const auto &[topic, _] : Configor::DataStream::CameraTopics) {
-        topicsToQuery.push_back(topic);
-    }
-    for (const auto &[topic, info] : Configor::DataStream::RGBDTopics) {
-        topicsToQuery.push_back(topic);
-        topicsToQuery.push_back(info.DepthTopic);
-    }
-
-    viewTemp.addQuery(*bag, rosbag::TopicQuery(topicsToQuery));
-    auto begTime = viewTemp.getBeginTime();
-    auto endTime = viewTemp.getEndTime();
-    spdlog::info("source data duration: from '{:.5f}' to '{:.5f}'.", begTime.toSec(),
-                 endTime.toSec());
-
-    // adjust the data time range
-    if (Configor::DataStream::BeginTime > 0.0) {
-        begTime += ros::Duration(Configor::DataStream::BeginTime);
-        if (begTime > endTime) {
-            spdlog::warn(
-                "begin time '{:.5f}' is out of the bag's data range, set begin time to '{:.5f}'.",
-                begTime.toSec(), viewTemp.getBeginTime().toSec());
-            begTime = viewTemp.getBeginTime();
-        }
-    }
-    if (Configor::DataStream::Duration > 0.0) {
-        endTime = begTime + ros::Duration(Configor::DataStream::Duration);
-        if (endTime > viewTemp.getEndTime()) {
-            spdlog::warn(
-                "end time '{:.5f}' is out of the bag's data range, set end time to '{:.5f}'.",
-                endTime.toSec(), viewTemp.getEndTime().toSec());
-            endTime = viewTemp.getEndTime();
-        }
-    }
-    spdlog::info("expect data duration: from '{:.5f}' to '{:.5f}'.", begTime.toSec(),
-                 endTime.toSec());
-
-    view.addQuery(*bag, rosbag::TopicQuery(topicsToQuery), begTime, endTime);
-
-    // create IMU data loader
-    std::map<std::string, IMUDataLoader::Ptr> imuDataLoaders;
-    std::map<std::string, RadarDataLoader::Ptr> radarDataLoaders;
-    std::map<std::string, LiDARDataLoader::Ptr> lidarDataLoaders;
-    std::map<std::string, CameraDataLoader::Ptr> cameraDataLoaders;
-    // for rgbd cameras
-    std::map<std::string, CameraDataLoader::Ptr> rgbdColorDataLoaders;
-    std::map<std::string, DepthDataLoader::Ptr> rgbdDepthDataLoaders;
     // temporal data containers ('list' containers)
     std::map<std::string, std::list<CameraFrame::Ptr>> rgbdColorMesTemp;
     std::map<std::string, std::list<DepthFrame::Ptr>> rgbdDepthMesTemp;
 
-    // get type enum from the string
-    for (const auto &[topic, config] : Configor::DataStream::IMUTopics) {
-        imuDataLoaders.insert({topic, IMUDataLoader::GetLoader(config.Type)});
-    }
-    for (const auto &[topic, config] : Configor::DataStream::RadarTopics) {
-        radarDataLoaders.insert({topic, RadarDataLoader::GetLoader(config.Type)});
-    }
-    for (const auto &[topic, config] : Configor::DataStream::LiDARTopics) {
-        lidarDataLoaders.insert({topic, LiDARDataLoader::GetLoader(config.Type)});
-    }
-    for (const auto &[topic, config] : Configor::DataStream::CameraTopics) {
-        cameraDataLoaders.insert({topic, CameraDataLoader::GetLoader(config.Type)});
-    }
-    for (const auto &[topic, config] : Configor::DataStream::RGBDTopics) {
-        rgbdColorDataLoaders.insert({topic, CameraDataLoader::GetLoader(config.Type)});
-        bool isInverse = config.DepthFactor < 0.0f;
-        rgbdDepthDataLoaders.insert(
-            {config.DepthTopic, DepthDataLoader::GetLoader(config.Type, isInverse)});
-    }
-
-    // read raw data
-    auto bar = std::make_shared<tqdm>();
-    int idx = 0;
-    for (auto iter = view.begin(); iter != view.end(); ++iter, ++idx) {
-        bar->progress(idx, static_cast<int>(view.size()));
-        const auto &item = *iter;
-        const std::string &topic = item.getTopic();
-        if (imuDataLoaders.cend() != imuDataLoaders.find(topic)) {
-            // is an inertial frame
-            auto mes = imuDataLoaders.at(topic)->UnpackFrame(item);
-            if (mes != nullptr) {
-                _imuMes[topic].push_back(mes);
-            }
-        } else if (radarDataLoaders.cend() != radarDataLoaders.find(topic)) {
-            // is a radar frame
-            auto mes = radarDataLoaders.at(topic)->UnpackScan(item);
-            if (mes != nullptr) {
-                _radarMes[topic].push_back(mes);
-            }
-        } else if (lidarDataLoaders.cend() != lidarDataLoaders.find(topic)) {
-            // is a lidar frame
-            auto mes = lidarDataLoaders.at(topic)->UnpackScan(item);
-            if (mes != nullptr) {
-                _lidarMes[topic].push_back(mes);
-            }
-        } else if (rgbdColorDataLoaders.cend() != rgbdColorDataLoaders.find(topic)) {
-            // is a rgbd color frame
-            auto mes = rgbdColorDataLoaders.at(topic)->UnpackFrame(item);
-            if (mes != nullptr) {
-                // id: uint64_t from timestamp (raw, millisecond)
-                mes->SetId(static_cast<ns_veta::IndexT>(mes->GetTimestamp() * 1E3));
-                rgbdColorMesTemp[topic].push_back(mes);
-            }
-        } else if (rgbdDepthDataLoaders.cend() != rgbdDepthDataLoaders.find(topic)) {
-            // is a rgbd depth frame
-            auto mes = rgbdDepthDataLoaders.at(topic)->UnpackFrame(item);
-            if (mes != nullptr) {
-                // id: uint64_t from timestamp (raw, millisecond)
-                mes->SetId(static_cast<ns_veta::IndexT>(mes->GetTimestamp() * 1E3));
-                rgbdDepthMesTemp[topic].push_back(mes);
-            }
-        } else if (cameraDataLoaders.cend() != cameraDataLoaders.find(topic)) {
-            // is a camera frame
-            auto mes = cameraDataLoaders.at(topic)->UnpackFrame(item);
-            if (mes != nullptr) {
-                // id: uint64_t from timestamp (raw, millisecond)
-                mes->SetId(static_cast<ns_veta::IndexT>(mes->GetTimestamp() * 1E3));
-                _camMes[topic].push_back(mes);
+    if (!Configor::DataStream::DatasetPath.empty()) {
+        // the native dataset is given, the ros bag (and the data cache) is not involved
+        _dataset = CalibDataset::Create(Configor::DataStream::DatasetPath);
+        _dataset->Load(_imuMes, _radarMes, _lidarMes, _camMes, rgbdColorMesTemp,
+                       rgbdDepthMesTemp);
+    } else {
+        // try to load decoded measurements from the data cache first
+        if (!Configor::Preference::DataCachePath.empty() &&
+            std::filesystem::exists(Configor::DataStream::BagPath)) {
+            _dataCache = CalibDataCache::Create(Configor::Preference::DataCachePath);
+        }
+        if (_dataCache == nullptr || !_dataCache->Load(_imuMes, _radarMes, _lidarMes, _camMes,
+                                                       rgbdColorMesTemp, rgbdDepthMesTemp)) {
+            ReadCalibDataFromBag(rgbdColorMesTemp, rgbdDepthMesTemp);
+            if (_dataCache != nullptr) {
+                _dataCache->Save(_imuMes, _radarMes, _lidarMes, _camMes, rgbdColorMesTemp,
+                                 rgbdDepthMesTemp);
             }
         }
     }
-    bar->finish();
-    bag->close();
 
     for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
         CheckTopicExists(topic, _imuMes);
@@ -233,9 +112,10 @@ void CalibDataManager::LoadCalibData() {
     // convenience), they are still fused separately in batch optimizations (a tightly-coupled
     // optimization framework)
     std::map<std::string, std::vector<RadarTargetArray::Ptr>> oldRadarMes = _radarMes;
-    for (const auto &[topic, loader] : radarDataLoaders) {
-        if (loader->GetRadarModel() == RadarModelType::AWR1843BOOST_RAW ||
-            loader->GetRadarModel() == RadarModelType::AWR1843BOOST_CUSTOM) {
+    for (const auto &[topic, config] : Configor::DataStream::RadarTopics) {
+        auto radarModel = RadarDataLoader::GetLoader(config.Type)->GetRadarModel();
+        if (radarModel == RadarModelType::AWR1843BOOST_RAW ||
+            radarModel == RadarModelType::AWR1843BOOST_CUSTOM) {
             const auto &mes = oldRadarMes.at(topic);
             std::vector<RadarTarget::Ptr> targets;
             std::vector<RadarTargetArray::Ptr> arrays;
@@ -261,29 +141,43 @@ void CalibDataManager::LoadCalibData() {
 
     // match color and depth images for rgbd cameras
     // 'rgbdColorMesTemp' + 'rgbdDepthMesTemp' -->  '_rgbdMes'
-    for (const auto &[colorTopic, colorFrames] : rgbdColorMesTemp) {
-        auto depthTopic = Configor::DataStream::RGBDTopics.at(colorTopic).DepthTopic;
+    // both sequences are sorted by timestamp first (whatever source they are loaded from), thus a
+    // linear merge join is performed. 'std::list::sort' is stable, equal stamps keep their order
+    auto TimeLess = [](const auto &m1, const auto &m2) {
+        return m1->GetTimestamp() < m2->GetTimestamp();
+    };
+    for (auto &[colorTopic, colorFrames] : rgbdColorMesTemp) {
+        const auto &config = Configor::DataStream::RGBDTopics.at(colorTopic);
+        const auto &depthTopic = config.DepthTopic;
+        const double tolerance = config.DepthSyncTolerance;
         auto &curRGBDMes = _rgbdMes[colorTopic];
         auto &depthImgs = rgbdDepthMesTemp.at(depthTopic);
+        colorFrames.sort(TimeLess);
+        depthImgs.sort(TimeLess);
+        auto depthIter = depthImgs.cbegin();
+        std::size_t droppedDepthCount = 0;
         for (const auto &colorFrame : colorFrames) {
             const double timestamp = colorFrame->GetTimestamp();
-            // find a matched depth image for current color image
+            // depth images that are too early can not be matched by this or later color images
+            while (depthIter != depthImgs.cend() &&
+                   (*depthIter)->GetTimestamp() <= timestamp - tolerance) {
+                ++depthIter, ++droppedDepthCount;
+            }
             // the matched depth and color images should be close enough to each other in time
             // domain
-            auto iter = std::find_if(
-                depthImgs.begin(), depthImgs.end(), [timestamp](const DepthFrame::Ptr &depthFrame) {
-                    // time distance: 0.001 s, i.e., 1 ms
-                    return std::abs(depthFrame->GetTimestamp() - timestamp) < 1E-3;
-                });
-            if (iter != depthImgs.cend()) {
-                curRGBDMes.push_back(RGBDFrame::Create(timestamp,                    // timestamp
-                                                       colorFrame->GetImage(),       // grey image
-                                                       colorFrame->GetColorImage(),  // color image
-                                                       (*iter)->GetDepthImage(),     // depth image
-                                                       colorFrame->GetId()           // image index
-                                                       ));
-                // remove this depth image
-                depthImgs.erase(iter);
+            if (depthIter != depthImgs.cend() &&
+                std::abs((*depthIter)->GetTimestamp() - timestamp) < tolerance) {
+                auto rgbdFrame = RGBDFrame::Create(timestamp,                      // timestamp
+                                                   cv::Mat(),                      // grey image
+                                                   cv::Mat(),                      // color image
+                                                   (*depthIter)->GetDepthImage(),  // depth image
+                                                   colorFrame->GetId()             // image index
+                );
+                // share the stored (maybe encoded) images, nothing is decoded or derived here
+                rgbdFrame->ShareStoredImages(*colorFrame);
+                curRGBDMes.push_back(rgbdFrame);
+                // this depth image is consumed
+                ++depthIter;
             } else {
                 spdlog::warn(
                     "can not find a matched depth image from '{}' for color image from '{}' at "
@@ -291,6 +185,12 @@ void CalibDataManager::LoadCalibData() {
                     depthTopic, colorTopic, timestamp);
             }
         }
+        droppedDepthCount += static_cast<std::size_t>(std::distance(depthIter, depthImgs.cend()));
+        spdlog::info(
+            "rgbd '{}': '{}' frames matched (tolerance: {:.5f} s), '{}' color images and '{}' "
+            "depth images dropped.",
+            colorTopic, curRGBDMes.size(), tolerance, colorFrames.size() - curRGBDMes.size(),
+            droppedDepthCount);
     }
     rgbdColorMesTemp.clear(), rgbdDepthMesTemp.clear();
     for (const auto &[topic, info] : Configor::DataStream::RGBDTopics) {
@@ -334,6 +234,233 @@ void CalibDataManager::LoadCalibData() {
     }
 }
 
+void CalibDataManager::SaveAsDataset(const std::string &filename, double chunkDuration) {
+    std::map<std::string, std::list<CameraFrame::Ptr>> rgbdColorMesTemp;
+    std::map<std::string, std::list<DepthFrame::Ptr>> rgbdDepthMesTemp;
+    ReadCalibDataFromBag(rgbdColorMesTemp, rgbdDepthMesTemp);
+    CalibDataset::Write(filename, _imuMes, _radarMes, _lidarMes, _camMes, rgbdColorMesTemp,
+                        rgbdDepthMesTemp, chunkDuration);
+}
+
+void CalibDataManager::ReadCalibDataFromBag(
+    std::map<std::string, std::list<CameraFrame::Ptr>> &rgbdColorMesTemp,
+    std::map<std::string, std::list<DepthFrame::Ptr>> &rgbdDepthMesTemp) {
+    // open the ros bag
+    auto bag = std::make_unique<rosbag::Bag>();
+    if (!std::filesystem::exists(Configor::DataStream::BagPath)) {
+        spdlog::error("the ros bag path '{}' is invalid!", Configor::DataStream::BagPath);
+    } else {
+        bag->open(Configor::DataStream::BagPath, rosbag::BagMode::Read);
+    }
+
+    auto view = rosbag::View();
+
+    // using a temp view to check the time range of the source ros bag
+    auto viewTemp = rosbag::View();
+
+    std::vector<std::string> topicsToQuery;
+    // add topics to vector
+    for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
+        topicsToQuery.push_back(topic);
+    }
+    for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
+        topicsToQuery.push_back(topic);
+    }
+    for (const auto &[topic, _] : Configor::DataStream::LiDARTopics) {
+        topicsToQuery.push_back(topic);
+    }
+    for (const auto &[topic, _] : Configor::DataStream::CameraTopics) {
+        topicsToQuery.push_back(topic);
+    }
+    for (const auto &[topic, info] : Configor::DataStream::RGBDTopics) {
+        topicsToQuery.push_back(topic);
+        topicsToQuery.push_back(info.DepthTopic);
+    }
+
+    viewTemp.addQuery(*bag, rosbag::TopicQuery(topicsToQuery));
+    auto begTime = viewTemp.getBeginTime();
+    auto endTime = viewTemp.getEndTime();
+    spdlog::info("source data duration: from '{:.5f}' to '{:.5f}'.", begTime.toSec(),
+                 endTime.toSec());
+
+    // adjust the data time range
+    if (Configor::DataStream::BeginTime > 0.0) {
+        begTime += ros::Duration(Configor::DataStream::BeginTime);
+        if (begTime > endTime) {
+            spdlog::warn(
+                "begin time '{:.5f}' is out of the bag's data range, set begin time to '{:.5f}'.",
+                begTime.toSec(), viewTemp.getBeginTime().toSec());
+            begTime = viewTemp.getBeginTime();
+        }
+    }
+    if (Configor::DataStream::Duration > 0.0) {
+        endTime = begTime + ros::Duration(Configor::DataStream::Duration);
+        if (endTime > viewTemp.getEndTime()) {
+            spdlog::warn(
+                "end time '{:.5f}' is out of the bag's data range, set end time to '{:.5f}'.",
+                endTime.toSec(), viewTemp.getEndTime().toSec());
+            endTime = viewTemp.getEndTime();
+        }
+    }
+    spdlog::info("expect data duration: from '{:.5f}' to '{:.5f}'.", begTime.toSec(),
+                 endTime.toSec());
+
+    view.addQuery(*bag, rosbag::TopicQuery(topicsToQuery), begTime, endTime);
+
+    // create IMU data loader
+    std::map<std::string, IMUDataLoader::Ptr> imuDataLoaders;
+    std::map<std::string, RadarDataLoader::Ptr> radarDataLoaders;
+    std::map<std::string, LiDARDataLoader::Ptr> lidarDataLoaders;
+    std::map<std::string, CameraDataLoader::Ptr> cameraDataLoaders;
+    // for rgbd cameras
+    std::map<std::string, CameraDataLoader::Ptr> rgbdColorDataLoaders;
+    std::map<std::string, DepthDataLoader::Ptr> rgbdDepthDataLoaders;
+
+    // get type enum from the string
+    for (const auto &[topic, config] : Configor::DataStream::IMUTopics) {
+        imuDataLoaders.insert({topic, IMUDataLoader::GetLoader(config.Type)});
+    }
+    for (const auto &[topic, config] : Configor::DataStream::RadarTopics) {
+        radarDataLoaders.insert({topic, RadarDataLoader::GetLoader(config.Type)});
+    }
+    for (const auto &[topic, config] : Configor::DataStream::LiDARTopics) {
+        lidarDataLoaders.insert({topic, LiDARDataLoader::GetLoader(config.Type)});
+    }
+    for (const auto &[topic, config] : Configor::DataStream::CameraTopics) {
+        cameraDataLoaders.insert({topic, CameraDataLoader::GetLoader(config.Type)});
+    }
+    for (const auto &[topic, config] : Configor::DataStream::RGBDTopics) {
+        rgbdColorDataLoaders.insert({topic, CameraDataLoader::GetLoader(config.Type)});
+        bool isInverse = config.DepthFactor < 0.0f;
+        rgbdDepthDataLoaders.insert(
+            {config.DepthTopic, DepthDataLoader::GetLoader(config.Type, isInverse)});
+    }
+
+    /**
+     * read raw data in a pipelined manner:
+     * (1) the reader stage traverses the view in bag order (index only, no message is read here)
+     *     and groups the message instances into per-topic batches;
+     * (2) batches are unpacked by a pool of decode workers, where copying the serialized bytes
+     *     out of the bag is serialized (see 'BagAccess'), while deserialization and decoding
+     *     (jpeg, velodyne packets, pcl conversions, ...) run in parallel;
+     * (3) decoded measurements are gathered topic by topic in timestamp order.
+     * as each measurement is written to its own slot, the output is deterministic.
+     */
+    std::map<std::string, std::vector<rosbag::MessageInstance>> mesInstances;
+    // topic, index of the first message instance, index of the last message instance (excluded)
+    std::vector<std::tuple<std::string, std::size_t, std::size_t>> batches;
+    for (const auto &item : view) {
+        auto &instances = mesInstances[item.getTopic()];
+        instances.push_back(item);
+        if (instances.size() % DecodeBatchSize == 0) {
+            batches.emplace_back(item.getTopic(), instances.size() - DecodeBatchSize,
+                                 instances.size());
+        }
+    }
+    for (const auto &[topic, instances] : mesInstances) {
+        if (auto rest = instances.size() % DecodeBatchSize; rest != 0) {
+            batches.emplace_back(topic, instances.size() - rest, instances.size());
+        }
+    }
+
+    // slots for decoded measurements, one for each message instance
+    std::map<std::string, std::vector<IMUFrame::Ptr>> imuMesSlots;
+    std::map<std::string, std::vector<RadarTargetArray::Ptr>> radarMesSlots;
+    std::map<std::string, std::vector<LiDARFrame::Ptr>> lidarMesSlots;
+    std::map<std::string, std::vector<CameraFrame::Ptr>> cameraMesSlots;
+    std::map<std::string, std::vector<CameraFrame::Ptr>> rgbdColorMesSlots;
+    std::map<std::string, std::vector<DepthFrame::Ptr>> rgbdDepthMesSlots;
+    for (const auto &[topic, instances] : mesInstances) {
+        if (imuDataLoaders.count(topic) != 0) {
+            imuMesSlots[topic].resize(instances.size());
+        } else if (radarDataLoaders.count(topic) != 0) {
+            radarMesSlots[topic].resize(instances.size());
+        } else if (lidarDataLoaders.count(topic) != 0) {
+            lidarMesSlots[topic].resize(instances.size());
+        } else if (rgbdColorDataLoaders.count(topic) != 0) {
+            rgbdColorMesSlots[topic].resize(instances.size());
+        } else if (rgbdDepthDataLoaders.count(topic) != 0) {
+            rgbdDepthMesSlots[topic].resize(instances.size());
+        } else if (cameraDataLoaders.count(topic) != 0) {
+            cameraMesSlots[topic].resize(instances.size());
+        }
+    }
+
+    auto DecodeBatch = [&](const std::string &topic, std::size_t sIdx, std::size_t eIdx) {
+        const auto &instances = mesInstances.at(topic);
+        for (std::size_t i = sIdx; i < eIdx; ++i) {
+            const auto &item = instances.at(i);
+            if (imuDataLoaders.cend() != imuDataLoaders.find(topic)) {
+                // is an inertial frame
+                imuMesSlots.at(topic).at(i) = imuDataLoaders.at(topic)->UnpackFrame(item);
+            } else if (radarDataLoaders.cend() != radarDataLoaders.find(topic)) {
+                // is a radar frame
+                radarMesSlots.at(topic).at(i) = radarDataLoaders.at(topic)->UnpackScan(item);
+            } else if (lidarDataLoaders.cend() != lidarDataLoaders.find(topic)) {
+                // is a lidar frame
+                lidarMesSlots.at(topic).at(i) = lidarDataLoaders.at(topic)->UnpackScan(item);
+            } else if (rgbdColorDataLoaders.cend() != rgbdColorDataLoaders.find(topic)) {
+                // is a rgbd color frame
+                auto mes = rgbdColorDataLoaders.at(topic)->UnpackFrame(item);
+                if (mes != nullptr) {
+                    // id: uint64_t from timestamp (raw, millisecond)
+                    mes->SetId(static_cast<ns_veta::IndexT>(mes->GetTimestamp() * 1E3));
+                }
+                rgbdColorMesSlots.at(topic).at(i) = mes;
+            } else if (rgbdDepthDataLoaders.cend() != rgbdDepthDataLoaders.find(topic)) {
+                // is a rgbd depth frame
+                auto mes = rgbdDepthDataLoaders.at(topic)->UnpackFrame(item);
+                if (mes != nullptr) {
+                    // id: uint64_t from timestamp (raw, millisecond)
+                    mes->SetId(static_cast<ns_veta::IndexT>(mes->GetTimestamp() * 1E3));
+                }
+                rgbdDepthMesSlots.at(topic).at(i) = mes;
+            } else if (cameraDataLoaders.cend() != cameraDataLoaders.find(topic)) {
+                // is a camera frame
+                auto mes = cameraDataLoaders.at(topic)->UnpackFrame(item);
+                if (mes != nullptr) {
+                    // id: uint64_t from timestamp (raw, millisecond)
+                    mes->SetId(static_cast<ns_veta::IndexT>(mes->GetTimestamp() * 1E3));
+                }
+                cameraMesSlots.at(topic).at(i) = mes;
+            }
+        }
+    };
+
+    // exceptions can not be thrown out of the parallel region, they are kept and rethrown later
+    std::vector<std::exception_ptr> batchExceptions(batches.size(), nullptr);
+    auto bar = std::make_shared<tqdm>();
+    int finishedBatchCount = 0;
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) schedule(dynamic) \
+    default(none) shared(batches, batchExceptions, bar, finishedBatchCount, DecodeBatch)
+    for (int i = 0; i < static_cast<int>(batches.size()); ++i) {
+        const auto &[topic, sIdx, eIdx] = batches.at(i);
+        try {
+            DecodeBatch(topic, sIdx, eIdx);
+        } catch (...) {
+            batchExceptions.at(i) = std::current_exception();
+        }
+#pragma omp critical
+        { bar->progress(finishedBatchCount++, static_cast<int>(batches.size())); }
+    }
+    bar->finish();
+    bag->close();
+
+    for (const auto &exception : batchExceptions) {
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    // gather decoded measurements
+    GatherDecodedMes(imuMesSlots, _imuMes);
+    GatherDecodedMes(radarMesSlots, _radarMes);
+    GatherDecodedMes(lidarMesSlots, _lidarMes);
+    GatherDecodedMes(cameraMesSlots, _camMes);
+    GatherDecodedMes(rgbdColorMesSlots, rgbdColorMesTemp);
+    GatherDecodedMes(rgbdDepthMesSlots, rgbdDepthMesTemp);
+}
+
 void CalibDataManager::AdjustCalibDataSequence() {
     spdlog::info("adjust calibration data sequence...");
 
@@ -590,9 +717,8 @@ void CalibDataManager::AlignTimestamp() {
     for (const auto &[topic, data] : _lidarMes) {
         for (const auto &item : data) {
             item->SetTimestamp(item->GetTimestamp() - _rawStartTimestamp);
-            for (auto &p : *item->GetScan()) {
-                p.timestamp -= _rawStartTimestamp;
-            }
+            // only the base time of the compact scan is shifted
+            item->GetCompactScan()->ShiftTime(-_rawStartTimestamp);
         }
     }
     for (auto &[camTopic, mes] : _camMes) {
@@ -0,0 +1,363 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "calib/calib_dataset.h"
+#include "calib/calib_data_io.hpp"
+#include "config/configor.h"
+#include "util/status.hpp"
+#include "spdlog/spdlog.h"
+#include "filesystem"
+#include "fstream"
+#include "fcntl.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "unistd.h"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+const std::string CalibDataset::MAGIC = "IKALIBR-DATASET";
+const std::uint32_t CalibDataset::VERSION = 1;
+
+CalibDataset::CalibDataset(std::string filename)
+    : _filename(std::move(filename)),
+      _mapAddr(nullptr),
+      _mapSize(0) {
+    int fd = open(_filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw Status(Status::ERROR, "open dataset '{}' failed!", _filename);
+    }
+    struct stat fileStat {};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        close(fd);
+        throw Status(Status::ERROR, "stat dataset '{}' failed!", _filename);
+    }
+    // private mapping, writes to the mapped images (if any) are copy-on-write
+    void *addr = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw Status(Status::ERROR, "map dataset '{}' failed!", _filename);
+    }
+    _mapAddr = addr, _mapSize = static_cast<std::size_t>(fileStat.st_size);
+
+    // read the index only, measurements are read when loaded
+    BinaryDataReader reader{static_cast<const char *>(_mapAddr), _mapSize, 0};
+    try {
+        if (reader.ReadString() != MAGIC || reader.Read<std::uint32_t>() != VERSION) {
+            throw Status(Status::ERROR,
+                         "it's not an iKalibr dataset of version '{}', please convert the ros bag "
+                         "again!",
+                         VERSION);
+        }
+        reader.pos = reader.Read<std::uint64_t>();
+        _decodeDescriptor = reader.ReadString();
+        auto topicCount = reader.Read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < topicCount; ++i) {
+            auto &topicIndex = _index[reader.ReadString()];
+            topicIndex.kind = static_cast<MesKind>(reader.Read<std::uint8_t>());
+            topicIndex.type = reader.ReadString();
+            auto chunkCount = reader.Read<std::uint64_t>();
+            reader.Require(chunkCount * sizeof(ChunkIndex));
+            topicIndex.chunks.resize(chunkCount);
+            reader.ReadArray(topicIndex.chunks);
+        }
+        if (reader.ReadString() != MAGIC) {
+            throw Status(Status::ERROR, "the dataset file is truncated or broken!");
+        }
+    } catch (const IKalibrStatus &status) {
+        Unmap();
+        throw Status(Status::ERROR, "load dataset '{}' failed: {}", _filename, status.what);
+    }
+    spdlog::info("dataset '{}' is opened, '{}' topics are indexed.", _filename, _index.size());
+}
+
+CalibDataset::Ptr CalibDataset::Create(const std::string &filename) {
+    return std::make_shared<CalibDataset>(filename);
+}
+
+CalibDataset::~CalibDataset() { Unmap(); }
+
+const std::string &CalibDataset::GetFilename() const { return _filename; }
+
+const std::map<std::string, CalibDataset::TopicIndex> &CalibDataset::GetIndex() const {
+    return _index;
+}
+
+std::string CalibDataset::DecodeDescriptor() {
+    return fmt::format("keep images encoded: {}, image storage: '{}'",
+                       Configor::Preference::KeepImagesEncoded, Configor::Preference::ImageStorage);
+}
+
+std::map<std::string, std::pair<CalibDataset::MesKind, std::string>>
+CalibDataset::ConfiguredTopics() {
+    std::map<std::string, std::pair<MesKind, std::string>> topics;
+    for (const auto &[topic, config] : Configor::DataStream::IMUTopics) {
+        topics[topic] = {MesKind::IMU, config.Type};
+    }
+    for (const auto &[topic, config] : Configor::DataStream::RadarTopics) {
+        topics[topic] = {MesKind::RADAR, config.Type};
+    }
+    for (const auto &[topic, config] : Configor::DataStream::LiDARTopics) {
+        topics[topic] = {MesKind::LIDAR, config.Type};
+    }
+    for (const auto &[topic, config] : Configor::DataStream::CameraTopics) {
+        topics[topic] = {MesKind::CAMERA, config.Type};
+    }
+    for (const auto &[topic, config] : Configor::DataStream::RGBDTopics) {
+        topics[topic] = {MesKind::RGBD_COLOR, config.Type};
+        // the sign of the depth factor determines whether depth images are inverted when decoding
+        topics[config.DepthTopic] = {
+            MesKind::RGBD_DEPTH,
+            fmt::format("{}, inverse depth: {}", config.Type, config.DepthFactor < 0.0)};
+    }
+    return topics;
+}
+
+template <typename MesSeqType, typename ReadFunc>
+void CalibDataset::LoadTopic(const std::string &topic,
+                             double sTime,
+                             double eTime,
+                             MesSeqType &mesSeq,
+                             ReadFunc readMes) const {
+    const auto &chunks = _index.at(topic).chunks;
+    // chunks are in time order, find the first one that may contain measurements after 'sTime'
+    auto iter = std::lower_bound(
+        chunks.cbegin(), chunks.cend(), sTime,
+        [](const ChunkIndex &chunk, double t) { return chunk.eTime < t; });
+    for (; iter != chunks.cend() && iter->sTime <= eTime; ++iter) {
+        BinaryDataReader reader{static_cast<const char *>(_mapAddr), _mapSize, iter->offset};
+        for (std::uint64_t i = 0; i < iter->count; ++i) {
+            auto mes = readMes(reader);
+            // only chunks at both ends of the time piece contain measurements out of it
+            if (mes->GetTimestamp() >= sTime && mes->GetTimestamp() <= eTime) {
+                mesSeq.push_back(mes);
+            }
+        }
+    }
+}
+
+void CalibDataset::Load(TopicMes<std::vector<IMUFrame::Ptr>> &imuMes,
+                        TopicMes<std::vector<RadarTargetArray::Ptr>> &radarMes,
+                        TopicMes<std::vector<LiDARFrame::Ptr>> &lidarMes,
+                        TopicMes<std::vector<CameraFrame::Ptr>> &camMes,
+                        TopicMes<std::list<CameraFrame::Ptr>> &rgbdColorMes,
+                        TopicMes<std::list<DepthFrame::Ptr>> &rgbdDepthMes) const {
+    if (_decodeDescriptor != DecodeDescriptor()) {
+        spdlog::warn(
+            "dataset '{}' is converted with preferences '{}', which are different from the current "
+            "ones '{}', images would be loaded as they are converted.",
+            _filename, _decodeDescriptor, DecodeDescriptor());
+    }
+
+    // check the topics and compute the time range of their data, as 'rosbag::View' does
+    const auto topics = ConfiguredTopics();
+    double begTime = std::numeric_limits<double>::max();
+    double endTime = std::numeric_limits<double>::lowest();
+    for (const auto &[topic, kindType] : topics) {
+        auto iter = _index.find(topic);
+        if (iter == _index.cend()) {
+            // topics that do not exist are reported later
+            continue;
+        }
+        const auto &topicIndex = iter->second;
+        if (topicIndex.kind != kindType.first || topicIndex.type != kindType.second) {
+            throw Status(Status::ERROR,
+                         "topic '{}' in dataset '{}' is decoded as '{}', while '{}' is configured, "
+                         "please convert the ros bag again!",
+                         topic, _filename, topicIndex.type, kindType.second);
+        }
+        if (!topicIndex.chunks.empty()) {
+            begTime = std::min(begTime, topicIndex.chunks.front().sTime);
+            endTime = std::max(endTime, topicIndex.chunks.back().eTime);
+        }
+    }
+    spdlog::info("source data duration: from '{:.5f}' to '{:.5f}'.", begTime, endTime);
+
+    // adjust the data time range
+    const double srcBegTime = begTime, srcEndTime = endTime;
+    if (Configor::DataStream::BeginTime > 0.0) {
+        begTime += Configor::DataStream::BeginTime;
+        if (begTime > endTime) {
+            spdlog::warn(
+                "begin time '{:.5f}' is out of the dataset's data range, set begin time to "
+                "'{:.5f}'.",
+                begTime, srcBegTime);
+            begTime = srcBegTime;
+        }
+    }
+    if (Configor::DataStream::Duration > 0.0) {
+        endTime = begTime + Configor::DataStream::Duration;
+        if (endTime > srcEndTime) {
+            spdlog::warn(
+                "end time '{:.5f}' is out of the dataset's data range, set end time to '{:.5f}'.",
+                endTime, srcEndTime);
+            endTime = srcEndTime;
+        }
+    }
+    spdlog::info("expect data duration: from '{:.5f}' to '{:.5f}'.", begTime, endTime);
+
+    for (const auto &[topic, kindType] : topics) {
+        if (_index.count(topic) == 0) {
+            continue;
+        }
+        switch (kindType.first) {
+            case MesKind::IMU:
+                LoadTopic(topic, begTime, endTime, imuMes[topic],
+                          [](BinaryDataReader &reader) { return reader.ReadIMUFrame(); });
+                break;
+            case MesKind::RADAR:
+                LoadTopic(topic, begTime, endTime, radarMes[topic],
+                          [](BinaryDataReader &reader) { return reader.ReadRadarTargetArray(); });
+                break;
+            case MesKind::LIDAR:
+                LoadTopic(topic, begTime, endTime, lidarMes[topic],
+                          [](BinaryDataReader &reader) { return reader.ReadLiDARFrame(); });
+                break;
+            case MesKind::CAMERA:
+                LoadTopic(topic, begTime, endTime, camMes[topic],
+                          [](BinaryDataReader &reader) { return reader.ReadCameraFrame(); });
+                break;
+            case MesKind::RGBD_COLOR:
+                LoadTopic(topic, begTime, endTime, rgbdColorMes[topic],
+                          [](BinaryDataReader &reader) { return reader.ReadCameraFrame(); });
+                break;
+            case MesKind::RGBD_DEPTH:
+                LoadTopic(topic, begTime, endTime, rgbdDepthMes[topic],
+                          [](BinaryDataReader &reader) { return reader.ReadDepthFrame(); });
+                break;
+        }
+    }
+    spdlog::info("calibration data are loaded from dataset '{}'.", _filename);
+}
+
+void CalibDataset::Write(const std::string &filename,
+                         const TopicMes<std::vector<IMUFrame::Ptr>> &imuMes,
+                         const TopicMes<std::vector<RadarTargetArray::Ptr>> &radarMes,
+                         const TopicMes<std::vector<LiDARFrame::Ptr>> &lidarMes,
+                         const TopicMes<std::vector<CameraFrame::Ptr>> &camMes,
+                         const TopicMes<std::list<CameraFrame::Ptr>> &rgbdColorMes,
+                         const TopicMes<std::list<DepthFrame::Ptr>> &rgbdDepthMes,
+                         double chunkDuration) {
+    auto datasetDir = std::filesystem::path(filename).parent_path();
+    if (!datasetDir.empty() && !std::filesystem::exists(datasetDir) &&
+        !std::filesystem::create_directories(datasetDir)) {
+        throw Status(Status::ERROR, "create dataset directory '{}' failed!", datasetDir.string());
+    }
+    spdlog::info("writing calibration data to dataset '{}'...", filename);
+
+    // write to a temporary file first, an interrupted writing would not leave a broken dataset
+    const std::string tmpFilename = filename + ".tmp";
+    std::ofstream file(tmpFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw Status(Status::ERROR, "open dataset '{}' failed!", tmpFilename);
+    }
+    BinaryDataWriter writer{file};
+    writer.Write(MAGIC);
+    writer.Write(VERSION);
+    // the offset of the index, which is written when the index is ready
+    const auto indexOffsetPos = file.tellp();
+    writer.Write(static_cast<std::uint64_t>(0));
+
+    const auto topics = ConfiguredTopics();
+    std::map<std::string, TopicIndex> index;
+    auto WriteTopics = [&](const auto &topicMes) {
+        for (const auto &[topic, mesSeq] : topicMes) {
+            auto &topicIndex = index[topic];
+            std::tie(topicIndex.kind, topicIndex.type) = topics.at(topic);
+
+            // measurements are written in time order, so that chunks are in time order as well
+            std::vector<typename std::decay_t<decltype(mesSeq)>::value_type> sortedMes(
+                mesSeq.cbegin(), mesSeq.cend());
+            std::stable_sort(sortedMes.begin(), sortedMes.end(),
+                             [](const auto &m1, const auto &m2) {
+                                 return m1->GetTimestamp() < m2->GetTimestamp();
+                             });
+            for (const auto &mes : sortedMes) {
+                const double t = mes->GetTimestamp();
+                if (topicIndex.chunks.empty() ||
+                    t - topicIndex.chunks.back().sTime >= chunkDuration) {
+                    topicIndex.chunks.push_back(
+                        {t, t, static_cast<std::uint64_t>(file.tellp()), 0});
+                }
+                writer.WriteMes(mes);
+                auto &chunk = topicIndex.chunks.back();
+                chunk.eTime = t, ++chunk.count;
+            }
+        }
+    };
+    WriteTopics(imuMes);
+    WriteTopics(radarMes);
+    WriteTopics(lidarMes);
+    WriteTopics(camMes);
+    WriteTopics(rgbdColorMes);
+    WriteTopics(rgbdDepthMes);
+
+    // the index
+    const auto indexOffset = static_cast<std::uint64_t>(file.tellp());
+    writer.Write(DecodeDescriptor());
+    writer.Write(static_cast<std::uint64_t>(index.size()));
+    for (const auto &[topic, topicIndex] : index) {
+        writer.Write(topic);
+        writer.Write(static_cast<std::uint8_t>(topicIndex.kind));
+        writer.Write(topicIndex.type);
+        writer.Write(static_cast<std::uint64_t>(topicIndex.chunks.size()));
+        writer.WriteArray(topicIndex.chunks);
+        spdlog::info("topic '{}' of type '{}' is written, chunks: {}", topic, topicIndex.type,
+                     topicIndex.chunks.size());
+    }
+    writer.Write(MAGIC);
+    file.seekp(indexOffsetPos);
+    writer.Write(indexOffset);
+    file.close();
+
+    if (!file) {
+        std::filesystem::remove(tmpFilename);
+        throw Status(Status::ERROR, "write dataset '{}' failed!", tmpFilename);
+    }
+    std::filesystem::rename(tmpFilename, filename);
+    spdlog::info("calibration data are written to dataset '{}'.", filename);
+}
+
+void CalibDataset::Unmap() {
+    if (_mapAddr != nullptr) {
+        munmap(_mapAddr, _mapSize);
+        _mapAddr = nullptr, _mapSize = 0;
+    }
+}
+
+}  // namespace ns_ikalibr
@@ -37,6 +37,8 @@
 #include "ctraj/core/trajectory_estimator.h"
 #include "factor/hand_eye_rot_align_factor.hpp"
 #include "factor/imu_gyro_factor.hpp"
+#include "factor/batched_factor.hpp"
+#include "factor/data_correspondence.h"
 #include "factor/inertial_align_factor.hpp"
 #include "factor/lidar_inertial_align_factor.hpp"
 #include "factor/linear_knots_factor.hpp"
@@ -52,6 +54,7 @@
 #include "factor/visual_velocity_depth_factor.hpp"
 #include "util/utils_tpl.hpp"
 #include "factor/vel_visual_inertial_align_factor.hpp"
+#include "chrono"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -65,7 +68,11 @@ std::shared_ptr<ceres::SphereManifold<3>> Estimator::GRAVITY_MANIFOLD(
     new ceres::SphereManifold<3>());
 
 ceres::Problem::Options Estimator::DefaultProblemOptions() {
-    return ns_ctraj::TrajectoryEstimator<Configor::Prior::SplineOrder>::DefaultProblemOptions();
+    auto defaultProblemOptions =
+        ns_ctraj::TrajectoryEstimator<Configor::Prior::SplineOrder>::DefaultProblemOptions();
+    // residual groups (and landmarks) are removed from the estimator between batch optimizations
+    defaultProblemOptions.enable_fast_removal = true;
+    return defaultProblemOptions;
 }
 
 ceres::Solver::Options Estimator::DefaultSolverOptions(int threadNum, bool toStdout, bool useCUDA) {
@@ -73,7 +80,20 @@ ceres::Solver::Options Estimator::DefaultSolverOptions(int threadNum, bool toStd
         ns_ctraj::TrajectoryEstimator<Configor::Prior::SplineOrder>::DefaultSolverOptions(
             threadNum, toStdout, useCUDA);
     if (!useCUDA) {
+        // 'DENSE_SCHUR' is used if the linear solver is not configured (e.g., in tools)
         defaultSolverOptions.linear_solver_type = ceres::DENSE_SCHUR;
+        if (!Configor::Preference::LinearSolver.empty() &&
+            !ceres::StringToLinearSolverType(Configor::Preference::LinearSolver,
+                                             &defaultSolverOptions.linear_solver_type)) {
+            throw Status(Status::ERROR, "unsupported linear solver '{}'!",
+                         Configor::Preference::LinearSolver);
+        }
+        if (!Configor::Preference::Preconditioner.empty() &&
+            !ceres::StringToPreconditionerType(Configor::Preference::Preconditioner,
+                                               &defaultSolverOptions.preconditioner_type)) {
+            throw Status(Status::ERROR, "unsupported preconditioner '{}'!",
+                         Configor::Preference::Preconditioner);
+        }
     }
     defaultSolverOptions.trust_region_strategy_type = ceres::DOGLEG;
     return defaultSolverOptions;
@@ -92,13 +112,288 @@ Estimator::Ptr Estimator::Create(const SplineBundleType::Ptr &splines,
 ceres::Solver::Summary Estimator::Solve(const ceres::Solver::Options &options,
                                         const SpatialTemporalPriori::Ptr &priori) {
     if (priori != nullptr) {
-        priori->AddSpatTempPrioriConstraint(*this, *parMagr);
+        // the estimator may be solved more than once, priori constraints should not be duplicated
+        const std::string prioriGroup = "SPAT_TEMP_PRIORI";
+        this->RemoveResidualGroup(prioriGroup);
+        this->AddResidualGroup(prioriGroup,
+                               [&]() { priori->AddSpatTempPrioriConstraint(*this, *parMagr); });
     }
     ceres::Solver::Summary summary;
-    ceres::Solve(options, this, &summary);
+    if (ceres::IsSchurType(options.linear_solver_type) &&
+        options.linear_solver_ordering == nullptr) {
+        // eliminate landmark depths first rather than letting ceres find an independent set,
+        // which may pick spline knots and lead to a much larger reduced system
+        auto optionsWithOrdering = options;
+        optionsWithOrdering.linear_solver_ordering = LandmarkFirstOrdering();
+        ceres::Solve(optionsWithOrdering, this, &summary);
+    } else {
+        ceres::Solve(options, this, &summary);
+    }
     return summary;
 }
 
+std::shared_ptr<ceres::ParameterBlockOrdering> Estimator::LandmarkFirstOrdering() const {
+    std::vector<double *> paramBlocks;
+    this->GetParameterBlocks(&paramBlocks);
+
+    auto ordering = std::make_shared<ceres::ParameterBlockOrdering>();
+    bool landmarkInvolved = false;
+    for (double *param : paramBlocks) {
+        if (landmarkParams.count(param) != 0) {
+            ordering->AddElementToGroup(param, 0);
+            landmarkInvolved = true;
+        } else {
+            ordering->AddElementToGroup(param, 1);
+        }
+    }
+    return landmarkInvolved ? ordering : nullptr;
+}
+
+ceres::ResidualBlockId Estimator::AddResidualBlockToProblem(
+    ceres::CostFunction *costFunc,
+    ceres::LossFunction *lossFunc,
+    const std::vector<double *> &paramBlocks) {
+    auto id = this->AddResidualBlock(costFunc, lossFunc, paramBlocks);
+    if (curResidualGroup != nullptr) {
+        curResidualGroup->push_back(id);
+    }
+    return id;
+}
+
+std::vector<Estimator::PendingResidual> Estimator::CreateResidualsInParallel(
+    std::size_t count, const std::function<void(int, PendingResidual &)> &creator) {
+    std::vector<PendingResidual> residuals(count);
+
+    // exceptions can not be thrown out of the parallel region, they are kept and rethrown later
+    std::vector<std::exception_ptr> exceptions(count, nullptr);
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) \
+    schedule(dynamic, 64) default(none) shared(count, residuals, exceptions, creator)
+    for (int i = 0; i < static_cast<int>(count); ++i) {
+        try {
+            creator(i, residuals.at(i));
+        } catch (...) {
+            exceptions.at(i) = std::current_exception();
+        }
+    }
+
+    for (const auto &exception : exceptions) {
+        if (exception != nullptr) {
+            // nothing has been passed to the problem, release created functions before rethrowing
+            for (auto &residual : residuals) {
+                delete residual.costFunc, delete residual.lossFunc;
+            }
+            std::rethrow_exception(exception);
+        }
+    }
+    return residuals;
+}
+
+void Estimator::AddPendingResidualsInBatches(std::vector<PendingResidual> &residuals,
+                                             const PendingAdder &adder) {
+    std::vector<std::unique_ptr<ceres::CostFunction>> batch;
+    std::vector<std::unique_ptr<ceres::LossFunction>> lossFuncs;
+    const PendingResidual *batchFront = nullptr;
+
+    auto AddBatch = [&]() {
+        if (batch.size() == 1) {
+            // a single residual is added as it is, together with its loss function
+            adder(batch.front().release(), lossFuncs.front().release(), batchFront->so3Meta,
+                  batchFront->scaleMeta);
+        } else if (batch.size() > 1) {
+            // losses are applied to each residual by the batched factor
+            using Batched = BatchedFactor<ceres::CostFunction>;
+            adder(Batched::Create(std::move(batch), std::move(lossFuncs)), nullptr,
+                  batchFront->so3Meta, batchFront->scaleMeta);
+        }
+        batch.clear(), lossFuncs.clear();
+    };
+
+    for (auto &res : residuals) {
+        if (res.costFunc == nullptr) {
+            continue;
+        }
+        if (!batch.empty() && (!InvolveSameKnots(res.so3Meta, batchFront->so3Meta) ||
+                               !InvolveSameKnots(res.scaleMeta, batchFront->scaleMeta))) {
+            AddBatch();
+        }
+        if (batch.empty()) {
+            batchFront = &res;
+        }
+        batch.emplace_back(res.costFunc), lossFuncs.emplace_back(res.lossFunc);
+        // the ownership is taken
+        res.costFunc = nullptr, res.lossFunc = nullptr;
+    }
+    AddBatch();
+}
+
+std::vector<PointToSurfelCorrPtr> Estimator::SortedByTimestamp(
+    const std::vector<PointToSurfelCorrPtr> &corrs) {
+    std::vector<PointToSurfelCorrPtr> sortedCorrs = corrs;
+    std::stable_sort(sortedCorrs.begin(), sortedCorrs.end(),
+                     [](const PointToSurfelCorrPtr &c1, const PointToSurfelCorrPtr &c2) {
+                         return c1->timestamp < c2->timestamp;
+                     });
+    return sortedCorrs;
+}
+
+bool Estimator::InvolveSameKnots(const SplineMetaType &m1, const SplineMetaType &m2) {
+    if (m1.segments.size() != m2.segments.size()) {
+        return false;
+    }
+    for (int i = 0; i < static_cast<int>(m1.segments.size()); ++i) {
+        const auto &s1 = m1.segments.at(i), &s2 = m2.segments.at(i);
+        if (s1.t0 != s2.t0 || s1.NumParameters() != s2.NumParameters()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Estimator::AddResidualGroup(const std::string &name, const std::function<void()> &adder) {
+    if (curResidualGroup != nullptr) {
+        throw Status(Status::CRITICAL, "residual group '{}' can not be nested in another group!",
+                     name);
+    }
+    // residual blocks are appended if this group exists
+    curResidualGroup = &residualGroups[name];
+    const std::size_t lastCount = curResidualGroup->size();
+    const auto startTime = std::chrono::steady_clock::now();
+    try {
+        adder();
+    } catch (...) {
+        curResidualGroup = nullptr;
+        throw;
+    }
+    // the construction cost, which is dominated by creating cost functions of measurements
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    spdlog::info("residual group '{}': {} blocks added in {:.3f} s using {} threads", name,
+                 curResidualGroup->size() - lastCount, elapsed.count(),
+                 Configor::Preference::AvailableThreads());
+    curResidualGroup = nullptr;
+}
+
+bool Estimator::HasResidualGroup(const std::string &name) const {
+    return residualGroups.count(name) != 0;
+}
+
+std::vector<std::string> Estimator::GetResidualGroupNames() const {
+    std::vector<std::string> names;
+    names.reserve(residualGroups.size());
+    for (const auto &[name, _] : residualGroups) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+void Estimator::RemoveResidualGroup(const std::string &name) {
+    auto iter = residualGroups.find(name);
+    if (iter == residualGroups.end()) {
+        return;
+    }
+    std::unordered_set<double *> landmarks;
+    std::vector<double *> paramBlocks;
+    for (const auto &id : iter->second) {
+        this->GetParameterBlocksForResidualBlock(id, &paramBlocks);
+        for (double *param : paramBlocks) {
+            if (landmarkParams.count(param) != 0) {
+                landmarks.insert(param);
+            }
+        }
+        this->RemoveResidualBlock(id);
+    }
+    residualGroups.erase(iter);
+
+    // landmarks are owned by data associations, which may be deconstructed once their residual
+    // blocks are removed, a dangling param block should not be left in the problem
+    std::vector<ceres::ResidualBlockId> residualBlocks;
+    for (double *param : landmarks) {
+        this->GetResidualBlocksForParameterBlock(param, &residualBlocks);
+        if (residualBlocks.empty()) {
+            this->RemoveParameterBlock(param);
+            landmarkParams.erase(param);
+        }
+    }
+}
+
+void Estimator::ResetParamBlocksConstancy(Opt option) {
+    std::vector<double *> paramBlocks;
+    this->GetParameterBlocks(&paramBlocks);
+    for (double *param : paramBlocks) {
+        this->SetParameterBlockVariable(param);
+    }
+
+    auto SetConstancy = [this](double *param, bool optimized) {
+        if (!optimized && this->HasParameterBlock(param)) {
+            this->SetParameterBlockConstant(param);
+        }
+    };
+    auto SetTemporalConstancy = [this](double *param, bool optimized) {
+        if (!this->HasParameterBlock(param)) {
+            return;
+        }
+        if (!optimized) {
+            this->SetParameterBlockConstant(param);
+        } else {
+            // set bound
+            this->SetParameterLowerBound(param, 0, -Configor::Prior::TimeOffsetPadding);
+            this->SetParameterUpperBound(param, 0, Configor::Prior::TimeOffsetPadding);
+        }
+    };
+
+    // splines
+    for (const auto &knot : splines->GetSo3Spline(Configor::Preference::SO3_SPLINE).GetKnots()) {
+        SetConstancy(const_cast<double *>(knot.data()), IsOptionWith(Opt::OPT_SO3_SPLINE, option));
+    }
+    for (const auto &knot : splines->GetRdSpline(Configor::Preference::SCALE_SPLINE).GetKnots()) {
+        SetConstancy(const_cast<double *>(knot.data()),
+                     IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+    }
+    SetConstancy(parMagr->GRAVITY.data(), IsOptionWith(Opt::OPT_GRAVITY, option));
+
+    // imu intrinsics
+    for (const auto &[topic, intri] : parMagr->INTRI.IMU) {
+        SetConstancy(intri->ACCE.BIAS.data(), IsOptionWith(Opt::OPT_ACCE_BIAS, option));
+        SetConstancy(intri->ACCE.MAP_COEFF.data(), IsOptionWith(Opt::OPT_ACCE_MAP_COEFF, option));
+        SetConstancy(intri->GYRO.BIAS.data(), IsOptionWith(Opt::OPT_GYRO_BIAS, option));
+        SetConstancy(intri->GYRO.MAP_COEFF.data(), IsOptionWith(Opt::OPT_GYRO_MAP_COEFF, option));
+        SetConstancy(intri->SO3_AtoG.data(), IsOptionWith(Opt::OPT_SO3_AtoG, option));
+    }
+
+    // extrinsics and time offsets
+    auto &EXTRI = parMagr->EXTRI;
+    auto &TEMPORAL = parMagr->TEMPORAL;
+    for (auto &[topic, SO3_BiToBr] : EXTRI.SO3_BiToBr) {
+        SetConstancy(SO3_BiToBr.data(), IsOptionWith(Opt::OPT_SO3_BiToBr, option));
+        SetConstancy(EXTRI.POS_BiInBr.at(topic).data(), IsOptionWith(Opt::OPT_POS_BiInBr, option));
+        SetTemporalConstancy(&TEMPORAL.TO_BiToBr.at(topic),
+                             IsOptionWith(Opt::OPT_TO_BiToBr, option));
+    }
+    for (auto &[topic, SO3_RjToBr] : EXTRI.SO3_RjToBr) {
+        SetConstancy(SO3_RjToBr.data(), IsOptionWith(Opt::OPT_SO3_RjToBr, option));
+        SetConstancy(EXTRI.POS_RjInBr.at(topic).data(), IsOptionWith(Opt::OPT_POS_RjInBr, option));
+        SetTemporalConstancy(&TEMPORAL.TO_RjToBr.at(topic),
+                             IsOptionWith(Opt::OPT_TO_RjToBr, option));
+    }
+    for (auto &[topic, SO3_LkToBr] : EXTRI.SO3_LkToBr) {
+        SetConstancy(SO3_LkToBr.data(), IsOptionWith(Opt::OPT_SO3_LkToBr, option));
+        SetConstancy(EXTRI.POS_LkInBr.at(topic).data(), IsOptionWith(Opt::OPT_POS_LkInBr, option));
+        SetTemporalConstancy(&TEMPORAL.TO_LkToBr.at(topic),
+                             IsOptionWith(Opt::OPT_TO_LkToBr, option));
+    }
+    for (auto &[topic, SO3_CmToBr] : EXTRI.SO3_CmToBr) {
+        SetConstancy(SO3_CmToBr.data(), IsOptionWith(Opt::OPT_SO3_CmToBr, option));
+        SetConstancy(EXTRI.POS_CmInBr.at(topic).data(), IsOptionWith(Opt::OPT_POS_CmInBr, option));
+        SetTemporalConstancy(&TEMPORAL.TO_CmToBr.at(topic),
+                             IsOptionWith(Opt::OPT_TO_CmToBr, option));
+    }
+    for (auto &[topic, SO3_DnToBr] : EXTRI.SO3_DnToBr) {
+        SetConstancy(SO3_DnToBr.data(), IsOptionWith(Opt::OPT_SO3_DnToBr, option));
+        SetConstancy(EXTRI.POS_DnInBr.at(topic).data(), IsOptionWith(Opt::OPT_POS_DnInBr, option));
+        SetTemporalConstancy(&TEMPORAL.TO_DnToBr.at(topic),
+                             IsOptionWith(Opt::OPT_TO_DnToBr, option));
+    }
+}
+
 void Estimator::AddRdKnotsData(std::vector<double *> &paramBlockVec,
                                const Estimator::SplineBundleType::RdSplineType &spline,
                                const Estimator::SplineMetaType &splineMeta,
@@ -147,40 +442,26 @@ void Estimator::AddSo3KnotsData(std::vector<double *> &paramBlockVec,
     }
 }
 
-Eigen::MatrixXd Estimator::CRSMatrix2EigenMatrix(ceres::CRSMatrix *jacobian_crs_matrix) {
-    Eigen::MatrixXd J(jacobian_crs_matrix->num_rows, jacobian_crs_matrix->num_cols);
-    J.setZero();
-
-    std::vector<int> jacobian_crs_matrix_rows, jacobian_crs_matrix_cols;
-    std::vector<double> jacobian_crs_matrix_values;
-    jacobian_crs_matrix_rows = jacobian_crs_matrix->rows;
-    jacobian_crs_matrix_cols = jacobian_crs_matrix->cols;
-    jacobian_crs_matrix_values = jacobian_crs_matrix->values;
-
-    int cur_index_in_cols_and_values = 0;
-    // rows is a num_rows + 1 sized array
-    int row_size = static_cast<int>(jacobian_crs_matrix_rows.size()) - 1;
-    // outer loop traverse rows, inner loop traverse cols and values
-    for (int row_index = 0; row_index < row_size; ++row_index) {
-        while (cur_index_in_cols_and_values < jacobian_crs_matrix_rows[row_index + 1]) {
-            J(row_index, jacobian_crs_matrix_cols[cur_index_in_cols_and_values]) =
-                jacobian_crs_matrix_values[cur_index_in_cols_and_values];
-            cur_index_in_cols_and_values++;
-        }
-    }
-    return J;
+Eigen::SparseMatrix<double, Eigen::RowMajor> Estimator::CRSMatrix2EigenSparseMatrix(
+    const ceres::CRSMatrix &crsMatrix) {
+    // the compressed row storage of ceres shares the same layout as the row-major sparse matrix of
+    // eigen, thus it can be mapped directly, rather than be filled into a dense matrix
+    return Eigen::Map<const Eigen::SparseMatrix<double, Eigen::RowMajor>>(
+        crsMatrix.num_rows, crsMatrix.num_cols, static_cast<int>(crsMatrix.values.size()),
+        crsMatrix.rows.data(), crsMatrix.cols.data(), crsMatrix.values.data());
 }
 
 /**
  * param blocks:
  * [ SO3 | ... | SO3 | GYRO_BIAS | GYRO_MAP_COEFF | SO3_AtoG | SO3_BiToBr | TO_BiToBr ]
  */
-void Estimator::AddIMUGyroMeasurement(const IMUFrame::Ptr &imuFrame,
+bool Estimator::CreateIMUGyroResidual(const IMUFrame::Ptr &imuFrame,
                                       const std::string &topic,
                                       Opt option,
-                                      double gyroWeight) {
+                                      double gyroWeight,
+                                      PendingResidual &residual) {
     // prepare metas for splines
-    SplineMetaType so3Meta;
+    SplineMetaType &so3Meta = residual.so3Meta;
 
     // different relative control points finding [single vs. range]
     // for the inertial measurements from the reference IMU, there is no need to consider a time
@@ -191,7 +472,7 @@ void Estimator::AddIMUGyroMeasurement(const IMUFrame::Ptr &imuFrame,
         // invalid time stamp
         if (!splines->TimeInRangeForSo3(minTime, Configor::Preference::SO3_SPLINE) ||
             !splines->TimeInRangeForSo3(maxTime, Configor::Preference::SO3_SPLINE)) {
-            return;
+            return false;
         }
         splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, {{minTime, maxTime}},
                                         so3Meta);
@@ -200,35 +481,136 @@ void Estimator::AddIMUGyroMeasurement(const IMUFrame::Ptr &imuFrame,
 
         // check point time stamp
         if (!splines->TimeInRangeForSo3(curTime, Configor::Preference::SO3_SPLINE)) {
-            return;
+            return false;
         }
         splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, {{curTime, curTime}},
                                         so3Meta);
     }
 
     // create a cost function
-    auto costFunc =
-        IMUGyroFactor<Configor::Prior::SplineOrder>::Create(so3Meta, imuFrame, gyroWeight);
+    using Factor = IMUGyroFactor<Configor::Prior::SplineOrder>;
+    ceres::CostFunction *costFunc;
+    if (IsFixedAritySplineMeta(so3Meta) && Configor::Preference::UseAnalyticJacobian) {
+        // closed-form jacobians
+        costFunc = IMUGyroAnalyticFactor<Configor::Prior::SplineOrder>::Create(
+            so3Meta, imuFrame, parMagr->TEMPORAL.TO_BiToBr.at(topic), gyroWeight);
+    } else if (IsFixedAritySplineMeta(so3Meta)) {
+        // the knot count is known at compile time, use statically sized jets
+        costFunc = Factor::CreateFixedArity(so3Meta, imuFrame, gyroWeight);
+    } else {
+        auto dynCostFunc = Factor::Create(so3Meta, imuFrame, gyroWeight);
 
-    // so3 knots param block [each has four sub params]
-    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(4);
+        // so3 knots param block [each has four sub params]
+        for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
+            dynCostFunc->AddParameterBlock(4);
+        }
+
+        // GYRO gyroBias
+        dynCostFunc->AddParameterBlock(3);
+        // GYRO map coeff
+        dynCostFunc->AddParameterBlock(6);
+        // SO3_AtoG
+        dynCostFunc->AddParameterBlock(4);
+        // SO3_BiToBr
+        dynCostFunc->AddParameterBlock(4);
+        // TIME_OFFSET_BiToBc
+        dynCostFunc->AddParameterBlock(1);
+
+        // set Residuals
+        dynCostFunc->SetNumResiduals(3);
+        costFunc = dynCostFunc;
     }
 
-    // GYRO gyroBias
-    costFunc->AddParameterBlock(3);
-    // GYRO map coeff
-    costFunc->AddParameterBlock(6);
-    // SO3_AtoG
-    costFunc->AddParameterBlock(4);
-    // SO3_BiToBr
-    costFunc->AddParameterBlock(4);
-    // TIME_OFFSET_BiToBc
-    costFunc->AddParameterBlock(1);
+    residual.costFunc = costFunc;
+    return true;
+}
 
-    // set Residuals
-    costFunc->SetNumResiduals(3);
+void Estimator::AddIMUGyroMeasurement(const IMUFrame::Ptr &imuFrame,
+                                      const std::string &topic,
+                                      Opt option,
+                                      double gyroWeight) {
+    PendingResidual residual;
+    if (this->CreateIMUGyroResidual(imuFrame, topic, option, gyroWeight, residual)) {
+        this->AddIMUGyroResidualBlock(residual.costFunc, residual.so3Meta, topic, option);
+    }
+}
 
+/**
+ * the gyroscope counterpart of 'AddIMUAcceMeasurements', see it for details
+ */
+void Estimator::AddIMUGyroMeasurements(const std::vector<IMUFrame::Ptr> &imuFrames,
+                                       const std::string &topic,
+                                       Opt option,
+                                       double gyroWeight) {
+    if (!Configor::Preference::UseAnalyticJacobian ||
+        (IsOptionWith(Opt::OPT_TO_BiToBr, option) && Configor::DataStream::ReferIMU != topic)) {
+        auto residuals = CreateResidualsInParallel(
+            imuFrames.size(),
+            [this, &imuFrames, &topic, option, gyroWeight](int i, PendingResidual &res) {
+                this->CreateIMUGyroResidual(imuFrames.at(i), topic, option, gyroWeight, res);
+            });
+        AddPendingResidualsInBatches(
+            residuals, [this, &topic, option](ceres::CostFunction *costFunc, ceres::LossFunction *,
+                                              const SplineMetaType &so3Meta,
+                                              const SplineMetaType &) {
+                this->AddIMUGyroResidualBlock(costFunc, so3Meta, topic, option);
+            });
+        return;
+    }
+    using Factor = IMUGyroAnalyticFactor<Configor::Prior::SplineOrder>;
+
+    const double TO_BiToBr = parMagr->TEMPORAL.TO_BiToBr.at(topic);
+    auto residuals = CreateResidualsInParallel(
+        imuFrames.size(),
+        [this, &imuFrames, TO_BiToBr, gyroWeight](int i, PendingResidual &res) {
+            const auto &frame = imuFrames.at(i);
+            double curTime = frame->GetTimestamp() + TO_BiToBr;
+
+            // check point time stamp
+            if (!splines->TimeInRangeForSo3(curTime, Configor::Preference::SO3_SPLINE)) {
+                return;
+            }
+            splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE,
+                                            {{curTime, curTime}}, res.so3Meta);
+            res.costFunc = new Factor(res.so3Meta, frame, TO_BiToBr, gyroWeight);
+        });
+
+    std::vector<std::unique_ptr<Factor>> batch;
+    SplineMetaType batchSo3Meta;
+
+    auto AddBatch = [&]() {
+        if (!batch.empty()) {
+            this->AddIMUGyroResidualBlock(BatchedFactor<Factor>::Create(std::move(batch)),
+                                          batchSo3Meta, topic, option);
+            batch.clear();
+        }
+    };
+
+    for (const auto &res : residuals) {
+        if (res.costFunc == nullptr) {
+            continue;
+        }
+        const auto &so3Meta = res.so3Meta;
+        // a new segment starts
+        if (!batch.empty() && so3Meta.segments.front().t0 != batchSo3Meta.segments.front().t0) {
+            AddBatch();
+        }
+        if (batch.empty()) {
+            batchSo3Meta = so3Meta;
+        }
+        batch.emplace_back(static_cast<Factor *>(res.costFunc));
+    }
+    AddBatch();
+}
+
+/**
+ * param blocks:
+ * [ SO3 | ... | SO3 | GYRO_BIAS | GYRO_MAP_COEFF | SO3_AtoG | SO3_BiToBr | TO_BiToBr ]
+ */
+void Estimator::AddIMUGyroResidualBlock(ceres::CostFunction *costFunc,
+                                        const SplineMetaType &so3Meta,
+                                        const std::string &topic,
+                                        Opt option) {
     // organize the param block vector
     std::vector<double *> paramBlockVec;
 
@@ -253,7 +635,7 @@ void Estimator::AddIMUGyroMeasurement(const IMUFrame::Ptr &imuFrame,
     paramBlockVec.push_back(TIME_OFFSET_BiToBc);
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
     this->SetManifold(SO3_AtoG, QUATER_MANIFOLD.get());
     this->SetManifold(SO3_BiToBr, QUATER_MANIFOLD.get());
@@ -283,6 +665,281 @@ void Estimator::AddIMUGyroMeasurement(const IMUFrame::Ptr &imuFrame,
     }
 }
 
+/**
+ * param blocks:
+ * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | ACCE_BIAS | ACCE_MAP_COEFF | GRAVITY |
+ *   SO3_BiToBr | POS_BiInBr | TO_BiToBr ]
+ */
+void Estimator::AddIMUAcceResidualBlock(ceres::CostFunction *costFunc,
+                                        const SplineMetaType &so3Meta,
+                                        const SplineMetaType &scaleMeta,
+                                        const std::string &topic,
+                                        Opt option) {
+    // organize the param block vector
+    std::vector<double *> paramBlockVec;
+
+    // so3 knots param block
+    AddSo3KnotsData(paramBlockVec, splines->GetSo3Spline(Configor::Preference::SO3_SPLINE), so3Meta,
+                    !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
+
+    // lin acce knots
+    AddRdKnotsData(paramBlockVec, splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
+                   scaleMeta, !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+
+    // ACCE_BIAS
+    auto acceBias = parMagr->INTRI.IMU.at(topic)->ACCE.BIAS.data();
+    paramBlockVec.push_back(acceBias);
+    // ACCE_MAP_COEFF
+    auto aceMapCoeff = parMagr->INTRI.IMU.at(topic)->ACCE.MAP_COEFF.data();
+    paramBlockVec.push_back(aceMapCoeff);
+    // GRAVITY
+    auto gravity = parMagr->GRAVITY.data();
+    paramBlockVec.push_back(gravity);
+    // SO3_BiToBc
+    auto SO3_BiToBc = parMagr->EXTRI.SO3_BiToBr.at(topic).data();
+    paramBlockVec.push_back(SO3_BiToBc);
+    // POS_BiInBc
+    auto POS_BiInBc = parMagr->EXTRI.POS_BiInBr.at(topic).data();
+    paramBlockVec.push_back(POS_BiInBc);
+    // TIME_OFFSET_BiToBc
+    auto TIME_OFFSET_BiToBc = &parMagr->TEMPORAL.TO_BiToBr.at(topic);
+    paramBlockVec.push_back(TIME_OFFSET_BiToBc);
+
+    // pass to problem
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
+    this->SetManifold(gravity, GRAVITY_MANIFOLD.get());
+    this->SetManifold(SO3_BiToBc, QUATER_MANIFOLD.get());
+
+    if (!IsOptionWith(Opt::OPT_ACCE_BIAS, option)) {
+        this->SetParameterBlockConstant(acceBias);
+    }
+
+    if (!IsOptionWith(Opt::OPT_ACCE_MAP_COEFF, option)) {
+        this->SetParameterBlockConstant(aceMapCoeff);
+    }
+
+    if (!IsOptionWith(Opt::OPT_GRAVITY, option)) {
+        this->SetParameterBlockConstant(gravity);
+    }
+
+    if (!IsOptionWith(Opt::OPT_SO3_BiToBr, option)) {
+        this->SetParameterBlockConstant(SO3_BiToBc);
+    }
+
+    if (!IsOptionWith(Opt::OPT_POS_BiInBr, option)) {
+        this->SetParameterBlockConstant(POS_BiInBc);
+    }
+
+    if (!IsOptionWith(Opt::OPT_TO_BiToBr, option)) {
+        this->SetParameterBlockConstant(TIME_OFFSET_BiToBc);
+    } else {
+        // set bound
+        this->SetParameterLowerBound(TIME_OFFSET_BiToBc, 0, -Configor::Prior::TimeOffsetPadding);
+        this->SetParameterUpperBound(TIME_OFFSET_BiToBc, 0, Configor::Prior::TimeOffsetPadding);
+    }
+}
+
+void Estimator::AddLiDARPointToSurfelResidualBlock(ceres::CostFunction *costFunc,
+                                                   ceres::LossFunction *lossFunc,
+                                                   const SplineMetaType &so3Meta,
+                                                   const SplineMetaType &scaleMeta,
+                                                   const std::string &topic,
+                                                   Opt option) {
+    // organize the param block vector
+    std::vector<double *> paramBlockVec;
+
+    // so3 knots param block
+    AddSo3KnotsData(paramBlockVec, splines->GetSo3Spline(Configor::Preference::SO3_SPLINE), so3Meta,
+                    !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
+
+    // lin acce knots
+    AddRdKnotsData(paramBlockVec, splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
+                   scaleMeta, !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+
+    // SO3_LkToBr
+    auto SO3_LkToBr = parMagr->EXTRI.SO3_LkToBr.at(topic).data();
+    paramBlockVec.push_back(SO3_LkToBr);
+
+    // POS_LkInBr
+    auto POS_LkInBr = parMagr->EXTRI.POS_LkInBr.at(topic).data();
+    paramBlockVec.push_back(POS_LkInBr);
+
+    // TO_LkToBr
+    auto TO_LkToBr = &parMagr->TEMPORAL.TO_LkToBr.at(topic);
+    paramBlockVec.push_back(TO_LkToBr);
+
+    // pass to problem
+    this->AddResidualBlockToProblem(costFunc, lossFunc, paramBlockVec);
+    this->SetManifold(SO3_LkToBr, QUATER_MANIFOLD.get());
+
+    if (!IsOptionWith(Opt::OPT_SO3_LkToBr, option)) {
+        this->SetParameterBlockConstant(SO3_LkToBr);
+    }
+
+    if (!IsOptionWith(Opt::OPT_POS_LkInBr, option)) {
+        this->SetParameterBlockConstant(POS_LkInBr);
+    }
+
+    if (!IsOptionWith(Opt::OPT_TO_LkToBr, option)) {
+        this->SetParameterBlockConstant(TO_LkToBr);
+    } else {
+        // set bound
+        this->SetParameterLowerBound(TO_LkToBr, 0, -Configor::Prior::TimeOffsetPadding);
+        this->SetParameterUpperBound(TO_LkToBr, 0, Configor::Prior::TimeOffsetPadding);
+    }
+}
+
+void Estimator::AddRGBDPointToSurfelResidualBlock(ceres::CostFunction *costFunc,
+                                                  ceres::LossFunction *lossFunc,
+                                                  const SplineMetaType &so3Meta,
+                                                  const SplineMetaType &scaleMeta,
+                                                  const std::string &topic,
+                                                  Opt option) {
+    // organize the param block vector
+    std::vector<double *> paramBlockVec;
+
+    // so3 knots param block
+    AddSo3KnotsData(paramBlockVec, splines->GetSo3Spline(Configor::Preference::SO3_SPLINE), so3Meta,
+                    !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
+
+    // lin acce knots
+    AddRdKnotsData(paramBlockVec, splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
+                   scaleMeta, !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+
+    // SO3_DnToBr
+    auto SO3_DnToBr = parMagr->EXTRI.SO3_DnToBr.at(topic).data();
+    paramBlockVec.push_back(SO3_DnToBr);
+
+    // POS_DnInBr
+    auto POS_DnInBr = parMagr->EXTRI.POS_DnInBr.at(topic).data();
+    paramBlockVec.push_back(POS_DnInBr);
+
+    // TO_DnToBr
+    auto TO_DnToBr = &parMagr->TEMPORAL.TO_DnToBr.at(topic);
+    paramBlockVec.push_back(TO_DnToBr);
+
+    // pass to problem
+    this->AddResidualBlockToProblem(costFunc, lossFunc, paramBlockVec);
+    this->SetManifold(SO3_DnToBr, QUATER_MANIFOLD.get());
+
+    if (!IsOptionWith(Opt::OPT_SO3_DnToBr, option)) {
+        this->SetParameterBlockConstant(SO3_DnToBr);
+    }
+
+    if (!IsOptionWith(Opt::OPT_POS_DnInBr, option)) {
+        this->SetParameterBlockConstant(POS_DnInBr);
+    }
+
+    if (!IsOptionWith(Opt::OPT_TO_DnToBr, option)) {
+        this->SetParameterBlockConstant(TO_DnToBr);
+    } else {
+        // set bound
+        this->SetParameterLowerBound(TO_DnToBr, 0, -Configor::Prior::TimeOffsetPadding);
+        this->SetParameterUpperBound(TO_DnToBr, 0, Configor::Prior::TimeOffsetPadding);
+    }
+}
+
+/**
+ * param blocks:
+ * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | SO3_CmToBr | POS_CmInBr | TO_CmToBr |
+ * READOUT_TIME | FX | FY | CX | CY | GLOBAL_SCALE | INV_DEPTH ]
+ */
+void Estimator::AddVisualReprojectionResidualBlock(ceres::CostFunction *costFunc,
+                                                   ceres::LossFunction *lossFunc,
+                                                   const SplineMetaType &so3Meta,
+                                                   const SplineMetaType &scaleMeta,
+                                                   const std::string &topic,
+                                                   double *globalScale,
+                                                   double *invDepth,
+                                                   Opt option) {
+    const double TO_PADDING = Configor::Prior::TimeOffsetPadding;
+    const double RT_PADDING = Configor::Prior::ReadoutTimePadding;
+    double *RS_READOUT = &parMagr->TEMPORAL.RS_READOUT.at(topic);
+    double *TO_CmToBr = &parMagr->TEMPORAL.TO_CmToBr.at(topic);
+
+    // organize the param block vector
+    std::vector<double *> paramBlockVec;
+
+    // so3 knots param block
+    AddSo3KnotsData(paramBlockVec, splines->GetSo3Spline(Configor::Preference::SO3_SPLINE), so3Meta,
+                    !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
+
+    // lin acce knots
+    AddRdKnotsData(paramBlockVec, splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
+                   scaleMeta, !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+
+    auto SO3_CmToBr = parMagr->EXTRI.SO3_CmToBr.at(topic).data();
+    paramBlockVec.push_back(SO3_CmToBr);
+
+    auto POS_CmInBr = parMagr->EXTRI.POS_CmInBr.at(topic).data();
+    paramBlockVec.push_back(POS_CmInBr);
+
+    paramBlockVec.push_back(TO_CmToBr);
+    paramBlockVec.push_back(RS_READOUT);
+
+    auto &intri = parMagr->INTRI.Camera.at(topic);
+    paramBlockVec.push_back(intri->FXAddress());
+    paramBlockVec.push_back(intri->FYAddress());
+    paramBlockVec.push_back(intri->CXAddress());
+    paramBlockVec.push_back(intri->CYAddress());
+
+    paramBlockVec.push_back(globalScale);
+    paramBlockVec.push_back(invDepth);
+    landmarkParams.insert(invDepth);
+
+    // pass to problem
+    this->AddResidualBlockToProblem(costFunc, lossFunc, paramBlockVec);
+    this->SetManifold(SO3_CmToBr, QUATER_MANIFOLD.get());
+
+    if (!IsOptionWith(Opt::OPT_SO3_CmToBr, option)) {
+        this->SetParameterBlockConstant(SO3_CmToBr);
+    }
+
+    if (!IsOptionWith(Opt::OPT_POS_CmInBr, option)) {
+        this->SetParameterBlockConstant(POS_CmInBr);
+    }
+
+    if (!IsOptionWith(Opt::OPT_TO_CmToBr, option)) {
+        this->SetParameterBlockConstant(TO_CmToBr);
+    } else {
+        // set bound
+        this->SetParameterLowerBound(TO_CmToBr, 0, -TO_PADDING);
+        this->SetParameterUpperBound(TO_CmToBr, 0, TO_PADDING);
+    }
+
+    if (!IsOptionWith(Opt::OPT_RS_CAM_READOUT_TIME, option)) {
+        this->SetParameterBlockConstant(RS_READOUT);
+    } else {
+        // set bound
+        this->SetParameterLowerBound(RS_READOUT, 0, 0.0);
+        this->SetParameterUpperBound(RS_READOUT, 0, RT_PADDING);
+    }
+
+    if (!IsOptionWith(Opt::OPT_CAM_FOCAL_LEN, option)) {
+        this->SetParameterBlockConstant(intri->FXAddress());
+        this->SetParameterBlockConstant(intri->FYAddress());
+    }
+
+    if (!IsOptionWith(Opt::OPT_CAM_PRINCIPAL_POINT, option)) {
+        this->SetParameterBlockConstant(intri->CXAddress());
+        this->SetParameterBlockConstant(intri->CYAddress());
+    }
+
+    if (!IsOptionWith(Opt::OPT_VISUAL_GLOBAL_SCALE, option)) {
+        this->SetParameterBlockConstant(globalScale);
+    } else {
+        // set bound
+        this->SetParameterLowerBound(globalScale, 0, 1E-3);
+    }
+
+    if (!IsOptionWith(Opt::OPT_VISUAL_DEPTH, option)) {
+        this->SetParameterBlockConstant(invDepth);
+    } else {
+        // set bound
+        this->SetParameterLowerBound(invDepth, 0, 1E-3);
+    }
+}
+
 /**
  * param blocks:
  * [ SO3_LkToBr | POS_LkInBr | POS_BiInBr | S_VEL | E_VEL | GRAVITY ]
@@ -352,7 +1009,7 @@ void Estimator::AddLiDARInertialAlignment(const std::vector<IMUFrame::Ptr> &data
     auto GRAVITY = parMagr->GRAVITY.data();
     paramBlockVec.push_back(GRAVITY);
 
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
     this->SetManifold(SO3_LkToBr, QUATER_MANIFOLD.get());
     this->SetManifold(GRAVITY, GRAVITY_MANIFOLD.get());
 
@@ -444,7 +1101,7 @@ void Estimator::AddVisualInertialAlignment(const std::vector<IMUFrame::Ptr> &dat
 
     paramBlockVec.push_back(SCALE);
 
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
     this->SetManifold(SO3_CmToBr, QUATER_MANIFOLD.get());
     this->SetManifold(GRAVITY, GRAVITY_MANIFOLD.get());
 
@@ -518,7 +1175,7 @@ void Estimator::AddInertialAlignment(const std::vector<IMUFrame::Ptr> &data,
     paramBlockVec.push_back(sVel->data());
     paramBlockVec.push_back(eVel->data());
 
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
     this->SetManifold(GRAVITY, GRAVITY_MANIFOLD.get());
 
     if (!IsOptionWith(Opt::OPT_POS_BiInBr, option)) {
@@ -585,7 +1242,7 @@ void Estimator::AddRadarInertialAlignment(const std::vector<IMUFrame::Ptr> &data
     paramBlockVec.push_back(gravity);
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
     this->SetManifold(gravity, GRAVITY_MANIFOLD.get());
     this->SetManifold(SO3_RjToBr, QUATER_MANIFOLD.get());
 
@@ -654,7 +1311,7 @@ void Estimator::AddRadarInertialRotRoughAlignment(const std::vector<IMUFrame::Pt
     paramBlockVec.push_back(gravity);
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
     this->SetManifold(gravity, GRAVITY_MANIFOLD.get());
     this->SetManifold(SO3_RjToBr, QUATER_MANIFOLD.get());
 
@@ -723,7 +1380,7 @@ void Estimator::AddRGBDInertialAlignment(
     paramBlockVec.push_back(gravity);
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
     this->SetManifold(gravity, GRAVITY_MANIFOLD.get());
     this->SetManifold(SO3_DnToBr, QUATER_MANIFOLD.get());
 
@@ -805,7 +1462,7 @@ void Estimator::AddVelVisualInertialAlignment(
     paramBlockVec.push_back(eVelScale);
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
     this->SetManifold(gravity, GRAVITY_MANIFOLD.get());
     this->SetManifold(SO3_CmToBr, QUATER_MANIFOLD.get());
 
@@ -904,7 +1561,7 @@ void Estimator::AddHandEyeRotationAlignmentForLiDAR(const std::string &lidarTopi
     paramBlockVec.push_back(TO_LkToBr);
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
     this->SetManifold(SO3_LkToBr, QUATER_MANIFOLD.get());
 
@@ -1000,7 +1657,7 @@ void Estimator::AddHandEyeRotationAlignmentForCamera(const std::string &camTopic
     paramBlockVec.push_back(TO_CmToBr);
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
     this->SetManifold(SO3_CmToBr, QUATER_MANIFOLD.get());
 
@@ -1096,7 +1753,7 @@ void Estimator::AddHandEyeRotationAlignmentForRGBD(const std::string &rgbdTopic,
     paramBlockVec.push_back(TO_DnToBr);
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
     this->SetManifold(SO3_DnToBr, QUATER_MANIFOLD.get());
 
@@ -1150,7 +1807,7 @@ void Estimator::AddSO3Constraint(double timeByBr,
                     !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 }
 
 /**
@@ -1180,7 +1837,7 @@ void Estimator::AddVisualProjectionFactor(ns_veta::Posed *T_CurCToW,
     paramBlockVec.push_back(POS_LMInW->data());
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
     this->SetManifold(T_CurCToW->Rotation().data(), QUATER_MANIFOLD.get());
 }
@@ -1261,8 +1918,8 @@ Estimator::InertialIntegrationBase(const std::vector<IMUFrame::Ptr> &data,
     return {vecSeq, matSeq};
 }
 
-Eigen::MatrixXd Estimator::GetHessianMatrix(const std::vector<double *> &consideredParBlocks,
-                                            int numThread) {
+Eigen::SparseMatrix<double> Estimator::GetSparseHessianMatrix(
+    const std::vector<double *> &consideredParBlocks, int numThread) {
     // remove params that are not involved
     ceres::Problem::EvaluateOptions evalOpt;
     evalOpt.parameter_blocks = consideredParBlocks;
@@ -1272,14 +1929,73 @@ Eigen::MatrixXd Estimator::GetHessianMatrix(const std::vector<double *> &conside
     ceres::CRSMatrix jacobianCRSMatrix;
     this->Evaluate(evalOpt, nullptr, nullptr, nullptr, &jacobianCRSMatrix);
 
-    // obtain hessian matrix and residual vector
-    Eigen::MatrixXd JMat = CRSMatrix2EigenMatrix(&jacobianCRSMatrix);
+    // obtain the hessian matrix, the jacobian has as many rows as residuals, which is never dense
+    Eigen::SparseMatrix<double, Eigen::RowMajor> JMat =
+        CRSMatrix2EigenSparseMatrix(jacobianCRSMatrix);
 
-    Eigen::MatrixXd HMat = JMat.transpose() * JMat;
+    Eigen::SparseMatrix<double> HMat = JMat.transpose() * JMat;
+    HMat.makeCompressed();
 
     return HMat;
 }
 
+Eigen::MatrixXd Estimator::GetHessianMatrix(const std::vector<double *> &consideredParBlocks,
+                                            int numThread) {
+    return Eigen::MatrixXd(GetSparseHessianMatrix(consideredParBlocks, numThread));
+}
+
+std::optional<Eigen::MatrixXd> Estimator::GetMarginalCovariance(
+    const std::vector<double *> &parBlocks,
+    const std::vector<double *> &gaugeBlocks,
+    int numThread) {
+    // hold gauge blocks constant, blocks constant already are not touched
+    std::vector<double *> heldBlocks;
+    for (const auto &parBlock : gaugeBlocks) {
+        if (this->HasParameterBlock(parBlock) && !this->IsParameterBlockConstant(parBlock)) {
+            this->SetParameterBlockConstant(parBlock);
+            heldBlocks.push_back(parBlock);
+        }
+    }
+    auto covMat = ComputeMarginalCovariance(parBlocks, numThread);
+    // recover the states of gauge blocks
+    for (const auto &parBlock : heldBlocks) {
+        this->SetParameterBlockVariable(parBlock);
+    }
+    return covMat;
+}
+
+std::optional<Eigen::MatrixXd> Estimator::ComputeMarginalCovariance(
+    const std::vector<double *> &parBlocks, int numThread) {
+    ceres::Covariance::Options options;
+    options.num_threads = numThread;
+    ceres::Covariance covariance(options);
+
+    // only the blocks of the upper triangle are required, the others are obtained by symmetry
+    std::vector<std::pair<const double *, const double *>> blockPairs;
+    blockPairs.reserve(parBlocks.size() * (parBlocks.size() + 1) / 2);
+    for (int i = 0; i < static_cast<int>(parBlocks.size()); ++i) {
+        for (int j = i; j < static_cast<int>(parBlocks.size()); ++j) {
+            blockPairs.emplace_back(parBlocks.at(i), parBlocks.at(j));
+        }
+    }
+    // other param blocks (e.g., knots of splines) are marginalized
+    if (!covariance.Compute(blockPairs, this)) {
+        return std::nullopt;
+    }
+
+    int dim = 0;
+    for (const auto &parBlock : parBlocks) {
+        dim += this->ParameterBlockTangentSize(parBlock);
+    }
+    // the covariance matrix is symmetric, thus its storage order (row-major in ceres) is irrelevant
+    Eigen::MatrixXd covMat(dim, dim);
+    const std::vector<const double *> constParBlocks(parBlocks.cbegin(), parBlocks.cend());
+    if (!covariance.GetCovarianceMatrixInTangentSpace(constParBlocks, covMat.data())) {
+        return std::nullopt;
+    }
+    return covMat;
+}
+
 void Estimator::SetRefIMUParamsConstant() {
     auto SO3_BiToBr = parMagr->EXTRI.SO3_BiToBr.at(Configor::DataStream::ReferIMU).data();
     if (this->HasParameterBlock(SO3_BiToBr)) {
@@ -1331,7 +2047,7 @@ void Estimator::AddLinScaleTailConstraint(Opt option, double weight, int count)
                     .data();
         }
 
-        this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+        this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
         if (!IsOptionWith(Opt::OPT_SCALE_SPLINE, option)) {
             for (auto &knot : paramBlockVec) {
@@ -1364,7 +2080,7 @@ void Estimator::AddSO3TailConstraint(Opt option, double weight, int count) {
                     .data();
         }
 
-        this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+        this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
         for (const auto &item : paramBlockVec) {
             this->SetManifold(item, QUATER_MANIFOLD.get());
@@ -1393,7 +2109,7 @@ void Estimator::AddLinScaleHeadConstraint(Estimator::Opt option, double weight,
             paramBlockVec.at(i) = velSpline.GetKnot(j + i).data();
         }
 
-        this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+        this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
         if (!IsOptionWith(Opt::OPT_SCALE_SPLINE, option)) {
             for (auto &knot : paramBlockVec) {
@@ -1418,7 +2134,7 @@ void Estimator::AddSO3HeadConstraint(Estimator::Opt option, double weight, int c
             paramBlockVec.at(i) = so3Spline.GetKnot(j + i).data();
         }
 
-        this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+        this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
         for (const auto &item : paramBlockVec) {
             this->SetManifold(item, QUATER_MANIFOLD.get());
@@ -1459,7 +2175,7 @@ void Estimator::AddPriorExtriSO3Constraint(const Sophus::SO3d &SO3_Sen1ToSen2,
     paramBlockVec.push_back(SO3_Sen2ToRef->data());
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
     this->SetManifold(SO3_Sen1ToRef->data(), QUATER_MANIFOLD.get());
     this->SetManifold(SO3_Sen2ToRef->data(), QUATER_MANIFOLD.get());
@@ -1497,7 +2213,7 @@ void Estimator::AddPriorExtriPOSConstraint(const Eigen::Vector3d &POS_Sen1InSen2
     paramBlockVec.push_back(POS_Sen2InRef->data());
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 
     this->SetManifold(SO3_Sen2ToRef->data(), QUATER_MANIFOLD.get());
 }
@@ -1529,7 +2245,7 @@ void Estimator::AddPriorTimeOffsetConstraint(const double &TO_Sen1ToSen2,
     paramBlockVec.push_back(TO_Sen2ToRef);
 
     // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    this->AddResidualBlockToProblem(costFunc, nullptr, paramBlockVec);
 }
 
 void Estimator::PrintUninvolvedKnots() const {
@@ -1592,10 +2308,11 @@ void Estimator::AddVisualVelocityDepthFactor(Eigen::Vector3d *LIN_VEL_CmToWInCm,
     paramBlockVec.push_back(LIN_VEL_CmToWInCm->data());
     // DEPTH
     paramBlockVec.push_back(&corr->depth);
+    landmarkParams.insert(&corr->depth);
 
     // pass to problem, the loss function factor is the same as
     // 'Configor::Prior::LossForRGBDFactor', as this model is the same as rgbd velocity model
-    this->AddResidualBlock(
+    this->AddResidualBlockToProblem(
         costFunc, new ceres::HuberLoss(Configor::Prior::LossForOpticalFlowFactor), paramBlockVec);
 
     // the 'GRAVITY_MANIFOLD' manifold is used to make the vel vector keep const norm, as we only
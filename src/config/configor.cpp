@@ -64,6 +64,7 @@ const static std::map<std::string, OutputOption> OutputOptionMap = {
     {"RadarDopplerErrors", OutputOption::RadarDopplerErrors},
     {"VisualOpticalFlowErrors", OutputOption::VisualOpticalFlowErrors},
     {"LiDARPointToSurfelErrors", OutputOption::LiDARPointToSurfelErrors},
+    {"SpatTempCovariance", OutputOption::SpatTempCovariance},
     {"ALL", OutputOption::ALL},
 };
 
@@ -81,6 +82,7 @@ std::map<std::string, Configor::DataStream::CameraConfig> Configor::DataStream::
 std::map<std::string, Configor::DataStream::RGBDConfig> Configor::DataStream::RGBDTopics = {};
 std::string Configor::DataStream::ReferIMU = {};
 std::string Configor::DataStream::BagPath = {};
+std::string Configor::DataStream::DatasetPath = {};
 double Configor::DataStream::BeginTime = {};
 double Configor::DataStream::Duration = {};
 std::string Configor::DataStream::OutputPath = {};
@@ -98,9 +100,13 @@ double Configor::Prior::KnotTimeDist::ScaleSpline = {};
 
 double Configor::Prior::NDTLiDAROdometer::Resolution = {};
 double Configor::Prior::NDTLiDAROdometer::KeyFrameDownSample = {};
+double Configor::Prior::NDTLiDAROdometer::LocalMapRadius = {};
+int Configor::Prior::NDTLiDAROdometer::LocalMapKeyFrameMax = {};
 
 double Configor::Prior::LiDARDataAssociate::PointToSurfelMax = {};
 double Configor::Prior::LiDARDataAssociate::PlanarityMin = {};
+double Configor::Prior::LiDARDataAssociate::MapVoxelLeafSize = {};
+double Configor::Prior::LiDARDataAssociate::SurfelMapUpdateTolerance = {};
 const std::uint8_t Configor::Prior::LiDARDataAssociate::QueryDepthMin = 1;
 const std::uint8_t Configor::Prior::LiDARDataAssociate::QueryDepthMax = 2;
 const std::size_t Configor::Prior::LiDARDataAssociate::SurfelPointMin = 100;
@@ -108,6 +114,7 @@ const std::size_t Configor::Prior::LiDARDataAssociate::SurfelPointMin = 100;
 // 0.1, 0.2, 0.4, 0.8, 1.6, ...
 const double Configor::Prior::LiDARDataAssociate::MapResolution = 0.1;
 const std::uint8_t Configor::Prior::LiDARDataAssociate::MapDepthLevels = 16;
+const std::uint8_t Configor::Prior::LiDARDataAssociate::MapSubtreeDepth = 4;
 const int Configor::Prior::LiDARDataAssociate::PointToSurfelCountInScan = 200;
 
 // the loss function used for radar factor (m/s) (on the direction of target)
@@ -122,6 +129,13 @@ const double Configor::Prior::LossForOpticalFlowFactor = 30.0;
 bool Configor::Prior::OptTemporalParams = {};
 
 bool Configor::Preference::UseCudaInSolving = {};
+bool Configor::Preference::UseAnalyticJacobian = {};
+std::string Configor::Preference::LinearSolver = {};
+std::string Configor::Preference::Preconditioner = {};
+const std::set<std::string> Configor::Preference::LinearSolverTypes = {
+    "DENSE_SCHUR", "SPARSE_SCHUR", "SPARSE_NORMAL_CHOLESKY", "ITERATIVE_SCHUR"};
+const std::set<std::string> Configor::Preference::PreconditionerTypes = {
+    "JACOBI", "SCHUR_JACOBI", "CLUSTER_JACOBI", "CLUSTER_TRIDIAGONAL"};
 OutputOption Configor::Preference::Outputs = OutputOption::NONE;
 std::set<std::string> Configor::Preference::OutputsStr = {};
 std::string Configor::Preference::OutputDataFormatStr = {};
@@ -132,6 +146,12 @@ const std::map<CerealArchiveType::Enum, std::string> Configor::Preference::FileE
     {CerealArchiveType::Enum::XML, ".xml"},
     {CerealArchiveType::Enum::BINARY, ".bin"}};
 int Configor::Preference::ThreadsToUse = {};
+std::string Configor::Preference::DataCachePath = {};
+bool Configor::Preference::KeepImagesEncoded = {};
+int Configor::Preference::DecodedImageCacheSize = {};
+std::string Configor::Preference::ImageStorage = {};
+bool Configor::Preference::Headless = {};
+double Configor::Preference::UndistortionLUTResolution = {};
 const std::string Configor::Preference::SO3_SPLINE = "SO3_SPLINE";
 const std::string Configor::Preference::SCALE_SPLINE = "SCALE_SPLINE";
 double Configor::Preference::SplineScaleInViewer = {};
@@ -277,24 +297,37 @@ void Configor::PrintMainFields() {
             DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
                 DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
                     DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
-                        DESC_FORMAT DESC_FORMAT DESC_FORMAT,
+                        DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
+                            DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
+                                DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
+                                    DESC_FORMAT DESC_FORMAT,
         DESC_FIELD(IMUTopics), DESC_FIELD(RadarTopics), DESC_FIELD(LiDARTopics),
         DESC_FIELD(CameraTopics), DESC_FIELD(RGBDTopics), DESC_FIELD(DataStream::ReferIMU),
-        DESC_FIELD(DataStream::BagPath), DESC_FIELD(DataStream::BeginTime),
-        DESC_FIELD(DataStream::Duration), DESC_FIELD(DataStream::OutputPath),
+        DESC_FIELD(DataStream::BagPath), DESC_FIELD(DataStream::DatasetPath),
+        DESC_FIELD(DataStream::BeginTime), DESC_FIELD(DataStream::Duration),
+        DESC_FIELD(DataStream::OutputPath),
         DESC_FIELD(Prior::GravityNorm), DESC_FIELD(Prior::OptTemporalParams),
         DESC_FIELD(Prior::TimeOffsetPadding), DESC_FIELD(Prior::ReadoutTimePadding),
         DESC_FIELD(Prior::MapDownSample), DESC_FIELD(Prior::KnotTimeDist::SO3Spline),
         DESC_FIELD(Prior::KnotTimeDist::ScaleSpline),
         DESC_FIELD(Prior::NDTLiDAROdometer::Resolution),
         DESC_FIELD(Prior::NDTLiDAROdometer::KeyFrameDownSample),
+        DESC_FIELD(Prior::NDTLiDAROdometer::LocalMapRadius),
+        DESC_FIELD(Prior::NDTLiDAROdometer::LocalMapKeyFrameMax),
         DESC_FIELD(Prior::LiDARDataAssociate::PointToSurfelMax),
         DESC_FIELD(Prior::LiDARDataAssociate::PlanarityMin),
+        DESC_FIELD(Prior::LiDARDataAssociate::MapVoxelLeafSize),
+        DESC_FIELD(Prior::LiDARDataAssociate::SurfelMapUpdateTolerance),
         DESC_FIELD(Prior::LossForRadarDopplerFactor), DESC_FIELD(Prior::LossForPointToSurfelFactor),
         DESC_FIELD(Prior::LossForReprojFactor), DESC_FIELD(Prior::LossForOpticalFlowFactor),
-        DESC_FIELD(Preference::UseCudaInSolving), "Preference::OutputDataFormat",
-        Preference::OutputDataFormatStr, "Preference::Outputs", GetOptString(Preference::Outputs),
-        DESC_FIELD(Preference::ThreadsToUse));
+        DESC_FIELD(Preference::UseCudaInSolving), DESC_FIELD(Preference::UseAnalyticJacobian),
+        DESC_FIELD(Preference::LinearSolver), DESC_FIELD(Preference::Preconditioner),
+        "Preference::OutputDataFormat", Preference::OutputDataFormatStr, "Preference::Outputs",
+        GetOptString(Preference::Outputs),
+        DESC_FIELD(Preference::ThreadsToUse), DESC_FIELD(Preference::DataCachePath),
+        DESC_FIELD(Preference::KeepImagesEncoded), DESC_FIELD(Preference::DecodedImageCacheSize),
+        DESC_FIELD(Preference::ImageStorage), DESC_FIELD(Preference::Headless),
+        DESC_FIELD(Preference::UndistortionLUTResolution));
 
 #undef DESC_FIELD
 #undef DESC_FORMAT
@@ -386,6 +419,10 @@ void Configor::CheckConfigure() {
         if (config.DepthTopic.empty()) {
             throw Status(Status::ERROR, "empty depth topic (rgbd) topic exists!");
         }
+        if (config.DepthSyncTolerance <= 0.0) {
+            throw Status(Status::ERROR,
+                         "depth synchronization tolerance of rgbd '{}' should be positive!", topic);
+        }
         if (config.Weight <= 0.0) {
             throw Status(Status::ERROR, "weight of rgbd '{}' should be positive!", topic);
         }
@@ -412,7 +449,8 @@ void Configor::CheckConfigure() {
         throw Status(Status::ERROR, "the reference IMU is not set, it should be one of the IMUs!");
     }
 
-    if (!std::filesystem::exists(DataStream::BagPath)) {
+    // the ros bag is not required if the dataset is given, which is checked when it's opened
+    if (DataStream::DatasetPath.empty() && !std::filesystem::exists(DataStream::BagPath)) {
         throw Status(Status::ERROR, "can not find the ros bag (i.e., DataStream::BagPath)!");
     }
     if (DataStream::OutputPath.empty()) {
@@ -455,6 +493,21 @@ void Configor::CheckConfigure() {
                      "the down sample rate for NDT LiDAR odometer (i.e., "
                      "Prior::NDTLiDAROdometer::KeyFrameDownSample) should be positive!");
     }
+    if (Prior::NDTLiDAROdometer::LocalMapRadius <= 0.0) {
+        throw Status(Status::ERROR,
+                     "the local map radius for NDT LiDAR odometer (i.e., "
+                     "Prior::NDTLiDAROdometer::LocalMapRadius) should be positive!");
+    }
+    if (Prior::NDTLiDAROdometer::LocalMapKeyFrameMax <= 0) {
+        throw Status(Status::ERROR,
+                     "the max key frame count of the local map for NDT LiDAR odometer (i.e., "
+                     "Prior::NDTLiDAROdometer::LocalMapKeyFrameMax) should be positive!");
+    }
+    if (Prior::LiDARDataAssociate::SurfelMapUpdateTolerance < 0.0) {
+        throw Status(Status::ERROR,
+                     "the update tolerance of surfel maps (i.e., Prior::LiDARDataAssociate::"
+                     "SurfelMapUpdateTolerance) should not be negative!");
+    }
 
     if (Preference::SplineScaleInViewer <= 0.0) {
         throw Status(Status::ERROR, "the scale of splines in visualization should be positive!");
@@ -463,6 +516,21 @@ void Configor::CheckConfigure() {
         throw Status(Status::ERROR,
                      "the scale of coordinates in visualization should be positive!");
     }
+    if (Preference::KeepImagesEncoded && Preference::DecodedImageCacheSize <= 0) {
+        throw Status(Status::ERROR, "the size of the decoded image cache should be positive!");
+    }
+    if (Preference::LinearSolverTypes.count(Preference::LinearSolver) == 0) {
+        throw Status(Status::ERROR,
+                     "unsupported linear solver '{}' (i.e., Preference::LinearSolver), options: "
+                     "'DENSE_SCHUR', 'SPARSE_SCHUR', 'SPARSE_NORMAL_CHOLESKY', 'ITERATIVE_SCHUR'!",
+                     Preference::LinearSolver);
+    }
+    if (Preference::PreconditionerTypes.count(Preference::Preconditioner) == 0) {
+        throw Status(Status::ERROR,
+                     "unsupported preconditioner '{}' (i.e., Preference::Preconditioner), options: "
+                     "'JACOBI', 'SCHUR_JACOBI', 'CLUSTER_JACOBI', 'CLUSTER_TRIDIAGONAL'!",
+                     Preference::Preconditioner);
+    }
 }
 
 Configor::Ptr Configor::Create() { return std::make_shared<Configor>(); }
@@ -41,11 +41,19 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 
 namespace ns_ikalibr {
 
-LiDAROdometer::LiDAROdometer(float ndtResolution, int threads)
+LiDAROdometer::LiDAROdometer(float ndtResolution,
+                             int threads,
+                             double localMapRadius,
+                             std::size_t localMapKeyFrameMax)
     : _ndtResolution(ndtResolution),
       _threads(threads),
+      _lastKeyFramePos(Eigen::Vector3d::Zero()),
+      _lastKeyFrameYPR(Eigen::Vector3d::Zero()),
       _map(nullptr),
       _mapTime(0.0),
+      _localMapRadius(localMapRadius),
+      _localMapKeyFrameMax(localMapKeyFrameMax),
+      _localMap(nullptr),
       _ndt(new pclomp::NormalDistributionsTransform<IKalibrPoint, IKalibrPoint>),
       _initialized(false) {
     // init the ndt omp object
@@ -57,20 +65,27 @@ LiDAROdometer::LiDAROdometer(float ndtResolution, int threads)
     _ndt->setMaximumIterations(50);
 }
 
-LiDAROdometer::Ptr LiDAROdometer::Create(float ndtResolution, int threads) {
-    return std::make_shared<LiDAROdometer>(ndtResolution, threads);
+LiDAROdometer::Ptr LiDAROdometer::Create(float ndtResolution,
+                                         int threads,
+                                         double localMapRadius,
+                                         std::size_t localMapKeyFrameMax) {
+    return std::make_shared<LiDAROdometer>(ndtResolution, threads, localMapRadius,
+                                           localMapKeyFrameMax);
 }
 
 ns_ctraj::Posed LiDAROdometer::FeedFrame(const LiDARFrame::Ptr &frame,
                                          const Eigen::Matrix4d &predCurToLast,
                                          bool updateMap) {
     ns_ctraj::Posed curLtoM;
+    // converted from the compact scan only once, shared by the registration and map updating
+    const IKalibrPointCloud::Ptr scan = frame->GetScan();
     if (!_initialized) {
         // identity
         curLtoM = ns_ctraj::Posed(frame->GetTimestamp());
 
         // create map
         _map = boost::make_shared<IKalibrPointCloud>();
+        _localMap = boost::make_shared<IKalibrPointCloud>();
         _mapTime = frame->GetTimestamp();
 
         // here the pose id identity
@@ -79,7 +94,7 @@ ns_ctraj::Posed LiDAROdometer::FeedFrame(const LiDARFrame::Ptr &frame,
     } else {
         // down sample
         IKalibrPointCloud::Ptr filterCloud(new IKalibrPointCloud());
-        DownSampleCloud(frame->GetScan(), filterCloud, 0.5);
+        DownSampleCloud(scan, filterCloud, 0.5);
         _ndt->setInputSource(filterCloud);
 
         // organize the pred pose from cur frame to map
@@ -94,7 +109,7 @@ ns_ctraj::Posed LiDAROdometer::FeedFrame(const LiDARFrame::Ptr &frame,
     }
 
     if (updateMap && CheckKeyFrame(curLtoM)) {
-        UpdateMap(frame, curLtoM);
+        UpdateMap(scan, curLtoM);
         _keyFrameIdx.push_back(_frames.size());
     }
 
@@ -105,15 +120,12 @@ ns_ctraj::Posed LiDAROdometer::FeedFrame(const LiDARFrame::Ptr &frame,
 }
 
 bool LiDAROdometer::CheckKeyFrame(const ns_ctraj::Posed &LtoM) {
-    static Eigen::Vector3d lastPos(0.0, 0.0, 0.0);
-    static Eigen::Vector3d lastYPR(0.0, 0.0, 0.0);
-
     Eigen::Vector3d curPos = LtoM.t;
-    double posDist = (curPos - lastPos).norm();
+    double posDist = (curPos - _lastKeyFramePos).norm();
 
     // get current rotMat, ypr
     Eigen::Vector3d curYPR = RotMatToYPR(LtoM.so3.matrix());
-    Eigen::Vector3d deltaAngle = curYPR - lastYPR;
+    Eigen::Vector3d deltaAngle = curYPR - _lastKeyFrameYPR;
     for (int i = 0; i < 3; i++) {
         deltaAngle(i) = NormalizeAngle(deltaAngle(i));
     }
@@ -122,33 +134,69 @@ bool LiDAROdometer::CheckKeyFrame(const ns_ctraj::Posed &LtoM) {
     if (_frames.empty() || posDist > 0.2 || deltaAngle(0) > 5.0 || deltaAngle(1) > 5.0 ||
         deltaAngle(2) > 5.0) {
         // update state
-        lastPos = curPos;
-        lastYPR = curYPR;
+        _lastKeyFramePos = curPos;
+        _lastKeyFrameYPR = curYPR;
         return true;
     }
     return false;
 }
 
-void LiDAROdometer::UpdateMap(const LiDARFrame::Ptr &frame, const ns_ctraj::Posed &LtoM) {
+void LiDAROdometer::UpdateMap(const IKalibrPointCloud::Ptr &scan, const ns_ctraj::Posed &LtoM) {
+    IKalibrPointCloud::Ptr transformCloud;
     // update the first map frame using all points after this program is fine
     if (_frames.empty()) {
-        // copy the frame point cloud to the map
-        *_map += *frame->GetScan();
+        // the converted scan is owned by this odometer, thus no copy is required
+        transformCloud = scan;
     } else {
+        transformCloud = boost::make_shared<IKalibrPointCloud>();
         // down sample
         IKalibrPointCloud::Ptr filteredCloud(new IKalibrPointCloud);
-        DownSampleCloud(frame->GetScan(), filteredCloud, _ndtResolution);
+        DownSampleCloud(scan, filteredCloud, _ndtResolution);
 
         // transform
-        IKalibrPointCloud::Ptr transformCloud(new IKalibrPointCloud);
         pcl::transformPointCloud(*filteredCloud, *transformCloud,
                                  LtoM.se3().matrix().cast<float>());
+    }
+    *_map += *transformCloud;
+
+    UpdateLocalMap(LtoM.t, transformCloud);
+
+    // set the target point cloud, whose voxels are built over the bounded local map only
+    _ndt->setInputTarget(_localMap);
+}
 
-        *_map += *transformCloud;
+void LiDAROdometer::UpdateLocalMap(const Eigen::Vector3d &pos,
+                                   const IKalibrPointCloud::Ptr &cloudInMap) {
+    _localMapKeyFrames.emplace_back(pos, cloudInMap);
+
+    // key frames out of the radius (e.g., passed by long ago) slide out of the local map
+    const std::size_t oldSize = _localMapKeyFrames.size();
+    _localMapKeyFrames.erase(
+        std::remove_if(_localMapKeyFrames.begin(), _localMapKeyFrames.end(),
+                       [&pos, this](const auto &item) {
+                           return (item.first - pos).norm() > _localMapRadius;
+                       }),
+        _localMapKeyFrames.end());
+    // the oldest ones slide out if too many key frames are maintained (e.g., rotating in place)
+    while (_localMapKeyFrames.size() > _localMapKeyFrameMax) {
+        _localMapKeyFrames.pop_front();
     }
 
-    // set the target point cloud
-    _ndt->setInputTarget(_map);
+    if (_localMapKeyFrames.size() == oldSize) {
+        // no key frame slides out, just append the new one
+        *_localMap += *cloudInMap;
+    } else {
+        // rebuild the local map from the maintained key frames
+        _localMap = boost::make_shared<IKalibrPointCloud>();
+        std::size_t size = 0;
+        for (const auto &[p, cloud] : _localMapKeyFrames) {
+            size += cloud->size();
+        }
+        _localMap->reserve(size);
+        for (const auto &[p, cloud] : _localMapKeyFrames) {
+            *_localMap += *cloud;
+        }
+    }
 }
 
 void LiDAROdometer::DownSampleCloud(const IKalibrPointCloud::Ptr &inCloud,
@@ -170,6 +218,8 @@ const std::vector<ns_ctraj::Posed> &LiDAROdometer::GetOdomPoseVec() const { retu
 
 const IKalibrPointCloud::Ptr &LiDAROdometer::GetMap() const { return _map; }
 
+const IKalibrPointCloud::Ptr &LiDAROdometer::GetLocalMap() const { return _localMap; }
+
 const std::vector<LiDARFrame::Ptr> &LiDAROdometer::GetFramesVec() const { return _frames; }
 
 const pclomp::NormalDistributionsTransform<IKalibrPoint, IKalibrPoint>::Ptr &LiDAROdometer::GetNdt()
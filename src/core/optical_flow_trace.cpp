@@ -75,7 +75,8 @@ OpticalFlowCorr::Ptr OpticalFlowTripleTrace::CreateOpticalFlowCorr(
     if (auto rgbdFrame = std::dynamic_pointer_cast<RGBDFrame>(_trace.at(MID).first); rgbdFrame) {
         if (auto depthMat = rgbdFrame->GetDepthImage(); !depthMat.empty()) {
             const Eigen::Vector2d& midPoint = _trace.at(MID).second;
-            const auto rawDepth = depthMat.at<float>((int)midPoint(1), (int)midPoint(0));
+            const auto rawDepth =
+                RGBDFrame::RawDepth(depthMat, (int)midPoint(1), (int)midPoint(0));
             if (intri != nullptr) {
                 corr->depth = intri->ActualDepth(rawDepth);
             }
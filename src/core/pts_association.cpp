@@ -34,6 +34,9 @@
 
 #include "core/pts_association.h"
 #include "factor/data_correspondence.h"
+#include "sensor/lidar.h"
+#include "util/utils.h"
+#include "algorithm"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -85,11 +88,29 @@ PointToSurfelCondition &PointToSurfelCondition::WithPlanarityMin(double val) {
 // PointToSurfelAssociator
 // -----------------------
 
+PointToSurfelAssociator::PointToSurfelAssociator(double resolution, std::uint8_t depth)
+    : _resolution(resolution),
+      _depth(depth),
+      _subtreeSize(resolution * (1 << Configor::Prior::LiDARDataAssociate::MapSubtreeDepth)) {
+    // more buckets than threads, to balance the load of building them
+    const auto bucketCount = static_cast<std::size_t>(Configor::Preference::AvailableThreads() * 4);
+    _smps.reserve(bucketCount);
+    for (std::size_t i = 0; i < bucketCount; ++i) {
+        _smps.push_back(std::make_shared<ufo::map::SurfelMap>(_resolution, _depth));
+    }
+    _bucketPts.resize(bucketCount);
+}
+
 PointToSurfelAssociator::PointToSurfelAssociator(const IKalibrPointCloud::Ptr &mapInW,
                                                  double resolution,
-                                                 std::uint8_t depth) {
-    _smp = ufo::map::SurfelMap(resolution, depth);
-    InsertCloudToSurfelMap<IKalibrPoint>(_smp, *mapInW);
+                                                 std::uint8_t depth)
+    : PointToSurfelAssociator(resolution, depth) {
+    Update(mapInW);
+}
+
+PointToSurfelAssociator::Ptr PointToSurfelAssociator::Create(double resolution,
+                                                             std::uint8_t depth) {
+    return std::make_shared<PointToSurfelAssociator>(resolution, depth);
 }
 
 PointToSurfelAssociator::Ptr PointToSurfelAssociator::Create(const IKalibrPointCloud::Ptr &mapInW,
@@ -98,6 +119,76 @@ PointToSurfelAssociator::Ptr PointToSurfelAssociator::Create(const IKalibrPointC
     return std::make_shared<PointToSurfelAssociator>(mapInW, resolution, depth);
 }
 
+std::size_t PointToSurfelAssociator::Update(const IKalibrPointCloud::Ptr &mapInW,
+                                            double tolerance) {
+    // distribute points of the new map to buckets
+    std::vector<std::vector<ufo::map::Point3>> bucketPts(_smps.size());
+    for (const auto &p : mapInW->points) {
+        if (IS_POS_NAN(p)) {
+            continue;
+        }
+        bucketPts.at(BucketIndex(p.x, p.y, p.z)).emplace_back(p.x, p.y, p.z);
+    }
+
+    // for exact rebuilding, points are not compared, thus need not be retained
+    const bool retainPts = tolerance > 0.0;
+    const double toleranceSquared = tolerance * tolerance;
+    auto IsChanged = [retainPts, toleranceSquared](const std::vector<ufo::map::Point3> &oldPts,
+                                                   const std::vector<ufo::map::Point3> &newPts) {
+        if (!retainPts || oldPts.size() != newPts.size()) {
+            return true;
+        }
+        for (std::size_t i = 0; i < oldPts.size(); ++i) {
+            const double dx = newPts[i].x - oldPts[i].x, dy = newPts[i].y - oldPts[i].y,
+                         dz = newPts[i].z - oldPts[i].z;
+            if (dx * dx + dy * dy + dz * dz > toleranceSquared) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // rebuild changed buckets concurrently, unchanged ones (and their points) are kept as they are
+    const int bucketCount = static_cast<int>(_smps.size());
+    std::vector<std::exception_ptr> exceptions(bucketCount, nullptr);
+    std::vector<char> rebuilt(bucketCount, false);
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) schedule(dynamic) \
+    default(none) shared(bucketCount, bucketPts, exceptions, rebuilt, IsChanged, retainPts)
+    for (int i = 0; i < bucketCount; ++i) {
+        try {
+            if (!IsChanged(_bucketPts.at(i), bucketPts.at(i))) {
+                continue;
+            }
+            auto smp = std::make_shared<ufo::map::SurfelMap>(_resolution, _depth);
+            smp->insertSurfelPoint(std::begin(bucketPts.at(i)), std::end(bucketPts.at(i)));
+            _smps.at(i) = smp;
+            if (retainPts) {
+                _bucketPts.at(i) = std::move(bucketPts.at(i));
+            } else {
+                std::vector<ufo::map::Point3>().swap(_bucketPts.at(i));
+            }
+            rebuilt.at(i) = true;
+        } catch (...) {
+            exceptions.at(i) = std::current_exception();
+        }
+    }
+
+    for (const auto &exception : exceptions) {
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+    }
+    return static_cast<std::size_t>(std::count(rebuilt.cbegin(), rebuilt.cend(), true));
+}
+
+std::size_t PointToSurfelAssociator::BucketIndex(float x, float y, float z) const {
+    // subtrees are aligned with octree nodes at the subtree depth
+    const auto ix = static_cast<std::int64_t>(std::floor(x / _subtreeSize));
+    const auto iy = static_cast<std::int64_t>(std::floor(y / _subtreeSize));
+    const auto iz = static_cast<std::int64_t>(std::floor(z / _subtreeSize));
+    return SpatialHash(ix, iy, iz) % _smps.size();
+}
+
 double PointToSurfelAssociator::SurfelScore(const ufo::map::SurfelMap &m, const ufo::map::Node &n) {
     const auto &s = m.getSurfel(n);
     double score = s.getPlanarity();
@@ -115,33 +206,37 @@ Eigen::Vector4d PointToSurfelAssociator::SurfelCoeffs(const ufo::map::SurfelMap:
     return {norm.x, norm.y, norm.z, d};
 }
 
-const ufo::map::SurfelMap &PointToSurfelAssociator::GetSurfelMap() const { return _smp; }
+const std::vector<PointToSurfelAssociator::SurfelMapPtr> &PointToSurfelAssociator::GetSurfelMaps()
+    const {
+    return _smps;
+}
 
 std::vector<PointToSurfelCorr::Ptr> PointToSurfelAssociator::Association(
-    const IKalibrPointCloud::Ptr &mapCloud,
-    const IKalibrPointCloud::Ptr &rawCloud,
+    const LiDARScan::Ptr &mapScan,
+    const LiDARScan::Ptr &rawScan,
     const PointToSurfelCondition &condition) {
-    if (mapCloud == nullptr || rawCloud == nullptr) {
+    if (mapScan == nullptr || rawScan == nullptr) {
         return {};
     }
 
     namespace ufopred = ufo::map::predicate;
 
     // get the width and height of this scan
-    const int pts = static_cast<int>(rawCloud->size());
+    const int pts = static_cast<int>(rawScan->Size());
+    const auto &mx = mapScan->GetX(), &my = mapScan->GetY(), &mz = mapScan->GetZ();
 
     std::vector<double> winScores(pts, -1.0);
     std::vector<ufo::map::Node> winNodes(pts, ufo::map::Node());
 
 #pragma omp parallel for num_threads(omp_get_max_threads()) default(none) \
-    shared(pts, mapCloud, condition, winNodes, winScores)
+    shared(pts, mapScan, mx, my, mz, condition, winNodes, winScores)
     for (int i = 0; i < pts; ++i) {
-        const auto &mp = mapCloud->at(i);
-
         // nan point
-        if (IS_POS_NAN(mp)) {
+        if (!mapScan->IsValid(i)) {
             continue;
         }
+        // all surfels containing this point are in the surfel map of its bucket
+        const auto &smp = *_smps.at(BucketIndex(mx[i], my[i], mz[i]));
 
         // predicate
         auto pred = ufopred::HasSurfel()
@@ -153,16 +248,16 @@ std::vector<PointToSurfelCorr::Ptr> PointToSurfelAssociator::Association(
                     // planarity constraint
                     && ufopred::SurfelPlanarityMin(condition.planarityMin)
                     // geometry constraint
-                    && ufopred::Contains(ufo::geometry::Point(mp.x, mp.y, mp.z));
+                    && ufopred::Contains(ufo::geometry::Point(mx[i], my[i], mz[i]));
 
         double winScore = -1.0;
         ufo::map::Node winNode;
 
-        for (const auto &node : _smp.query(pred)) {
-            double s = SurfelScore(_smp, node);
+        for (const auto &node : smp.query(pred)) {
+            double s = SurfelScore(smp, node);
             if (winScore < 0.0 || s > winScore) {
                 // this surfel is a good surfel, check point to surfel distance
-                if (PointToSurfel(_smp.getSurfel(node), ufo::map::Point3(mp.x, mp.y, mp.z)) <
+                if (PointToSurfel(smp.getSurfel(node), ufo::map::Point3(mx[i], my[i], mz[i])) <
                     condition.pointToSurfelMax) {
                     winScore = s, winNode = node;
                 }
@@ -172,20 +267,20 @@ std::vector<PointToSurfelCorr::Ptr> PointToSurfelAssociator::Association(
         winScores.at(i) = winScore, winNodes.at(i) = winNode;
     }
 
+    const auto &rx = rawScan->GetX(), &ry = rawScan->GetY(), &rz = rawScan->GetZ();
     std::vector<PointToSurfelCorr::Ptr> corrs;
     corrs.reserve(pts);
     for (int i = 0; i < pts; ++i) {
         double winScore = winScores.at(i);
         // valid
         if (winScore > 0.0) {
-            const auto &rp = rawCloud->at(i);
-            const auto &mp = mapCloud->at(i);
+            const auto &smp = *_smps.at(BucketIndex(mx[i], my[i], mz[i]));
 
-            auto corr =
-                PointToSurfelCorr::Create(rp.timestamp, Eigen::Vector3d(rp.x, rp.y, rp.z), winScore,
-                                          SurfelCoeffs(_smp.getSurfel(winNodes.at(i))));
+            auto corr = PointToSurfelCorr::Create(rawScan->GetTimestamp(i),
+                                                  Eigen::Vector3d(rx[i], ry[i], rz[i]), winScore,
+                                                  SurfelCoeffs(smp.getSurfel(winNodes.at(i))));
 
-            corr->pInMap = Eigen::Vector3d(mp.x, mp.y, mp.z);
+            corr->pInMap = Eigen::Vector3d(mx[i], my[i], mz[i]);
             corr->node = winNodes.at(i);
 
             corrs.push_back(corr);
@@ -191,8 +191,10 @@ bool RotOnlyVisualOdometer::GrabFrame(const CameraFrame::Ptr &curFrame,
     _trackFeatLast = trackedFeats;
 
     // spdlog::info("show tracked features on the image...");
-    ShowCurrentFrame();
-    cv::waitKey(1);
+    if (!Configor::Preference::Headless) {
+        ShowCurrentFrame();
+        cv::waitKey(1);
+    }
 #undef VISUALIZATION
     return true;
 }
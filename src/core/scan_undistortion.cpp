@@ -37,6 +37,8 @@
 #include "sensor/lidar.h"
 #include "util/tqdm.h"
 #include "util/utils_tpl.hpp"
+#include "spdlog/spdlog.h"
+#include "chrono"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -55,33 +57,123 @@ ScanUndistortion::Ptr ScanUndistortion::Create(const SplineBundleType::Ptr &spli
     return std::make_shared<ScanUndistortion>(splines, calibParamManager);
 }
 
+// ---------------
+// PoseLookUpTable
+// ---------------
+
+Sophus::SE3d ScanUndistortion::PoseLookUpTable::Interpolate(double t) const {
+    if (so3.size() == 1) {
+        return {so3.front(), pos.front()};
+    }
+    const double idx = std::clamp((t - st) / dt, 0.0, static_cast<double>(so3.size() - 1));
+    const auto i = std::min(static_cast<std::size_t>(idx), so3.size() - 2);
+    const double alpha = idx - static_cast<double>(i);
+
+    const auto &so3A = so3.at(i), &so3B = so3.at(i + 1);
+    return {so3A * Sophus::SO3d::exp(alpha * (so3A.inverse() * so3B).log()),
+            (1.0 - alpha) * pos.at(i) + alpha * pos.at(i + 1)};
+}
+
+std::optional<ScanUndistortion::PoseLookUpTable> ScanUndistortion::CreatePoseLookUpTable(
+    const LiDARScan::Ptr &scan, double TO_LkToBr) const {
+    const double resolution = Configor::Preference::UndistortionLUTResolution;
+    if (resolution <= 0.0) {
+        return {};
+    }
+    // the time span of points that can be undistorted, samples at both ends are exactly the times
+    // of points, thus they are in the range of splines as well
+    double minTime = std::numeric_limits<double>::max();
+    double maxTime = std::numeric_limits<double>::lowest();
+    for (std::size_t i = 0; i < scan->Size(); ++i) {
+        if (!scan->IsValid(i)) {
+            continue;
+        }
+        double pTimeByBr = scan->GetTimestamp(i) + TO_LkToBr;
+        if (!_so3Spline.TimeStampInRange(pTimeByBr) || !_posSpline.TimeStampInRange(pTimeByBr)) {
+            continue;
+        }
+        minTime = std::min(minTime, pTimeByBr);
+        maxTime = std::max(maxTime, pTimeByBr);
+    }
+    if (minTime > maxTime) {
+        return {};
+    }
+
+    const auto count =
+        static_cast<std::size_t>(std::ceil((maxTime - minTime) / resolution - 1E-9)) + 1;
+    PoseLookUpTable lut;
+    lut.st = minTime;
+    lut.dt = count > 1 ? (maxTime - minTime) / static_cast<double>(count - 1) : 0.0;
+    lut.so3.resize(count);
+    lut.pos.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        double t = i + 1 == count ? maxTime : minTime + static_cast<double>(i) * lut.dt;
+        lut.so3.at(i) = _so3Spline.Evaluate(t);
+        lut.pos.at(i) = _posSpline.Evaluate(t);
+    }
+    return lut;
+}
+
+std::optional<Sophus::SE3d> ScanUndistortion::GetRefIMUToW(
+    double timeByBr, const std::optional<PoseLookUpTable> &lut) const {
+    if (!_so3Spline.TimeStampInRange(timeByBr) || !_posSpline.TimeStampInRange(timeByBr)) {
+        return {};
+    }
+    if (lut != std::nullopt) {
+        return lut->Interpolate(timeByBr);
+    } else {
+        return Sophus::SE3d(_so3Spline.Evaluate(timeByBr), _posSpline.Evaluate(timeByBr));
+    }
+}
+
 // ---------------
 // UndistortToScan
 // ---------------
 
 std::vector<LiDARFrame::Ptr> ScanUndistortion::UndistortToScan(
     const std::vector<LiDARFrame::Ptr> &data, const std::string &topic, Option option) {
-    std::vector<LiDARFrame::Ptr> lidarUndistFrames;
+    std::vector<LiDARFrame::Ptr> lidarUndistFrames(data.size(), nullptr);
 
-    auto bar = std::make_shared<tqdm>();
     bool correctPos = IsOptionWith(Option::UNDIST_POS, option);
+    // scans are undistorted independently, exceptions are kept and rethrown out of the region
+    std::vector<std::exception_ptr> exceptions(data.size(), nullptr);
+    auto bar = std::make_shared<tqdm>();
+    int finishedCount = 0;
+    auto start = std::chrono::steady_clock::now();
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) schedule(dynamic) \
+    default(none) shared(data, topic, correctPos, lidarUndistFrames, exceptions, bar, finishedCount)
     for (int i = 0; i < static_cast<int>(data.size()); ++i) {
-        bar->progress(i, static_cast<int>(data.size()));
-
-        if (auto undistLidarFrame = UndistortToScan(data.at(i), topic, correctPos)) {
-            lidarUndistFrames.push_back(*undistLidarFrame);
-        } else {
-            lidarUndistFrames.push_back(nullptr);
+        try {
+            if (auto undistLidarFrame = UndistortToScan(data.at(i), topic, correctPos)) {
+                lidarUndistFrames.at(i) = *undistLidarFrame;
+            }
+        } catch (...) {
+            exceptions.at(i) = std::current_exception();
         }
+#pragma omp critical
+        { bar->progress(finishedCount++, static_cast<int>(data.size())); }
     }
     bar->finish();
+
+    for (const auto &exception : exceptions) {
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+    }
+    spdlog::info("undistorting {} scans of lidar '{}' costs {:.3f} (s), lut resolution: {} (s)",
+                 data.size(), topic,
+                 std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+                 Configor::Preference::UndistortionLUTResolution);
     return lidarUndistFrames;
 }
 
 std::optional<LiDARFrame::Ptr> ScanUndistortion::UndistortToScan(const LiDARFrame::Ptr &lidarFrame,
                                                                  const std::string &topic,
                                                                  bool correctPos) {
-    double scanTimeByBr = lidarFrame->GetTimestamp() + _parMagr->TEMPORAL.TO_LkToBr.at(topic);
+    const double TO_LkToBr = _parMagr->TEMPORAL.TO_LkToBr.at(topic);
+    const Sophus::SE3d SE3_LkToBr = _parMagr->EXTRI.SE3_LkToBr(topic);
+
+    double scanTimeByBr = lidarFrame->GetTimestamp() + TO_LkToBr;
     // id this time stamp is invalid, return
     if (!_so3Spline.TimeStampInRange(scanTimeByBr) || !_posSpline.TimeStampInRange(scanTimeByBr)) {
         return {};
@@ -89,59 +181,45 @@ std::optional<LiDARFrame::Ptr> ScanUndistortion::UndistortToScan(const LiDARFram
 
     Sophus::SE3d scanRefIMUToW(_so3Spline.Evaluate(scanTimeByBr),
                                _posSpline.Evaluate(scanTimeByBr));
-    auto scanToRef = scanRefIMUToW * _parMagr->EXTRI.SE3_LkToBr(topic);
+    auto scanToRef = scanRefIMUToW * SE3_LkToBr;
 
     Sophus::SE3d refToScan = scanToRef.inverse();
 
     // prepare
-    IKalibrPointCloud::Ptr undistScan(new IKalibrPointCloud);
-    auto rawScan = lidarFrame->GetScan();
-    // assign
-    undistScan->header = rawScan->header;
-    undistScan->height = rawScan->height;
-    undistScan->width = rawScan->width;
-    undistScan->resize(rawScan->height * rawScan->width);
-    undistScan->is_dense = rawScan->is_dense;
-
-    for (int h = 0; h < static_cast<int>(rawScan->height); h++) {
-        for (int w = 0; w < static_cast<int>(rawScan->width); w++) {
-            const auto &rawPoint = rawScan->points[h * rawScan->width + w];
-            IKalibrPoint undistPoint;
-
-            if (IS_POS_NAN(rawPoint)) {
-                SET_POS_NAN(undistPoint)
-            } else {
-                double pTimeByBr = rawPoint.timestamp + _parMagr->TEMPORAL.TO_LkToBr.at(topic);
-
-                if (_so3Spline.TimeStampInRange(pTimeByBr) &&
-                    _posSpline.TimeStampInRange(pTimeByBr)) {
-                    Sophus::SE3d pRefIMUToW(_so3Spline.Evaluate(pTimeByBr),
-                                            _posSpline.Evaluate(pTimeByBr));
-                    auto pointToRef = pRefIMUToW * _parMagr->EXTRI.SE3_LkToBr(topic);
-
-                    Sophus::SE3d pointToScan = refToScan * pointToRef;
-
-                    Eigen::Vector3d rp(rawPoint.x, rawPoint.y, rawPoint.z), up;
-                    if (correctPos) {
-                        up = pointToScan * rp;
-                    } else {
-                        up = pointToScan.so3() * rp;
-                    }
-
-                    undistPoint.x = static_cast<float>(up(0));
-                    undistPoint.y = static_cast<float>(up(1));
-                    undistPoint.z = static_cast<float>(up(2));
-                    undistPoint.timestamp = rawPoint.timestamp;
-                    // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-                    // undistPoint.intensity = rawPoint.intensity;
-                } else {
-                    // we can't undistort it
-                    SET_POS_NAN(undistPoint)
-                }
-            }
-            // undistScan->at(w, h) = undistPoint;
-            undistScan->points[h * rawScan->width + w] = undistPoint;
+    const auto &rawScan = lidarFrame->GetCompactScan();
+    auto undistScan = LiDARScan::Create(rawScan->GetBaseTime());
+    // assign, points are invalid (NaN) by default, timestamps are the same as the raw ones
+    undistScan->Resize(rawScan->GetWidth(), rawScan->GetHeight());
+    undistScan->SetDense(rawScan->IsDense());
+    undistScan->GetTimeOffsets() = rawScan->GetTimeOffsets();
+
+    const auto &rx = rawScan->GetX(), &ry = rawScan->GetY(), &rz = rawScan->GetZ();
+    auto &ux = undistScan->GetX(), &uy = undistScan->GetY(), &uz = undistScan->GetZ();
+    const auto lut = CreatePoseLookUpTable(rawScan, TO_LkToBr);
+
+    for (std::size_t i = 0; i < rawScan->Size(); ++i) {
+        if (!rawScan->IsValid(i)) {
+            continue;
         }
+        auto pRefIMUToW = GetRefIMUToW(rawScan->GetTimestamp(i) + TO_LkToBr, lut);
+        if (pRefIMUToW == std::nullopt) {
+            // we can't undistort it
+            continue;
+        }
+        auto pointToRef = *pRefIMUToW * SE3_LkToBr;
+
+        Sophus::SE3d pointToScan = refToScan * pointToRef;
+
+        Eigen::Vector3d rp(rx[i], ry[i], rz[i]), up;
+        if (correctPos) {
+            up = pointToScan * rp;
+        } else {
+            up = pointToScan.so3() * rp;
+        }
+
+        ux[i] = static_cast<float>(up(0));
+        uy[i] = static_cast<float>(up(1));
+        uz[i] = static_cast<float>(up(2));
     }
 
     return LiDARFrame::Create(lidarFrame->GetTimestamp(), undistScan);
@@ -153,79 +231,87 @@ std::optional<LiDARFrame::Ptr> ScanUndistortion::UndistortToScan(const LiDARFram
 
 std::vector<LiDARFrame::Ptr> ScanUndistortion::UndistortToRef(
     const std::vector<LiDARFrame::Ptr> &data, const std::string &topic, Option option) {
-    std::vector<LiDARFrame::Ptr> lidarUndistFramesInRef;
+    std::vector<LiDARFrame::Ptr> lidarUndistFramesInRef(data.size(), nullptr);
 
-    auto bar = std::make_shared<tqdm>();
     bool correctPos = IsOptionWith(Option::UNDIST_POS, option);
+    // scans are undistorted independently, exceptions are kept and rethrown out of the region
+    std::vector<std::exception_ptr> exceptions(data.size(), nullptr);
+    auto bar = std::make_shared<tqdm>();
+    int finishedCount = 0;
+    auto start = std::chrono::steady_clock::now();
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) schedule(dynamic) \
+    default(none)                                                                              \
+    shared(data, topic, correctPos, lidarUndistFramesInRef, exceptions, bar, finishedCount)
     for (int i = 0; i < static_cast<int>(data.size()); ++i) {
-        bar->progress(i, static_cast<int>(data.size()));
-
-        if (auto undistLidarFrame = UndistortToRef(data.at(i), topic, correctPos)) {
-            lidarUndistFramesInRef.push_back(*undistLidarFrame);
-        } else {
-            lidarUndistFramesInRef.push_back(nullptr);
+        try {
+            if (auto undistLidarFrame = UndistortToRef(data.at(i), topic, correctPos)) {
+                lidarUndistFramesInRef.at(i) = *undistLidarFrame;
+            }
+        } catch (...) {
+            exceptions.at(i) = std::current_exception();
         }
+#pragma omp critical
+        { bar->progress(finishedCount++, static_cast<int>(data.size())); }
     }
     bar->finish();
+
+    for (const auto &exception : exceptions) {
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+    }
+    spdlog::info("undistorting {} scans of lidar '{}' costs {:.3f} (s), lut resolution: {} (s)",
+                 data.size(), topic,
+                 std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+                 Configor::Preference::UndistortionLUTResolution);
     return lidarUndistFramesInRef;
 }
 
 std::optional<LiDARFrame::Ptr> ScanUndistortion::UndistortToRef(const LiDARFrame::Ptr &lidarFrame,
                                                                 const std::string &topic,
                                                                 bool correctPos) {
-    double scanTimeByBr = lidarFrame->GetTimestamp() + _parMagr->TEMPORAL.TO_LkToBr.at(topic);
+    const double TO_LkToBr = _parMagr->TEMPORAL.TO_LkToBr.at(topic);
+    const Sophus::SE3d SE3_LkToBr = _parMagr->EXTRI.SE3_LkToBr(topic);
+
+    double scanTimeByBr = lidarFrame->GetTimestamp() + TO_LkToBr;
     if (!_so3Spline.TimeStampInRange(scanTimeByBr) || !_posSpline.TimeStampInRange(scanTimeByBr)) {
         return {};
     }
     // prepare
-    IKalibrPointCloud::Ptr undistScan(new IKalibrPointCloud);
-    auto rawScan = lidarFrame->GetScan();
-    // assign
-    undistScan->header = rawScan->header;
-    undistScan->height = rawScan->height;
-    undistScan->width = rawScan->width;
-    undistScan->resize(rawScan->height * rawScan->width);
-    undistScan->is_dense = rawScan->is_dense;
-
-    for (int h = 0; h < static_cast<int>(rawScan->height); h++) {
-        for (int w = 0; w < static_cast<int>(rawScan->width); w++) {
-            const auto &rawPoint = rawScan->points[h * rawScan->width + w];
-            IKalibrPoint undistPoint;
-
-            if (IS_POS_NAN(rawPoint)) {
-                SET_POS_NAN(undistPoint)
-            } else {
-                double pTimeByBr = rawPoint.timestamp + _parMagr->TEMPORAL.TO_LkToBr.at(topic);
-
-                if (_so3Spline.TimeStampInRange(pTimeByBr) &&
-                    _posSpline.TimeStampInRange(pTimeByBr)) {
-                    Sophus::SE3d pBrToW(_so3Spline.Evaluate(pTimeByBr),
-                                        _posSpline.Evaluate(pTimeByBr));
-                    auto pointToW = pBrToW * _parMagr->EXTRI.SE3_LkToBr(topic);
-
-                    Eigen::Vector3d rp(rawPoint.x, rawPoint.y, rawPoint.z), up;
-                    if (correctPos) {
-                        up = pointToW * rp;
-                    } else {
-                        up = pointToW.so3() * rp;
-                    }
-
-                    undistPoint.x = static_cast<float>(up(0));
-                    undistPoint.y = static_cast<float>(up(1));
-                    undistPoint.z = static_cast<float>(up(2));
-                    undistPoint.timestamp = rawPoint.timestamp;
-                    // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-                    // undistPoint.intensity = rawPoint.intensity;
-                } else {
-                    // we can't undistort it (no condition)
-                    SET_POS_NAN(undistPoint)
-                }
-            }
-            // undistScan->at(w, h) = undistPoint;
-            undistScan->points[h * rawScan->width + w] = undistPoint;
+    const auto &rawScan = lidarFrame->GetCompactScan();
+    auto undistScan = LiDARScan::Create(rawScan->GetBaseTime());
+    // assign, points are invalid (NaN) by default, timestamps are the same as the raw ones
+    undistScan->Resize(rawScan->GetWidth(), rawScan->GetHeight());
+    undistScan->SetDense(rawScan->IsDense());
+    undistScan->GetTimeOffsets() = rawScan->GetTimeOffsets();
+
+    const auto &rx = rawScan->GetX(), &ry = rawScan->GetY(), &rz = rawScan->GetZ();
+    auto &ux = undistScan->GetX(), &uy = undistScan->GetY(), &uz = undistScan->GetZ();
+    const auto lut = CreatePoseLookUpTable(rawScan, TO_LkToBr);
+
+    for (std::size_t i = 0; i < rawScan->Size(); ++i) {
+        if (!rawScan->IsValid(i)) {
+            continue;
         }
+        auto pBrToW = GetRefIMUToW(rawScan->GetTimestamp(i) + TO_LkToBr, lut);
+        if (pBrToW == std::nullopt) {
+            // we can't undistort it (no condition)
+            continue;
+        }
+        auto pointToW = *pBrToW * SE3_LkToBr;
+
+        Eigen::Vector3d rp(rx[i], ry[i], rz[i]), up;
+        if (correctPos) {
+            up = pointToW * rp;
+        } else {
+            up = pointToW.so3() * rp;
+        }
+
+        ux[i] = static_cast<float>(up(0));
+        uy[i] = static_cast<float>(up(1));
+        uz[i] = static_cast<float>(up(2));
     }
 
     return LiDARFrame::Create(lidarFrame->GetTimestamp(), undistScan);
 }
-}  // namespace ns_ikalibr
\ No newline at end of file
+}  // namespace ns_ikalibr
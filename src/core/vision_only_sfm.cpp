@@ -115,7 +115,9 @@ bool VisionOnlySfM::PreProcess() {
     }
 
     CreateViewCubes();
-    _viewer->AddEntity(_viewCubes, Viewer::VIEW_ASSOCIATION);
+    if (_viewer != nullptr) {
+        _viewer->AddEntity(_viewCubes, Viewer::VIEW_ASSOCIATION);
+    }
 
     // ------------------
     // feature extraction
@@ -240,7 +242,7 @@ bool VisionOnlySfM::PreProcess() {
 #undef VISUALIZATION
         }
 
-        if (j % 10 == 0) {
+        if (_viewer != nullptr && j % 10 == 0) {
             _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION)
                 .AddEntityLocal(_viewCubes, Viewer::VIEW_ASSOCIATION);
             DrawMatchesInViewer(ns_viewer::Colour::Red());
@@ -250,9 +252,11 @@ bool VisionOnlySfM::PreProcess() {
     spdlog::info("feature matching finished.");
     hasDone.clear();
     featMap.clear();
-    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION)
-        .AddEntityLocal(_viewCubes, Viewer::VIEW_ASSOCIATION);
-    DrawMatchesInViewer(ns_viewer::Colour::Green());
+    if (_viewer != nullptr) {
+        _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION)
+            .AddEntityLocal(_viewCubes, Viewer::VIEW_ASSOCIATION);
+        DrawMatchesInViewer(ns_viewer::Colour::Green());
+    }
 
     spdlog::info("checking the covisibility graph connection...");
     if (!IsGraphConnect(ExtractKeysAsVec(_matchRes))) {
@@ -272,10 +276,12 @@ bool VisionOnlySfM::StructureFromMotion() {
     spdlog::info(
         "initialize structure using the frame pair with enough covisibility and parallax...");
     auto initViewIdxPair = InitStructure();
-    _viewer->AddVeta(_veta, Viewer::VIEW_MAP);
-    cv::Mat img = DrawMatchResult(initViewIdxPair);
-    cv::imshow("img", img);
-    cv::waitKey(0);
+    if (_viewer != nullptr) {
+        _viewer->AddVeta(_veta, Viewer::VIEW_MAP);
+        cv::Mat img = DrawMatchResult(initViewIdxPair);
+        cv::imshow("img", img);
+        cv::waitKey(0);
+    }
 
     spdlog::info("performing incremental structure from motion...");
     IncrementalSfM(initViewIdxPair);
@@ -875,7 +881,7 @@ void VisionOnlySfM::IncrementalSfM(const IndexPair &sViewIdxPair) {
             }
 
             viewPairsHaveDone.insert(edge);
-            if (viewPairsHaveDone.size() % 10 == 0) {
+            if (_viewer != nullptr && viewPairsHaveDone.size() % 10 == 0) {
                 _viewer->ClearViewer(Viewer::VIEW_MAP).AddVeta(_veta, Viewer::VIEW_MAP);
                 _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION)
                     .AddEntityLocal(_viewCubes, Viewer::VIEW_ASSOCIATION);
@@ -885,10 +891,13 @@ void VisionOnlySfM::IncrementalSfM(const IndexPair &sViewIdxPair) {
             }
         }
     }
-    _viewer->ClearViewer(Viewer::VIEW_MAP).AddVeta(_veta, Viewer::VIEW_MAP);
-    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION)
-        .AddEntityLocal(_viewCubes, Viewer::VIEW_ASSOCIATION);
-    DrawMatchesInViewer(ns_viewer::Colour::Green(), viewPairsHaveDone, ns_viewer::Colour::Black());
+    if (_viewer != nullptr) {
+        _viewer->ClearViewer(Viewer::VIEW_MAP).AddVeta(_veta, Viewer::VIEW_MAP);
+        _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION)
+            .AddEntityLocal(_viewCubes, Viewer::VIEW_ASSOCIATION);
+        DrawMatchesInViewer(ns_viewer::Colour::Green(), viewPairsHaveDone,
+                            ns_viewer::Colour::Black());
+    }
 }
 
 void VisionOnlySfM::InsertTriangulateLM(const SfMFeaturePairInfo &featPair,
@@ -1136,7 +1145,9 @@ std::set<IndexPair> VisionOnlySfM::FindCovisibility(double covThd) {
     }
 
     CreateViewCubes();
-    _viewer->AddEntity(_viewCubes, Viewer::VIEW_ASSOCIATION);
+    if (_viewer != nullptr) {
+        _viewer->AddEntity(_viewCubes, Viewer::VIEW_ASSOCIATION);
+    }
 
     std::set<IndexPair> hasDone, covPairs;
     for (int j = 0; j < static_cast<int>(_frames.size()); ++j) {
@@ -1144,7 +1155,7 @@ std::set<IndexPair> VisionOnlySfM::FindCovisibility(double covThd) {
         auto covFrames = FindCovisibility(refFrame, hasDone, covThd);
         // spdlog::info("covisibility view count of refFrame '{}': '{}'", refFrame->GetId(),
         // covFrames.size());
-        if (j % 10 == 0) {
+        if (_viewer != nullptr && j % 10 == 0) {
             _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION)
                 .AddEntityLocal(_viewCubes, Viewer::VIEW_ASSOCIATION);
             DrawMatchesInViewer(ns_viewer::Colour::Red());
@@ -59,8 +59,12 @@ template struct HandEyeRotationAlignFactor<Configor::Prior::SplineOrder>;
 template struct IMUAcceFactor<Configor::Prior::SplineOrder, 2>;
 template struct IMUAcceFactor<Configor::Prior::SplineOrder, 1>;
 template struct IMUAcceFactor<Configor::Prior::SplineOrder, 0>;
+template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 2>;
+template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 1>;
+template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 0>;
 
 template struct IMUGyroFactor<Configor ::Prior::SplineOrder>;
+template struct IMUGyroAnalyticFactor<Configor::Prior::SplineOrder>;
 
 template struct LiDARInertialAlignHelper<Configor::Prior::SplineOrder>;
 template struct LiDARInertialAlignFactor<Configor::Prior::SplineOrder>;
@@ -72,10 +76,16 @@ template struct LinearScaleDerivFactor<Configor::Prior::SplineOrder, 0>;
 template struct PointToSurfelFactor<Configor::Prior::SplineOrder, 2>;
 template struct PointToSurfelFactor<Configor::Prior::SplineOrder, 1>;
 template struct PointToSurfelFactor<Configor::Prior::SplineOrder, 0>;
+template struct PointToSurfelAnalyticFactor<Configor::Prior::SplineOrder, 2>;
+template struct PointToSurfelAnalyticFactor<Configor::Prior::SplineOrder, 1>;
+template struct PointToSurfelAnalyticFactor<Configor::Prior::SplineOrder, 0>;
 
 template struct RadarFactor<Configor::Prior::SplineOrder, 2>;
 template struct RadarFactor<Configor::Prior::SplineOrder, 1>;
 template struct RadarFactor<Configor::Prior::SplineOrder, 0>;
+template struct RadarAnalyticFactor<Configor::Prior::SplineOrder, 2>;
+template struct RadarAnalyticFactor<Configor::Prior::SplineOrder, 1>;
+template struct RadarAnalyticFactor<Configor::Prior::SplineOrder, 0>;
 
 template struct RadarInertialAlignHelper<Configor::Prior::SplineOrder>;
 template struct RadarInertialAlignFactor<Configor::Prior::SplineOrder>;
@@ -33,7 +33,12 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "sensor/camera.h"
+#include "config/configor.h"
+#include "opencv4/opencv2/imgcodecs.hpp"
+#include "opencv4/opencv2/imgproc.hpp"
 #include "spdlog/spdlog.h"
+#include "list"
+#include "unordered_map"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -41,16 +46,91 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 
 namespace ns_ikalibr {
 
+// -----------------
+// DecodedImageCache
+// -----------------
+
+/**
+ * a bounded lru cache of camera frames whose images are decoded from the kept encoded images (or
+ * derived from the single stored image). when the cache is full, decoded images of the least
+ * recently used frame are released, so that the memory of decoded images is bounded by
+ * 'Configor::Preference::DecodedImageCacheSize'.
+ */
+class DecodedImageCache {
+private:
+    using FrameList = std::list<std::pair<const CameraFrame *, std::weak_ptr<const CameraFrame>>>;
+
+    std::mutex _mutex;
+    // the most recently used frame is at the front
+    FrameList _frames;
+    std::unordered_map<const CameraFrame *, FrameList::iterator> _index;
+
+public:
+    static DecodedImageCache &Instance() {
+        // never destructed, frames may be released after static objects are destructed
+        static auto *cache = new DecodedImageCache();
+        return *cache;
+    }
+
+    void Touch(const CameraFrame *frame) {
+        auto weakFrame = frame->weak_from_this();
+        if (weakFrame.expired()) {
+            // the frame is not owned by a shared pointer, it's not managed
+            return;
+        }
+        // frames in use by workers should not be evicted, thus the capacity is bounded from below
+        const auto capacity = static_cast<std::size_t>(
+            std::max(Configor::Preference::DecodedImageCacheSize,
+                     2 * Configor::Preference::AvailableThreads()));
+
+        std::vector<std::shared_ptr<const CameraFrame>> evicted;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (auto iter = _index.find(frame); iter != _index.end()) {
+                _frames.splice(_frames.begin(), _frames, iter->second);
+            } else {
+                _frames.emplace_front(frame, weakFrame);
+                _index.insert({frame, _frames.begin()});
+            }
+            while (_frames.size() > capacity) {
+                if (auto lruFrame = _frames.back().second.lock(); lruFrame != nullptr) {
+                    evicted.push_back(lruFrame);
+                }
+                _index.erase(_frames.back().first);
+                _frames.pop_back();
+            }
+        }
+        // release outside the lock, as releasing the last reference would call 'Remove'
+        for (const auto &lruFrame : evicted) {
+            lruFrame->ReleaseDecoded();
+        }
+    }
+
+    void Remove(const CameraFrame *frame) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (auto iter = _index.find(frame); iter != _index.end()) {
+            _frames.erase(iter->second);
+            _index.erase(iter);
+        }
+    }
+};
+
+// -----------
+// CameraFrame
+// -----------
+
 CameraFrame::CameraFrame(double timestamp, cv::Mat greyImg, cv::Mat colorImg, ns_veta::IndexT id)
     : _timestamp(timestamp),
       _greyImg(std::move(greyImg)),
       _colorImg(std::move(colorImg)),
-      _id(id) {
-    if (!greyImg.empty() && !colorImg.empty() && greyImg.size() != colorImg.size()) {
+      _id(id),
+      _encodedImg(nullptr),
+      _storage(ImageStorageType::GREY_AND_COLOR) {
+    if (!_greyImg.empty() && !_colorImg.empty() && _greyImg.size() != _colorImg.size()) {
         spdlog::warn(
             "the size of grey image ({}x{}) is not the same as the one of color image ({}x{})!",
-            greyImg.size().width, greyImg.size().height, colorImg.size().width,
-            colorImg.size().height);
+            _greyImg.size().width, _greyImg.size().height, _colorImg.size().width,
+            _colorImg.size().height);
     }
 }
 
@@ -61,7 +141,30 @@ CameraFrame::Ptr CameraFrame::Create(double timestamp,
     return std::make_shared<CameraFrame>(timestamp, greyImg, colorImg, id);
 }
 
-cv::Mat &CameraFrame::GetImage() { return _greyImg; }
+CameraFrame::Ptr CameraFrame::CreateSingleImage(double timestamp,
+                                                const cv::Mat &img,
+                                                ImageStorageType storage,
+                                                ns_veta::IndexT id) {
+    CameraFrame::Ptr frame;
+    switch (storage) {
+        case ImageStorageType::GREY_ONLY:
+            frame = CameraFrame::Create(timestamp, img, cv::Mat(), id);
+            break;
+        case ImageStorageType::COLOR_ONLY:
+            frame = CameraFrame::Create(timestamp, cv::Mat(), img, id);
+            break;
+        default:
+            // the given image is treated as the color one
+            cv::Mat greyImg;
+            cv::cvtColor(img, greyImg, cv::COLOR_BGR2GRAY);
+            frame = CameraFrame::Create(timestamp, greyImg, img, id);
+            break;
+    }
+    frame->_storage = storage;
+    return frame;
+}
+
+cv::Mat CameraFrame::GetImage() const { return DecodeOnDemand(false); }
 
 double CameraFrame::GetTimestamp() const { return _timestamp; }
 
@@ -73,6 +176,12 @@ std::ostream &operator<<(std::ostream &os, const CameraFrame &frame) {
 }
 
 void CameraFrame::ReleaseMat() {
+    if (IsImageOnDemand()) {
+        // the stored image (if not encoded) is the only one to decode or derive images from
+        ReleaseDecoded();
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_decodeMutex);
     _greyImg.release();
     _colorImg.release();
 }
@@ -81,5 +190,86 @@ ns_veta::IndexT CameraFrame::GetId() const { return _id; }
 
 void CameraFrame::SetId(ns_veta::IndexT id) { _id = id; }
 
-cv::Mat &CameraFrame::GetColorImage() { return _colorImg; }
+cv::Mat CameraFrame::GetColorImage() const { return DecodeOnDemand(true); }
+
+void CameraFrame::SetEncodedImage(const EncodedImage &encodedImg) { _encodedImg = encodedImg; }
+
+const CameraFrame::EncodedImage &CameraFrame::GetEncodedImage() const { return _encodedImg; }
+
+ImageStorageType CameraFrame::GetImageStorage() const { return _storage; }
+
+void CameraFrame::ShareStoredImages(const CameraFrame &frame) {
+    std::scoped_lock lock(_decodeMutex, frame._decodeMutex);
+    _encodedImg = frame._encodedImg;
+    _storage = frame._storage;
+    _greyImg = _colorImg = cv::Mat();
+    if (_encodedImg == nullptr) {
+        if (_storage != ImageStorageType::COLOR_ONLY) {
+            _greyImg = frame._greyImg;
+        }
+        if (_storage != ImageStorageType::GREY_ONLY) {
+            _colorImg = frame._colorImg;
+        }
+    }
+}
+
+CameraFrame::~CameraFrame() {
+    if (IsImageOnDemand()) {
+        DecodedImageCache::Instance().Remove(this);
+    }
+}
+
+bool CameraFrame::IsImageOnDemand() const {
+    return _encodedImg != nullptr || _storage != ImageStorageType::GREY_AND_COLOR;
+}
+
+cv::Mat CameraFrame::DecodeOnDemand(bool colorImg) const {
+    if (!IsImageOnDemand()) {
+        return colorImg ? _colorImg : _greyImg;
+    }
+    const bool isStoredImg = _encodedImg == nullptr &&
+                             (colorImg ? _storage == ImageStorageType::COLOR_ONLY
+                                       : _storage == ImageStorageType::GREY_ONLY);
+    if (isStoredImg) {
+        // the stored image is never released by the decoded image cache
+        return colorImg ? _colorImg : _greyImg;
+    }
+    cv::Mat img;
+    {
+        std::lock_guard<std::mutex> lock(_decodeMutex);
+        cv::Mat &targetImg = colorImg ? _colorImg : _greyImg;
+        if (targetImg.empty() && _encodedImg != nullptr) {
+            // decode as the eager loaders do (bgr8 first, then grey). For raw images (encoded to
+            // png losslessly from their bgr8 conversions) the decoded ones are bit-identical, for
+            // compressed ones 'imdecode' is used rather than 'cv_bridge', which is identical for
+            // common 8-bit jpeg/png images, but may differ for others (e.g., 16-bit png images)
+            cv::Mat cImg = cv::imdecode(*_encodedImg, cv::IMREAD_COLOR);
+            if (cImg.empty()) {
+                spdlog::warn("decode the encoded image of frame at time '{:.5f}' failed!",
+                             _timestamp);
+            } else if (colorImg) {
+                _colorImg = cImg;
+            } else {
+                cv::cvtColor(cImg, _greyImg, cv::COLOR_BGR2GRAY);
+            }
+        } else if (targetImg.empty() && colorImg && !_greyImg.empty()) {
+            cv::cvtColor(_greyImg, _colorImg, cv::COLOR_GRAY2BGR);
+        } else if (targetImg.empty() && !colorImg && !_colorImg.empty()) {
+            cv::cvtColor(_colorImg, _greyImg, cv::COLOR_BGR2GRAY);
+        }
+        img = targetImg;
+    }
+    DecodedImageCache::Instance().Touch(this);
+    return img;
+}
+
+void CameraFrame::ReleaseDecoded() const {
+    std::lock_guard<std::mutex> lock(_decodeMutex);
+    if (_encodedImg != nullptr || _storage == ImageStorageType::COLOR_ONLY) {
+        _greyImg.release();
+    }
+    if (_encodedImg != nullptr || _storage == ImageStorageType::GREY_ONLY) {
+        _colorImg.release();
+    }
+}
 }  // namespace ns_ikalibr
\ No newline at end of file
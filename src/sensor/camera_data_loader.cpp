@@ -37,6 +37,9 @@
 #include "sensor_msgs/CompressedImage.h"
 #include "cv_bridge/cv_bridge.h"
 #include "util/status.hpp"
+#include "util/bag_access.h"
+#include "config/configor.h"
+#include "opencv4/opencv2/imgcodecs.hpp"
 #include "spdlog/fmt/fmt.h"
 
 namespace {
@@ -45,8 +48,12 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 
 namespace ns_ikalibr {
 
-CameraDataLoader::CameraDataLoader(CameraModelType model)
-    : _model(model) {}
+CameraDataLoader::CameraDataLoader(CameraModelType model,
+                                   bool keepEncoded,
+                                   ImageStorageType storage)
+    : _model(model),
+      _keepEncoded(keepEncoded),
+      _storage(storage) {}
 
 CameraDataLoader::Ptr CameraDataLoader::GetLoader(const std::string &modelStr) {
     // try extract radar model
@@ -56,19 +63,29 @@ CameraDataLoader::Ptr CameraDataLoader::GetLoader(const std::string &modelStr) {
     } catch (...) {
         throw Status(Status::ERROR, CameraModel::UnsupportedCameraModelMsg(modelStr));
     }
+    ImageStorageType storage;
+    try {
+        storage = EnumCast::stringToEnum<ImageStorageType>(Configor::Preference::ImageStorage);
+    } catch (...) {
+        throw Status(Status::ERROR,
+                     "unsupported image storage type: '{}', supported types: 'GREY_AND_COLOR', "
+                     "'GREY_ONLY' and 'COLOR_ONLY'",
+                     Configor::Preference::ImageStorage);
+    }
+    const bool keepEncoded = Configor::Preference::KeepImagesEncoded;
     CameraDataLoader::Ptr dataLoader;
     switch (model) {
         case CameraModelType::SENSOR_IMAGE_GS:
         case CameraModelType::SENSOR_IMAGE_RS_FIRST:
         case CameraModelType::SENSOR_IMAGE_RS_MID:
         case CameraModelType::SENSOR_IMAGE_RS_LAST:
-            dataLoader = SensorImageLoader::Create(model);
+            dataLoader = SensorImageLoader::Create(model, keepEncoded, storage);
             break;
         case CameraModelType::SENSOR_IMAGE_COMP_GS:
         case CameraModelType::SENSOR_IMAGE_COMP_RS_FIRST:
         case CameraModelType::SENSOR_IMAGE_COMP_RS_MID:
         case CameraModelType::SENSOR_IMAGE_COMP_RS_LAST:
-            dataLoader = SensorImageCompLoader::Create(model);
+            dataLoader = SensorImageCompLoader::Create(model, keepEncoded, storage);
             break;
         default:
             throw Status(Status::ERROR, CameraModel::UnsupportedCameraModelMsg(modelStr));
@@ -130,49 +147,89 @@ void CameraDataLoader::RefineImgMsgWrongEncoding(const sensor_msgs::Image::Ptr &
     }
 }
 
+CameraFrame::Ptr CameraDataLoader::CreateFrame(double timestamp, const cv::Mat &cImg) const {
+    switch (_storage) {
+        case ImageStorageType::GREY_ONLY: {
+            cv::Mat gImg;
+            cv::cvtColor(cImg, gImg, cv::COLOR_BGR2GRAY);
+            return CameraFrame::CreateSingleImage(timestamp, gImg, _storage);
+        }
+        case ImageStorageType::COLOR_ONLY:
+            return CameraFrame::CreateSingleImage(timestamp, cImg, _storage);
+        default: {
+            cv::Mat gImg;
+            cv::cvtColor(cImg, gImg, cv::COLOR_BGR2GRAY);
+            return CameraFrame::Create(timestamp, gImg, cImg);
+        }
+    }
+}
+
 // -----------------
 // SensorImageLoader
 // -----------------
-SensorImageLoader::SensorImageLoader(CameraModelType model)
-    : CameraDataLoader(model) {}
-
-SensorImageLoader::Ptr SensorImageLoader::Create(CameraModelType model) {
-    return std::make_shared<SensorImageLoader>(model);
+SensorImageLoader::SensorImageLoader(CameraModelType model,
+                                     bool keepEncoded,
+                                     ImageStorageType storage)
+    : CameraDataLoader(model, keepEncoded, storage) {}
+
+SensorImageLoader::Ptr SensorImageLoader::Create(CameraModelType model,
+                                                 bool keepEncoded,
+                                                 ImageStorageType storage) {
+    return std::make_shared<SensorImageLoader>(model, keepEncoded, storage);
 }
 
 CameraFrame::Ptr SensorImageLoader::UnpackFrame(const rosbag::MessageInstance &msgInstance) {
-    sensor_msgs::ImagePtr msg = msgInstance.instantiate<sensor_msgs::Image>();
+    sensor_msgs::ImagePtr msg = BagAccess::Instantiate<sensor_msgs::Image>(msgInstance);
 
     CheckMessage<sensor_msgs::Image>(msg);
     RefineImgMsgWrongEncoding(msg);
 
-    cv::Mat cImg, gImg;
+    cv::Mat cImg;
     cv_bridge::toCvCopy(msg, sensor_msgs::image_encodings::BGR8)->image.copyTo(cImg);
-    cv::cvtColor(cImg, gImg, cv::COLOR_BGR2GRAY);
 
-    return CameraFrame::Create(msg->header.stamp.toSec(), gImg, cImg);
+    if (_keepEncoded) {
+        // encode the bgr8 image losslessly (png), it would be decoded on first access, and the
+        // decoded image is bit-identical to the one loaded eagerly. Note that the encoding costs
+        // extra loading time, i.e., memory is saved at the expense of time for raw images
+        auto encodedImg = std::make_shared<std::vector<uchar>>();
+        cv::imencode(".png", cImg, *encodedImg);
+        auto frame = CameraFrame::Create(msg->header.stamp.toSec());
+        frame->SetEncodedImage(encodedImg);
+        return frame;
+    }
+
+    return CreateFrame(msg->header.stamp.toSec(), cImg);
 }
 
 // ---------------------
 // SensorImageCompLoader
 // ---------------------
-SensorImageCompLoader::SensorImageCompLoader(CameraModelType model)
-    : CameraDataLoader(model) {}
-
-SensorImageCompLoader::Ptr SensorImageCompLoader::Create(CameraModelType model) {
-    return std::make_shared<SensorImageCompLoader>(model);
+SensorImageCompLoader::SensorImageCompLoader(CameraModelType model,
+                                             bool keepEncoded,
+                                             ImageStorageType storage)
+    : CameraDataLoader(model, keepEncoded, storage) {}
+
+SensorImageCompLoader::Ptr SensorImageCompLoader::Create(CameraModelType model,
+                                                         bool keepEncoded,
+                                                         ImageStorageType storage) {
+    return std::make_shared<SensorImageCompLoader>(model, keepEncoded, storage);
 }
 
 CameraFrame::Ptr SensorImageCompLoader::UnpackFrame(const rosbag::MessageInstance &msgInstance) {
     sensor_msgs::CompressedImageConstPtr msg =
-        msgInstance.instantiate<sensor_msgs::CompressedImage>();
+        BagAccess::Instantiate<sensor_msgs::CompressedImage>(msgInstance);
 
     CheckMessage<sensor_msgs::CompressedImage>(msg);
 
-    cv::Mat cImg, gImg;
-    cv_bridge::toCvCopy(msg, sensor_msgs::image_encodings::BGR8)->image.copyTo(cImg);
-    cv::cvtColor(cImg, gImg, cv::COLOR_BGR2GRAY);
+    if (_keepEncoded) {
+        // keep the compressed data as it is, it would be decoded on first access
+        auto frame = CameraFrame::Create(msg->header.stamp.toSec());
+        frame->SetEncodedImage(std::make_shared<const std::vector<uchar>>(msg->data));
+        return frame;
+    }
 
-    return CameraFrame::Create(msg->header.stamp.toSec(), gImg, cImg);
+    cv::Mat cImg;
+    cv_bridge::toCvCopy(msg, sensor_msgs::image_encodings::BGR8)->image.copyTo(cImg);
+    return CreateFrame(msg->header.stamp.toSec(), cImg);
 }
 }  // namespace ns_ikalibr
\ No newline at end of file
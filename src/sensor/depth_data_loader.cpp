@@ -37,6 +37,7 @@
 #include "sensor_msgs/CompressedImage.h"
 #include "cv_bridge/cv_bridge.h"
 #include "util/status.hpp"
+#include "util/bag_access.h"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -98,6 +99,24 @@ void DepthDataLoader::InverseMat(cv::Mat &floatMat) {
     }
 }
 
+void DepthDataLoader::FormatDepthMat(cv::Mat &depthMat) const {
+    if (depthMat.channels() != 1) {
+        throw Status(Status::ERROR, "the channel of depth image dose not equal to 1!!!");
+    }
+    if (depthMat.type() == CV_16UC1 && !_isInverse) {
+        // native 16-bit depth images are kept as they are (half the memory of float ones), the
+        // depth model (alpha, beta) is applied when depth values are looked up
+        return;
+    }
+    if (depthMat.type() != CV_32FC1) {
+        // todo: the alpha=1.0, beta=0.0, assume that the depth factor is not provided
+        depthMat.convertTo(depthMat, CV_32F, 1.0, 0.0);
+    }
+    if (_isInverse) {
+        InverseMat(depthMat);
+    }
+}
+
 // ----------------------
 // DepthSensorImageLoader
 // ----------------------
@@ -109,22 +128,13 @@ DepthSensorImageLoader::Ptr DepthSensorImageLoader::Create(CameraModelType model
 }
 
 DepthFrame::Ptr DepthSensorImageLoader::UnpackFrame(const rosbag::MessageInstance &msgInstance) {
-    sensor_msgs::ImagePtr msg = msgInstance.instantiate<sensor_msgs::Image>();
+    sensor_msgs::ImagePtr msg = BagAccess::Instantiate<sensor_msgs::Image>(msgInstance);
 
     CheckMessage<sensor_msgs::Image>(msg);
 
     cv::Mat dImg;
     cv_bridge::toCvCopy(msg)->image.copyTo(dImg);
-    if (dImg.channels() != 1) {
-        throw Status(Status::ERROR, "the channel of depth image dose not equal to 1!!!");
-    }
-    if (dImg.type() != CV_32FC1) {
-        // todo: the alpha=1.0, beta=0.0, assume that the depth factor is not provided
-        dImg.convertTo(dImg, CV_32F, 1.0, 0.0);
-    }
-    if (_isInverse) {
-        InverseMat(dImg);
-    }
+    FormatDepthMat(dImg);
 
     return DepthFrame::Create(msg->header.stamp.toSec(), dImg);
 }
@@ -143,22 +153,13 @@ DepthSensorImageCompLoader::Ptr DepthSensorImageCompLoader::Create(CameraModelTy
 DepthFrame::Ptr DepthSensorImageCompLoader::UnpackFrame(
     const rosbag::MessageInstance &msgInstance) {
     sensor_msgs::CompressedImageConstPtr msg =
-        msgInstance.instantiate<sensor_msgs::CompressedImage>();
+        BagAccess::Instantiate<sensor_msgs::CompressedImage>(msgInstance);
 
     CheckMessage<sensor_msgs::CompressedImage>(msg);
 
     cv::Mat dImg;
     cv_bridge::toCvCopy(msg)->image.copyTo(dImg);
-    if (dImg.channels() != 1) {
-        throw Status(Status::ERROR, "the channel of depth image dose not equal to 1!!!");
-    }
-    if (dImg.type() != CV_32FC1) {
-        // todo: the alpha=1.0, beta=0.0, assume that the depth factor is not provided
-        dImg.convertTo(dImg, CV_32F, 1.0, 0.0);
-    }
-    if (_isInverse) {
-        InverseMat(dImg);
-    }
+    FormatDepthMat(dImg);
     return DepthFrame::Create(msg->header.stamp.toSec(), dImg);
 }
 
@@ -35,6 +35,7 @@
 #include "sensor/imu_data_loader.h"
 #include "util/enum_cast.hpp"
 #include "util/status.hpp"
+#include "util/bag_access.h"
 #include "spdlog/fmt/fmt.h"
 #include "config/configor.h"
 #include "ikalibr/SbgImuData.h"
@@ -106,7 +107,7 @@ SensorIMULoader::Ptr SensorIMULoader::Create(IMUModelType imuModel,
 
 IMUFrame::Ptr SensorIMULoader::UnpackFrame(const rosbag::MessageInstance &msgInstance) {
     // imu data item
-    sensor_msgs::ImuConstPtr msg = msgInstance.instantiate<sensor_msgs::Imu>();
+    sensor_msgs::ImuConstPtr msg = BagAccess::Instantiate<sensor_msgs::Imu>(msgInstance);
 
     CheckMessage<sensor_msgs::Imu>(msg);
 
@@ -132,7 +133,7 @@ SbgIMULoader::Ptr SbgIMULoader::Create(IMUModelType imuModel) {
 
 IMUFrame::Ptr SbgIMULoader::UnpackFrame(const rosbag::MessageInstance &msgInstance) {
     // imu data item
-    ikalibr::SbgImuData::ConstPtr msg = msgInstance.instantiate<ikalibr::SbgImuData>();
+    ikalibr::SbgImuData::ConstPtr msg = BagAccess::Instantiate<ikalibr::SbgImuData>(msgInstance);
 
     CheckMessage<ikalibr::SbgImuData>(msg);
 
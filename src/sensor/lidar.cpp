@@ -44,21 +44,138 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 
 namespace ns_ikalibr {
 
-LiDARFrame::LiDARFrame(double timestamp, IKalibrPointCloud::Ptr scan)
+// ---------
+// LiDARScan
+// ---------
+
+LiDARScan::LiDARScan(double baseTime)
+    : _baseTime(baseTime),
+      _width(0),
+      _height(1),
+      _isDense(true) {}
+
+LiDARScan::Ptr LiDARScan::Create(double baseTime) { return std::make_shared<LiDARScan>(baseTime); }
+
+LiDARScan::Ptr LiDARScan::FromPCL(const IKalibrPointCloud &cloud, double baseTime) {
+    auto scan = LiDARScan::Create(baseTime);
+    const std::size_t size = cloud.size();
+    scan->_x.resize(size), scan->_y.resize(size), scan->_z.resize(size), scan->_dt.resize(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        const auto &p = cloud.points[i];
+        scan->_x[i] = p.x, scan->_y[i] = p.y, scan->_z[i] = p.z;
+        scan->_dt[i] = static_cast<float>(p.timestamp - baseTime);
+    }
+    scan->_width = cloud.width, scan->_height = cloud.height;
+    scan->_isDense = cloud.is_dense;
+    return scan;
+}
+
+IKalibrPointCloud::Ptr LiDARScan::ToPCL() const {
+    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud);
+    cloud->resize(Size());
+    for (std::size_t i = 0; i < Size(); ++i) {
+        auto &p = cloud->points[i];
+        p.x = _x[i], p.y = _y[i], p.z = _z[i];
+        p.timestamp = GetTimestamp(i);
+    }
+    cloud->width = _width, cloud->height = _height;
+    cloud->is_dense = _isDense;
+    return cloud;
+}
+
+void LiDARScan::Resize(std::uint32_t width, std::uint32_t height) {
+    const std::size_t size = static_cast<std::size_t>(width) * height;
+    _x.assign(size, NAN), _y.assign(size, NAN), _z.assign(size, NAN), _dt.assign(size, 0.0f);
+    _width = width, _height = height;
+}
+
+void LiDARScan::Reserve(std::size_t size) {
+    _x.reserve(size), _y.reserve(size), _z.reserve(size), _dt.reserve(size);
+}
+
+void LiDARScan::PushBack(float x, float y, float z, double timestamp) {
+    _x.push_back(x), _y.push_back(y), _z.push_back(z);
+    _dt.push_back(static_cast<float>(timestamp - _baseTime));
+    _width = static_cast<std::uint32_t>(_x.size()), _height = 1;
+}
+
+void LiDARScan::SetPoint(std::size_t idx, float x, float y, float z, double timestamp) {
+    _x[idx] = x, _y[idx] = y, _z[idx] = z;
+    _dt[idx] = static_cast<float>(timestamp - _baseTime);
+}
+
+std::size_t LiDARScan::Size() const { return _x.size(); }
+
+bool LiDARScan::Empty() const { return _x.empty(); }
+
+std::uint32_t LiDARScan::GetWidth() const { return _width; }
+
+std::uint32_t LiDARScan::GetHeight() const { return _height; }
+
+bool LiDARScan::IsDense() const { return _isDense; }
+
+void LiDARScan::SetDense(bool isDense) { _isDense = isDense; }
+
+double LiDARScan::GetBaseTime() const { return _baseTime; }
+
+void LiDARScan::ShiftTime(double dt) { _baseTime += dt; }
+
+void LiDARScan::Transform(const Eigen::Matrix4f &trans) {
+    const Eigen::Matrix3f rot = trans.topLeftCorner<3, 3>();
+    const Eigen::Vector3f pos = trans.topRightCorner<3, 1>();
+    for (std::size_t i = 0; i < Size(); ++i) {
+        const Eigen::Vector3f p = rot * Eigen::Vector3f(_x[i], _y[i], _z[i]) + pos;
+        _x[i] = p(0), _y[i] = p(1), _z[i] = p(2);
+    }
+}
+
+const std::vector<float> &LiDARScan::GetX() const { return _x; }
+
+const std::vector<float> &LiDARScan::GetY() const { return _y; }
+
+const std::vector<float> &LiDARScan::GetZ() const { return _z; }
+
+const std::vector<float> &LiDARScan::GetTimeOffsets() const { return _dt; }
+
+std::vector<float> &LiDARScan::GetX() { return _x; }
+
+std::vector<float> &LiDARScan::GetY() { return _y; }
+
+std::vector<float> &LiDARScan::GetZ() { return _z; }
+
+std::vector<float> &LiDARScan::GetTimeOffsets() { return _dt; }
+
+double LiDARScan::GetTimestamp(std::size_t idx) const { return _baseTime + _dt[idx]; }
+
+bool LiDARScan::IsValid(std::size_t idx) const {
+    return !std::isnan(_x[idx]) && !std::isnan(_y[idx]) && !std::isnan(_z[idx]);
+}
+
+// ----------
+// LiDARFrame
+// ----------
+
+LiDARFrame::LiDARFrame(double timestamp, LiDARScan::Ptr scan)
     : _timestamp(timestamp),
       _scan(std::move(scan)) {}
 
-LiDARFrame::Ptr LiDARFrame::Create(double timestamp, const IKalibrPointCloud::Ptr &scan) {
+LiDARFrame::Ptr LiDARFrame::Create(double timestamp, const LiDARScan::Ptr &scan) {
     return std::make_shared<LiDARFrame>(timestamp, scan);
 }
 
-IKalibrPointCloud::Ptr LiDARFrame::GetScan() const { return this->_scan; }
+LiDARFrame::Ptr LiDARFrame::Create(double timestamp, const IKalibrPointCloud::Ptr &scan) {
+    return std::make_shared<LiDARFrame>(timestamp, LiDARScan::FromPCL(*scan, timestamp));
+}
+
+IKalibrPointCloud::Ptr LiDARFrame::GetScan() const { return _scan->ToPCL(); }
+
+const LiDARScan::Ptr &LiDARFrame::GetCompactScan() const { return _scan; }
 
 double LiDARFrame::GetTimestamp() const { return _timestamp; }
 
 std::ostream &operator<<(std::ostream &os, const LiDARFrame &frame) {
-    os << "size: " << frame._scan->size() << ", width: " << frame._scan->width
-       << ", height: " << frame._scan->height << ", timestamp: " << frame._timestamp;
+    os << "size: " << frame._scan->Size() << ", width: " << frame._scan->GetWidth()
+       << ", height: " << frame._scan->GetHeight() << ", timestamp: " << frame._timestamp;
     return os;
 }
 
@@ -38,12 +38,14 @@
 
 #include "sensor/lidar_data_loader.h"
 #include "ikalibr/LivoxCustomMsg.h"
-#include "sensor_msgs/PointCloud2.h"
 #include "spdlog/spdlog.h"
 #include "util/status.hpp"
+#include "util/bag_access.h"
 #include "velodyne_msgs/VelodynePacket.h"
 #include "velodyne_pointcloud/pointcloudXYZIRT.h"
 #include "velodyne_pointcloud/rawdata.h"
+#include "config/configor.h"
+#include "cstring"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -84,6 +86,125 @@ LiDARDataLoader::Ptr LiDARDataLoader::GetLoader(const std::string &lidarModelStr
 
 LidarModelType LiDARDataLoader::GetLiDARModel() const { return _lidarModel; }
 
+/**
+ * load a numeric field of a 'sensor_msgs::PointCloud2' point as a double, the data buffer is not
+ * guaranteed to be aligned, thus 'memcpy' is used
+ */
+static double LoadPointField(const std::uint8_t *data, std::uint8_t datatype) {
+    auto Load = [data](auto typeTag) {
+        decltype(typeTag) val;
+        std::memcpy(&val, data, sizeof(val));
+        return static_cast<double>(val);
+    };
+    switch (datatype) {
+        case sensor_msgs::PointField::INT8:
+            return Load(std::int8_t{});
+        case sensor_msgs::PointField::UINT8:
+            return Load(std::uint8_t{});
+        case sensor_msgs::PointField::INT16:
+            return Load(std::int16_t{});
+        case sensor_msgs::PointField::UINT16:
+            return Load(std::uint16_t{});
+        case sensor_msgs::PointField::INT32:
+            return Load(std::int32_t{});
+        case sensor_msgs::PointField::UINT32:
+            return Load(std::uint32_t{});
+        case sensor_msgs::PointField::FLOAT32:
+            return Load(float{});
+        case sensor_msgs::PointField::FLOAT64:
+            return Load(double{});
+        default:
+            throw Status(Status::CRITICAL,
+                         "unknown data type '{}' of the field in 'sensor_msgs::PointCloud2'!",
+                         static_cast<int>(datatype));
+    }
+}
+
+LiDARFrame::Ptr LiDARDataLoader::ParsePointCloud2(const sensor_msgs::PointCloud2 &msg,
+                                                  const std::string &timeField,
+                                                  double timeScale,
+                                                  bool absoluteTime,
+                                                  float minRange,
+                                                  float maxRange) const {
+    const std::string modelStr(EnumCast::enumToString(GetLiDARModel()));
+    if (msg.is_bigendian) {
+        throw Status(Status::CRITICAL,
+                     "big-endian 'sensor_msgs::PointCloud2' messages are not supported for lidar "
+                     "model '{}'!",
+                     modelStr);
+    }
+    if (msg.data.size() < static_cast<std::size_t>(msg.row_step) * msg.height) {
+        throw Status(Status::CRITICAL,
+                     "the data buffer of the 'sensor_msgs::PointCloud2' message is truncated!");
+    }
+
+    // find the offsets of fields
+    const sensor_msgs::PointField *xField = nullptr, *yField = nullptr, *zField = nullptr,
+                                  *tField = nullptr;
+    for (const auto &field : msg.fields) {
+        if (field.name == "x") {
+            xField = &field;
+        } else if (field.name == "y") {
+            yField = &field;
+        } else if (field.name == "z") {
+            zField = &field;
+        } else if (field.name == timeField) {
+            tField = &field;
+        }
+    }
+    for (const auto &[field, name] : {std::pair{xField, std::string("x")},
+                                      std::pair{yField, std::string("y")},
+                                      std::pair{zField, std::string("z")},
+                                      std::pair{tField, timeField}}) {
+        if (field == nullptr) {
+            throw Status(Status::CRITICAL,
+                         "field '{}' is missing in the 'sensor_msgs::PointCloud2' message for "
+                         "lidar model '{}'!",
+                         name, modelStr);
+        }
+        // positions should be stored as float32 ones, while the time field could be any numeric
+        const bool isPosField = name != timeField;
+        if (field->count != 1 ||
+            (isPosField && field->datatype != sensor_msgs::PointField::FLOAT32)) {
+            throw Status(Status::CRITICAL,
+                         "field '{}' of the 'sensor_msgs::PointCloud2' message for lidar model "
+                         "'{}' has an unsupported layout!",
+                         name, modelStr);
+        }
+    }
+    const std::uint32_t xOff = xField->offset, yOff = yField->offset, zOff = zField->offset;
+    const std::uint32_t tOff = tField->offset;
+    const std::uint8_t tType = tField->datatype;
+
+    const double timebase = msg.header.stamp.toSec();
+    const double timeShift = absoluteTime ? 0.0 : timebase;
+
+    auto scan = LiDARScan::Create(timebase);
+    scan->Reserve(static_cast<std::size_t>(msg.width) * msg.height);
+    scan->SetDense(false);
+
+    const float minRange2 = minRange * minRange, maxRange2 = maxRange * maxRange;
+    for (std::uint32_t row = 0; row < msg.height; ++row) {
+        const std::uint8_t *ptr = msg.data.data() + static_cast<std::size_t>(row) * msg.row_step;
+        for (std::uint32_t col = 0; col < msg.width; ++col, ptr += msg.point_step) {
+            float x, y, z;
+            std::memcpy(&x, ptr + xOff, sizeof(float));
+            std::memcpy(&y, ptr + yOff, sizeof(float));
+            std::memcpy(&z, ptr + zOff, sizeof(float));
+
+            // comparisons with NaN are always false, thus invalid points are dropped here as well
+            const float range2 = x * x + y * y + z * z;
+            if (!(range2 >= minRange2 && range2 <= maxRange2)) {
+                continue;
+            }
+            // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
+            scan->PushBack(x, y, z, timeShift + LoadPointField(ptr + tOff, tType) * timeScale);
+        }
+    }
+
+    return LiDARFrame::Create(timebase, scan);
+}
+
 // ----------
 // Velodyne16
 // ----------
@@ -99,7 +220,7 @@ Velodyne16::Ptr Velodyne16::Create(LidarModelType lidarModel) {
 LiDARFrame::Ptr Velodyne16::UnpackScan(const rosbag::MessageInstance &msgInstance) {
     if (_lidarModel == LidarModelType::VLP_16_PACKET) {
         velodyne_msgs::VelodyneScan::ConstPtr scanMsg =
-            msgInstance.instantiate<velodyne_msgs::VelodyneScan>();
+            BagAccess::Instantiate<velodyne_msgs::VelodyneScan>(msgInstance);
         CheckMessage<velodyne_msgs::VelodyneScan>(scanMsg);
         return UnpackScan(scanMsg);
     } else {
@@ -111,116 +232,120 @@ LiDARFrame::Ptr Velodyne16::UnpackScan(const rosbag::MessageInstance &msgInstanc
 
 LiDARFrame::Ptr Velodyne16::UnpackScan(
     const velodyne_msgs::VelodyneScan::ConstPtr &lidarMsg) const {
-    LiDARFrame::Ptr output = LiDARFrame::Create(lidarMsg->header.stamp.toSec());
-
-    // point cloud
-    auto scan = output->GetScan();
-    scan->height = 16;
-    scan->width = 24 * (int)lidarMsg->packets.size();
-    scan->is_dense = false;
-    scan->resize(scan->height * scan->width);
-    for (auto &p : scan->points) {
-        SET_POS_NAN(p)
+    const double scanTimestamp = lidarMsg->header.stamp.toSec();
+    LiDARFrame::Ptr output = LiDARFrame::Create(scanTimestamp);
+
+    // point cloud, all points are initialized as invalid ones
+    const auto &scan = output->GetCompactScan();
+    const int packetCount = static_cast<int>(lidarMsg->packets.size());
+    scan->Resize(2 * BLOCKS_PER_PACKET * packetCount, 16);
+    scan->SetDense(false);
+
+    // each packet owns its '2 * BLOCKS_PER_PACKET' columns of the scan, thus packets are decoded
+    // in parallel without any synchronization
+    auto &scanRef = *scan;
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) schedule(static) \
+    default(none) shared(lidarMsg, packetCount, scanTimestamp, scanRef)
+    for (int i = 0; i < packetCount; ++i) {
+        UnpackPacket(lidarMsg->packets[i], i * BLOCKS_PER_PACKET, scanTimestamp, scanRef);
     }
 
-    int blockCounter = 0;
-
-    double scanTimestamp = lidarMsg->header.stamp.toSec();
+    return output;
+}
 
-    for (const auto &packet : lidarMsg->packets) {
-        float azimuth;
+void Velodyne16::UnpackPacket(const velodyne_msgs::VelodynePacket &packet,
+                              int blockCounter,
+                              double scanTimestamp,
+                              LiDARScan &scan) const {
+    const auto *raw = (const RAW_PACKET_T *)&packet.data[0];
+    const std::size_t width = scan.GetWidth();
+
+    float lastAzimuthDiff = 0;
+    // per-laser buffers of a firing, which are filled in vectorizable loops
+    float distance[16], xs[16], ys[16], zs[16];
+    int azimuthCorrected[16];
+    bool inAngleRange[16];
+
+    for (int block = 0; block < BLOCKS_PER_PACKET; block++, blockCounter++) {
+        // Calculate difference between current and next block's azimuth angle.
+        const auto azimuth = (float)(raw->blocks[block].rotation);
         float azimuthDiff;
-        float lastAzimuthDiff = 0;
-        float azimuthCorrectedF;
-        int azimuthCorrected;
-        float x, y, z;
-
-        const auto *raw = (const RAW_PACKET_T *)&packet.data[0];
-
-        for (int block = 0; block < BLOCKS_PER_PACKET; block++, blockCounter++) {
-            // Calculate difference between current and next block's azimuth angle.
-            azimuth = (float)(raw->blocks[block].rotation);
-
-            if (block < (BLOCKS_PER_PACKET - 1)) {
-                azimuthDiff = (float)((ROTATION_MAX_UNITS + raw->blocks[block + 1].rotation -
-                                       raw->blocks[block].rotation) %
-                                      ROTATION_MAX_UNITS);
-                lastAzimuthDiff = azimuthDiff;
-            } else {
-                azimuthDiff = lastAzimuthDiff;
-            }
 
-            for (int firing = 0, k = 0; firing < FIRINGS_PER_BLOCK; firing++) {
-                for (int dsr = 0; dsr < SCANS_PER_FIRING; dsr++, k += RAW_SCAN_SIZE) {
-                    /** Position Calculation */
-                    union TwoBytes tmp {};
-                    tmp.bytes[0] = raw->blocks[block].data[k];
-                    tmp.bytes[1] = raw->blocks[block].data[k + 1];
-
-                    /** correct for the laser rotation as a function of timing during
-                     * the firings **/
-                    azimuthCorrectedF =
-                        azimuth + (azimuthDiff *
-                                   (((float)dsr * DSR_TOFFSET) + ((float)firing * FIRING_TOFFSET)) /
-                                   BLOCK_TDURATION);
-
-                    azimuthCorrected = ((int)round(azimuthCorrectedF)) % ROTATION_MAX_UNITS;
+        if (block < (BLOCKS_PER_PACKET - 1)) {
+            azimuthDiff = (float)((ROTATION_MAX_UNITS + raw->blocks[block + 1].rotation -
+                                   raw->blocks[block].rotation) %
+                                  ROTATION_MAX_UNITS);
+            lastAzimuthDiff = azimuthDiff;
+        } else {
+            azimuthDiff = lastAzimuthDiff;
+        }
 
-                    /*condition added to avoid calculating points which are not
+        for (int firing = 0; firing < FIRINGS_PER_BLOCK; firing++) {
+            const std::uint8_t *data =
+                raw->blocks[block].data + firing * SCANS_PER_FIRING * RAW_SCAN_SIZE;
+            const float *dsrTOffset = FIRING_DSR_TOFFSET[firing];
+
+            // attention: all floating-point expressions are kept in the same order as the
+            // per-point decoder, so that the output is bit-identical
+#pragma omp simd
+            for (int dsr = 0; dsr < 16; dsr++) {
+                /** Position Calculation, two bytes in little-endian */
+                const auto rawDistance = static_cast<std::uint16_t>(
+                    data[dsr * RAW_SCAN_SIZE] | (data[dsr * RAW_SCAN_SIZE + 1] << 8));
+                distance[dsr] = (float)rawDistance * DISTANCE_RESOLUTION;
+
+                /** correct for the laser rotation as a function of timing during the firings **/
+                const float azimuthCorrectedF =
+                    azimuth + (azimuthDiff * dsrTOffset[dsr] / BLOCK_TDURATION);
+                azimuthCorrected[dsr] = ((int)round(azimuthCorrectedF)) % ROTATION_MAX_UNITS;
+
+                /*condition added to avoid calculating points which are not
                   in the interesting defined area (minAngle < area < maxAngle)*/
-                    if ((azimuthCorrected >= CONFIG.minAngle &&
-                         azimuthCorrected <= CONFIG.maxAngle &&
-                         CONFIG.minAngle < CONFIG.maxAngle) ||
-                        (CONFIG.minAngle > CONFIG.maxAngle &&
-                         (azimuthCorrected <= CONFIG.maxAngle ||
-                          azimuthCorrected >= CONFIG.minAngle))) {
-                        // convert polar coordinates to Euclidean XYZ
-                        float distance = (float)tmp.uint * DISTANCE_RESOLUTION;
-
-                        float cos_vert_angle = COS_VERT_ANGLE[dsr];
-                        float sin_vert_angle = SIN_VERT_ANGLE[dsr];
-
-                        float cos_rot_angle = COS_ROT_TABLE[azimuthCorrected];
-                        float sin_rot_angle = SIN_ROT_TABLE[azimuthCorrected];
-
-                        x = distance * cos_vert_angle * sin_rot_angle;
-                        y = distance * cos_vert_angle * cos_rot_angle;
-                        z = distance * sin_vert_angle;
-
-                        /** Use standard ROS coordinate system (right-hand rule) */
-                        float x_coord = y;
-                        float y_coord = -x;
-                        float z_coord = z;
-
-                        // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT'
-                        // here float intensity = raw->blocks[block].data[k + 2];
-                        double point_timestamp =
-                            scanTimestamp + GetExactTime(dsr, 2 * blockCounter + firing);
-
-                        IKalibrPoint point_xyz;
-                        point_xyz.timestamp = point_timestamp;
-
-                        if (PointInRange(distance)) {
-                            point_xyz.x = x_coord;
-                            point_xyz.y = y_coord;
-                            point_xyz.z = z_coord;
-                            // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT'
-                            // here point_xyz.intensity = intensity;
-                        } else {
-                            SET_POS_NAN(point_xyz)
-                        }
-
-                        scan->at(2 * blockCounter + firing, SCAN_MAPPING_16[dsr]) = point_xyz;
-                    }
+                inAngleRange[dsr] = (azimuthCorrected[dsr] >= CONFIG.minAngle &&
+                                     azimuthCorrected[dsr] <= CONFIG.maxAngle &&
+                                     CONFIG.minAngle < CONFIG.maxAngle) ||
+                                    (CONFIG.minAngle > CONFIG.maxAngle &&
+                                     (azimuthCorrected[dsr] <= CONFIG.maxAngle ||
+                                      azimuthCorrected[dsr] >= CONFIG.minAngle));
+
+                // convert polar coordinates to Euclidean XYZ, the corrected azimuth is always
+                // in [0, ROTATION_MAX_UNITS), thus the table lookup is safe for all lanes
+                const float cos_rot_angle = COS_ROT_TABLE[azimuthCorrected[dsr]];
+                const float sin_rot_angle = SIN_ROT_TABLE[azimuthCorrected[dsr]];
+
+                xs[dsr] = distance[dsr] * COS_VERT_ANGLE[dsr] * sin_rot_angle;
+                ys[dsr] = distance[dsr] * COS_VERT_ANGLE[dsr] * cos_rot_angle;
+                zs[dsr] = distance[dsr] * SIN_VERT_ANGLE[dsr];
+            }
+
+            const int col = 2 * blockCounter + firing;
+            for (int dsr = 0; dsr < 16; dsr++) {
+                if (!inAngleRange[dsr]) {
+                    continue;
+                }
+                // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
+                double point_timestamp = scanTimestamp + GetExactTime(dsr, col);
+                const std::size_t idx = SCAN_MAPPING_16[dsr] * width + col;
+
+                if (PointInRange(distance[dsr])) {
+                    /** Use standard ROS coordinate system (right-hand rule) */
+                    scan.SetPoint(idx, ys[dsr], -xs[dsr], zs[dsr], point_timestamp);
+                } else {
+                    scan.SetPoint(idx, NAN, NAN, NAN, point_timestamp);
                 }
             }
         }
     }
-
-    return output;
 }
 
-double Velodyne16::GetExactTime(int dsr, int firing) const { return VLP16_TIME_BLOCK[firing][dsr]; }
+double Velodyne16::GetExactTime(int dsr, int firing) const {
+    if (firing < TIME_BLOCK_COLS) {
+        return VLP16_TIME_BLOCK[firing][dsr];
+    } else {
+        // scans with more packets than the table covers, computed in the same way as the table
+        return dsr * 2.304 * 1e-6 + firing * 55.296 * 1e-6;
+    }
+}
 
 void Velodyne16::SetParameters() {
     CONFIG.maxRange = 150;
@@ -251,6 +376,13 @@ void Velodyne16::SetParameters() {
         SIN_VERT_ANGLE[i] = std::sin(vertCorrection[i]);
     }
 
+    for (int firing = 0; firing < FIRINGS_PER_BLOCK; firing++) {
+        for (int dsr = 0; dsr < SCANS_PER_FIRING; dsr++) {
+            FIRING_DSR_TOFFSET[firing][dsr] =
+                ((float)dsr * DSR_TOFFSET) + ((float)firing * FIRING_TOFFSET);
+        }
+    }
+
     SCAN_MAPPING_16[15] = 0;
     SCAN_MAPPING_16[13] = 1;
     SCAN_MAPPING_16[11] = 2;
@@ -269,7 +401,7 @@ void Velodyne16::SetParameters() {
     SCAN_MAPPING_16[2] = 14;
     SCAN_MAPPING_16[0] = 15;
 
-    for (unsigned int w = 0; w < 1824; w++) {
+    for (unsigned int w = 0; w < TIME_BLOCK_COLS; w++) {
         for (unsigned int h = 0; h < 16; h++) {
             VLP16_TIME_BLOCK[w][h] = h * 2.304 * 1e-6 + w * 55.296 * 1e-6;  //  16*1824
         }
@@ -292,43 +424,12 @@ VelodynePoints::Ptr VelodynePoints::Create(LidarModelType lidarModel) {
 
 LiDARFrame::Ptr VelodynePoints::UnpackScan(const rosbag::MessageInstance &msgInstance) {
     sensor_msgs::PointCloud2::ConstPtr lidarMsg =
-        msgInstance.instantiate<sensor_msgs::PointCloud2>();
+        BagAccess::Instantiate<sensor_msgs::PointCloud2>(msgInstance);
 
     CheckMessage<sensor_msgs::PointCloud2>(lidarMsg);
 
-    PosIRTPointCloud pcIn;
-    pcl::fromROSMsg(*lidarMsg, pcIn);
-
-    double timebase = lidarMsg->header.stamp.toSec();
-
-    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud());
-    cloud->is_dense = false;
-    cloud->resize(pcIn.size());
-
-    std::size_t j = 0;
-    for (const auto &src : pcIn) {
-        if (IS_POS_NAN(src)) {
-            continue;
-        }
-
-        double depth = sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-
-        if (depth > 200 || depth < 1) {
-            continue;
-        } else {
-            IKalibrPoint dstPoint;
-            dstPoint.x = src.x;
-            dstPoint.y = src.y;
-            dstPoint.z = src.z;
-            dstPoint.timestamp = timebase + src.time;
-            // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-            // dstPoint.intensity = src.intensity;
-            cloud->at(j++) = dstPoint;
-        }
-    }
-    cloud->resize(j);
-
-    return LiDARFrame::Create(timebase, cloud);
+    // field 'time' [float32]: relative time in seconds
+    return ParsePointCloud2(*lidarMsg, "time", 1.0, false, 1.0f, 200.0f);
 }
 
 // -----------
@@ -343,43 +444,12 @@ OusterLiDAR::Ptr OusterLiDAR::Create(LidarModelType lidarModel) {
 
 LiDARFrame::Ptr OusterLiDAR::UnpackScan(const rosbag::MessageInstance &msgInstance) {
     sensor_msgs::PointCloud2::ConstPtr lidarMsg =
-        msgInstance.instantiate<sensor_msgs::PointCloud2>();
+        BagAccess::Instantiate<sensor_msgs::PointCloud2>(msgInstance);
 
     CheckMessage<sensor_msgs::PointCloud2>(lidarMsg);
 
-    OusterPointCloud pcIn;
-    pcl::fromROSMsg(*lidarMsg, pcIn);
-
-    double timebase = lidarMsg->header.stamp.toSec();
-
-    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud());
-    cloud->is_dense = false;
-    cloud->resize(pcIn.size());
-
-    std::size_t j = 0;
-    for (const auto &src : pcIn) {
-        if (IS_POS_NAN(src)) {
-            continue;
-        }
-
-        double depth = sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-
-        if (depth > 60 || depth < 1) {
-            continue;
-        } else {
-            IKalibrPoint dstPoint;
-            dstPoint.x = src.x;
-            dstPoint.y = src.y;
-            dstPoint.z = src.z;
-            dstPoint.timestamp = timebase + static_cast<double>(src.t) * 1E-9;
-            // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-            // dstPoint.intensity = src.intensity;
-            cloud->at(j++) = dstPoint;
-        }
-    }
-    cloud->resize(j);
-
-    return LiDARFrame::Create(timebase, cloud);
+    // field 't' [uint32]: relative time in nanoseconds
+    return ParsePointCloud2(*lidarMsg, "t", 1E-9, false, 1.0f, 60.0f);
 }
 
 // -------------
@@ -394,44 +464,12 @@ PandarXTLiDAR::Ptr PandarXTLiDAR::Create(LidarModelType lidarModel) {
 
 LiDARFrame::Ptr PandarXTLiDAR::UnpackScan(const rosbag::MessageInstance &msgInstance) {
     sensor_msgs::PointCloud2::ConstPtr lidarMsg =
-        msgInstance.instantiate<sensor_msgs::PointCloud2>();
+        BagAccess::Instantiate<sensor_msgs::PointCloud2>(msgInstance);
 
     CheckMessage<sensor_msgs::PointCloud2>(lidarMsg);
 
-    PandarPointCloud pcIn;
-    pcl::fromROSMsg(*lidarMsg, pcIn);
-
-    double timebase = lidarMsg->header.stamp.toSec();
-
-    /// point cloud
-    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud);
-    cloud->is_dense = false;
-    cloud->resize(pcIn.size());
-
-    std::size_t j = 0;
-    for (const auto &src : pcIn) {
-        if (IS_POS_NAN(src)) {
-            continue;
-        }
-
-        double depth = sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-
-        if (depth > 100 || depth < 1) {
-            continue;
-        } else {
-            IKalibrPoint dstPoint;
-            dstPoint.x = src.x;
-            dstPoint.y = src.y;
-            dstPoint.z = src.z;
-            dstPoint.timestamp = src.timestamp;
-            // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-            // dstPoint.intensity = src.intensity;
-            cloud->at(j++) = dstPoint;
-        }
-    }
-    cloud->resize(j);
-
-    return LiDARFrame::Create(timebase, cloud);
+    // field 'timestamp' [float64]: absolute time in seconds
+    return ParsePointCloud2(*lidarMsg, "timestamp", 1.0, true, 1.0f, 100.0f);
 }
 
 // ----------
@@ -445,40 +483,33 @@ LivoxLiDAR::Ptr LivoxLiDAR::Create(LidarModelType lidarModel) {
 }
 
 LiDARFrame::Ptr LivoxLiDAR::UnpackScan(const rosbag::MessageInstance &msgInstance) {
-    ikalibr::LivoxCustomMsg::ConstPtr lidarMsg = msgInstance.instantiate<ikalibr::LivoxCustomMsg>();
+    ikalibr::LivoxCustomMsg::ConstPtr lidarMsg =
+        BagAccess::Instantiate<ikalibr::LivoxCustomMsg>(msgInstance);
 
     CheckMessage<ikalibr::LivoxCustomMsg>(lidarMsg);
 
     // from nanosecond to second
     double timebase = lidarMsg->header.stamp.toSec();
 
-    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud);
-    cloud->resize(lidarMsg->point_num);
-    std::size_t j = 0;
+    // the custom message is deserialized by roscpp, points are written into the compact scan
+    // directly, with the range filter fused in
+    auto scan = LiDARScan::Create(timebase);
+    scan->Reserve(lidarMsg->points.size());
 
+    constexpr float minRange2 = 1.0f * 1.0f, maxRange2 = 100.0f * 100.0f;
     for (const auto &src : lidarMsg->points) {
-        if (IS_POS_NAN(src)) {
+        // comparisons with NaN are always false, thus invalid points are dropped here as well
+        const float range2 = src.x * src.x + src.y * src.y + src.z * src.z;
+        if (!(range2 >= minRange2 && range2 <= maxRange2)) {
             continue;
         }
-
-        double depth = std::sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-
-        if (depth > 100 || depth < 1) {
-            continue;
-        } else {
-            IKalibrPoint dstPoint;
-            dstPoint.x = src.x;
-            dstPoint.y = src.y;
-            dstPoint.z = src.z;
-            dstPoint.timestamp = timebase + static_cast<double>(src.offset_time) * 1E-9;
-            // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-            // dstPoint.intensity = src.reflectivity;
-            cloud->at(j++) = dstPoint;
-        }
+        // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
+        // dstPoint.intensity = src.reflectivity;
+        scan->PushBack(src.x, src.y, src.z,
+                       timebase + static_cast<double>(src.offset_time) * 1E-9);
     }
-    cloud->resize(j);
 
-    return LiDARFrame::Create(timebase, cloud);
+    return LiDARFrame::Create(timebase, scan);
 }
 
 }  // namespace ns_ikalibr
\ No newline at end of file
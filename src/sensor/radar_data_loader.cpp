@@ -37,6 +37,7 @@
 #include "ikalibr/AWR1843RadarScan.h"
 #include "ikalibr/AWR1843RadarScanCustom.h"
 #include "util/status.hpp"
+#include "util/bag_access.h"
 #include "sensor_msgs/PointCloud2.h"
 #include "pcl_conversions/pcl_conversions.h"
 #include "spdlog/fmt/fmt.h"
@@ -99,7 +100,7 @@ AinsteinRadarLoader::Ptr AinsteinRadarLoader::Create(RadarModelType radarModel)
 
 RadarTargetArray::Ptr AinsteinRadarLoader::UnpackScan(const rosbag::MessageInstance &msgInstance) {
     ikalibr::AinsteinRadarTargetArray::ConstPtr msg =
-        msgInstance.instantiate<ikalibr::AinsteinRadarTargetArray>();
+        BagAccess::Instantiate<ikalibr::AinsteinRadarTargetArray>(msgInstance);
 
     CheckMessage<ikalibr::AinsteinRadarTargetArray>(msg);
 
@@ -132,7 +133,8 @@ AWR1843BOOSTRawLoader::Ptr AWR1843BOOSTRawLoader::Create(RadarModelType radarMod
 RadarTargetArray::Ptr AWR1843BOOSTRawLoader::UnpackScan(
     const rosbag::MessageInstance &msgInstance) {
     // for ti mm wave radar, every event saved singly
-    ikalibr::AWR1843RadarScan::ConstPtr msg = msgInstance.instantiate<ikalibr::AWR1843RadarScan>();
+    ikalibr::AWR1843RadarScan::ConstPtr msg =
+        BagAccess::Instantiate<ikalibr::AWR1843RadarScan>(msgInstance);
 
     CheckMessage<ikalibr::AWR1843RadarScan>(msg);
 
@@ -163,7 +165,8 @@ PointCloud2POSVLoader::Ptr PointCloud2POSVLoader::Create(RadarModelType radarMod
 
 RadarTargetArray::Ptr PointCloud2POSVLoader::UnpackScan(
     const rosbag::MessageInstance &msgInstance) {
-    sensor_msgs::PointCloud2::ConstPtr msg = msgInstance.instantiate<sensor_msgs::PointCloud2>();
+    sensor_msgs::PointCloud2::ConstPtr msg =
+        BagAccess::Instantiate<sensor_msgs::PointCloud2>(msgInstance);
 
     CheckMessage<sensor_msgs::PointCloud2>(msg);
 
@@ -202,7 +205,8 @@ PointCloud2POSIVLoader::Ptr PointCloud2POSIVLoader::Create(RadarModelType radarM
 
 RadarTargetArray::Ptr PointCloud2POSIVLoader::UnpackScan(
     const rosbag::MessageInstance &msgInstance) {
-    sensor_msgs::PointCloud2::ConstPtr msg = msgInstance.instantiate<sensor_msgs::PointCloud2>();
+    sensor_msgs::PointCloud2::ConstPtr msg =
+        BagAccess::Instantiate<sensor_msgs::PointCloud2>(msgInstance);
 
     CheckMessage<sensor_msgs::PointCloud2>(msg);
 
@@ -243,7 +247,7 @@ RadarTargetArray::Ptr AWR1843BOOSTCustomLoader::UnpackScan(
     const rosbag::MessageInstance &msgInstance) {
     // for ti mm wave radar, every event saved singly
     ikalibr::AWR1843RadarScanCustom::ConstPtr msg =
-        msgInstance.instantiate<ikalibr::AWR1843RadarScanCustom>();
+        BagAccess::Instantiate<ikalibr::AWR1843RadarScanCustom>(msgInstance);
 
     CheckMessage<ikalibr::AWR1843RadarScanCustom>(msg);
 
@@ -274,7 +278,8 @@ PointCloud2XRIOLoader::Ptr PointCloud2XRIOLoader::Create(RadarModelType radarMod
 
 RadarTargetArray::Ptr PointCloud2XRIOLoader::UnpackScan(
     const rosbag::MessageInstance &msgInstance) {
-    sensor_msgs::PointCloud2::ConstPtr msg = msgInstance.instantiate<sensor_msgs::PointCloud2>();
+    sensor_msgs::PointCloud2::ConstPtr msg =
+        BagAccess::Instantiate<sensor_msgs::PointCloud2>(msgInstance);
 
     CheckMessage<sensor_msgs::PointCloud2>(msg);
 
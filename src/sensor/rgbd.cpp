@@ -43,6 +43,28 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 
 namespace ns_ikalibr {
 
+/**
+ * traverse raw depths of a depth image, which is either a native 16-bit one or a float one, the
+ * 'func' is called as 'func(row, col, rawDepth)'
+ */
+template <typename Func>
+void ForEachRawDepth(const cv::Mat& depthImg, Func func) {
+    auto Traverse = [&depthImg, &func](auto depthTypeTag) {
+        using DepthType = decltype(depthTypeTag);
+        for (int row = 0; row < depthImg.rows; ++row) {
+            auto dData = depthImg.ptr<DepthType>(row);
+            for (int col = 0; col < depthImg.cols; ++col) {
+                func(row, col, static_cast<float>(dData[col]));
+            }
+        }
+    };
+    if (depthImg.type() == CV_16UC1) {
+        Traverse(ushort{});
+    } else {
+        Traverse(float{});
+    }
+}
+
 // ---------
 // RGBDFrame
 // ---------
@@ -77,6 +99,14 @@ RGBDFrame::Ptr RGBDFrame::Create(double timestamp,
 
 cv::Mat& RGBDFrame::GetDepthImage() { return _depthImg; }
 
+float RGBDFrame::RawDepth(const cv::Mat& depthImg, int row, int col) {
+    if (depthImg.type() == CV_16UC1) {
+        return static_cast<float>(depthImg.at<ushort>(row, col));
+    } else {
+        return depthImg.at<float>(row, col);
+    }
+}
+
 void RGBDFrame::ReleaseMat() {
     CameraFrame::ReleaseMat();
     _depthImg.release();
@@ -92,28 +122,21 @@ cv::Mat RGBDFrame::CreateColorDepthMap(const RGBDIntrinsics::Ptr& intri,
     cv::Mat invDepthImg(rowCnt, colCnt, CV_32FC1, cv::Scalar(0.0f));
     float min = std::numeric_limits<float>::max(), max = std::numeric_limits<float>::min();
 
-    for (int row = 0; row < rowCnt; ++row) {
-        auto iData = invDepthImg.ptr<float>(row);
-        auto dData = _depthImg.ptr<float>(row);
-        for (int col = 0; col < colCnt; ++col) {
-            auto depth = (float)intri->ActualDepth(dData[0]);
-            if (depth > zMin && depth < zMax) {
-                iData[0] = 1.0f / depth;
-            } else {
-                iData[0] = 0.0f;
-            }
-            if (iData[0] < min) {
-                min = iData[0];
-            }
-            if (iData[0] > max) {
-                max = iData[0];
-            }
-            // color mat ptr
-            iData += 1;
-            // depth mat ptr
-            dData += 1;
+    ForEachRawDepth(_depthImg, [&](int row, int col, float rawDepth) {
+        auto& invDepth = invDepthImg.ptr<float>(row)[col];
+        auto depth = (float)intri->ActualDepth(rawDepth);
+        if (depth > zMin && depth < zMax) {
+            invDepth = 1.0f / depth;
+        } else {
+            invDepth = 0.0f;
         }
-    }
+        if (invDepth < min) {
+            min = invDepth;
+        }
+        if (invDepth > max) {
+            max = invDepth;
+        }
+    });
     float alpha = 255.0f / (max - min), beta = -min * alpha;
     cv::Mat uCharImg, colorImg;
 
@@ -130,7 +153,7 @@ cv::Mat RGBDFrame::CreateColorDepthMap(const RGBDIntrinsics::Ptr& intri,
 
     if (withColorMat) {
         cv::Mat rgbdMap;
-        cv::hconcat(_colorImg, colorImg, rgbdMap);
+        cv::hconcat(DecodeOnDemand(true), colorImg, rgbdMap);
         return rgbdMap;
     } else {
         return colorImg;
@@ -140,7 +163,7 @@ cv::Mat RGBDFrame::CreateColorDepthMap(const RGBDIntrinsics::Ptr& intri,
 ColorPointCloud::Ptr RGBDFrame::CreatePointCloud(const RGBDIntrinsicsPtr& intri,
                                                  float zMin,
                                                  float zMax) {
-    auto cMat = _colorImg;
+    auto cMat = DecodeOnDemand(true);
     auto dMat = _depthImg;
     int rowCnt = cMat.rows;
     int colCnt = cMat.cols;
@@ -151,68 +174,60 @@ ColorPointCloud::Ptr RGBDFrame::CreatePointCloud(const RGBDIntrinsicsPtr& intri,
 
     ColorPointCloud::Ptr cloud(new ColorPointCloud);
     cloud->reserve(rowCnt * colCnt);
-    for (int row = 0; row < rowCnt; ++row) {
-        auto cData = cMat.ptr<uchar>(row);
-        auto dData = dMat.ptr<float>(row);
-        for (int col = 0; col < colCnt; ++col) {
-            auto depth = (float)intri->ActualDepth(dData[0]);
-            if (depth > zMin && depth < zMax) {
-                Eigen::Vector2d lmInDnPlane = intri->intri->ImgToCam({col, row});
-                Eigen::Vector3d lmInDn(lmInDnPlane(0) * depth, lmInDnPlane(1) * depth, depth);
-
-                ColorPoint p;
-                p.x = (float)lmInDn(0);
-                p.y = (float)lmInDn(1);
-                p.z = (float)lmInDn(2);
-                p.b = cData[0];
-                p.g = cData[1];
-                p.r = cData[2];
-                p.a = 255;
-                cloud->push_back(p);
-            }
+    ForEachRawDepth(dMat, [&](int row, int col, float rawDepth) {
+        auto depth = (float)intri->ActualDepth(rawDepth);
+        if (depth > zMin && depth < zMax) {
+            Eigen::Vector2d lmInDnPlane = intri->intri->ImgToCam({col, row});
+            Eigen::Vector3d lmInDn(lmInDnPlane(0) * depth, lmInDnPlane(1) * depth, depth);
+
             // color mat ptr
-            cData += 3;
-            // depth mat ptr
-            dData += 1;
+            auto cData = cMat.ptr<uchar>(row) + 3 * col;
+
+            ColorPoint p;
+            p.x = (float)lmInDn(0);
+            p.y = (float)lmInDn(1);
+            p.z = (float)lmInDn(2);
+            p.b = cData[0];
+            p.g = cData[1];
+            p.r = cData[2];
+            p.a = 255;
+            cloud->push_back(p);
         }
-    }
+    });
     return cloud;
 }
 
 IKalibrPointCloud::Ptr RGBDFrame::CreatePointCloud(
     double rsExpFactor, double readout, const RGBDIntrinsicsPtr& intri, float zMin, float zMax) {
-    auto cMat = _colorImg;
+    // no color is required, and the depth image is aligned with (i.e., shares the size of) the
+    // color one, thus the latter is not decoded here
     auto dMat = _depthImg;
-    int rowCnt = cMat.rows;
-    int colCnt = cMat.cols;
+    int rowCnt = dMat.rows;
+    int colCnt = dMat.cols;
 
-    if (cMat.empty() || dMat.empty() || cMat.size != dMat.size) {
+    if (dMat.empty()) {
         return nullptr;
     }
 
     IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud);
     cloud->reserve(rowCnt * colCnt);
-    const int imgHeight = _greyImg.rows;
-    for (int row = 0; row < rowCnt; ++row) {
-        auto dData = dMat.ptr<float>(row);
-        const double rdFactorAry = row / (double)imgHeight - rsExpFactor;
-        for (int col = 0; col < colCnt; ++col) {
-            auto depth = (float)intri->ActualDepth(dData[0]);
-            if (depth > zMin && depth < zMax) {
-                Eigen::Vector2d lmInDnPlane = intri->intri->ImgToCam({col, row});
-                Eigen::Vector3d lmInDn(lmInDnPlane(0) * depth, lmInDnPlane(1) * depth, depth);
-
-                IKalibrPoint p;
-                p.timestamp = _timestamp + rdFactorAry * readout;
-                p.x = (float)lmInDn(0);
-                p.y = (float)lmInDn(1);
-                p.z = (float)lmInDn(2);
-                cloud->push_back(p);
-            }
-            // depth mat ptr
-            dData += 1;
+    const int imgHeight = dMat.rows;
+    ForEachRawDepth(dMat, [&](int row, int col, float rawDepth) {
+        auto depth = (float)intri->ActualDepth(rawDepth);
+        if (depth > zMin && depth < zMax) {
+            Eigen::Vector2d lmInDnPlane = intri->intri->ImgToCam({col, row});
+            Eigen::Vector3d lmInDn(lmInDnPlane(0) * depth, lmInDnPlane(1) * depth, depth);
+
+            const double rdFactorAry = row / (double)imgHeight - rsExpFactor;
+
+            IKalibrPoint p;
+            p.timestamp = _timestamp + rdFactorAry * readout;
+            p.x = (float)lmInDn(0);
+            p.y = (float)lmInDn(1);
+            p.z = (float)lmInDn(2);
+            cloud->push_back(p);
         }
-    }
+    });
     return cloud;
 }
 
@@ -48,8 +48,7 @@ CalibSolver::BackUp::Ptr CalibSolver::BatchOptimization(
     const std::map<std::string, std::vector<VisualReProjCorrSeq::Ptr>> &visualReprojCorrs,
     const std::map<std::string, std::vector<OpticalFlowCorr::Ptr>> &rgbdCorrs,
     const std::map<std::string, std::vector<OpticalFlowCorr::Ptr>> &visualVelCorrs,
-    const std::optional<std::map<std::string, std::vector<PointToSurfelCorrPtr>>> &rgbdPtsCorrs)
-    const {
+    const std::optional<std::map<std::string, std::vector<PointToSurfelCorrPtr>>> &rgbdPtsCorrs) {
     // a lambda function to obtain the string of current optimization option
     auto GetOptString = [](OptOption opt) -> std::string {
         std::stringstream stringStream;
@@ -86,98 +85,156 @@ CalibSolver::BackUp::Ptr CalibSolver::BatchOptimization(
 
     spdlog::info("Optimization option: {}", GetOptString(optOption));
 
-    auto estimator = Estimator::Create(_splines, _parMagr);
-    auto visualGlobalScale = std::make_shared<double>(1.0);
+    if (_batchEstimator == nullptr) {
+        _batchEstimator = Estimator::Create(_splines, _parMagr);
+        _visualGlobalScale = std::make_shared<double>(1.0);
+    }
+    // the last stage rescaled the visual structure by this scale (see the end of this function),
+    // and inverse depths are re-associated from it, thus it restarts at 1.0 as before. The block
+    // itself is kept, as it may still be a parameter block of the shared estimator
+    *_visualGlobalScale = 1.0;
+    auto estimator = _batchEstimator;
+    auto visualGlobalScale = _visualGlobalScale;
     constexpr bool OPTICAL_FLOW_EST_INV_DEPTH = true;
 
+    /**
+     * residuals of raw measurements (imus and radars) are kept in the estimator across batch
+     * optimizations, they are rebuilt only if the time padding changes (i.e., whether their time
+     * offsets are optimized), as it changes the involved knots. Residuals from data associations
+     * are renewed every time, as correspondences are re-associated using the refined states
+     */
+    const std::string imuGroup =
+        IsOptionWith(OptOption::OPT_TO_BiToBr, optOption) ? "IMU_PADDED" : "IMU";
+    const std::string radarGroup =
+        IsOptionWith(OptOption::OPT_TO_RjToBr, optOption) ? "RADAR_PADDED" : "RADAR";
+    for (const auto &name : estimator->GetResidualGroupNames()) {
+        if (name != imuGroup && name != radarGroup) {
+            estimator->RemoveResidualGroup(name);
+        }
+    }
+    // param blocks kept in the estimator follow the current option
+    estimator->ResetParamBlocksConstancy(optOption);
+
+    auto AddRawGroup = [&estimator](const std::string &name, const std::function<void()> &adder) {
+        if (estimator->HasResidualGroup(name)) {
+            spdlog::info("reuse residual group '{}' from the last batch optimization", name);
+        } else {
+            estimator->AddResidualGroup(name, adder);
+        }
+    };
+
     switch (GetScaleType()) {
         case TimeDeriv::LIN_ACCE_SPLINE: {
             /**
              * only when imu-only multi-imu calibration is required, the linear acceleration spline
              * would be maintained
              */
-            for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
-                this->AddAcceFactor<TimeDeriv::LIN_ACCE_SPLINE>(estimator, topic, optOption);
-                this->AddGyroFactor(estimator, topic, optOption);
-            }
+            AddRawGroup(imuGroup, [&]() {
+                for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
+                    this->AddAcceFactor<TimeDeriv::LIN_ACCE_SPLINE>(estimator, topic, optOption);
+                    this->AddGyroFactor(estimator, topic, optOption);
+                }
+            });
         } break;
         case TimeDeriv::LIN_VEL_SPLINE: {
             /**
              * when rgbds or radars are involved in the calibration, a linear velocity spline would
              * be maintained in the estimator
              */
-            for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
-                this->AddRadarFactor<TimeDeriv::LIN_VEL_SPLINE>(estimator, topic, optOption);
-            }
-            for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
-                this->AddAcceFactor<TimeDeriv::LIN_VEL_SPLINE>(estimator, topic, optOption);
-                this->AddGyroFactor(estimator, topic, optOption);
-            }
-            for (const auto &[topic, corrs] : rgbdCorrs) {
-                this->AddRGBDOpticalFlowFactor<TimeDeriv::LIN_VEL_SPLINE,
-                                               OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-            }
-            for (const auto &[topic, corrs] : visualVelCorrs) {
-                this->AddVisualOpticalFlowFactor<TimeDeriv::LIN_VEL_SPLINE,
-                                                 OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-            }
+            AddRawGroup(radarGroup, [&]() {
+                for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
+                    this->AddRadarFactor<TimeDeriv::LIN_VEL_SPLINE>(estimator, topic, optOption);
+                }
+            });
+            AddRawGroup(imuGroup, [&]() {
+                for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
+                    this->AddAcceFactor<TimeDeriv::LIN_VEL_SPLINE>(estimator, topic, optOption);
+                    this->AddGyroFactor(estimator, topic, optOption);
+                }
+            });
+            estimator->AddResidualGroup("RGBD_OPTICAL_FLOW", [&]() {
+                for (const auto &[topic, corrs] : rgbdCorrs) {
+                    this->AddRGBDOpticalFlowFactor<TimeDeriv::LIN_VEL_SPLINE,
+                                                   OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+            });
+            estimator->AddResidualGroup("VISUAL_OPTICAL_FLOW", [&]() {
+                for (const auto &[topic, corrs] : visualVelCorrs) {
+                    this->AddVisualOpticalFlowFactor<TimeDeriv::LIN_VEL_SPLINE,
+                                                     OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+            });
         } break;
         case TimeDeriv::LIN_POS_SPLINE: {
             /*
              * when lidars or optical cameras are involved in the calibration, a translation spline
              * would be maintained in the estimator
              */
-            for (const auto &[topic, corrs] : lidarPtsCorrs) {
-                this->AddLiDARPointToSurfelFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic,
-                                                                             corrs, optOption);
-            }
-            for (const auto &[topic, corrs] : visualReprojCorrs) {
-                this->AddVisualReprojectionFactor<TimeDeriv::LIN_POS_SPLINE>(
-                    estimator, topic, corrs, visualGlobalScale.get(),
-                    RefineReadoutTimeOptForCameras(topic, optOption));
-            }
-            for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
-                this->AddRadarFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic, optOption);
-            }
-            for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
-                this->AddAcceFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic, optOption);
-                this->AddGyroFactor(estimator, topic, optOption);
-            }
-            for (const auto &[topic, corrs] : rgbdCorrs) {
-                this->AddRGBDOpticalFlowFactor<TimeDeriv::LIN_POS_SPLINE,
-                                               OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-                /**
-                 * when pos spline is maintained, we add additional reprojection constraints for
-                 * optical flow tracking correspondence
-                 */
-                this->AddRGBDOpticalFlowReprojFactor<TimeDeriv::LIN_POS_SPLINE,
+            estimator->AddResidualGroup("LIDAR_POINT_TO_SURFEL", [&]() {
+                for (const auto &[topic, corrs] : lidarPtsCorrs) {
+                    this->AddLiDARPointToSurfelFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic,
+                                                                                 corrs, optOption);
+                }
+            });
+            estimator->AddResidualGroup("VISUAL_REPROJECTION", [&]() {
+                for (const auto &[topic, corrs] : visualReprojCorrs) {
+                    this->AddVisualReprojectionFactor<TimeDeriv::LIN_POS_SPLINE>(
+                        estimator, topic, corrs, visualGlobalScale.get(),
+                        RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+            });
+            AddRawGroup(radarGroup, [&]() {
+                for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
+                    this->AddRadarFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic, optOption);
+                }
+            });
+            AddRawGroup(imuGroup, [&]() {
+                for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
+                    this->AddAcceFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic, optOption);
+                    this->AddGyroFactor(estimator, topic, optOption);
+                }
+            });
+            estimator->AddResidualGroup("RGBD_OPTICAL_FLOW", [&]() {
+                for (const auto &[topic, corrs] : rgbdCorrs) {
+                    this->AddRGBDOpticalFlowFactor<TimeDeriv::LIN_POS_SPLINE,
+                                                   OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                    /**
+                     * when pos spline is maintained, we add additional reprojection constraints
+                     * for optical flow tracking correspondence
+                     */
+                    this->AddRGBDOpticalFlowReprojFactor<TimeDeriv::LIN_POS_SPLINE,
+                                                         OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+            });
+            estimator->AddResidualGroup("VISUAL_OPTICAL_FLOW", [&]() {
+                for (const auto &[topic, corrs] : visualVelCorrs) {
+                    this->AddVisualOpticalFlowFactor<TimeDeriv::LIN_POS_SPLINE,
                                                      OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-            }
-            for (const auto &[topic, corrs] : visualVelCorrs) {
-                this->AddVisualOpticalFlowFactor<TimeDeriv::LIN_POS_SPLINE,
-                                                 OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-                /**
-                 * when pos spline is maintained, we add additional reprojection constraints for
-                 * optical flow tracking correspondence
-                 */
-                this->AddVisualOpticalFlowReprojFactor<TimeDeriv::LIN_POS_SPLINE,
-                                                       OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-            }
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                    /**
+                     * when pos spline is maintained, we add additional reprojection constraints
+                     * for optical flow tracking correspondence
+                     */
+                    this->AddVisualOpticalFlowReprojFactor<TimeDeriv::LIN_POS_SPLINE,
+                                                           OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+            });
             if (rgbdPtsCorrs != std::nullopt) {
                 /**
                  * such point-to-surfel data association is not necessary, if it exists, we add to
                  * the estimator
                  */
-                for (const auto &[topic, corrs] : *rgbdPtsCorrs) {
-                    this->AddRGBDPointToSurfelFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic,
-                                                                                corrs, optOption);
-                }
+                estimator->AddResidualGroup("RGBD_POINT_TO_SURFEL", [&]() {
+                    for (const auto &[topic, corrs] : *rgbdPtsCorrs) {
+                        this->AddRGBDPointToSurfelFactor<TimeDeriv::LIN_POS_SPLINE>(
+                            estimator, topic, corrs, optOption);
+                    }
+                });
             }
         } break;
     }
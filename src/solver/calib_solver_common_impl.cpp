@@ -101,6 +101,9 @@ CalibSolver::CalibSolver(CalibDataManager::Ptr calibDataManager,
       _ceresOption(Estimator::DefaultSolverOptions(
           Configor::Preference::AvailableThreads(), true, Configor::Preference::UseCudaInSolving)),
       _viewer(nullptr),
+      _batchEstimator(nullptr),
+      _visualGlobalScale(nullptr),
+      _lidarAssociator(nullptr),
       _initAsset(new InitAsset),
       _solveFinished(false) {
     // create so3 and linear scale splines given start and end times, knot distances
@@ -108,21 +111,26 @@ CalibSolver::CalibSolver(CalibDataManager::Ptr calibDataManager,
         _dataMagr->GetCalibStartTimestamp(), _dataMagr->GetCalibEndTimestamp(),
         Configor::Prior::KnotTimeDist::SO3Spline, Configor::Prior::KnotTimeDist::ScaleSpline);
 
-    // create viewer
-    _viewer = Viewer::Create(_parMagr, _splines);
-    auto modelPath = ros::package::getPath("ikalibr") + "/model/ikalibr.obj";
-    _viewer->FillEmptyViews(modelPath);
+    // create viewer, which is never constructed in the headless mode (all drawings are skipped)
+    if (!Configor::Preference::Headless) {
+        _viewer = Viewer::Create(_parMagr, _splines);
+        auto modelPath = ros::package::getPath("ikalibr") + "/model/ikalibr.obj";
+        _viewer->FillEmptyViews(modelPath);
 
-    // pass the 'CeresViewerCallBack' to ceres option so that update the viewer after every
-    // iteration in ceres
-    _ceresOption.callbacks.push_back(new CeresViewerCallBack(_viewer));
-    _ceresOption.update_state_every_iteration = true;
+        // pass the 'CeresViewerCallBack' to ceres option so that update the viewer after every
+        // iteration in ceres
+        _ceresOption.callbacks.push_back(new CeresViewerCallBack(_viewer));
+    }
 
     // output spatiotemporal parameters after each iteration if needed
     if (IsOptionWith(OutputOption::ParamInEachIter, Configor::Preference::Outputs)) {
         _ceresOption.callbacks.push_back(new CeresDebugCallBack(_parMagr));
     }
 
+    // callbacks read the parameters, thus they are copied back after every iteration, otherwise
+    // (headless mode without debug outputs) this per-iteration overhead is avoided
+    _ceresOption.update_state_every_iteration = !_ceresOption.callbacks.empty();
+
     // spatial and temporal priori
     if (std::filesystem::exists(Configor::Prior::SpatTempPrioriPath)) {
         _priori = SpatialTemporalPriori::Load(Configor::Prior::SpatTempPrioriPath);
@@ -138,6 +146,10 @@ CalibSolver::Ptr CalibSolver::Create(const CalibDataManager::Ptr &calibDataManag
 }
 
 CalibSolver::~CalibSolver() {
+    // headless mode, no window to wait for
+    if (_viewer == nullptr) {
+        return;
+    }
     // solving is not performed or not finished as an exception is thrown
     if (!_solveFinished) {
         pangolin::QuitAll();
@@ -693,8 +705,7 @@ void CalibSolver::AddGyroFactor(Estimator::Ptr &estimator,
                                 Estimator::Opt option) const {
     double weight = Configor::DataStream::IMUTopics.at(imuTopic).GyroWeight;
 
-    for (const auto &item : _dataMagr->GetIMUMeasurements(imuTopic)) {
-        estimator->AddIMUGyroMeasurement(item, imuTopic, option, weight);
-    }
+    estimator->AddIMUGyroMeasurements(_dataMagr->GetIMUMeasurements(imuTopic), imuTopic, option,
+                                      weight);
 }
 }  // namespace ns_ikalibr
\ No newline at end of file
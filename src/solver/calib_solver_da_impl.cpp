@@ -46,7 +46,10 @@
 #include "spdlog/spdlog.h"
 #include "util/cloud_define.hpp"
 #include "util/tqdm.h"
+#include "util/utils.h"
 #include "viewer/viewer.h"
+#include "numeric"
+#include "unordered_map"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -66,26 +69,130 @@ CalibSolver::BuildGlobalMapOfLiDAR() const {
     auto undistHelper = ScanUndistortion::Create(_splines, _parMagr);
 
     std::map<std::string, std::vector<LiDARFrame::Ptr>> undistFrames;
-    IKalibrPointCloud::Ptr mapCloud(new IKalibrPointCloud);
+    // frames of all lidars, which would be assembled to the map together
+    std::vector<LiDARFrame::Ptr> framesInMap;
     for (const auto &[topic, data] : _dataMagr->GetLiDARMeasurements()) {
         spdlog::info("undistort scans for lidar '{}'...", topic);
         undistFrames[topic] =
             undistHelper->UndistortToRef(data, topic, ScanUndistortion::Option::ALL);
+        const auto &frames = undistFrames.at(topic);
+        framesInMap.insert(framesInMap.end(), frames.cbegin(), frames.cend());
+    }
+
+    spdlog::info("marge scans from {} lidar(s) to map...", undistFrames.size());
+    auto mapCloud =
+        AssembleLiDARMap(framesInMap, Configor::Prior::LiDARDataAssociate::MapVoxelLeafSize);
+
+    return {mapCloud, undistFrames};
+}
+
+IKalibrPointCloud::Ptr CalibSolver::AssembleLiDARMap(const std::vector<LiDARFrame::Ptr> &frames,
+                                                     double leafSize) {
+    IKalibrPointCloud::Ptr mapCloud(new IKalibrPointCloud);
 
-        spdlog::info("marge scans from lidar '{}' to map...", topic);
-        for (auto &frame : undistFrames.at(topic)) {
-            if (frame == nullptr) {
+    if (leafSize <= 0.0) {
+        // the first pass: count valid points of each frame, to obtain their ranges in the map
+        std::vector<std::size_t> offsets(frames.size() + 1, 0);
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) schedule(dynamic) \
+    default(none) shared(frames, offsets)
+        for (int i = 0; i < static_cast<int>(frames.size()); ++i) {
+            if (frames[i] == nullptr) {
                 continue;
             }
-            *mapCloud += *frame->GetScan();
+            const auto &scan = frames[i]->GetCompactScan();
+            std::size_t count = 0;
+            for (std::size_t j = 0; j < scan->Size(); ++j) {
+                count += scan->IsValid(j);
+            }
+            offsets[i + 1] = count;
         }
-    }
+        std::partial_sum(offsets.cbegin(), offsets.cend(), offsets.begin());
 
-    IKalibrPointCloud::Ptr newMapCloud(new IKalibrPointCloud);
-    std::vector<int> index;
-    pcl::removeNaNFromPointCloud(*mapCloud, *newMapCloud, index);
+        // the second pass: write valid points of frames into their disjoint ranges concurrently
+        mapCloud->resize(offsets.back());
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) schedule(dynamic) \
+    default(none) shared(frames, offsets, mapCloud)
+        for (int i = 0; i < static_cast<int>(frames.size()); ++i) {
+            if (frames[i] == nullptr) {
+                continue;
+            }
+            const auto &scan = frames[i]->GetCompactScan();
+            const auto &x = scan->GetX(), &y = scan->GetY(), &z = scan->GetZ();
+            std::size_t idx = offsets[i];
+            for (std::size_t j = 0; j < scan->Size(); ++j) {
+                if (!scan->IsValid(j)) {
+                    continue;
+                }
+                auto &p = mapCloud->points[idx++];
+                p.x = x[j], p.y = y[j], p.z = z[j];
+                p.timestamp = scan->GetTimestamp(j);
+            }
+        }
+    } else {
+        // on-the-fly voxel hashing: points are accumulated into per-chunk voxels without the
+        // full-resolution map being materialized, voxels are merged to their centroids finally
+        struct Voxel {
+            double x = 0.0, y = 0.0, z = 0.0;
+            std::size_t count = 0;
+        };
+        using VoxelMap = std::unordered_map<Eigen::Vector3i, Voxel, SpatialHasher>;
+
+        // frames are partitioned into contiguous chunks by index, each accumulated into its own
+        // voxels, thus the map is reproducible whatever threads the runtime actually provides
+        const auto frameCount = static_cast<int>(frames.size());
+        const int chunks =
+            std::max(1, std::min(Configor::Preference::AvailableThreads(), frameCount));
+        std::vector<VoxelMap> chunkVoxels(chunks);
+#pragma omp parallel for num_threads(chunks) schedule(static) default(none) \
+    shared(frames, leafSize, chunkVoxels, chunks, frameCount)
+        for (int c = 0; c < chunks; ++c) {
+            auto &voxels = chunkVoxels.at(c);
+            for (int i = c * frameCount / chunks; i < (c + 1) * frameCount / chunks; ++i) {
+                if (frames[i] == nullptr) {
+                    continue;
+                }
+                const auto &scan = frames[i]->GetCompactScan();
+                const auto &x = scan->GetX(), &y = scan->GetY(), &z = scan->GetZ();
+                for (std::size_t j = 0; j < scan->Size(); ++j) {
+                    if (!scan->IsValid(j)) {
+                        continue;
+                    }
+                    Eigen::Vector3i key(static_cast<int>(std::floor(x[j] / leafSize)),
+                                        static_cast<int>(std::floor(y[j] / leafSize)),
+                                        static_cast<int>(std::floor(z[j] / leafSize)));
+                    auto &voxel = voxels[key];
+                    voxel.x += x[j], voxel.y += y[j], voxel.z += z[j];
+                    ++voxel.count;
+                }
+            }
+        }
+
+        // merge voxels of all chunks in order
+        auto &voxels = chunkVoxels.front();
+        for (int c = 1; c < chunks; ++c) {
+            for (const auto &[key, voxel] : chunkVoxels.at(c)) {
+                auto &target = voxels[key];
+                target.x += voxel.x, target.y += voxel.y, target.z += voxel.z;
+                target.count += voxel.count;
+            }
+            chunkVoxels.at(c).clear();
+        }
 
-    return {newMapCloud, undistFrames};
+        mapCloud->reserve(voxels.size());
+        for (const auto &[key, voxel] : voxels) {
+            const auto count = static_cast<double>(voxel.count);
+            IKalibrPoint p;
+            p.x = static_cast<float>(voxel.x / count);
+            p.y = static_cast<float>(voxel.y / count);
+            p.z = static_cast<float>(voxel.z / count);
+            // a voxel merges points of different scans, thus it has no meaningful time stamp
+            p.timestamp = std::numeric_limits<double>::quiet_NaN();
+            mapCloud->push_back(p);
+        }
+    }
+    mapCloud->is_dense = true;
+
+    return mapCloud;
 }
 
 IKalibrPointCloud::Ptr CalibSolver::BuildGlobalMapOfRadar() const {
@@ -117,17 +224,19 @@ IKalibrPointCloud::Ptr CalibSolver::BuildGlobalMapOfRadar() const {
         *radarCloud += *curRadarCloud;
     }
 
-    // ---------------------------
-    // down sample the radar cloud
-    // ---------------------------
-    pcl::VoxelGrid<IKalibrPoint> filter;
-    filter.setInputCloud(radarCloud);
-    auto size = static_cast<float>(Configor::Prior::MapDownSample * 2.0);
-    filter.setLeafSize(size, size, size);
-
-    IKalibrPointCloud::Ptr radarCloudSampled(new IKalibrPointCloud);
-    filter.filter(*radarCloudSampled);
-    _viewer->AddStarMarkCloud(radarCloudSampled, Viewer::VIEW_MAP);
+    // ----------------------------------------------------
+    // down sample the radar cloud (only for visualization)
+    // ----------------------------------------------------
+    if (_viewer != nullptr) {
+        pcl::VoxelGrid<IKalibrPoint> filter;
+        filter.setInputCloud(radarCloud);
+        auto size = static_cast<float>(Configor::Prior::MapDownSample * 2.0);
+        filter.setLeafSize(size, size, size);
+
+        IKalibrPointCloud::Ptr radarCloudSampled(new IKalibrPointCloud);
+        filter.filter(*radarCloudSampled);
+        _viewer->AddStarMarkCloud(radarCloudSampled, Viewer::VIEW_MAP);
+    }
 
     return radarCloud;
 }
@@ -255,37 +364,49 @@ CalibSolver::BuildGlobalMapOfRGBD() const {
 std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> CalibSolver::DataAssociationForLiDARs(
     const IKalibrPointCloud::Ptr &map,
     const std::map<std::string, std::vector<LiDARFrame::Ptr>> &undistFrames,
-    int ptsCountInEachScan) const {
+    int ptsCountInEachScan) {
     if (!Configor::IsLiDARIntegrated()) {
         return {};
     }
 
-    // ---------------------------------
-    // Step 1: down sample the map cloud
-    // ---------------------------------
-    pcl::VoxelGrid<IKalibrPoint> filter;
-    filter.setInputCloud(map);
-    auto size = static_cast<float>(Configor::Prior::MapDownSample);
-    filter.setLeafSize(size, size, size);
-
+    // ---------------------------------------------------------
+    // Step 1: down sample the map cloud (only for visualization)
+    // ---------------------------------------------------------
     IKalibrPointCloud::Ptr mapDownSampled(new IKalibrPointCloud);
-    filter.filter(*mapDownSampled);
-
-    _viewer->AddAlignedCloud(mapDownSampled, Viewer::VIEW_MAP, -_parMagr->GRAVITY.cast<float>(),
-                             2.0f);
+    if (_viewer != nullptr) {
+        pcl::VoxelGrid<IKalibrPoint> filter;
+        filter.setInputCloud(map);
+        auto size = static_cast<float>(Configor::Prior::MapDownSample);
+        filter.setLeafSize(size, size, size);
+        filter.filter(*mapDownSampled);
+
+        _viewer->AddAlignedCloud(mapDownSampled, Viewer::VIEW_MAP,
+                                 -_parMagr->GRAVITY.cast<float>(), 2.0f);
+    }
 
     // ------------------------------------------------
     // Step 2: perform data association for each frames
     // ------------------------------------------------
-    auto associator = PointToSurfelAssociator::Create(
-        // we use the dense map to create data associator for high-perform point-to-surfel search
-        map, Configor::Prior::LiDARDataAssociate::MapResolution,
-        Configor::Prior::LiDARDataAssociate::MapDepthLevels);
+    if (_lidarAssociator == nullptr) {
+        _lidarAssociator =
+            PointToSurfelAssociator::Create(Configor::Prior::LiDARDataAssociate::MapResolution,
+                                            Configor::Prior::LiDARDataAssociate::MapDepthLevels);
+    }
+    auto associator = _lidarAssociator;
+    // we use the dense map to update the data associator for high-perform point-to-surfel search,
+    // surfel maps are warm started from the last stage, only changed parts of them are rebuilt
+    auto rebuiltCount =
+        associator->Update(map, Configor::Prior::LiDARDataAssociate::SurfelMapUpdateTolerance);
+    const auto bucketCount = associator->GetSurfelMaps().size();
+    spdlog::info("surfel maps updated, {} of {} buckets rebuilt ({:.1f}%)", rebuiltCount,
+                 bucketCount, 100.0 * static_cast<double>(rebuiltCount) / bucketCount);
     auto condition = PointToSurfelCondition();
-    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
-    _viewer->AddSurfelMap(associator->GetSurfelMap(), condition, Viewer::VIEW_ASSOCIATION);
-    _viewer->AddCloud(mapDownSampled, Viewer::VIEW_ASSOCIATION,
-                      ns_viewer::Colour::Black().WithAlpha(0.2f), 2.0f);
+    if (_viewer != nullptr) {
+        _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+        _viewer->AddSurfelMap(associator->GetSurfelMaps(), condition, Viewer::VIEW_ASSOCIATION);
+        _viewer->AddCloud(mapDownSampled, Viewer::VIEW_ASSOCIATION,
+                          ns_viewer::Colour::Black().WithAlpha(0.2f), 2.0f);
+    }
 
     // deconstruction
     mapDownSampled.reset();
@@ -309,8 +430,8 @@ std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> CalibSolver::DataAsso
                 continue;
             }
 
-            auto ptsVec = associator->Association(framesInMap.at(i)->GetScan(),
-                                                  rawFrames.at(i)->GetScan(), condition);
+            auto ptsVec = associator->Association(framesInMap.at(i)->GetCompactScan(),
+                                                  rawFrames.at(i)->GetCompactScan(), condition);
 
             curPointToSurfel.insert(curPointToSurfel.end(), ptsVec.cbegin(), ptsVec.cend());
         }
@@ -338,7 +459,10 @@ std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> CalibSolver::DataAsso
         count += curPointToSurfel.size();
     }
     spdlog::info("total point to surfel count for LiDARs: {}", count);
-    _viewer->AddPointToSurfel(associator->GetSurfelMap(), pointToSurfel, Viewer::VIEW_ASSOCIATION);
+    if (_viewer != nullptr) {
+        _viewer->AddPointToSurfel(associator->GetSurfelMaps(), pointToSurfel,
+                                  Viewer::VIEW_ASSOCIATION);
+    }
 
     return pointToSurfel;
 }
@@ -352,19 +476,20 @@ std::map<std::string, std::vector<PointToSurfelCorrPtr>> CalibSolver::DataAssoci
         return {};
     }
 
-    // ---------------------------------
-    // Step 1: down sample the map cloud
-    // ---------------------------------
-    pcl::VoxelGrid<IKalibrPoint> filter;
-    filter.setInputCloud(map);
-    auto size = static_cast<float>(Configor::Prior::MapDownSample);
-    filter.setLeafSize(size, size, size);
-
+    // ---------------------------------------------------------
+    // Step 1: down sample the map cloud (only for visualization)
+    // ---------------------------------------------------------
     IKalibrPointCloud::Ptr mapDownSampled(new IKalibrPointCloud);
-    filter.filter(*mapDownSampled);
-
-    _viewer->AddAlignedCloud(mapDownSampled, Viewer::VIEW_MAP, -_parMagr->GRAVITY.cast<float>(),
-                             2.0f);
+    if (_viewer != nullptr) {
+        pcl::VoxelGrid<IKalibrPoint> filter;
+        filter.setInputCloud(map);
+        auto size = static_cast<float>(Configor::Prior::MapDownSample);
+        filter.setLeafSize(size, size, size);
+        filter.filter(*mapDownSampled);
+
+        _viewer->AddAlignedCloud(mapDownSampled, Viewer::VIEW_MAP,
+                                 -_parMagr->GRAVITY.cast<float>(), 2.0f);
+    }
 
     // ------------------------------------------------
     // Step 2: perform data association for each frames
@@ -380,10 +505,12 @@ std::map<std::string, std::vector<PointToSurfelCorrPtr>> CalibSolver::DataAssoci
                                             Configor::Prior::LiDARDataAssociate::QueryDepthMax + 1,
                                             Configor::Prior::LiDARDataAssociate::SurfelPointMin,
                                             Configor::Prior::LiDARDataAssociate::PlanarityMin);
-    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
-    _viewer->AddSurfelMap(associator->GetSurfelMap(), condition, Viewer::VIEW_ASSOCIATION);
-    _viewer->AddCloud(mapDownSampled, Viewer::VIEW_ASSOCIATION,
-                      ns_viewer::Colour::Black().WithAlpha(0.2f), 2.0f);
+    if (_viewer != nullptr) {
+        _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+        _viewer->AddSurfelMap(associator->GetSurfelMaps(), condition, Viewer::VIEW_ASSOCIATION);
+        _viewer->AddCloud(mapDownSampled, Viewer::VIEW_ASSOCIATION,
+                          ns_viewer::Colour::Black().WithAlpha(0.2f), 2.0f);
+    }
 
     // deconstruction
     mapDownSampled.reset();
@@ -434,7 +561,10 @@ std::map<std::string, std::vector<PointToSurfelCorrPtr>> CalibSolver::DataAssoci
         count += curPointToSurfel.size();
     }
     spdlog::info("total point to surfel count for RGBDs: {}", count);
-    _viewer->AddPointToSurfel(associator->GetSurfelMap(), pointToSurfel, Viewer::VIEW_ASSOCIATION);
+    if (_viewer != nullptr) {
+        _viewer->AddPointToSurfel(associator->GetSurfelMaps(), pointToSurfel,
+                                  Viewer::VIEW_ASSOCIATION);
+    }
 
     return pointToSurfel;
 }
@@ -452,7 +582,9 @@ CalibSolver::DataAssociationForPosCameras() const {
             VisualReProjAssociator::Create(EnumCast::stringToEnum<CameraModelType>(
                                                Configor::DataStream::CameraTopics.at(topic).Type))
                 ->Association(*sfmData, _parMagr->INTRI.Camera.at(topic));
-        _viewer->AddVeta(sfmData, Viewer::VIEW_MAP);
+        if (_viewer != nullptr) {
+            _viewer->AddVeta(sfmData, Viewer::VIEW_MAP);
+        }
         spdlog::info("visual reprojection sequences for '{}': {}", topic, corrs.at(topic).size());
     }
     return corrs;
@@ -621,6 +753,9 @@ std::map<std::string, std::vector<OpticalFlowCorr::Ptr>> CalibSolver::DataAssoci
 
     // add veta for visualization
     for (const auto &[topic, _] : Configor::DataStream::RGBDTopics) {
+        if (_viewer == nullptr) {
+            break;
+        }
         const auto &intri = _parMagr->INTRI.RGBD.at(topic);
 
         auto veta =
@@ -741,8 +876,11 @@ std::map<std::string, std::vector<OpticalFlowCorr::Ptr>> CalibSolver::DataAssoci
         }
     }
 
-    // add veta from pixel dynamics
+    // add veta from pixel dynamics (only for visualization)
     for (const auto &[topic, _] : Configor::DataStream::VelCameraTopics()) {
+        if (_viewer == nullptr) {
+            break;
+        }
         const auto &intri = _parMagr->INTRI.Camera.at(topic);
 
         auto veta =
@@ -49,7 +49,9 @@ void CalibSolver::InitPrepBatchOpt() const {
      */
     spdlog::info("aligning all states to gravity direction...");
     AlignStatesToGravity();
-    _viewer->UpdateSplineViewer();
+    if (_viewer != nullptr) {
+        _viewer->UpdateSplineViewer();
+    }
 
     /**
      * transform the veta to world frame if Cameras are integrated
@@ -70,9 +72,9 @@ void CalibSolver::InitPrepBatchOpt() const {
      * build map and undisto frames if LiDARs are integrated
      */
     spdlog::info("build global map and undisto lidar frames in world...");
-    auto &globalMap = _initAsset->globalMap;
-    globalMap = IKalibrPointCloud::Ptr(new IKalibrPointCloud);
     auto &undistFramesInMap = _initAsset->undistFramesInMap;
+    // frames of all lidars, which would be assembled to the map together
+    std::vector<LiDARFrame::Ptr> framesInMap;
     for (const auto &[lidarTopic, odometer] : _initAsset->lidarOdometers) {
         auto SE3_Lk0ToBr0 = this->CurLkToW(odometer->GetMapTime(), lidarTopic);
 
@@ -95,15 +97,18 @@ void CalibSolver::InitPrepBatchOpt() const {
             } else {
                 const auto &SE3_ScanToLk0 = poseSeq.at(i);
                 Sophus::SE3d SE3_ScanToBr0 = *SE3_Lk0ToBr0 * SE3_ScanToLk0.se3();
-                IKalibrPointCloud::Ptr scanInBr0(new IKalibrPointCloud);
-                pcl::transformPointCloud(*undistoScan->GetScan(), *scanInBr0,
-                                         SE3_ScanToBr0.matrix().cast<float>());
+                // transformed in the compact layout, without round trips through pcl clouds
+                auto scanInBr0 = std::make_shared<LiDARScan>(*undistoScan->GetCompactScan());
+                scanInBr0->Transform(SE3_ScanToBr0.matrix().cast<float>());
                 curUndistFramesInMap.at(i) =
                     LiDARFrame::Create(undistoScan->GetTimestamp(), scanInBr0);
-
-                *globalMap += *scanInBr0;
             }
         }
+        framesInMap.insert(framesInMap.end(), curUndistFramesInMap.cbegin(),
+                           curUndistFramesInMap.cend());
     }
+    // the same as 'BuildGlobalMapOfLiDAR', thus surfel maps are warm-started from a consistent map
+    _initAsset->globalMap =
+        AssembleLiDARMap(framesInMap, Configor::Prior::LiDARDataAssociate::MapVoxelLeafSize);
 }
 }  // namespace ns_ikalibr
\ No newline at end of file
@@ -96,7 +96,7 @@ void CalibSolver::InitPrepRGBDInertialAlign() const {
         for (int i = 0; i < static_cast<int>(frameVec.size()); ++i) {
             bar->progress(i, static_cast<int>(frameVec.size()));
 
-            if (i % 30 == 0) {
+            if (_viewer != nullptr && i % 30 == 0) {
                 /**
                  * we do not update the viewer too frequent, which would lead to heavy tasks
                  */
@@ -201,7 +201,9 @@ void CalibSolver::InitPrepRGBDInertialAlign() const {
                     estimator->Solve(optWithoutOutput, _priori);
                 }
 
-                _viewer->UpdateSensorViewer();
+                if (_viewer != nullptr) {
+                    _viewer->UpdateSensorViewer();
+                }
             }
         }
         bar->finish();
@@ -219,7 +221,9 @@ void CalibSolver::InitPrepRGBDInertialAlign() const {
                          "insufficiently excited motion or bad images.");
         }
     }
-    _viewer->ClearViewer(Viewer::VIEW_MAP);
+    if (_viewer != nullptr) {
+        _viewer->ClearViewer(Viewer::VIEW_MAP);
+    }
     cv::destroyAllWindows();
 
     /**
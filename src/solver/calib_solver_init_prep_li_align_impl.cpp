@@ -40,8 +40,8 @@
 #include "core/scan_undistortion.h"
 #include "solver/calib_solver.h"
 #include "spdlog/spdlog.h"
-#include "util/tqdm.h"
 #include "viewer/viewer.h"
+#include "omp.h"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -65,27 +65,81 @@ void CalibSolver::InitPrepLiDARInertialAlign() const {
                       Configor::Prior::TimeOffsetPadding;
 
     /**
-     * we use the ndt to recover rotations of lidar scans and use them to recovce the extrinsisc
-     * rotation of lidars
+     * lidars are independent of each other in the following odometry, thus they are processed
+     * concurrently, where the thread budget is shared: each lidar runs its ndt with a share of it
      */
-    spdlog::info("LiDARs are integrated, initializing extrinsic rotations of LiDARs...");
-    for (const auto &[topic, data] : _dataMagr->GetLiDARMeasurements()) {
-        spdlog::info("performing ndt odometer for '{}' for extrinsic rotation initialization...",
-                     topic);
+    const auto &lidarMes = _dataMagr->GetLiDARMeasurements();
+    std::vector<std::string> lidarTopics;
+    lidarTopics.reserve(lidarMes.size());
+    for (const auto &[topic, _] : lidarMes) {
+        lidarTopics.push_back(topic);
+    }
+    const int lidarThreads = std::min(static_cast<int>(lidarTopics.size()),
+                                      Configor::Preference::AvailableThreads());
+    const int ndtThreads = std::max(1, Configor::Preference::AvailableThreads() / lidarThreads);
+
+    auto ForEachLiDARConcurrently = [&lidarTopics, &lidarThreads, &ndtThreads](
+                                        const std::function<void(const std::string &)> &handler) {
+        // the ndt solvers open nested parallel regions
+        const int maxActiveLevels = omp_get_max_active_levels();
+        omp_set_max_active_levels(std::max(maxActiveLevels, 2));
+        // exceptions can not be thrown out of the parallel region, they are kept and rethrown later
+        std::vector<std::exception_ptr> exceptions(lidarTopics.size(), nullptr);
+#pragma omp parallel for num_threads(lidarThreads) schedule(dynamic) default(none) \
+    shared(lidarTopics, exceptions, handler)
+        for (int i = 0; i < static_cast<int>(lidarTopics.size()); ++i) {
+            try {
+                handler(lidarTopics.at(i));
+            } catch (...) {
+                exceptions.at(i) = std::current_exception();
+            }
+        }
+        omp_set_max_active_levels(maxActiveLevels);
 
-        auto lidarOdometer = LiDAROdometer::Create(
+        for (const auto &exception : exceptions) {
+            if (exception != nullptr) {
+                std::rethrow_exception(exception);
+            }
+        }
+    };
+    auto CreateLiDAROdometer = [&ndtThreads]() {
+        return LiDAROdometer::Create(
             // the resolution of ndt
             static_cast<float>(Configor::Prior::NDTLiDAROdometer::Resolution),
-            // the thread count to used
-            Configor::Preference::AvailableThreads());
+            // the thread count to used, shared among lidars
+            ndtThreads,
+            // the bounds of the sliding local map
+            Configor::Prior::NDTLiDAROdometer::LocalMapRadius,
+            static_cast<std::size_t>(Configor::Prior::NDTLiDAROdometer::LocalMapKeyFrameMax));
+    };
 
+    /**
+     * we use the ndt to recover rotations of lidar scans and use them to recovce the extrinsisc
+     * rotation of lidars
+     */
+    spdlog::info(
+        "LiDARs are integrated, initializing extrinsic rotations of {} LiDAR(s) using {} thread(s) "
+        "for each...",
+        lidarTopics.size(), ndtThreads);
+    std::map<std::string, LiDAROdometer::Ptr> rotOdometers;
+    for (const auto &topic : lidarTopics) {
+        rotOdometers.insert({topic, CreateLiDAROdometer()});
+    }
+    ForEachLiDARConcurrently([&](const std::string &topic) {
+        const auto &data = lidarMes.at(topic);
+        const auto &lidarOdometer = rotOdometers.at(topic);
         auto rotEstimator = RotationEstimator::Create();
-        auto bar = std::make_shared<tqdm>();
         for (int i = 0; i < static_cast<int>(data.size()); ++i) {
-            bar->progress(i, static_cast<int>(data.size()));
             // just for visualization
-            _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
-            _viewer->AddAlignedCloud(data.at(i)->GetScan(), Viewer::VIEW_ASSOCIATION);
+            if (_viewer != nullptr) {
+                // convert outside the critical section, which would serialize the odometers
+                auto scan = data.at(i)->GetScan();
+#pragma omp critical(viewer)
+                {
+                    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+                    _viewer->AddAlignedCloud(scan, Viewer::VIEW_ASSOCIATION);
+                }
+            }
 
             // run the lidar odometer(feed frame to ndt solver)
             lidarOdometer->FeedFrame(data.at(i));
@@ -100,27 +154,33 @@ void CalibSolver::InitPrepLiDARInertialAlign() const {
 
             // check solver status
             if (rotEstimator->SolveStatus()) {
-                // update extrinsic rotation from lidar to the reference imu
+                // update extrinsic rotation from lidar to the reference imu (entries of the map
+                // exist already, thus lidars write to different ones concurrently)
                 _parMagr->EXTRI.SO3_LkToBr.at(topic) = rotEstimator->GetSO3SensorToSpline();
                 // once we solve the rotation successfully, just break
-                bar->finish();
                 break;
             }
         }
         if (!rotEstimator->SolveStatus()) {
             throw Status(Status::ERROR,
-                         "initialize rotation 'SO3_LkToBr' failed, this may be related to the "
-                         "'NDTResolution' of lidar odometer.");
+                         "initialize rotation 'SO3_LkToBr' of '{}' failed, this may be related to "
+                         "the 'NDTResolution' of lidar odometer.",
+                         topic);
         } else {
             spdlog::info("extrinsic rotation of '{}' is recovered using '{:06}' frames", topic,
                          lidarOdometer->GetOdomPoseVec().size());
         }
-        // update viewer: add global map and update sensor spatiotemporal visualization
-        _viewer->AddCloud(lidarOdometer->GetMap(), Viewer::VIEW_MAP,
-                          ns_viewer::Entity::GetUniqueColour(), 2.0f);
+    });
+    // update viewer: add global maps and update sensor spatiotemporal visualization
+    if (_viewer != nullptr) {
+        for (const auto &topic : lidarTopics) {
+            _viewer->AddCloud(rotOdometers.at(topic)->GetMap(), Viewer::VIEW_MAP,
+                              ns_viewer::Entity::GetUniqueColour(), 2.0f);
+        }
         _viewer->UpdateSensorViewer();
+        _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
     }
-    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+    rotOdometers.clear();
 
     /**
      * once the extrinsic rotations are recovered, we use the prior rotations to undistort lidar
@@ -130,32 +190,36 @@ void CalibSolver::InitPrepLiDARInertialAlign() const {
     auto &undistFramesInScan = _initAsset->undistFramesInScan;
     auto undistHelper = ScanUndistortion::Create(_splines, _parMagr);
 
-    for (const auto &[topic, data] : _dataMagr->GetLiDARMeasurements()) {
+    for (const auto &topic : lidarTopics) {
         spdlog::info("undistort scans for lidar '{}'...", topic);
 
         // undistort rotation only using 'UNDIST_SO3' in initialization
         undistFramesInScan[topic] = undistHelper->UndistortToScan(
             // raw lidar scans
-            data,
+            lidarMes.at(topic),
             // the ros topic
             topic, ScanUndistortion::Option::UNDIST_SO3);
 
-        spdlog::info("rerun odometer for lidar '{}' using undistorted scans...", topic);
-
-        lidarOdometers[topic] = LiDAROdometer::Create(
-            // resolution of ndt
-            static_cast<float>(Configor::Prior::NDTLiDAROdometer::Resolution),
-            // the thread count for solving
-            Configor::Preference::AvailableThreads());
+        // created here, as the map can not be modified in the concurrent region
+        lidarOdometers[topic] = CreateLiDAROdometer();
+    }
 
+    spdlog::info("rerun odometers for {} LiDAR(s) using undistorted scans...",
+                 lidarTopics.size());
+    ForEachLiDARConcurrently([&](const std::string &topic) {
+        const auto &data = lidarMes.at(topic);
         const auto &undistFrames = undistFramesInScan.at(topic);
-        auto bar = std::make_shared<tqdm>();
         for (int i = 0; i < static_cast<int>(undistFrames.size()); ++i) {
-            bar->progress(i, static_cast<int>(undistFrames.size()));
-
             // clear the viewer
-            _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
-            _viewer->AddAlignedCloud(data.at(i)->GetScan(), Viewer::VIEW_ASSOCIATION);
+            if (_viewer != nullptr) {
+                // converted out of the critical section as well
+                auto scan = data.at(i)->GetScan();
+#pragma omp critical(viewer)
+                {
+                    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+                    _viewer->AddAlignedCloud(scan, Viewer::VIEW_ASSOCIATION);
+                }
+            }
 
             auto curUndistFrame = undistFrames.at(i);
             // we compute the prior rotation from the estimated rotation spline and extrinsics
@@ -183,12 +247,18 @@ void CalibSolver::InitPrepLiDARInertialAlign() const {
             }
             lidarOdometers.at(topic)->FeedFrame(curUndistFrame, predCurToLast, i < 100);
         }
-        bar->finish();
+        spdlog::info("odometer for lidar '{}' finished, frames: {}, key frames: {}", topic,
+                     lidarOdometers.at(topic)->FrameSize(),
+                     lidarOdometers.at(topic)->KeyFrameSize());
+    });
 
-        // update the viewer, add global lidar map
+    // update the viewer, add global lidar maps
+    if (_viewer != nullptr) {
         _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
-        _viewer->AddCloud(lidarOdometers.at(topic)->GetMap(), Viewer::VIEW_MAP,
-                          ns_viewer::Entity::GetUniqueColour(), 2.0f);
+        for (const auto &topic : lidarTopics) {
+            _viewer->AddCloud(lidarOdometers.at(topic)->GetMap(), Viewer::VIEW_MAP,
+                              ns_viewer::Entity::GetUniqueColour(), 2.0f);
+        }
     }
 
     /**
@@ -123,7 +123,9 @@ void CalibSolver::InitPrepPosCameraInertialAlign() const {
             spdlog::info("extrinsic rotation of '{}' is recovered using '{:06}' frames", topic,
                          odometer->GetRotations().size());
         }
-        _viewer->UpdateSensorViewer();
+        if (_viewer != nullptr) {
+            _viewer->UpdateSensorViewer();
+        }
 
         rotOnlyOdom.insert({topic, odometer});
     }
@@ -208,7 +210,9 @@ void CalibSolver::InitPrepPosCameraInertialAlign() const {
             _dataMagr->SetSfMData(topic, veta);
 
             // just for visualization
-            _viewer->AddVeta(veta, Viewer::VIEW_MAP);
+            if (_viewer != nullptr) {
+                _viewer->AddVeta(veta, Viewer::VIEW_MAP);
+            }
 
             spdlog::info(
                 "SfM info for topic '{}' after filtering: view count: {}, landmark count: {}",
@@ -186,7 +186,9 @@ void CalibSolver::InitPrepVelCameraInertialAlign() const {
                     estimator->Solve(optWithoutOutput, _priori);
                 }
 
-                _viewer->UpdateSensorViewer();
+                if (_viewer != nullptr) {
+                    _viewer->UpdateSensorViewer();
+                }
             }
         }
         bar->finish();
@@ -204,7 +206,9 @@ void CalibSolver::InitPrepVelCameraInertialAlign() const {
                          "insufficiently excited motion or bad images.");
         }
     }
-    _viewer->ClearViewer(Viewer::VIEW_MAP);
+    if (_viewer != nullptr) {
+        _viewer->ClearViewer(Viewer::VIEW_MAP);
+    }
     cv::destroyAllWindows();
 
     /**
@@ -457,6 +457,9 @@ void CalibSolver::InitSensorInertialAlign() const {
     }
 
     for (const auto &[topic, lidarOdom] : _initAsset->lidarOdometers) {
+        if (_viewer == nullptr) {
+            break;
+        }
         _viewer->AddCloud(lidarOdom->GetMap(), Viewer::VIEW_MAP,
                           ns_viewer::Entity::GetUniqueColour(), 2.0f);
     }
@@ -467,7 +470,9 @@ void CalibSolver::InitSensorInertialAlign() const {
         spdlog::info("visual global scale for camera '{}': {:.3f}", camTopic,
                      visualScaleSeq.at(camTopic));
         PerformTransformForVeta(veta, ns_veta::Posed(), visualScaleSeq.at(camTopic));
-        _viewer->AddVeta(veta, Viewer::VIEW_MAP);
+        if (_viewer != nullptr) {
+            _viewer->AddVeta(veta, Viewer::VIEW_MAP);
+        }
     }
     // perform scale for 'sfmPoseSeq', which would used for scale spline recovery
     for (auto &[camTopic, poseSeq] : sfmPoseSeq) {
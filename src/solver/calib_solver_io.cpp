@@ -37,6 +37,7 @@
 #include "calib/estimator.h"
 #include "cereal/types/list.hpp"
 #include "cereal/types/utility.hpp"
+#include "cereal/types/vector.hpp"
 #include "factor/data_correspondence.h"
 #include "opencv2/highgui.hpp"
 #include "opencv2/imgcodecs.hpp"
@@ -88,6 +89,10 @@ void CalibSolverIO::SaveByProductsToDisk() const {
         this->SaveHessianMatrix();
     }
 
+    if (IsOptionWith(OutputOption::SpatTempCovariance, Configor::Preference::Outputs)) {
+        this->SaveSpatTempCovariance();
+    }
+
     if (IsOptionWith(OutputOption::AlignedInertialMes, Configor::Preference::Outputs)) {
         this->SaveAlignedInertialMes();
     }
@@ -187,59 +192,7 @@ void CalibSolverIO::SaveHessianMatrix() const {
     };
 
     // spatiotemporal parameters (extrinsics, time offsets, rs readout time)
-    for (auto &[topic, item] : _solver->_parMagr->EXTRI.SO3_BiToBr) {
-        InvolveParameter(item.data(), "SO3_BiToBr-" + topic);
-    }
-    for (auto &[topic, item] : _solver->_parMagr->EXTRI.POS_BiInBr) {
-        InvolveParameter(item.data(), "POS_BiInBr-" + topic);
-    }
-
-    for (auto &[topic, item] : _solver->_parMagr->EXTRI.SO3_RjToBr) {
-        InvolveParameter(item.data(), "SO3_RjToBr-" + topic);
-    }
-    for (auto &[topic, item] : _solver->_parMagr->EXTRI.POS_RjInBr) {
-        InvolveParameter(item.data(), "POS_RjInBr-" + topic);
-    }
-
-    for (auto &[topic, item] : _solver->_parMagr->EXTRI.SO3_LkToBr) {
-        InvolveParameter(item.data(), "SO3_LkToBr-" + topic);
-    }
-    for (auto &[topic, item] : _solver->_parMagr->EXTRI.POS_LkInBr) {
-        InvolveParameter(item.data(), "POS_LkInBr-" + topic);
-    }
-
-    for (auto &[topic, item] : _solver->_parMagr->EXTRI.SO3_CmToBr) {
-        InvolveParameter(item.data(), "SO3_CmToBr-" + topic);
-    }
-    for (auto &[topic, item] : _solver->_parMagr->EXTRI.POS_CmInBr) {
-        InvolveParameter(item.data(), "POS_CmInBr-" + topic);
-    }
-
-    for (auto &[topic, item] : _solver->_parMagr->EXTRI.SO3_DnToBr) {
-        InvolveParameter(item.data(), "SO3_DnToBr-" + topic);
-    }
-    for (auto &[topic, item] : _solver->_parMagr->EXTRI.POS_DnInBr) {
-        InvolveParameter(item.data(), "POS_DnInBr-" + topic);
-    }
-
-    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.TO_BiToBr) {
-        InvolveParameter(&item, "TO_BiToBr-" + topic);
-    }
-    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.TO_RjToBr) {
-        InvolveParameter(&item, "TO_RjToBr-" + topic);
-    }
-    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.TO_LkToBr) {
-        InvolveParameter(&item, "TO_LkToBr-" + topic);
-    }
-    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.TO_CmToBr) {
-        InvolveParameter(&item, "TO_CmToBr-" + topic);
-    }
-    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.TO_DnToBr) {
-        InvolveParameter(&item, "TO_DnToBr-" + topic);
-    }
-    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.RS_READOUT) {
-        InvolveParameter(&item, "RS_READOUT-" + topic);
-    }
+    this->InvolveSpatTempParameters(InvolveParameter);
 
     // intrinsics
     for (auto &[topic, intri] : _solver->_parMagr->INTRI.IMU) {
@@ -277,17 +230,169 @@ void CalibSolverIO::SaveHessianMatrix() const {
     }
 
     auto hessianMat =
-        estimator->GetHessianMatrix(parAddress, Configor::Preference::AvailableThreads());
+        estimator->GetSparseHessianMatrix(parAddress, Configor::Preference::AvailableThreads());
+
+    // the hessian matrix is symmetric and sparse, only non-zeros of its upper triangle are stored
+    // as (row index, col index, value) triplets, rather than the whole dense matrix
+    std::vector<int> rowIndices, colIndices;
+    std::vector<double> values;
+    for (int k = 0; k < hessianMat.outerSize(); ++k) {
+        for (Eigen::SparseMatrix<double>::InnerIterator it(hessianMat, k); it; ++it) {
+            if (it.row() > it.col()) {
+                continue;
+            }
+            rowIndices.push_back(static_cast<int>(it.row()));
+            colIndices.push_back(static_cast<int>(it.col()));
+            values.push_back(it.value());
+        }
+    }
+
     auto filename = saveDir + "/hessian" + Configor::GetFormatExtension();
     std::ofstream file(filename);
     auto ar = GetOutputArchiveVariant(file, Configor::Preference::OutputDataFormat);
     SerializeByOutputArchiveVariant(
         ar, Configor::Preference::OutputDataFormat, cereal::make_nvp("row", hessianMat.rows()),
-        cereal::make_nvp("col", hessianMat.cols()), cereal::make_nvp("hessian", hessianMat),
+        cereal::make_nvp("col", hessianMat.cols()), cereal::make_nvp("upper_triangle", true),
+        cereal::make_nvp("non_zeros", values.size()), cereal::make_nvp("row_indices", rowIndices),
+        cereal::make_nvp("col_indices", colIndices), cereal::make_nvp("values", values),
         cereal::make_nvp("par_order_size", parOrderSize));
     spdlog::info("saving hessian matrix finished!");
 }
 
+void CalibSolverIO::SaveSpatTempCovariance() const {
+    std::string saveDir = Configor::DataStream::OutputPath + "/covariance";
+    if (TryCreatePath(saveDir)) {
+        spdlog::info("saving covariance of spatiotemporal parameters to dir: '{}'...", saveDir);
+    } else {
+        return;
+    }
+
+    std::vector<double *> parAddress;
+    auto estimator = _solver->_backup->estimator;
+    std::vector<std::pair<std::string, int>> parOrderSize;
+
+    // constant ones (e.g., extrinsics of the reference imu) are certain, thus are not considered
+    this->InvolveSpatTempParameters([&parAddress, &parOrderSize, &estimator](
+                                        double *address, const std::string &name) {
+        if (!estimator->HasParameterBlock(address) ||
+            estimator->IsParameterBlockConstant(address)) {
+            return;
+        }
+        parAddress.push_back(address);
+        parOrderSize.emplace_back(name, estimator->ParameterBlockTangentSize(address));
+    });
+    if (parAddress.empty()) {
+        spdlog::warn("no spatiotemporal parameter is estimated, skip saving covariance!");
+        return;
+    }
+
+    /**
+     * the batch problem has a free gauge, i.e., the yaw of splines about the gravity (and the
+     * origin of the translation spline), thus the first involved knots are held constant in
+     * computation, the covariance is then expressed with respect to the first pose
+     */
+    std::vector<double *> gaugeBlocks;
+    auto FirstKnotInvolved = [&estimator, &gaugeBlocks](auto &spline) {
+        for (int i = 0; i < static_cast<int>(spline.GetKnots().size()); ++i) {
+            if (estimator->HasParameterBlock(spline.GetKnot(i).data())) {
+                gaugeBlocks.push_back(spline.GetKnot(i).data());
+                break;
+            }
+        }
+    };
+    FirstKnotInvolved(_solver->_splines->GetSo3Spline(Configor::Preference::SO3_SPLINE));
+    if (CalibSolver::GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
+        FirstKnotInvolved(_solver->_splines->GetRdSpline(Configor::Preference::SCALE_SPLINE));
+    }
+
+    // all the other parameters (intrinsics, knots, ...) are marginalized
+    auto covMat = estimator->GetMarginalCovariance(parAddress, gaugeBlocks,
+                                                   Configor::Preference::AvailableThreads());
+    if (covMat == std::nullopt) {
+        spdlog::warn(
+            "the covariance of spatiotemporal parameters can not be computed, the jacobian is "
+            "rank deficient even though the gauge is fixed, some parameters may be unobservable "
+            "(e.g., due to degenerate motion or an insufficient number of correspondences)!");
+        return;
+    }
+
+    // standard deviations of parameters
+    for (int i = 0, idx = 0; i < static_cast<int>(parOrderSize.size()); ++i) {
+        const auto &[name, size] = parOrderSize.at(i);
+        Eigen::VectorXd stdDev = covMat->diagonal().segment(idx, size).cwiseSqrt();
+        std::stringstream stringStream;
+        stringStream << stdDev.transpose();
+        spdlog::info("standard deviation of '{}': [{}]", name, stringStream.str());
+        idx += size;
+    }
+
+    auto filename = saveDir + "/spat_temp_covariance" + Configor::GetFormatExtension();
+    std::ofstream file(filename);
+    auto ar = GetOutputArchiveVariant(file, Configor::Preference::OutputDataFormat);
+    SerializeByOutputArchiveVariant(
+        ar, Configor::Preference::OutputDataFormat, cereal::make_nvp("row", covMat->rows()),
+        cereal::make_nvp("col", covMat->cols()), cereal::make_nvp("covariance", *covMat),
+        cereal::make_nvp("par_order_size", parOrderSize));
+    spdlog::info("saving covariance of spatiotemporal parameters finished!");
+}
+
+void CalibSolverIO::InvolveSpatTempParameters(
+    const std::function<void(double *, const std::string &)> &involver) const {
+    for (auto &[topic, item] : _solver->_parMagr->EXTRI.SO3_BiToBr) {
+        involver(item.data(), "SO3_BiToBr-" + topic);
+    }
+    for (auto &[topic, item] : _solver->_parMagr->EXTRI.POS_BiInBr) {
+        involver(item.data(), "POS_BiInBr-" + topic);
+    }
+
+    for (auto &[topic, item] : _solver->_parMagr->EXTRI.SO3_RjToBr) {
+        involver(item.data(), "SO3_RjToBr-" + topic);
+    }
+    for (auto &[topic, item] : _solver->_parMagr->EXTRI.POS_RjInBr) {
+        involver(item.data(), "POS_RjInBr-" + topic);
+    }
+
+    for (auto &[topic, item] : _solver->_parMagr->EXTRI.SO3_LkToBr) {
+        involver(item.data(), "SO3_LkToBr-" + topic);
+    }
+    for (auto &[topic, item] : _solver->_parMagr->EXTRI.POS_LkInBr) {
+        involver(item.data(), "POS_LkInBr-" + topic);
+    }
+
+    for (auto &[topic, item] : _solver->_parMagr->EXTRI.SO3_CmToBr) {
+        involver(item.data(), "SO3_CmToBr-" + topic);
+    }
+    for (auto &[topic, item] : _solver->_parMagr->EXTRI.POS_CmInBr) {
+        involver(item.data(), "POS_CmInBr-" + topic);
+    }
+
+    for (auto &[topic, item] : _solver->_parMagr->EXTRI.SO3_DnToBr) {
+        involver(item.data(), "SO3_DnToBr-" + topic);
+    }
+    for (auto &[topic, item] : _solver->_parMagr->EXTRI.POS_DnInBr) {
+        involver(item.data(), "POS_DnInBr-" + topic);
+    }
+
+    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.TO_BiToBr) {
+        involver(&item, "TO_BiToBr-" + topic);
+    }
+    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.TO_RjToBr) {
+        involver(&item, "TO_RjToBr-" + topic);
+    }
+    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.TO_LkToBr) {
+        involver(&item, "TO_LkToBr-" + topic);
+    }
+    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.TO_CmToBr) {
+        involver(&item, "TO_CmToBr-" + topic);
+    }
+    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.TO_DnToBr) {
+        involver(&item, "TO_DnToBr-" + topic);
+    }
+    for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.RS_READOUT) {
+        involver(&item, "RS_READOUT-" + topic);
+    }
+}
+
 void CalibSolverIO::VerifyVisualLiDARConsistency() const {
     if (!Configor::IsLiDARIntegrated()) {
         return;
@@ -349,8 +454,10 @@ void CalibSolverIO::VerifyVisualLiDARConsistency() const {
 
             // connect
             cv::hconcat(undistImgColor, colorImg, res);
-            cv::imshow("Covisibility Image", res);
-            cv::waitKey(1);
+            if (!Configor::Preference::Headless) {
+                cv::imshow("Covisibility Image", res);
+                cv::waitKey(1);
+            }
         }
         bar->finish();
         // save pose vector
@@ -411,8 +518,10 @@ void CalibSolverIO::VerifyVisualLiDARConsistency() const {
 
             // connect
             cv::hconcat(undistImgColor, colorImg, res);
-            cv::imshow("Covisibility Image", res);
-            cv::waitKey(1);
+            if (!Configor::Preference::Headless) {
+                cv::imshow("Covisibility Image", res);
+                cv::waitKey(1);
+            }
         }
         bar->finish();
         // save pose vector
@@ -466,8 +575,10 @@ void CalibSolverIO::SaveVisualKinematics() const {
             cv::Mat res = gravityDrawer->CreateGravityImg(frame);
             auto filename = subSaveDir + '/' + std::to_string(frame->GetId()) + ".jpg";
             cv::imwrite(filename, res);
-            cv::imshow("Visual Gravity", res);
-            cv::waitKey(1);
+            if (!Configor::Preference::Headless) {
+                cv::imshow("Visual Gravity", res);
+                cv::waitKey(1);
+            }
         }
         bar->finish();
     }
@@ -510,8 +621,10 @@ void CalibSolverIO::SaveVisualKinematics() const {
             cv::Mat res = gravityDrawer->CreateGravityImg(frame);
             auto filename = subSaveDir + '/' + std::to_string(frame->GetId()) + ".jpg";
             cv::imwrite(filename, res);
-            cv::imshow("Visual Gravity", res);
-            cv::waitKey(1);
+            if (!Configor::Preference::Headless) {
+                cv::imshow("Visual Gravity", res);
+                cv::waitKey(1);
+            }
         }
         bar->finish();
     }
@@ -538,8 +651,10 @@ void CalibSolverIO::SaveVisualKinematics() const {
             cv::Mat res = linVelDrawer->CreateLinVelImg(frame);
             auto filename = subSaveDir + '/' + std::to_string(frame->GetId()) + ".jpg";
             cv::imwrite(filename, res);
-            cv::imshow("Visual Linear Velocity", res);
-            cv::waitKey(1);
+            if (!Configor::Preference::Headless) {
+                cv::imshow("Visual Linear Velocity", res);
+                cv::waitKey(1);
+            }
         }
         bar->finish();
     }
@@ -584,8 +699,10 @@ void CalibSolverIO::SaveVisualKinematics() const {
             cv::Mat res = linVelDrawer->CreateLinVelImg(frame, scaleSplineType);
             auto filename = subSaveDir + '/' + std::to_string(frame->GetId()) + ".jpg";
             cv::imwrite(filename, res);
-            cv::imshow("Visual Linear Velocity", res);
-            cv::waitKey(1);
+            if (!Configor::Preference::Headless) {
+                cv::imshow("Visual Linear Velocity", res);
+                cv::waitKey(1);
+            }
         }
         bar->finish();
     }
@@ -612,8 +729,10 @@ void CalibSolverIO::SaveVisualKinematics() const {
             cv::Mat res = angVelDrawer->CreateAngVelImg(frame);
             auto filename = subSaveDir + '/' + std::to_string(frame->GetId()) + ".jpg";
             cv::imwrite(filename, res);
-            cv::imshow("Visual Angular Velocity", res);
-            cv::waitKey(1);
+            if (!Configor::Preference::Headless) {
+                cv::imshow("Visual Angular Velocity", res);
+                cv::waitKey(1);
+            }
         }
         bar->finish();
     }
@@ -656,8 +775,10 @@ void CalibSolverIO::SaveVisualKinematics() const {
             cv::Mat res = angVelDrawer->CreateAngVelImg(frame);
             auto filename = subSaveDir + '/' + std::to_string(frame->GetId()) + ".jpg";
             cv::imwrite(filename, res);
-            cv::imshow("Visual Angular Velocity", res);
-            cv::waitKey(1);
+            if (!Configor::Preference::Headless) {
+                cv::imshow("Visual Angular Velocity", res);
+                cv::waitKey(1);
+            }
         }
         bar->finish();
     }
@@ -113,11 +113,13 @@ void CalibSolver::Process() {
         /**
          * the preparation visualization tasks before the batch optimization.
          */
-        _viewer->ClearViewer(Viewer::VIEW_MAP);
-        if (Configor::IsRadarIntegrated() && GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
-            // add radar cloud if radars and pose spline is maintained
-            auto color = ns_viewer::Colour::Black().WithAlpha(0.2f);
-            _viewer->AddCloud(BuildGlobalMapOfRadar(), Viewer::VIEW_MAP, color, 2.0f);
+        if (_viewer != nullptr) {
+            _viewer->ClearViewer(Viewer::VIEW_MAP);
+            if (Configor::IsRadarIntegrated() && GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
+                // add radar cloud if radars and pose spline is maintained
+                auto color = ns_viewer::Colour::Black().WithAlpha(0.2f);
+                _viewer->AddCloud(BuildGlobalMapOfRadar(), Viewer::VIEW_MAP, color, 2.0f);
+            }
         }
         std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> lidarPtsCorr;
 
@@ -164,7 +166,9 @@ void CalibSolver::Process() {
          * update the viewer and output the spatiotemporal parameters after this batch optimization
          * if output is needed, output the stage parameters to the disk
          */
-        _viewer->UpdateSplineViewer();
+        if (_viewer != nullptr) {
+            _viewer->UpdateSplineViewer();
+        }
         _parMagr->ShowParamStatus();
         if (outputParams) {
             SaveStageCalibParam(_parMagr, "stage_4_bo_" + std::to_string(i));
@@ -181,11 +185,13 @@ void CalibSolver::Process() {
 #if USE_CROSS_MODEL_REFINEMENT
     for (int i = 0; i < 3; ++i) {
         spdlog::info("perform '{}-th' cross-model batch optimization...", i);
-        _viewer->ClearViewer(Viewer::VIEW_MAP);
-        // add radar cloud if radars and pose spline is maintained
-        if (Configor::IsRadarIntegrated() && GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
-            auto color = ns_viewer::Colour::Black().WithAlpha(0.2f);
-            _viewer->AddCloud(BuildGlobalMapOfRadar(), Viewer::VIEW_MAP, color, 2.0f);
+        if (_viewer != nullptr) {
+            _viewer->ClearViewer(Viewer::VIEW_MAP);
+            // add radar cloud if radars and pose spline is maintained
+            if (Configor::IsRadarIntegrated() && GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
+                auto color = ns_viewer::Colour::Black().WithAlpha(0.2f);
+                _viewer->AddCloud(BuildGlobalMapOfRadar(), Viewer::VIEW_MAP, color, 2.0f);
+            }
         }
 
         std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> lidarPtsCorr;
@@ -221,7 +227,9 @@ void CalibSolver::Process() {
             // the spatiotemporal parameters between rgb camera and depth camera would be conflict
             rgbdPtsCorr);
 
-        _viewer->UpdateSplineViewer();
+        if (_viewer != nullptr) {
+            _viewer->UpdateSplineViewer();
+        }
         _parMagr->ShowParamStatus();
 
         if (IsOptionWith(OutputOption::ParamInEachIter, Configor::Preference::Outputs)) {
@@ -234,7 +242,9 @@ void CalibSolver::Process() {
     /**
      * some tasks after batch optimization
      */
-    _viewer->ClearViewer(Viewer::VIEW_MAP);
+    if (_viewer != nullptr) {
+        _viewer->ClearViewer(Viewer::VIEW_MAP);
+    }
     if (Configor::IsLiDARIntegrated()) {
         spdlog::info("build final lidar map and point-to-surfel correspondences...");
         // aligned map
@@ -244,18 +254,22 @@ void CalibSolver::Process() {
         // lidar map and corr map would be added to the viewer in this function
         _backup->lidarCorrs =
             DataAssociationForLiDARs(std::get<0>(final), std::get<1>(final), 100000);
+        // surfel maps would not be updated anymore
+        _lidarAssociator = nullptr;
     }
     if (Configor::IsRadarIntegrated() && GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
         spdlog::info("build final radar map...");
         // radar map would be added to the viewer in this function
         _backup->radarMap = BuildGlobalMapOfRadar();
     }
-    if (Configor::IsPosCameraIntegrated()) {
+    // the following vetas are only for visualization
+    if (_viewer != nullptr && Configor::IsPosCameraIntegrated()) {
         for (const auto &[topic, sfmData] : _dataMagr->GetSfMData()) {
             _viewer->AddVeta(sfmData, Viewer::VIEW_MAP);
         }
     }
-    if (Configor::IsRGBDIntegrated() && GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
+    if (_viewer != nullptr && Configor::IsRGBDIntegrated() &&
+        GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
         // add veta from pixel dynamics
         for (const auto &[topic, _] : Configor::DataStream::RGBDTopics) {
             const auto &veta = CreateVetaFromOpticalFlow(topic, _backup->ofCorrs.at(topic),
@@ -270,7 +284,8 @@ void CalibSolver::Process() {
             }
         }
     }
-    if (Configor::IsVelCameraIntegrated() && GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
+    if (_viewer != nullptr && Configor::IsVelCameraIntegrated() &&
+        GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
         // add veta from pixel dynamics
         for (const auto &[topic, _] : Configor::DataStream::VelCameraTopics()) {
             const auto &intri = _parMagr->INTRI.Camera.at(topic);
@@ -222,6 +222,16 @@ double NormalizeAngle(double ang_degree) {
     return ang_degree;
 }
 
+std::size_t SpatialHash(std::int64_t ix, std::int64_t iy, std::int64_t iz) {
+    // large primes from 'Optimized Spatial Hashing for Collision Detection of Deformable Objects'
+    return static_cast<std::size_t>(ix) * 73856093 ^ static_cast<std::size_t>(iy) * 19349669 ^
+           static_cast<std::size_t>(iz) * 83492791;
+}
+
+std::size_t SpatialHasher::operator()(const Eigen::Vector3i &key) const {
+    return SpatialHash(key(0), key(1), key(2));
+}
+
 std::vector<std::string> FilesInDir(const std::string &directory) {
     std::vector<std::string> files;
     for (const auto &elem : std::filesystem::directory_iterator(directory))
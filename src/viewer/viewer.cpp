@@ -214,7 +214,7 @@ void Viewer::ZoomOutCoordCallBack() {
     UpdateSplineViewer();
 }
 
-Viewer &Viewer::AddSurfelMap(const ufo::map::SurfelMap &smp,
+Viewer &Viewer::AddSurfelMap(const std::vector<std::shared_ptr<ufo::map::SurfelMap>> &smps,
                              const PointToSurfelCondition &condition,
                              const std::string &view) {
     namespace ufopred = ufo::map::predicate;
@@ -225,16 +225,19 @@ Viewer &Viewer::AddSurfelMap(const ufo::map::SurfelMap &smp,
                 ufopred::NumSurfelPointsMin(condition.surfelPointMin) &&
                 ufopred::SurfelPlanarityMin(condition.planarityMin);
 
-    for (const auto &node : smp.query(pred)) {
-        // create entities
-        auto cen = smp.getNodeCenter(node);
-        auto pose =
-            ns_viewer::Posef(Eigen::Matrix3f::Identity(), Eigen::Vector3f(cen.x, cen.y, cen.z));
-        auto min = smp.getNodeMin(node), max = smp.getNodeMax(node);
-        auto cube = ns_viewer::Cube::Create(pose, true, max.x - min.x, max.y - min.y, max.z - min.z,
-                                            ns_viewer::Colour::Black().WithAlpha(0.4f));
-
-        entities.push_back(cube);
+    for (const auto &smp : smps) {
+        for (const auto &node : smp->query(pred)) {
+            // create entities
+            auto cen = smp->getNodeCenter(node);
+            auto pose =
+                ns_viewer::Posef(Eigen::Matrix3f::Identity(), Eigen::Vector3f(cen.x, cen.y, cen.z));
+            auto min = smp->getNodeMin(node), max = smp->getNodeMax(node);
+            auto cube =
+                ns_viewer::Cube::Create(pose, true, max.x - min.x, max.y - min.y, max.z - min.z,
+                                        ns_viewer::Colour::Black().WithAlpha(0.4f));
+
+            entities.push_back(cube);
+        }
     }
 
     entities.push_back(Gravity());
@@ -244,7 +247,7 @@ Viewer &Viewer::AddSurfelMap(const ufo::map::SurfelMap &smp,
 }
 
 Viewer &Viewer::AddPointToSurfel(
-    const ufo::map::SurfelMap &smp,
+    const std::vector<std::shared_ptr<ufo::map::SurfelMap>> &smps,
     const std::map<std::string, std::vector<PointToSurfelCorrPtr>> &corrs,
     const std::string &view) {
     std::map<ufo::map::Node, std::vector<PointToSurfelCorr::Ptr>> nodes;
@@ -254,6 +257,8 @@ Viewer &Viewer::AddPointToSurfel(
         }
     }
 
+    // geometries of nodes only depend on the resolution and depth shared by all surfel maps
+    const auto &smp = *smps.front();
     std::vector<ns_viewer::Entity::Ptr> entities;
     for (const auto &[node, nodeCorrs] : nodes) {
         auto color = ns_viewer::Entity::GetUniqueColour();